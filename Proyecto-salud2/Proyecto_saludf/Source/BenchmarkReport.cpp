@@ -0,0 +1,144 @@
+/**
+ * @file BenchmarkReport.cpp
+ * @brief Implementación de la clase BenchmarkReport, resultados de las pruebas de rendimiento en JSON.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "BenchmarkReport.h"
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QSysInfo>
+#include <QtGlobal>
+
+/**
+ * @brief Constructor. Inicia el cronómetro.
+ * @param report Informe donde se registra el resultado.
+ * @param name Nombre de la prueba.
+ * @param rowsPerIteration Filas procesadas en cada iteración, o 0.
+ */
+BenchmarkReport::Measurement::Measurement(BenchmarkReport& report, const QString& name, qint64 rowsPerIteration)
+    : m_report(report),
+      m_name(name),
+      m_rowsPerIteration(rowsPerIteration),
+      m_iterations(0)
+{
+    m_timer.start();
+}
+
+/**
+ * @brief Destructor. Registra el resultado si hubo iteraciones.
+ */
+BenchmarkReport::Measurement::~Measurement()
+{
+    if (m_iterations > 0) {
+        m_report.record(m_name, m_iterations, m_timer.nsecsElapsed(), m_rowsPerIteration);
+    }
+}
+
+/**
+ * @brief Constructor.
+ * @param suite Nombre de la suite.
+ */
+BenchmarkReport::BenchmarkReport(const QString& suite)
+    : m_suite(suite)
+{
+}
+
+/**
+ * @brief Añade un parámetro del conjunto de datos (filas, usuarios, semilla...).
+ * @param key Nombre del parámetro.
+ * @param value Valor.
+ */
+void BenchmarkReport::setParameter(const QString& key, const QJsonValue& value)
+{
+    m_parameters.insert(key, value);
+}
+
+/**
+ * @brief Registra el resultado de una prueba.
+ * @param name Nombre de la prueba.
+ * @param iterations Iteraciones medidas.
+ * @param elapsedNs Tiempo total de las iteraciones en nanosegundos.
+ * @param rowsPerIteration Filas procesadas en cada iteración, o 0.
+ */
+void BenchmarkReport::record(const QString& name, qint64 iterations, qint64 elapsedNs, qint64 rowsPerIteration)
+{
+    Result result;
+    result.name = name;
+    result.iterations = iterations;
+    result.nsPerIteration = iterations > 0 ? static_cast<double>(elapsedNs) / iterations : 0;
+    result.rowsPerIteration = rowsPerIteration;
+    m_results.append(result);
+}
+
+/**
+ * @brief Resultados registrados, en orden.
+ * @return Lista de resultados.
+ */
+const QVector<BenchmarkReport::Result>& BenchmarkReport::results() const
+{
+    return m_results;
+}
+
+/**
+ * @brief Documento JSON del informe.
+ * @return Objeto con la suite, el entorno, los parámetros y los resultados.
+ */
+QJsonObject BenchmarkReport::toJson() const
+{
+    QJsonObject environment;
+    environment.insert("qt_version", QString::fromLatin1(qVersion()));
+    environment.insert("os", QSysInfo::prettyProductName());
+    environment.insert("cpu_architecture", QSysInfo::currentCpuArchitecture());
+    environment.insert("kernel", QSysInfo::kernelType() + ' ' + QSysInfo::kernelVersion());
+
+    QJsonArray results;
+    for (const Result& result : m_results) {
+        QJsonObject entry;
+        entry.insert("name", result.name);
+        entry.insert("iterations", static_cast<double>(result.iterations));
+        entry.insert("ns_per_iteration", result.nsPerIteration);
+        if (result.rowsPerIteration > 0 && result.nsPerIteration > 0) {
+            entry.insert("rows_per_iteration", static_cast<double>(result.rowsPerIteration));
+            entry.insert("rows_per_second", result.rowsPerIteration * 1e9 / result.nsPerIteration);
+        }
+        results.append(entry);
+    }
+
+    QJsonObject report;
+    report.insert("suite", m_suite);
+    report.insert("timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    report.insert("label", qEnvironmentVariable("SALUD_BENCH_LABEL"));
+    report.insert("environment", environment);
+    report.insert("dataset", m_parameters);
+    report.insert("results", results);
+    return report;
+}
+
+/**
+ * @brief Escribe el informe en un archivo, reemplazándolo de forma atómica.
+ * @param filePath Archivo de destino.
+ * @return true si se escribió correctamente.
+ */
+bool BenchmarkReport::write(const QString& filePath) const
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(toJson()).toJson(QJsonDocument::Indented));
+    return file.commit();
+}
+
+/**
+ * @brief Archivo de salida configurado.
+ * @return SALUD_BENCH_JSON, o "benchmark-results.json" si no está definida.
+ */
+QString BenchmarkReport::outputPath()
+{
+    const QString path = qEnvironmentVariable("SALUD_BENCH_JSON");
+    return path.isEmpty() ? QStringLiteral("benchmark-results.json") : path;
+}
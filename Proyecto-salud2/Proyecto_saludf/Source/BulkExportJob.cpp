@@ -0,0 +1,300 @@
+/**
+ * @file BulkExportJob.cpp
+ * @brief Implementación de la clase BulkExportJob, exportación paralela de todos los usuarios en archivos fragmentados.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "BulkExportJob.h"
+#include "Logging.h"
+#include "CSVExporter.h"
+#include "DatabaseManager.h"
+#include <QDir>
+#include <QFile>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QThread>
+
+namespace {
+/**
+ * @brief Cada cuántas filas una tarea informa su progreso.
+ */
+const qint64 kProgressInterval = 65536;
+}
+
+/**
+ * @brief Constructor del trabajo.
+ * @param outputDirectory Directorio donde se escriben los fragmentos y el manifiesto.
+ * @param options Opciones de formato CSV de los fragmentos.
+ * @param parent Objeto padre, por defecto nullptr.
+ */
+BulkExportJob::BulkExportJob(const QString& outputDirectory, const CSVOptions& options, QObject *parent)
+    : QObject(parent),
+      m_outputDirectory(outputDirectory),
+      m_options(options),
+      m_totalRows(0),
+      m_rowsDone(0),
+      m_pendingShards(0),
+      m_cancelled(false),
+      m_running(false)
+{
+    m_pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+/**
+ * @brief Destructor. Cancela y espera a las tareas en curso.
+ */
+BulkExportJob::~BulkExportJob()
+{
+    cancel();
+    m_pool.waitForDone();
+}
+
+/**
+ * @brief Número de tareas paralelas; por defecto, el número de núcleos.
+ * @param threads Número de hilos.
+ */
+void BulkExportJob::setThreadCount(int threads)
+{
+    m_pool.setMaxThreadCount(qMax(1, threads));
+}
+
+/**
+ * @brief Ruta del manifiesto del trabajo.
+ * @return Ruta del archivo manifest.json.
+ */
+QString BulkExportJob::manifestPath() const
+{
+    return QDir(m_outputDirectory).filePath("manifest.json");
+}
+
+/**
+ * @brief Reparte los usuarios en fragmentos equilibrados por número de filas.
+ * @return true si se pudieron leer los conteos por usuario.
+ *
+ * Se planifican cuatro fragmentos por hilo para que un usuario con mucho historial no deje a
+ * los demás hilos ociosos al final. Los usuarios se asignan en orden de id a fragmentos
+ * contiguos hasta alcanzar la cuota de filas de cada uno.
+ */
+bool BulkExportJob::planShards()
+{
+    QSqlQuery query(DatabaseManager::instance().getDatabase());
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT user_id, COUNT(*) FROM health_records GROUP BY user_id ORDER BY user_id")) {
+        qCWarning(lcExport) << "Error al planificar la exportación masiva:" << query.lastError().text();
+        return false;
+    }
+
+    QVector<QPair<int, qint64>> counts;
+    m_totalRows = 0;
+    while (query.next()) {
+        const qint64 rows = query.value(1).toLongLong();
+        counts.append(qMakePair(query.value(0).toInt(), rows));
+        m_totalRows += rows;
+    }
+
+    m_shards.clear();
+    if (counts.isEmpty()) {
+        return true;
+    }
+
+    const int shardCount = qMax(1, qMin(counts.size(), m_pool.maxThreadCount() * 4));
+    const qint64 target = qMax<qint64>(1, (m_totalRows + shardCount - 1) / shardCount);
+
+    Shard current;
+    for (const auto& count : counts) {
+        current.userIds.append(count.first);
+        current.expectedRows += count.second;
+        if (current.expectedRows >= target) {
+            current.index = m_shards.size();
+            m_shards.append(current);
+            current = Shard();
+        }
+    }
+    if (!current.userIds.isEmpty()) {
+        current.index = m_shards.size();
+        m_shards.append(current);
+    }
+    for (Shard& shard : m_shards) {
+        shard.fileName = QString("shard-%1.csv").arg(shard.index, 5, 10, QChar('0'));
+    }
+    return true;
+}
+
+/**
+ * @brief Inicia la exportación sin bloquear al llamador.
+ * @return true si el trabajo arrancó, false si no hay datos que exportar o ya está en curso.
+ */
+bool BulkExportJob::start()
+{
+    if (m_running.exchange(true)) {
+        qCDebug(lcExport) << "La exportación masiva ya está en curso";
+        return false;
+    }
+    if (!QDir().mkpath(m_outputDirectory) || !planShards() || m_shards.isEmpty()) {
+        qCWarning(lcExport) << "No hay datos para la exportación masiva o el directorio no es válido:" << m_outputDirectory;
+        m_running.store(false);
+        return false;
+    }
+
+    m_cancelled.store(false);
+    m_rowsDone.store(0);
+    m_pendingShards.store(m_shards.size());
+    qCInfo(lcExport) << "Exportación masiva:" << m_totalRows << "filas en" << m_shards.size()
+             << "fragmentos con" << m_pool.maxThreadCount() << "hilos";
+
+    for (int i = 0; i < m_shards.size(); ++i) {
+        m_pool.start(QRunnable::create([this, i]() { exportShard(i); }));
+    }
+    return true;
+}
+
+/**
+ * @brief Solicita la cancelación; las tareas terminan en la siguiente fila.
+ */
+void BulkExportJob::cancel()
+{
+    m_cancelled.store(true);
+}
+
+/**
+ * @brief Espera a que terminen todas las tareas.
+ */
+void BulkExportJob::waitForFinished()
+{
+    m_pool.waitForDone();
+}
+
+/**
+ * @brief Exporta un fragmento. Se ejecuta en un hilo del pool.
+ * @param shardIndex Índice del fragmento.
+ *
+ * Cada tarea usa su propia conexión de lectura (en WAL los lectores no se bloquean entre sí)
+ * y su propio archivo, así que no comparte nada con las demás salvo los contadores.
+ */
+void BulkExportJob::exportShard(int shardIndex)
+{
+    Shard shard;
+    {
+        QMutexLocker locker(&m_mutex);
+        shard = m_shards[shardIndex];
+    }
+
+    const QString connectionName = QString("bulk_export_%1").arg(shardIndex);
+    {
+        QSqlDatabase connection = DatabaseManager::openConnection(connectionName);
+        QFile file(QDir(m_outputDirectory).filePath(shard.fileName));
+
+        if (connection.isOpen() && file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            CSVWriter writer(&file, m_options);
+            CSVExporter::writeHeader(writer, m_options);
+
+            QSqlQuery query(connection);
+            query.setForwardOnly(true);
+            query.prepare(CSVExporter::selectColumnsSql() + " WHERE user_id = :user_id ORDER BY date_time, id");
+
+            shard.ok = true;
+            qint64 reported = 0;
+            for (int userId : shard.userIds) {
+                if (m_cancelled.load(std::memory_order_relaxed)) {
+                    shard.ok = false;
+                    break;
+                }
+                query.bindValue(":user_id", userId);
+                if (!query.exec()) {
+                    qCWarning(lcExport) << "Error al exportar user_id" << userId << ":" << query.lastError().text();
+                    shard.ok = false;
+                    break;
+                }
+                // writeRows por lotes para poder informar progreso y atender la cancelación
+                while (!m_cancelled.load(std::memory_order_relaxed)) {
+                    const qint64 rows = CSVExporter::writeRows(query, writer, kProgressInterval);
+                    shard.rows += rows;
+                    if (shard.rows - reported >= kProgressInterval) {
+                        emit progress(m_rowsDone.fetch_add(shard.rows - reported) + shard.rows - reported, m_totalRows);
+                        reported = shard.rows;
+                    }
+                    if (rows < kProgressInterval) {
+                        break;
+                    }
+                }
+                query.finish();
+            }
+            shard.ok = writer.flush() && shard.ok && !m_cancelled.load();
+            shard.bytes = writer.bytesWritten();
+            m_rowsDone.fetch_add(shard.rows - reported);
+            file.close();
+        } else {
+            qCWarning(lcExport) << "No se pudo preparar el fragmento" << shard.fileName << ":" << file.errorString()
+                     << connection.lastError().text();
+        }
+        connection.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_shards[shardIndex] = shard;
+    }
+    emit progress(m_rowsDone.load(), m_totalRows);
+
+    if (m_pendingShards.fetch_sub(1) == 1) {
+        finish();
+    }
+}
+
+/**
+ * @brief Escribe el manifiesto y emite finished(). La llama la última tarea en terminar.
+ */
+void BulkExportJob::finish()
+{
+    bool success = !m_cancelled.load();
+    QJsonArray shards;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (const Shard& shard : m_shards) {
+            QJsonArray users;
+            for (int userId : shard.userIds) {
+                users.append(userId);
+            }
+            QJsonObject entry;
+            entry["file"] = shard.fileName;
+            entry["users"] = users;
+            entry["rows"] = static_cast<double>(shard.rows);
+            entry["bytes"] = static_cast<double>(shard.bytes);
+            entry["complete"] = shard.ok;
+            shards.append(entry);
+            success = success && shard.ok;
+        }
+    }
+
+    QJsonObject manifest;
+    manifest["version"] = 1;
+    manifest["created"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    manifest["database"] = DatabaseManager::databasePath();
+    manifest["format"] = "csv";
+    manifest["delimiter"] = QString(QChar(m_options.delimiter));
+    manifest["header"] = m_options.writeHeader;
+    manifest["totalRows"] = static_cast<double>(m_totalRows);
+    manifest["exportedRows"] = static_cast<double>(m_rowsDone.load());
+    manifest["cancelled"] = m_cancelled.load();
+    manifest["shards"] = shards;
+
+    QFile file(manifestPath());
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+        || file.write(QJsonDocument(manifest).toJson()) < 0) {
+        qCWarning(lcExport) << "Error al escribir el manifiesto de la exportación:" << file.errorString();
+        success = false;
+    }
+    file.close();
+
+    qCInfo(lcExport) << "Exportación masiva terminada. Éxito:" << success << ", filas:" << m_rowsDone.load();
+    m_running.store(false);
+    emit finished(success, manifestPath());
+}
@@ -6,45 +6,235 @@
  */
 
 #include "CSVExporter.h"
+#include "Logging.h"
+#include "Trace.h"
+#include "DatabaseManager.h"
+#include "ParallelCompressor.h"
 #include <QFile>
-#include <QTextStream>
-#include <QDebug>
+#include <QSqlError>
+#include <QVariant>
+#include <memory>
+
+namespace {
+/**
+ * @brief Cabecera de los archivos CSV exportados.
+ */
+const char* const kHeaderColumns[] = {
+    "ID", "User ID", "DateTime", "Weight", "Blood Pressure", "Glucose Level"
+};
+
+/**
+ * @class ExportOutput
+ * @brief Archivo de salida de una exportación, comprimido si la extensión lo pide (.gz o .zst).
+ */
+class ExportOutput
+{
+public:
+    /**
+     * @brief Abre el archivo y, si corresponde, el compresor por encima.
+     * @param filePath Ruta del archivo.
+     * @return Dispositivo donde escribir el CSV, o nullptr si no se pudo abrir.
+     */
+    QIODevice* open(const QString& filePath)
+    {
+        m_file.setFileName(filePath);
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCWarning(lcExport) << "Error al abrir el archivo:" << m_file.errorString();
+            return nullptr;
+        }
+        CompressionOptions compression;
+        if (!ParallelCompressor::codecForPath(filePath, &compression.codec)) {
+            return &m_file;
+        }
+        m_compressor.reset(new ParallelCompressor(&m_file, compression));
+        if (!m_compressor->open(QIODevice::WriteOnly)) {
+            m_file.close();
+            return nullptr;
+        }
+        return m_compressor.get();
+    }
+
+    /**
+     * @brief Termina la compresión pendiente y cierra el archivo.
+     * @return true si todo se escribió correctamente.
+     */
+    bool close()
+    {
+        bool success = true;
+        if (m_compressor) {
+            m_compressor->close();
+            success = m_compressor->ok();
+        }
+        m_file.close();
+        return success;
+    }
+
+private:
+    /**
+     * @brief Archivo de destino.
+     */
+    QFile m_file;
+
+    /**
+     * @brief Compresor por bloques, si la extensión lo pide.
+     */
+    std::unique_ptr<ParallelCompressor> m_compressor;
+};
+}
 
 /**
  * @brief Exporta registros de salud a un archivo CSV.
  * @param filePath Ruta del archivo CSV donde se guardarán los datos.
  * @param records Vector de registros de salud a exportar.
+ * @param options Opciones de formato CSV.
  * @return true si la exportación es exitosa, false en caso contrario.
  *
- * Escribe los registros en formato CSV, escapando comas en el campo de presión arterial.
+ * Escribe los registros con CSVWriter; la presión arterial se entrecomilla según RFC 4180
+ * cuando contiene el delimitador. Si la ruta termina en .gz o .zst la salida se comprime.
  */
-bool CSVExporter::exportToCSV(const QString& filePath, const QVector<healthrecord>& records) {
-    // Abrir el archivo CSV
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qDebug() << "Error al abrir el archivo:" << file.errorString();
+bool CSVExporter::exportToCSV(const QString& filePath, const QVector<healthrecord>& records,
+                              const CSVOptions& options)
+{
+    TRACE_SPAN("export", "CSVExporter::exportToCSV");
+    // Abrir el archivo CSV en modo binario: los saltos de línea los decide CSVOptions
+    ExportOutput output;
+    QIODevice* device = output.open(filePath);
+    if (!device) {
         return false;
     }
 
-    // Crear un flujo de texto para escribir en el archivo
-    QTextStream out(&file);
-
-    // Escribir la cabecera del CSV
-    out << "ID,User ID,DateTime,Weight,Blood Pressure,Glucose Level\n";
+    CSVWriter writer(device, options);
+    writeHeader(writer, options);
 
-    // Escribir cada registro
     for (const healthrecord& record : records) {
-        // Escapar comas en blood_pressure para evitar problemas en el CSV
-        QString bloodPressure = QString(record.getBloodPressure()).replace(",", ";");
-        out << QString("%1,%2,%3,%4,%5,%6\n")
-               .arg(record.getId())
-               .arg(record.getUserId())
-               .arg(record.getDateTime().toString("yyyy-MM-dd hh:mm:ss"))
-               .arg(record.getWeight())
-               .arg(bloodPressure)
-               .arg(record.getGlucose());
-    }
-
-    file.close();
-    return true;
+        const QDateTime dateTime = record.getDateTime();
+        const QDate date = dateTime.date();
+        const QTime time = dateTime.time();
+
+        writer.writeText(record.getId());
+        writer.writeText(record.getUserId());
+        writer.writeDateTime(date.year(), date.month(), date.day(), time.hour(), time.minute(), time.second());
+        writer.writeFloat(record.getWeight());
+        writer.writeText(record.getBloodPressure());
+        writer.writeFloat(record.getGlucose());
+        writer.endRow();
+    }
+
+    const bool flushed = writer.flush();
+    return output.close() && flushed;
+}
+
+/**
+ * @brief Exporta los registros de un usuario leyéndolos de la base de datos con un cursor.
+ * @param filePath Ruta del archivo CSV donde se guardarán los datos.
+ * @param userId Identificador del usuario.
+ * @param options Opciones de formato CSV.
+ * @return true si la exportación es exitosa, false en caso contrario.
+ *
+ * Recorre las filas en orden (date_time, id) con una consulta forwardOnly sobre el índice
+ * (user_id, date_time), de modo que nunca hay más de una fila materializada en memoria.
+ * Si la ruta termina en .gz o .zst la salida se comprime por bloques en paralelo.
+ */
+bool CSVExporter::exportUserRecords(const QString& filePath, int userId, const CSVOptions& options)
+{
+    TRACE_SPAN("export", "CSVExporter::exportUserRecords");
+    QSqlQuery query(DatabaseManager::instance().getDatabase());
+    query.setForwardOnly(true);
+    query.prepare(selectColumnsSql() + " WHERE user_id = :user_id ORDER BY date_time, id");
+    query.bindValue(":user_id", userId);
+    if (!query.exec()) {
+        qCWarning(lcExport) << "Error al consultar los registros a exportar:" << query.lastError().text();
+        return false;
+    }
+
+    ExportOutput output;
+    QIODevice* device = output.open(filePath);
+    if (!device) {
+        return false;
+    }
+
+    CSVWriter writer(device, options);
+    writeHeader(writer, options);
+    const qint64 rows = writeRows(query, writer);
+
+    const bool flushed = writer.flush();
+    const bool success = output.close() && flushed;
+    qCInfo(lcExport) << "Exportadas" << rows << "filas," << writer.bytesWritten() << "bytes, para user_id:" << userId;
+    return success;
+}
+
+/**
+ * @brief Consulta SQL que produce las columnas en el orden que espera writeRows().
+ * @param extraColumns Columnas adicionales después de las seis exportadas, o vacío.
+ * @return Sentencia SELECT sin cláusula WHERE ni ORDER BY.
+ *
+ * La fecha se entrega como segundos desde la época calculados por SQLite sobre el texto
+ * almacenado, sin conversión de zona, para formatearla con ancho fijo sin pasar por QDateTime.
+ * writeRows() no escribe las columnas adicionales; sirven para leerlas con keyColumn.
+ */
+QString CSVExporter::selectColumnsSql(const QString& extraColumns)
+{
+    return "SELECT id, user_id, CAST(strftime('%s', date_time) AS INTEGER), weight, blood_pressure, glucose_level"
+           + (extraColumns.isEmpty() ? QString() : ", " + extraColumns) + " FROM health_records";
+}
+
+/**
+ * @brief Escribe la fila de cabecera si las opciones lo piden.
+ * @param writer Escritor CSV.
+ * @param options Opciones de formato.
+ */
+void CSVExporter::writeHeader(CSVWriter& writer, const CSVOptions& options)
+{
+    if (!options.writeHeader) {
+        return;
+    }
+    for (const char* column : kHeaderColumns) {
+        writer.writeText(column, static_cast<int>(qstrlen(column)));
+    }
+    writer.endRow();
+}
+
+/**
+ * @brief Escribe como filas CSV el resultado de una consulta basada en selectColumnsSql().
+ * @param query Consulta ejecutada, preferiblemente en modo forwardOnly.
+ * @param writer Escritor CSV.
+ * @param maxRows Número máximo de filas a escribir en esta llamada, o -1 para todas.
+ * @param lastKey Si no es nulo y se escribió alguna fila, recibe la columna keyColumn de la última.
+ * @param keyColumn Columna de la consulta que se devuelve en lastKey; 0 es el id.
+ * @return Número de filas escritas.
+ *
+ * Los valores NULL se escriben como campos vacíos. Con maxRows el cursor queda en la última
+ * fila escrita, de modo que una nueva llamada continúa donde terminó la anterior.
+ */
+qint64 CSVExporter::writeRows(QSqlQuery& query, CSVWriter& writer, qint64 maxRows, qint64* lastKey, int keyColumn)
+{
+    TRACE_SPAN("export", "CSVExporter::writeRows");
+    qint64 rows = 0;
+    while ((maxRows < 0 || rows < maxRows) && query.next()) {
+        writer.writeInt(query.value(0).toLongLong());
+        if (lastKey) {
+            *lastKey = query.value(keyColumn).toLongLong();
+        }
+        writer.writeInt(query.value(1).toLongLong());
+        writer.writeEpochSeconds(query.value(2).toLongLong());
+
+        const QVariant weight = query.value(3);
+        if (weight.isNull()) {
+            writer.writeEmpty();
+        } else {
+            writer.writeFloat(weight.toFloat());
+        }
+
+        writer.writeText(query.value(4).toString());
+
+        const QVariant glucose = query.value(5);
+        if (glucose.isNull()) {
+            writer.writeEmpty();
+        } else {
+            writer.writeFloat(glucose.toFloat());
+        }
+        writer.endRow();
+        ++rows;
+    }
+    return rows;
 }
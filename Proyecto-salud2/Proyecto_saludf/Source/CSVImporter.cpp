@@ -0,0 +1,291 @@
+/**
+ * @file CSVImporter.cpp
+ * @brief Implementación de la clase CSVImporter para importar registros de salud desde archivos CSV.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "CSVImporter.h"
+#include "CSVScanner.h"
+#include "Logging.h"
+#include "RecordValidator.h"
+#include "healthrecord.h"
+#include <QFile>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+/**
+ * @brief Bytes de una línea rechazada que se copian al informe.
+ */
+const int kRejectTextBytes = 200;
+
+/**
+ * @brief Compara un campo con un nombre de columna sin distinguir mayúsculas ASCII.
+ * @param field Campo.
+ * @param name Nombre en minúsculas.
+ * @return true si coinciden, ignorando espacios a los lados.
+ */
+bool fieldEquals(const CSVField& field, const char* name)
+{
+    const char* begin = field.data;
+    const char* end = field.data + field.size;
+    while (begin < end && *begin == ' ') {
+        ++begin;
+    }
+    while (end > begin && end[-1] == ' ') {
+        --end;
+    }
+    const size_t length = std::strlen(name);
+    if (static_cast<size_t>(end - begin) != length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        char c = begin[i];
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+        if (c != name[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Busca en la cabecera la columna que coincide con alguno de los nombres.
+ * @param fields Campos de la cabecera.
+ * @param fieldCount Número de campos.
+ * @param names Nombres aceptados, terminados en nullptr.
+ * @return Índice de la columna, o -1 si no aparece.
+ */
+int findColumn(const CSVField* fields, int fieldCount, const char* const* names)
+{
+    for (int i = 0; i < fieldCount; ++i) {
+        for (const char* const* name = names; *name; ++name) {
+            if (fieldEquals(fields[i], *name)) {
+                return i;
+            }
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Nombres de columna aceptados en la cabecera, en minúsculas.
+ */
+const char* const kDateNames[] = {"datetime", "date_time", "date time", "fecha", "fecha y hora", nullptr};
+const char* const kWeightNames[] = {"weight", "peso", nullptr};
+const char* const kBloodPressureNames[] = {"blood pressure", "blood_pressure", "presion", "presión",
+                                           "presion arterial", "presión arterial", nullptr};
+const char* const kGlucoseNames[] = {"glucose level", "glucose_level", "glucose", "glucosa",
+                                     "nivel de glucosa", nullptr};
+
+/**
+ * @struct ChunkLayout
+ * @brief Lo que una tarea necesita saber del archivo para procesar su fragmento.
+ */
+struct ChunkLayout
+{
+    CSVImportOptions options;
+    QString userIdText;
+    int dateColumn;
+    int weightColumn;
+    int bloodPressureColumn;
+    int glucoseColumn;
+    int requiredFields;
+};
+
+/**
+ * @brief Anota una línea rechazada en el resultado de una tarea.
+ * @param output Resultado de la tarea.
+ * @param lineOffset Línea relativa al inicio del fragmento.
+ * @param lineStart Inicio de la línea.
+ * @param lineEnd Fin de la línea.
+ * @param reason Motivo del rechazo.
+ * @param maxReported Máximo de rechazos detallados.
+ */
+void rejectLine(IngestOutput& output, qint64 lineOffset, const char* lineStart, const char* lineEnd,
+                const QString& reason, int maxReported)
+{
+    ++output.rejected;
+    if (output.rejectedLines.size() >= maxReported) {
+        return;
+    }
+    RejectedLine rejected;
+    rejected.lineNumber = lineOffset;
+    rejected.reason = reason;
+    int length = static_cast<int>(std::min<qint64>(lineEnd - lineStart, kRejectTextBytes));
+    while (length > 0 && (lineStart[length - 1] == '\n' || lineStart[length - 1] == '\r')) {
+        --length;
+    }
+    rejected.text = QString::fromUtf8(lineStart, length);
+    output.rejectedLines.append(rejected);
+}
+
+/**
+ * @brief Procesa un fragmento del archivo. Se ejecuta en un hilo de IngestPipeline.
+ * @param p Inicio del fragmento, al comienzo de una línea.
+ * @param end Fin del fragmento.
+ * @param layout Columnas y opciones del archivo.
+ * @param output Resultado de la tarea.
+ */
+void parseChunk(const char* p, const char* end, const ChunkLayout& layout, IngestOutput& output)
+{
+    CSVField fields[CSVScanner::kMaxFields];
+    int fieldCount = 0;
+    std::vector<char> scratch;
+    qint64 newlines = 0;
+    const int maxReported = layout.options.ingest.maxReportedRejects;
+
+    while (p < end) {
+        const char* lineStart = p;
+        p = CSVScanner::splitLine(p, end, layout.options.delimiter, layout.options.quote, fields, &fieldCount,
+                                  scratch, &newlines);
+        const qint64 lineOffset = output.lineSpan;
+        output.lineSpan += 1 + newlines;
+
+        if (fieldCount == 1 && fields[0].size == 0) {
+            continue;
+        }
+        ++output.inputs;
+
+        QDateTime dateTime;
+        float weight = 0.0f;
+        float glucose = 0.0f;
+        if (fieldCount < layout.requiredFields) {
+            rejectLine(output, lineOffset, lineStart, p, "Faltan columnas.", maxReported);
+            continue;
+        }
+        const CSVField& date = fields[layout.dateColumn];
+        if (!RecordValidator::parseDateTime(date.data, date.data + date.size, &dateTime)) {
+            rejectLine(output, lineOffset, lineStart, p,
+                       RecordValidator::message(RecordValidator::InvalidDateTime), maxReported);
+            continue;
+        }
+        const CSVField& bloodPressure = fields[layout.bloodPressureColumn];
+        const RecordValidator::Result result = RecordValidator::validate(
+            fields[layout.weightColumn].data, fields[layout.weightColumn].size, bloodPressure.data, bloodPressure.size,
+            fields[layout.glucoseColumn].data, fields[layout.glucoseColumn].size, &weight, &glucose);
+        if (result != RecordValidator::Valid) {
+            rejectLine(output, lineOffset, lineStart, p, RecordValidator::message(result), maxReported);
+            continue;
+        }
+        output.records.append(healthrecord(QString(), layout.userIdText, dateTime, weight,
+                                           QString::fromUtf8(bloodPressure.data, bloodPressure.size).trimmed(),
+                                           glucose));
+    }
+}
+}
+
+/**
+ * @brief Importa un archivo CSV para un usuario.
+ * @param filePath Ruta del archivo.
+ * @param userId Usuario al que se asignan los registros.
+ * @param options Parámetros de la importación.
+ * @return Informe con los totales y las líneas rechazadas.
+ */
+CSVImportReport CSVImporter::importFile(const QString& filePath, int userId, const CSVImportOptions& options)
+{
+    CSVImportReport report;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        report.error = "No se pudo abrir el archivo: " + file.errorString();
+        qCWarning(lcDb) << report.error;
+        return report;
+    }
+    const qint64 size = file.size();
+    if (size == 0) {
+        report.ok = true;
+        return report;
+    }
+    const char* data = reinterpret_cast<const char*>(file.map(0, size));
+    if (!data) {
+        report.error = "No se pudo mapear el archivo: " + file.errorString();
+        qCWarning(lcDb) << report.error;
+        return report;
+    }
+
+    const char* p = data;
+    const char* end = data + size;
+    if (size >= 3 && std::memcmp(p, "\xEF\xBB\xBF", 3) == 0) {
+        p += 3;
+    }
+
+    CSVField fields[CSVScanner::kMaxFields];
+    int fieldCount = 0;
+    std::vector<char> scratch;
+    qint64 newlines = 0;
+    qint64 lineNumber = 1;
+
+    // Columnas por defecto: el orden de CSVExporter (ID, User ID, DateTime, Weight, Blood Pressure, Glucose Level)
+    int dateColumn = 2;
+    int weightColumn = 3;
+    int bloodPressureColumn = 4;
+    int glucoseColumn = 5;
+
+    const char* firstLine = CSVScanner::splitLine(p, end, options.delimiter, options.quote, fields, &fieldCount,
+                                                  scratch, &newlines);
+    if (findColumn(fields, fieldCount, kDateNames) >= 0) {
+        dateColumn = findColumn(fields, fieldCount, kDateNames);
+        weightColumn = findColumn(fields, fieldCount, kWeightNames);
+        bloodPressureColumn = findColumn(fields, fieldCount, kBloodPressureNames);
+        glucoseColumn = findColumn(fields, fieldCount, kGlucoseNames);
+        if (weightColumn < 0 || bloodPressureColumn < 0 || glucoseColumn < 0) {
+            report.error = "La cabecera debe tener columnas de fecha, peso, presión arterial y glucosa.";
+            qCWarning(lcDb) << report.error;
+            return report;
+        }
+        p = firstLine;
+        lineNumber += 1 + newlines;
+    }
+
+    ChunkLayout layout;
+    layout.options = options;
+    layout.userIdText = QString::number(userId);
+    layout.dateColumn = dateColumn;
+    layout.weightColumn = weightColumn;
+    layout.bloodPressureColumn = bloodPressureColumn;
+    layout.glucoseColumn = glucoseColumn;
+    layout.requiredFields = 1 + std::max(std::max(dateColumn, weightColumn),
+                                         std::max(bloodPressureColumn, glucoseColumn));
+
+    IngestOptions ingestOptions = options.ingest;
+    ingestOptions.firstLineNumber = lineNumber;
+    IngestPipeline pipeline(ingestOptions);
+
+    const qint64 chunkBytes = std::max(4096, options.chunkBytes);
+    while (p < end) {
+        if (options.progress && !options.progress(p - data, size)) {
+            report.canceled = true;
+            break;
+        }
+        const char* chunkStart = p;
+        p = CSVScanner::nextChunkEnd(p, end, chunkBytes, options.quote);
+        const char* chunkEnd = p;
+        pipeline.submit([chunkStart, chunkEnd, &layout](IngestOutput& output) {
+            parseChunk(chunkStart, chunkEnd, layout, output);
+        });
+    }
+    const IngestResult result = pipeline.finish();
+    file.unmap(reinterpret_cast<uchar*>(const_cast<char*>(data)));
+
+    report.lines = result.inputs;
+    report.imported = result.imported;
+    report.rejected = result.rejected;
+    report.rejectedLines = result.rejectedLines;
+    report.metrics = result.metrics;
+    report.ok = result.failed == 0 && !report.canceled;
+    if (result.failed > 0) {
+        report.error = QString("No se pudieron guardar %1 registros.").arg(result.failed);
+    } else if (report.canceled) {
+        report.error = "Importación cancelada; se conservan los registros leídos hasta ese momento.";
+    } else if (options.progress) {
+        options.progress(size, size);
+    }
+    qCInfo(lcDb) << "Importación CSV de" << filePath << ": líneas" << report.lines << ", importadas" << report.imported
+             << ", rechazadas" << report.rejected << ", hilos" << pipeline.workerCount();
+    return report;
+}
@@ -0,0 +1,251 @@
+/**
+ * @file CSVScanner.cpp
+ * @brief Implementación de la clase CSVScanner, separación de líneas CSV y corte en fragmentos sobre bytes.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "CSVScanner.h"
+#include <QtAlgorithms>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SALUD_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+/**
+ * @brief Cuenta los saltos de línea de un rango.
+ * @param p Inicio del rango.
+ * @param end Fin del rango.
+ * @return Número de '\n'.
+ */
+inline qint64 countNewlines(const char* p, const char* end)
+{
+    qint64 count = 0;
+    while (p < end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        if (!newline) {
+            break;
+        }
+        ++count;
+        p = newline + 1;
+    }
+    return count;
+}
+}
+
+/**
+ * @brief Indica si las búsquedas se compilaron con SSE2.
+ * @return true si findSpecial() y countByte() usan SSE2.
+ */
+bool CSVScanner::hasSse2()
+{
+#ifdef SALUD_HAVE_SSE2
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Busca el siguiente delimitador, comilla o salto de línea.
+ * @param p Inicio de la búsqueda.
+ * @param end Fin del texto.
+ * @param delimiter Separador de campos.
+ * @param quote Carácter de comillas.
+ * @return Posición del primer carácter especial, o end si no hay ninguno.
+ *
+ * Con SSE2 compara 16 bytes por instrucción contra los cuatro caracteres y usa la máscara
+ * resultante para saltar directamente al primero que coincide; el resto se recorre byte a byte.
+ */
+const char* CSVScanner::findSpecial(const char* p, const char* end, char delimiter, char quote)
+{
+#ifdef SALUD_HAVE_SSE2
+    const __m128i delimiters = _mm_set1_epi8(delimiter);
+    const __m128i quotes = _mm_set1_epi8(quote);
+    const __m128i newlines = _mm_set1_epi8('\n');
+    const __m128i returns = _mm_set1_epi8('\r');
+    while (end - p >= 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i matches = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, delimiters), _mm_cmpeq_epi8(chunk, quotes)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, newlines), _mm_cmpeq_epi8(chunk, returns)));
+        const quint32 mask = static_cast<quint32>(_mm_movemask_epi8(matches));
+        if (mask != 0) {
+            return p + qCountTrailingZeroBits(mask);
+        }
+        p += 16;
+    }
+#endif
+    return findSpecialScalar(p, end, delimiter, quote);
+}
+
+/**
+ * @brief Versión byte a byte de findSpecial().
+ * @param p Inicio de la búsqueda.
+ * @param end Fin del texto.
+ * @param delimiter Separador de campos.
+ * @param quote Carácter de comillas.
+ * @return Posición del primer carácter especial, o end si no hay ninguno.
+ */
+const char* CSVScanner::findSpecialScalar(const char* p, const char* end, char delimiter, char quote)
+{
+    while (p < end && *p != delimiter && *p != quote && *p != '\n' && *p != '\r') {
+        ++p;
+    }
+    return p;
+}
+
+/**
+ * @brief Cuenta las apariciones de un byte en un rango.
+ * @param p Inicio del rango.
+ * @param end Fin del rango.
+ * @param c Byte a contar.
+ * @return Número de apariciones.
+ */
+qint64 CSVScanner::countByte(const char* p, const char* end, char c)
+{
+    qint64 count = 0;
+#ifdef SALUD_HAVE_SSE2
+    const __m128i needle = _mm_set1_epi8(c);
+    while (end - p >= 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        count += qPopulationCount(static_cast<quint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle))));
+        p += 16;
+    }
+#endif
+    return count + countByteScalar(p, end, c);
+}
+
+/**
+ * @brief Versión byte a byte de countByte().
+ * @param p Inicio del rango.
+ * @param end Fin del rango.
+ * @param c Byte a contar.
+ * @return Número de apariciones.
+ */
+qint64 CSVScanner::countByteScalar(const char* p, const char* end, char c)
+{
+    qint64 count = 0;
+    for (; p < end; ++p) {
+        count += *p == c ? 1 : 0;
+    }
+    return count;
+}
+
+/**
+ * @brief Busca el final de un fragmento: el primer salto de línea fuera de comillas tras target bytes.
+ * @param p Inicio del fragmento, al comienzo de una línea.
+ * @param end Fin del texto.
+ * @param target Tamaño aproximado del fragmento.
+ * @param quote Carácter de comillas.
+ * @return Inicio del fragmento siguiente, o end.
+ *
+ * El estado de las comillas en target se deduce de la paridad de comillas desde p, que se
+ * cuenta de 16 en 16 bytes; solo el tramo hasta el salto de línea se recorre byte a byte.
+ */
+const char* CSVScanner::nextChunkEnd(const char* p, const char* end, qint64 target, char quote)
+{
+    if (end - p <= target) {
+        return end;
+    }
+    const char* q = p + target;
+    bool inQuotes = (countByte(p, q, quote) & 1) != 0;
+    for (; q < end; ++q) {
+        if (*q == quote) {
+            inQuotes = !inQuotes;
+        } else if (*q == '\n' && !inQuotes) {
+            return q + 1;
+        }
+    }
+    return end;
+}
+
+/**
+ * @brief Separa una línea CSV en campos.
+ * @param p Inicio de la línea.
+ * @param end Fin del texto.
+ * @param delimiter Separador de campos.
+ * @param quote Carácter de comillas.
+ * @param fields Campos de la línea; debe tener espacio para kMaxFields.
+ * @param fieldCount Número de campos.
+ * @param scratch Buffer para los campos con comillas escapadas; se reutiliza entre líneas.
+ * @param newlines Saltos de línea contenidos dentro de campos entre comillas.
+ * @return Inicio de la línea siguiente.
+ */
+const char* CSVScanner::splitLine(const char* p, const char* end, char delimiter, char quote, CSVField* fields,
+                                  int* fieldCount, std::vector<char>& scratch, qint64* newlines)
+{
+    scratch.clear();
+    *fieldCount = 0;
+    *newlines = 0;
+
+    while (true) {
+        CSVField field = {p, 0, -1};
+        if (p < end && *p == quote) {
+            const char* start = ++p;
+            while (true) {
+                const char* q = static_cast<const char*>(std::memchr(p, quote, static_cast<size_t>(end - p)));
+                if (!q) {
+                    q = end;
+                }
+                *newlines += countNewlines(p, q);
+                if (q + 1 < end && q[1] == quote) {
+                    // Comilla escapada: el campo se arma en el buffer auxiliar
+                    if (field.scratchOffset < 0) {
+                        field.scratchOffset = static_cast<int>(scratch.size());
+                        scratch.insert(scratch.end(), start, q + 1);
+                    } else {
+                        scratch.insert(scratch.end(), p, q + 1);
+                    }
+                    p = q + 2;
+                    continue;
+                }
+                if (field.scratchOffset >= 0) {
+                    scratch.insert(scratch.end(), p, q);
+                    field.size = static_cast<int>(scratch.size()) - field.scratchOffset;
+                } else {
+                    field.data = start;
+                    field.size = static_cast<int>(q - start);
+                }
+                p = q < end ? q + 1 : end;
+                break;
+            }
+            // Texto después de la comilla de cierre: se ignora hasta el siguiente separador
+            while (p < end && *p != delimiter && *p != '\n' && *p != '\r') {
+                ++p;
+            }
+        } else {
+            const char* q = findSpecial(p, end, delimiter, quote);
+            while (q < end && *q == quote) {
+                q = findSpecial(q + 1, end, delimiter, quote);
+            }
+            field.size = static_cast<int>(q - p);
+            p = q;
+        }
+
+        if (*fieldCount < kMaxFields) {
+            fields[(*fieldCount)++] = field;
+        }
+        if (p < end && *p == delimiter) {
+            ++p;
+            continue;
+        }
+        break;
+    }
+
+    for (int i = 0; i < *fieldCount; ++i) {
+        if (fields[i].scratchOffset >= 0) {
+            fields[i].data = scratch.data() + fields[i].scratchOffset;
+        }
+    }
+    if (p < end && *p == '\r') {
+        ++p;
+    }
+    if (p < end && *p == '\n') {
+        ++p;
+    }
+    return p;
+}
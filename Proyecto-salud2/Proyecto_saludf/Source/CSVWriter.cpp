@@ -0,0 +1,345 @@
+/**
+ * @file CSVWriter.cpp
+ * @brief Implementación de la clase CSVWriter, escritor CSV con buffer reutilizable y formato numérico sin asignaciones.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "CSVWriter.h"
+#include "Logging.h"
+#include <charconv>
+#include <cstring>
+
+namespace {
+/**
+ * @brief Escribe un entero de ancho fijo con ceros a la izquierda.
+ * @param out Destino.
+ * @param value Valor no negativo.
+ * @param width Número de dígitos.
+ */
+inline void writePadded(char* out, int value, int width)
+{
+    for (int i = width - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+/**
+ * @brief Convierte días desde 1970-01-01 a fecha civil (algoritmo de H. Hinnant).
+ * @param days Días desde la época.
+ * @param year Año resultante.
+ * @param month Mes resultante (1-12).
+ * @param day Día resultante (1-31).
+ */
+inline void civilFromDays(qint64 days, int& year, int& month, int& day)
+{
+    days += 719468;
+    const qint64 era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+    const unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const unsigned monthPrime = (5 * dayOfYear + 2) / 153;
+    day = static_cast<int>(dayOfYear - (153 * monthPrime + 2) / 5 + 1);
+    month = static_cast<int>(monthPrime < 10 ? monthPrime + 3 : monthPrime - 9);
+    year = static_cast<int>(yearOfEra + era * 400 + (month <= 2 ? 1 : 0));
+}
+}
+
+/**
+ * @brief Constructor del escritor.
+ * @param device Dispositivo abierto para escritura.
+ * @param options Opciones de formato.
+ */
+CSVWriter::CSVWriter(QIODevice* device, const CSVOptions& options)
+    : m_device(device),
+      m_options(options),
+      m_buffer(static_cast<std::size_t>(options.bufferBytes > 4096 ? options.bufferBytes : 4096)),
+      m_used(0),
+      m_flushed(0),
+      m_firstField(true),
+      m_ok(true)
+{
+}
+
+/**
+ * @brief Destructor. Vacía el buffer pendiente.
+ */
+CSVWriter::~CSVWriter()
+{
+    flush();
+}
+
+/**
+ * @brief Garantiza espacio para bytes más en el buffer y devuelve dónde escribirlos.
+ * @param bytes Número de bytes a reservar.
+ * @return Puntero a la zona libre del buffer.
+ */
+char* CSVWriter::reserve(int bytes)
+{
+    const std::size_t needed = static_cast<std::size_t>(bytes);
+    if (m_used + needed > m_buffer.size()) {
+        flush();
+        if (needed > m_buffer.size()) {
+            m_buffer.resize(needed);
+        }
+    }
+    return m_buffer.data() + m_used;
+}
+
+/**
+ * @brief Escribe el delimitador si no es el primer campo de la fila.
+ */
+void CSVWriter::beginField()
+{
+    if (!m_firstField) {
+        *reserve(1) = m_options.delimiter;
+        ++m_used;
+    }
+    m_firstField = false;
+}
+
+/**
+ * @brief Escribe un campo entero.
+ * @param value Valor.
+ */
+void CSVWriter::writeInt(qint64 value)
+{
+    beginField();
+    char* out = reserve(24);
+    const std::to_chars_result result = std::to_chars(out, out + 24, value);
+    m_used += static_cast<std::size_t>(result.ptr - out);
+}
+
+/**
+ * @brief Escribe un campo real con la representación más corta que conserva el valor.
+ * @param value Valor.
+ */
+void CSVWriter::writeFloat(float value)
+{
+    beginField();
+    char* out = reserve(32);
+    const std::to_chars_result result = std::to_chars(out, out + 32, value);
+    m_used += static_cast<std::size_t>(result.ptr - out);
+}
+
+/**
+ * @brief Escribe un campo real con la representación más corta que conserva el valor.
+ * @param value Valor.
+ */
+void CSVWriter::writeDouble(double value)
+{
+    beginField();
+    char* out = reserve(32);
+    const std::to_chars_result result = std::to_chars(out, out + 32, value);
+    m_used += static_cast<std::size_t>(result.ptr - out);
+}
+
+/**
+ * @brief Escribe una fecha y hora con formato fijo "yyyy-MM-dd hh:mm:ss".
+ */
+void CSVWriter::writeDateTime(int year, int month, int day, int hour, int minute, int second)
+{
+    beginField();
+    char* out = reserve(19);
+    writePadded(out, year, 4);
+    out[4] = '-';
+    writePadded(out + 5, month, 2);
+    out[7] = '-';
+    writePadded(out + 8, day, 2);
+    out[10] = ' ';
+    writePadded(out + 11, hour, 2);
+    out[13] = ':';
+    writePadded(out + 14, minute, 2);
+    out[16] = ':';
+    writePadded(out + 17, second, 2);
+    m_used += 19;
+}
+
+/**
+ * @brief Escribe una fecha y hora a partir de segundos desde la época, sin conversión de zona.
+ * @param epochSeconds Segundos desde 1970-01-01 00:00:00.
+ */
+void CSVWriter::writeEpochSeconds(qint64 epochSeconds)
+{
+    qint64 days = epochSeconds / 86400;
+    qint64 secondsOfDay = epochSeconds % 86400;
+    if (secondsOfDay < 0) {
+        secondsOfDay += 86400;
+        --days;
+    }
+    int year;
+    int month;
+    int day;
+    civilFromDays(days, year, month, day);
+    const int seconds = static_cast<int>(secondsOfDay);
+    writeDateTime(year, month, day, seconds / 3600, (seconds / 60) % 60, seconds % 60);
+}
+
+/**
+ * @brief Escribe un campo de texto, entrecomillado según las opciones.
+ * @param text Texto del campo.
+ *
+ * Codifica a UTF-8 directamente sobre el buffer, sin QByteArray intermedio.
+ */
+void CSVWriter::writeText(const QString& text)
+{
+    const QChar* chars = text.constData();
+    const int length = text.size();
+
+    bool needsQuotes = m_options.quoteMode == CSVOptions::QuoteAll;
+    if (m_options.quoteMode == CSVOptions::QuoteMinimal) {
+        for (int i = 0; i < length && !needsQuotes; ++i) {
+            const ushort c = chars[i].unicode();
+            needsQuotes = c == static_cast<uchar>(m_options.delimiter) || c == static_cast<uchar>(m_options.quote)
+                          || c == '\r' || c == '\n';
+        }
+    }
+
+    beginField();
+    // Peor caso: 3 bytes por unidad UTF-16, comillas duplicadas y las dos comillas exteriores
+    char* out = reserve(length * 6 + 2);
+    char* start = out;
+    if (needsQuotes) {
+        *out++ = m_options.quote;
+    }
+    for (int i = 0; i < length; ++i) {
+        uint code = chars[i].unicode();
+        if (chars[i].isHighSurrogate() && i + 1 < length && chars[i + 1].isLowSurrogate()) {
+            code = QChar::surrogateToUcs4(chars[i], chars[i + 1]);
+            ++i;
+        }
+
+        if (code < 0x80) {
+            char c = static_cast<char>(code);
+            if (needsQuotes && c == m_options.quote) {
+                *out++ = c;
+            } else if (m_options.quoteMode == CSVOptions::QuoteNone) {
+                if (c == m_options.delimiter) {
+                    c = ';';
+                } else if (c == '\r' || c == '\n') {
+                    c = ' ';
+                }
+            }
+            *out++ = c;
+        } else if (code < 0x800) {
+            *out++ = static_cast<char>(0xC0 | (code >> 6));
+            *out++ = static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            *out++ = static_cast<char>(0xE0 | (code >> 12));
+            *out++ = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            *out++ = static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            *out++ = static_cast<char>(0xF0 | (code >> 18));
+            *out++ = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            *out++ = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            *out++ = static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+    if (needsQuotes) {
+        *out++ = m_options.quote;
+    }
+    m_used += static_cast<std::size_t>(out - start);
+}
+
+/**
+ * @brief Escribe un campo de texto ASCII/UTF-8 ya codificado.
+ * @param text Bytes del campo.
+ * @param size Número de bytes.
+ */
+void CSVWriter::writeText(const char* text, int size)
+{
+    bool needsQuotes = m_options.quoteMode == CSVOptions::QuoteAll;
+    if (m_options.quoteMode == CSVOptions::QuoteMinimal) {
+        for (int i = 0; i < size && !needsQuotes; ++i) {
+            const char c = text[i];
+            needsQuotes = c == m_options.delimiter || c == m_options.quote || c == '\r' || c == '\n';
+        }
+    }
+
+    beginField();
+    char* out = reserve(size * 2 + 2);
+    char* start = out;
+    if (needsQuotes) {
+        *out++ = m_options.quote;
+    }
+    for (int i = 0; i < size; ++i) {
+        char c = text[i];
+        if (needsQuotes && c == m_options.quote) {
+            *out++ = c;
+        } else if (m_options.quoteMode == CSVOptions::QuoteNone) {
+            if (c == m_options.delimiter) {
+                c = ';';
+            } else if (c == '\r' || c == '\n') {
+                c = ' ';
+            }
+        }
+        *out++ = c;
+    }
+    if (needsQuotes) {
+        *out++ = m_options.quote;
+    }
+    m_used += static_cast<std::size_t>(out - start);
+}
+
+/**
+ * @brief Escribe un campo vacío (por ejemplo, un valor NULL).
+ */
+void CSVWriter::writeEmpty()
+{
+    beginField();
+}
+
+/**
+ * @brief Termina la fila actual.
+ */
+void CSVWriter::endRow()
+{
+    char* out = reserve(2);
+    if (m_options.crlf) {
+        out[0] = '\r';
+        out[1] = '\n';
+        m_used += 2;
+    } else {
+        out[0] = '\n';
+        m_used += 1;
+    }
+    m_firstField = true;
+}
+
+/**
+ * @brief Escribe en el dispositivo el contenido del buffer.
+ * @return true si la escritura tuvo éxito.
+ */
+bool CSVWriter::flush()
+{
+    if (m_used == 0) {
+        return m_ok;
+    }
+    const qint64 written = m_device->write(m_buffer.data(), static_cast<qint64>(m_used));
+    if (written != static_cast<qint64>(m_used)) {
+        qCWarning(lcExport) << "Error al escribir el CSV:" << m_device->errorString();
+        m_ok = false;
+    }
+    m_flushed += static_cast<qint64>(m_used);
+    m_used = 0;
+    return m_ok;
+}
+
+/**
+ * @brief Indica si todas las escrituras han tenido éxito.
+ * @return false si alguna escritura al dispositivo falló.
+ */
+bool CSVWriter::ok() const
+{
+    return m_ok;
+}
+
+/**
+ * @brief Bytes producidos hasta el momento (incluye los que siguen en el buffer).
+ * @return Número de bytes.
+ */
+qint64 CSVWriter::bytesWritten() const
+{
+    return m_flushed + static_cast<qint64>(m_used);
+}
@@ -0,0 +1,56 @@
+/**
+ * @file ChangeFeed.cpp
+ * @brief Implementación de la clase ChangeFeed, canal de notificaciones de cambios en health_records.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "ChangeFeed.h"
+#include "Logging.h"
+
+/**
+ * @brief Obtiene la instancia única de ChangeFeed.
+ * @return Referencia a la instancia singleton.
+ */
+ChangeFeed& ChangeFeed::instance()
+{
+    static ChangeFeed instance;
+    return instance;
+}
+
+/**
+ * @brief Constructor privado de la clase ChangeFeed.
+ *
+ * Los tipos deben estar registrados para que las conexiones en cola puedan copiar los lotes.
+ */
+ChangeFeed::ChangeFeed()
+    : m_inserted(Metrics::instance().counter("salud_records_inserted_total", "Filas de health_records insertadas.")),
+      m_updated(Metrics::instance().counter("salud_records_updated_total", "Filas de health_records actualizadas.")),
+      m_deleted(Metrics::instance().counter("salud_records_deleted_total", "Filas de health_records eliminadas."))
+{
+    qRegisterMetaType<RecordChange>("RecordChange");
+    qRegisterMetaType<QVector<RecordChange>>("QVector<RecordChange>");
+}
+
+/**
+ * @brief Publica los cambios de una transacción confirmada.
+ * @param changes Cambios aplicados en la transacción.
+ *
+ * Cada cambio publicado suma a los contadores de filas escritas, ya que solo se publican
+ * transacciones confirmadas.
+ */
+void ChangeFeed::publish(const QVector<RecordChange>& changes)
+{
+    if (changes.isEmpty()) {
+        return;
+    }
+    qCDebug(lcDb) << "Publicando" << changes.size() << "cambios de health_records";
+    quint64 counts[3] = {0, 0, 0};
+    for (const RecordChange& change : changes) {
+        ++counts[change.type];
+    }
+    m_inserted->add(counts[RecordChange::Inserted]);
+    m_updated->add(counts[RecordChange::Updated]);
+    m_deleted->add(counts[RecordChange::Deleted]);
+    emit recordsChanged(changes);
+}
@@ -0,0 +1,38 @@
+/**
+ * @file Checksum.cpp
+ * @brief Implementación de la clase Checksum, sumas de verificación compartidas por la bitácora y los exportadores.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "Checksum.h"
+
+/**
+ * @brief Calcula el CRC-32 (polinomio IEEE 802.3, el de gzip y zip) de un bloque de bytes.
+ * @param data Datos.
+ * @param size Número de bytes.
+ * @param crc CRC acumulado de los bloques anteriores, o 0 para empezar.
+ * @return CRC-32 de los datos.
+ */
+quint32 Checksum::crc32(const char* data, qint64 size, quint32 crc)
+{
+    static const struct Table {
+        quint32 values[256];
+        Table()
+        {
+            for (quint32 i = 0; i < 256; ++i) {
+                quint32 c = i;
+                for (int k = 0; k < 8; ++k) {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                values[i] = c;
+            }
+        }
+    } table;
+
+    crc ^= 0xFFFFFFFFu;
+    for (qint64 i = 0; i < size; ++i) {
+        crc = table.values[(crc ^ static_cast<quint8>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
@@ -0,0 +1,695 @@
+/**
+ * @file ColumnarFormat.cpp
+ * @brief Implementación de la clase ColumnarFormat, formato binario por columnas para exportar e importar registros de salud.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "ColumnarFormat.h"
+#include "Logging.h"
+#include "DatabaseManager.h"
+#include "IngestPipeline.h"
+#include "Trace.h"
+#include "healthrecord.h"
+#include <QDateTime>
+#include <QFile>
+#include <QSqlError>
+#include <QVariant>
+#include <QtEndian>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+const quint32 kFileMagic = 0x31435248;   // "HRC1"
+const quint32 kGroupMagic = 0x31475248;  // "HRG1"
+const quint32 kFooterMagic = 0x45435248; // "HRCE"
+const quint16 kVersion = 1;
+const int kFileHeaderBytes = 32;
+const int kGroupHeaderBytes = 16;
+const int kColumnHeaderBytes = 32;
+const int kFooterBytes = 16;
+
+/**
+ * @brief Tipos físicos de las columnas.
+ */
+enum ColumnType : quint8 { Int64Type = 1, Int32Type = 2, Float32Type = 3, Int16Type = 4 };
+
+/**
+ * @brief Codificaciones de los valores de un bloque.
+ */
+enum ColumnEncoding : quint8 { PlainEncoding = 0, DeltaEncoding = 1 };
+
+/**
+ * @brief Tipo físico de cada columna, en el orden de ColumnarFormat::Column.
+ */
+const ColumnType kColumnTypes[ColumnarFormat::ColumnCount] = {
+    Int64Type, Int32Type, Float32Type, Float32Type, Int16Type, Int16Type
+};
+
+/**
+ * @brief Añade un entero en little-endian.
+ * @param out Destino.
+ * @param value Valor.
+ */
+template <typename T>
+inline void appendLE(QByteArray& out, T value)
+{
+    char bytes[sizeof(T)];
+    qToLittleEndian(value, bytes);
+    out.append(bytes, static_cast<int>(sizeof(T)));
+}
+
+/**
+ * @brief Añade un real en little-endian.
+ * @param out Destino.
+ * @param value Valor.
+ */
+inline void appendFloatLE(QByteArray& out, float value)
+{
+    quint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    appendLE(out, bits);
+}
+
+/**
+ * @brief Añade un real doble en little-endian.
+ * @param out Destino.
+ * @param value Valor.
+ */
+inline void appendDoubleLE(QByteArray& out, double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    appendLE(out, bits);
+}
+
+/**
+ * @brief Lee un entero little-endian.
+ * @param data Origen.
+ * @return Valor leído.
+ */
+template <typename T>
+inline T readLE(const uchar* data)
+{
+    return qFromLittleEndian<T>(data);
+}
+
+/**
+ * @brief Lee un real little-endian.
+ * @param data Origen.
+ * @return Valor leído.
+ */
+inline float readFloatLE(const uchar* data)
+{
+    const quint32 bits = readLE<quint32>(data);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Lee un real doble little-endian.
+ * @param data Origen.
+ * @return Valor leído.
+ */
+inline double readDoubleLE(const uchar* data)
+{
+    const quint64 bits = readLE<quint64>(data);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Tamaño en bytes de un valor de un tipo físico.
+ * @param type Tipo físico.
+ * @return Bytes por valor.
+ */
+inline int typeWidth(quint8 type)
+{
+    switch (type) {
+    case Int64Type:
+        return 8;
+    case Int32Type:
+    case Float32Type:
+        return 4;
+    case Int16Type:
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Actualiza estadísticas con un valor no nulo.
+ * @param stats Estadísticas del bloque.
+ * @param value Valor.
+ * @param first Indica si es el primer valor no nulo; se pone a false.
+ */
+inline void accumulateStats(ColumnStats& stats, double value, bool& first)
+{
+    if (first) {
+        stats.minValue = value;
+        stats.maxValue = value;
+        first = false;
+    } else {
+        stats.minValue = std::min(stats.minValue, value);
+        stats.maxValue = std::max(stats.maxValue, value);
+    }
+}
+
+/**
+ * @brief Codifica los valores de una columna de un grupo sin comprimir.
+ * @param column Columna a codificar.
+ * @param group Grupo de filas.
+ * @param raw Destino de los valores codificados.
+ * @param stats Estadísticas calculadas.
+ * @return Codificación usada.
+ */
+ColumnEncoding encodeValues(int column, const ColumnarRowGroup& group, QByteArray& raw, ColumnStats& stats)
+{
+    const int rows = group.size();
+    raw.resize(0);
+    raw.reserve(rows * typeWidth(kColumnTypes[column]));
+    stats = ColumnStats();
+    bool first = true;
+
+    switch (column) {
+    case ColumnarFormat::TimestampColumn: {
+        qint64 previous = 0;
+        for (qint64 value : group.timestamps) {
+            appendLE<qint64>(raw, value - previous);
+            previous = value;
+            accumulateStats(stats, static_cast<double>(value), first);
+        }
+        return DeltaEncoding;
+    }
+    case ColumnarFormat::UserIdColumn: {
+        qint32 previous = 0;
+        for (qint32 value : group.userIds) {
+            appendLE<qint32>(raw, value - previous);
+            previous = value;
+            accumulateStats(stats, value, first);
+        }
+        return DeltaEncoding;
+    }
+    case ColumnarFormat::WeightColumn:
+    case ColumnarFormat::GlucoseColumn: {
+        const QVector<float>& values = column == ColumnarFormat::WeightColumn ? group.weights : group.glucose;
+        for (float value : values) {
+            appendFloatLE(raw, value);
+            if (std::isnan(value)) {
+                ++stats.nullCount;
+            } else {
+                accumulateStats(stats, value, first);
+            }
+        }
+        return PlainEncoding;
+    }
+    default: {
+        const QVector<qint16>& values = column == ColumnarFormat::SystolicColumn ? group.systolic : group.diastolic;
+        for (qint16 value : values) {
+            appendLE<qint16>(raw, value);
+            if (value == 0) {
+                ++stats.nullCount;
+            } else {
+                accumulateStats(stats, value, first);
+            }
+        }
+        return PlainEncoding;
+    }
+    }
+}
+
+/**
+ * @brief Serializa un grupo de filas completo: cabecera del grupo y un bloque por columna.
+ * @param group Grupo de filas.
+ * @param options Parámetros de escritura.
+ * @param out Destino; se vacía antes de escribir.
+ * @param raw Buffer auxiliar reutilizado entre llamadas.
+ */
+void encodeGroup(const ColumnarRowGroup& group, const ColumnarOptions& options, QByteArray& out, QByteArray& raw)
+{
+    out.resize(0);
+    appendLE<quint32>(out, kGroupMagic);
+    appendLE<quint32>(out, static_cast<quint32>(group.size()));
+    appendLE<quint32>(out, 0);
+    appendLE<quint32>(out, 0);
+
+    for (int column = 0; column < ColumnarFormat::ColumnCount; ++column) {
+        ColumnStats stats;
+        const ColumnEncoding encoding = encodeValues(column, group, raw, stats);
+
+        QByteArray compressed;
+        if (options.compress) {
+            compressed = qCompress(raw, options.compressionLevel);
+        }
+        const bool useCompressed = !compressed.isEmpty() && compressed.size() < raw.size();
+        const QByteArray& stored = useCompressed ? compressed : raw;
+
+        out.append(static_cast<char>(column));
+        out.append(static_cast<char>(kColumnTypes[column]));
+        out.append(static_cast<char>(encoding));
+        out.append(static_cast<char>(useCompressed ? 1 : 0));
+        appendLE<quint32>(out, static_cast<quint32>(stored.size()));
+        appendLE<quint32>(out, stats.nullCount);
+        appendLE<quint32>(out, 0);
+        appendDoubleLE(out, stats.minValue);
+        appendDoubleLE(out, stats.maxValue);
+        out.append(stored);
+        out.append((8 - stored.size() % 8) % 8, '\0');
+    }
+}
+
+/**
+ * @brief Vacía las columnas de un grupo conservando su capacidad.
+ * @param group Grupo a vaciar.
+ */
+void clearGroup(ColumnarRowGroup& group)
+{
+    group.timestamps.resize(0);
+    group.userIds.resize(0);
+    group.weights.resize(0);
+    group.glucose.resize(0);
+    group.systolic.resize(0);
+    group.diastolic.resize(0);
+}
+
+/**
+ * @brief Decodifica el bloque de una columna.
+ * @param column Columna esperada.
+ * @param header Cabecera del bloque.
+ * @param rows Filas del grupo.
+ * @param group Grupo donde se escriben los valores.
+ * @return true si el bloque es válido, false en caso contrario.
+ */
+bool decodeColumn(int column, const uchar* header, int rows, ColumnarRowGroup& group)
+{
+    const quint8 type = header[1];
+    const quint8 encoding = header[2];
+    const bool compressed = header[3] != 0;
+    const quint32 storedBytes = readLE<quint32>(header + 4);
+    const uchar* data = header + kColumnHeaderBytes;
+
+    if (header[0] != column || type != kColumnTypes[column]) {
+        return false;
+    }
+
+    QByteArray inflated;
+    if (compressed) {
+        inflated = qUncompress(data, static_cast<int>(storedBytes));
+        data = reinterpret_cast<const uchar*>(inflated.constData());
+        if (inflated.size() != rows * typeWidth(type)) {
+            return false;
+        }
+    } else if (storedBytes != static_cast<quint32>(rows * typeWidth(type))) {
+        return false;
+    }
+
+    switch (column) {
+    case ColumnarFormat::TimestampColumn: {
+        group.timestamps.resize(rows);
+        qint64 value = 0;
+        for (int i = 0; i < rows; ++i) {
+            const qint64 stored = readLE<qint64>(data + i * 8);
+            value = encoding == DeltaEncoding ? value + stored : stored;
+            group.timestamps[i] = value;
+        }
+        break;
+    }
+    case ColumnarFormat::UserIdColumn: {
+        group.userIds.resize(rows);
+        qint32 value = 0;
+        for (int i = 0; i < rows; ++i) {
+            const qint32 stored = readLE<qint32>(data + i * 4);
+            value = encoding == DeltaEncoding ? value + stored : stored;
+            group.userIds[i] = value;
+        }
+        break;
+    }
+    case ColumnarFormat::WeightColumn:
+    case ColumnarFormat::GlucoseColumn: {
+        QVector<float>& values = column == ColumnarFormat::WeightColumn ? group.weights : group.glucose;
+        values.resize(rows);
+        for (int i = 0; i < rows; ++i) {
+            values[i] = readFloatLE(data + i * 4);
+        }
+        break;
+    }
+    default: {
+        QVector<qint16>& values = column == ColumnarFormat::SystolicColumn ? group.systolic : group.diastolic;
+        values.resize(rows);
+        for (int i = 0; i < rows; ++i) {
+            values[i] = readLE<qint16>(data + i * 2);
+        }
+        break;
+    }
+    }
+    return true;
+}
+}
+
+/**
+ * @brief Exporta los registros de un usuario.
+ * @param filePath Ruta del archivo de salida.
+ * @param userId Identificador del usuario.
+ * @param options Parámetros de escritura.
+ * @return true si la exportación es exitosa, false en caso contrario.
+ */
+bool ColumnarFormat::exportUserRecords(const QString& filePath, int userId, const ColumnarOptions& options)
+{
+    QSqlQuery query(DatabaseManager::instance().getDatabase());
+    query.setForwardOnly(true);
+    query.prepare(selectColumnsSql() + " WHERE user_id = :user_id ORDER BY date_time, id");
+    query.bindValue(":user_id", userId);
+    if (!query.exec()) {
+        qCWarning(lcExport) << "Error al consultar los registros a exportar:" << query.lastError().text();
+        return false;
+    }
+    return writeQuery(query, filePath, options);
+}
+
+/**
+ * @brief Exporta los registros de todos los usuarios.
+ * @param filePath Ruta del archivo de salida.
+ * @param options Parámetros de escritura.
+ * @return true si la exportación es exitosa, false en caso contrario.
+ *
+ * El orden (user_id, date_time) sigue el índice idx_health_records_user_date y deja los
+ * identificadores de usuario casi constantes dentro de cada grupo, que es lo que mejor comprime.
+ */
+bool ColumnarFormat::exportAllRecords(const QString& filePath, const ColumnarOptions& options)
+{
+    QSqlQuery query(DatabaseManager::instance().getDatabase());
+    query.setForwardOnly(true);
+    if (!query.exec(selectColumnsSql() + " ORDER BY user_id, date_time, id")) {
+        qCWarning(lcExport) << "Error al consultar los registros a exportar:" << query.lastError().text();
+        return false;
+    }
+    return writeQuery(query, filePath, options);
+}
+
+/**
+ * @brief Consulta SQL que produce las columnas en el orden que espera writeQuery().
+ * @return Sentencia SELECT sin cláusula WHERE ni ORDER BY.
+ */
+QString ColumnarFormat::selectColumnsSql()
+{
+    return "SELECT user_id, CAST(strftime('%s', date_time) AS INTEGER), weight, blood_pressure, glucose_level "
+           "FROM health_records";
+}
+
+/**
+ * @brief Escribe en un archivo el resultado de una consulta basada en selectColumnsSql().
+ * @param query Consulta ejecutada, preferiblemente en modo forwardOnly.
+ * @param filePath Ruta del archivo de salida.
+ * @param options Parámetros de escritura.
+ * @param rows Si no es nulo, recibe el número de filas escritas.
+ * @return true si la escritura es exitosa, false en caso contrario.
+ *
+ * Las filas se acumulan en un grupo de rowsPerGroup filas que se serializa y escribe al
+ * llenarse; la cabecera del archivo se completa al final, cuando ya se conocen los totales.
+ */
+bool ColumnarFormat::writeQuery(QSqlQuery& query, const QString& filePath, const ColumnarOptions& options,
+                                qint64* rows)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(lcExport) << "Error al abrir el archivo:" << file.errorString();
+        return false;
+    }
+
+    const int rowsPerGroup = std::max(1, options.rowsPerGroup);
+    bool success = file.write(QByteArray(kFileHeaderBytes, '\0')) == kFileHeaderBytes;
+
+    ColumnarRowGroup group;
+    group.timestamps.reserve(rowsPerGroup);
+    group.userIds.reserve(rowsPerGroup);
+    group.weights.reserve(rowsPerGroup);
+    group.glucose.reserve(rowsPerGroup);
+    group.systolic.reserve(rowsPerGroup);
+    group.diastolic.reserve(rowsPerGroup);
+
+    QVector<quint64> groupOffsets;
+    QByteArray encoded;
+    QByteArray raw;
+    qint64 totalRows = 0;
+
+    auto flushGroup = [&]() {
+        if (group.size() == 0 || !success) {
+            return;
+        }
+        encodeGroup(group, options, encoded, raw);
+        groupOffsets.append(static_cast<quint64>(file.pos()));
+        success = file.write(encoded) == encoded.size();
+        totalRows += group.size();
+        clearGroup(group);
+    };
+
+    const float nullFloat = std::numeric_limits<float>::quiet_NaN();
+    while (success && query.next()) {
+        group.userIds.append(query.value(0).toInt());
+        group.timestamps.append(query.value(1).toLongLong());
+
+        const QVariant weight = query.value(2);
+        group.weights.append(weight.isNull() ? nullFloat : weight.toFloat());
+
+        int systolic = 0;
+        int diastolic = 0;
+        if (!healthrecord::parseBloodPressure(query.value(3).toString(), &systolic, &diastolic)
+            || systolic > std::numeric_limits<qint16>::max() || diastolic > std::numeric_limits<qint16>::max()) {
+            systolic = 0;
+            diastolic = 0;
+        }
+        group.systolic.append(static_cast<qint16>(systolic));
+        group.diastolic.append(static_cast<qint16>(diastolic));
+
+        const QVariant glucose = query.value(4);
+        group.glucose.append(glucose.isNull() ? nullFloat : glucose.toFloat());
+
+        if (group.size() >= rowsPerGroup) {
+            flushGroup();
+        }
+    }
+    flushGroup();
+
+    // Índice de grupos, pie y cabecera definitiva
+    QByteArray tail;
+    const quint64 indexOffset = static_cast<quint64>(file.pos());
+    for (quint64 offset : groupOffsets) {
+        appendLE<quint64>(tail, offset);
+    }
+    appendLE<quint64>(tail, indexOffset);
+    appendLE<quint32>(tail, kFooterMagic);
+    appendLE<quint32>(tail, 0);
+    success = success && file.write(tail) == tail.size();
+
+    QByteArray header;
+    appendLE<quint32>(header, kFileMagic);
+    appendLE<quint16>(header, kVersion);
+    appendLE<quint16>(header, static_cast<quint16>(ColumnCount));
+    appendLE<quint64>(header, static_cast<quint64>(totalRows));
+    appendLE<quint32>(header, static_cast<quint32>(groupOffsets.size()));
+    appendLE<quint32>(header, 0);
+    appendLE<qint64>(header, QDateTime::currentSecsSinceEpoch());
+    success = success && file.seek(0) && file.write(header) == header.size();
+
+    const qint64 fileBytes = file.size();
+    file.close();
+    if (!success) {
+        qCWarning(lcExport) << "Error al escribir el archivo por columnas:" << file.errorString();
+        return false;
+    }
+
+    qCInfo(lcExport) << "Exportadas" << totalRows << "filas en" << groupOffsets.size() << "grupos," << fileBytes << "bytes";
+    if (rows) {
+        *rows = totalRows;
+    }
+    return true;
+}
+
+/**
+ * @brief Recorre los grupos de un archivo mapeado en memoria.
+ * @param filePath Ruta del archivo.
+ * @param visitor Función llamada con cada grupo; si devuelve false, el recorrido se detiene.
+ * @param fromSeconds Los grupos que terminan antes de este instante se saltan sin decodificar.
+ * @param toSeconds Los grupos que empiezan después de este instante se saltan sin decodificar.
+ * @return true si el archivo es válido y se recorrió completo, false en caso contrario.
+ *
+ * El archivo no se copia a memoria: los bloques sin comprimir se decodifican directamente
+ * desde el mapeo, y las estadísticas de la columna de fecha permiten saltar grupos completos.
+ */
+bool ColumnarFormat::readFile(const QString& filePath, const std::function<bool(const ColumnarRowGroup&)>& visitor,
+                              qint64 fromSeconds, qint64 toSeconds)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(lcExport) << "Error al abrir el archivo:" << file.errorString();
+        return false;
+    }
+    const qint64 size = file.size();
+    if (size < kFileHeaderBytes + kFooterBytes) {
+        qCWarning(lcExport) << "Archivo por columnas demasiado corto:" << filePath;
+        return false;
+    }
+    const uchar* base = file.map(0, size);
+    if (!base) {
+        qCWarning(lcExport) << "No se pudo mapear el archivo:" << file.errorString();
+        return false;
+    }
+
+    const uchar* footer = base + size - kFooterBytes;
+    const quint32 groupCount = readLE<quint32>(base + 16);
+    const quint64 indexOffset = readLE<quint64>(footer);
+    if (readLE<quint32>(base) != kFileMagic || readLE<quint16>(base + 4) != kVersion
+        || readLE<quint16>(base + 6) != ColumnCount || readLE<quint32>(footer + 8) != kFooterMagic
+        || indexOffset + static_cast<quint64>(groupCount) * 8 != static_cast<quint64>(size - kFooterBytes)) {
+        qCWarning(lcExport) << "Archivo por columnas inválido:" << filePath;
+        return false;
+    }
+
+    ColumnarRowGroup group;
+    for (quint32 g = 0; g < groupCount; ++g) {
+        const quint64 offset = readLE<quint64>(base + indexOffset + g * 8);
+        if (offset < kFileHeaderBytes || offset + kGroupHeaderBytes > indexOffset
+            || readLE<quint32>(base + offset) != kGroupMagic) {
+            qCWarning(lcExport) << "Grupo" << g << "inválido en" << filePath;
+            return false;
+        }
+        const int rows = static_cast<int>(readLE<quint32>(base + offset + 4));
+
+        // Ubicar los bloques de las columnas y validar que caben en el grupo
+        const uchar* columnHeaders[ColumnCount];
+        const uchar* cursor = base + offset + kGroupHeaderBytes;
+        for (int column = 0; column < ColumnCount; ++column) {
+            if (cursor + kColumnHeaderBytes > base + indexOffset) {
+                qCWarning(lcExport) << "Grupo" << g << "truncado en" << filePath;
+                return false;
+            }
+            const quint32 storedBytes = readLE<quint32>(cursor + 4);
+            const quint64 padded = (static_cast<quint64>(storedBytes) + 7) & ~static_cast<quint64>(7);
+            if (static_cast<quint64>(base + indexOffset - cursor) < kColumnHeaderBytes + padded) {
+                qCWarning(lcExport) << "Grupo" << g << "truncado en" << filePath;
+                return false;
+            }
+            columnHeaders[column] = cursor;
+            group.stats[column].nullCount = readLE<quint32>(cursor + 8);
+            group.stats[column].minValue = readDoubleLE(cursor + 16);
+            group.stats[column].maxValue = readDoubleLE(cursor + 24);
+            cursor += kColumnHeaderBytes + padded;
+        }
+
+        const ColumnStats& time = group.stats[TimestampColumn];
+        if (rows == 0 || time.maxValue < static_cast<double>(fromSeconds)
+            || time.minValue > static_cast<double>(toSeconds)) {
+            continue;
+        }
+
+        for (int column = 0; column < ColumnCount; ++column) {
+            if (!decodeColumn(column, columnHeaders[column], rows, group)) {
+                qCWarning(lcExport) << "Bloque de la columna" << column << "del grupo" << g << "dañado en" << filePath;
+                return false;
+            }
+        }
+        if (!visitor(group)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Convierte las filas de un grupo en registros de salud.
+ * @param group Grupo decodificado.
+ * @param targetUserId Si es mayor que 0, todas las filas se asignan a este usuario.
+ * @return Registros en el orden del grupo.
+ */
+QVector<healthrecord> ColumnarFormat::toRecords(const ColumnarRowGroup& group, int targetUserId)
+{
+    const qint64 kUnixEpochJulianDay = 2440588;
+    QVector<healthrecord> records;
+    records.reserve(group.size());
+    for (int i = 0; i < group.size(); ++i) {
+        const qint64 timestamp = group.timestamps[i];
+        qint64 days = timestamp / 86400;
+        qint64 seconds = timestamp % 86400;
+        if (seconds < 0) {
+            seconds += 86400;
+            --days;
+        }
+        const QDateTime dateTime(QDate::fromJulianDay(kUnixEpochJulianDay + days),
+                                 QTime(static_cast<int>(seconds / 3600), static_cast<int>(seconds / 60 % 60),
+                                       static_cast<int>(seconds % 60)));
+        const int userId = targetUserId > 0 ? targetUserId : group.userIds[i];
+        const QString bloodPressure = group.systolic[i] > 0 && group.diastolic[i] > 0
+                                          ? QString::number(group.systolic[i]) + "/" + QString::number(group.diastolic[i])
+                                          : QString();
+        records.append(healthrecord("", QString::number(userId), dateTime, group.weights[i], bloodPressure,
+                                    group.glucose[i]));
+    }
+    return records;
+}
+
+/**
+ * @brief Importa un archivo a health_records por la cola de inserción, en lotes acotados.
+ * @param filePath Ruta del archivo.
+ * @param targetUserId Si es mayor que 0, todas las filas se asignan a este usuario.
+ * @param importedRows Si no es nulo, recibe el número de filas confirmadas.
+ * @param progress Si no es nulo, se llama con las filas enviadas y el total antes de cada grupo
+ * y al terminar; si devuelve false la importación se cancela.
+ * @return true si el archivo se importó completo, false en caso contrario.
+ *
+ * Una primera pasada valida todos los grupos, así que un archivo dañado no importa nada. Después
+ * los grupos se convierten en los hilos de IngestPipeline y se confirman en lotes de batchRows
+ * filas por el escritor de la cola: ninguna transacción retiene el bloqueo de escritura de SQLite
+ * durante todo el archivo, y la conexión del llamador queda libre. Si un lote falla, los ya
+ * confirmados se conservan; reimportar el archivo no duplica filas.
+ */
+bool ColumnarFormat::importFile(const QString& filePath, int targetUserId, qint64* importedRows,
+                                const std::function<bool(qint64, qint64)>& progress)
+{
+    TRACE_SPAN("export", "ColumnarFormat::importFile");
+    qint64 totalRows = 0;
+    if (!readFile(filePath, [&totalRows](const ColumnarRowGroup& group) {
+            totalRows += group.size();
+            return true;
+        })) {
+        qCWarning(lcExport) << "Importación por columnas cancelada, el archivo no es válido:" << filePath;
+        return false;
+    }
+
+    IngestPipeline pipeline;
+    qint64 submittedRows = 0;
+    bool canceled = false;
+    const bool read = readFile(filePath, [&](const ColumnarRowGroup& group) {
+        if (progress && !progress(submittedRows, totalRows)) {
+            canceled = true;
+            return false;
+        }
+        submittedRows += group.size();
+        return pipeline.submit([group, targetUserId](IngestOutput& output) {
+            output.inputs = group.size();
+            output.lineSpan = group.size();
+            output.records = toRecords(group, targetUserId);
+        });
+    });
+    const IngestResult result = pipeline.finish();
+
+    qCInfo(lcExport) << "Importadas" << result.imported << "de" << totalRows << "filas desde" << filePath;
+    if (importedRows) {
+        *importedRows = result.imported;
+    }
+    if (canceled) {
+        qCInfo(lcExport) << "Importación por columnas cancelada:" << filePath;
+        return false;
+    }
+    if (!read || result.failed > 0) {
+        qCWarning(lcExport) << "Importación por columnas incompleta:" << filePath << ", filas sin guardar" << result.failed;
+        return false;
+    }
+    if (progress) {
+        progress(totalRows, totalRows);
+    }
+    return true;
+}
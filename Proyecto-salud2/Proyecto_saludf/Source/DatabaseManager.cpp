@@ -6,13 +6,83 @@
  */
 
 #include "DatabaseManager.h"
+#include "Logging.h"
+#include "ChangeFeed.h"
+#include "IngestQueue.h"
+#include "IngestJournal.h"
+#include "TimeSeriesStore.h"
+#include "IncrementalExporter.h"
+#include "PasswordHasher.h"
+#include "Metrics.h"
+#include "QueryStats.h"
 #include <QSqlQuery>
 #include <QSqlError>
-#include <QDebug>
-#include <QCryptographicHash>
 #include <QSqlRecord>
 #include <QDateTime>
+#include <QFileInfo>
 #include <QVariant>
+#include <QCoreApplication>
+#include <QPointer>
+#include <QMutexLocker>
+#include <QSet>
+#include <vector>
+#include <cmath>
+
+namespace {
+/**
+ * @brief Ruta configurada del archivo de la base de datos.
+ * @return Referencia a la ruta, "health_app.db" si no se cambió.
+ */
+QString& configuredDatabasePath()
+{
+    static QString path = QStringLiteral("health_app.db");
+    return path;
+}
+
+/**
+ * @brief Pasa a minúsculas solo las letras ASCII, como COLLATE NOCASE de SQLite.
+ * @param text Texto.
+ * @return Texto con A-Z convertidas a a-z y el resto sin cambios.
+ */
+QString asciiCaseFolded(const QString& text)
+{
+    QString folded = text;
+    for (QChar& c : folded) {
+        if (c >= QLatin1Char('A') && c <= QLatin1Char('Z')) {
+            c = QChar(c.unicode() + ('a' - 'A'));
+        }
+    }
+    return folded;
+}
+
+/**
+ * @brief Compara dos valores REAL de health_records, donde NULL solo es igual a NULL.
+ * @param a Primer valor.
+ * @param b Segundo valor.
+ * @return true si son iguales.
+ */
+bool sameReal(const QVariant& a, const QVariant& b)
+{
+    if (a.isNull() || b.isNull()) {
+        return a.isNull() && b.isNull();
+    }
+    return a.toDouble() == b.toDouble();
+}
+
+/**
+ * @brief Compara dos valores TEXT de health_records, donde NULL solo es igual a NULL.
+ * @param a Primer valor.
+ * @param b Segundo valor.
+ * @return true si son iguales.
+ */
+bool sameText(const QVariant& a, const QVariant& b)
+{
+    if (a.isNull() || b.isNull()) {
+        return a.isNull() && b.isNull();
+    }
+    return a.toString() == b.toString();
+}
+}
 
 /**
  * @brief Obtiene la instancia única de DatabaseManager.
@@ -32,17 +102,84 @@ DatabaseManager& DatabaseManager::instance()
  * Inicializa la base de datos al crear la instancia singleton.
  */
 DatabaseManager::DatabaseManager()
+    : m_userCache(kUserCacheCapacity)
 {
-    initializeDatabase();
+    // Crear el canal de cambios en el hilo principal antes de que otro hilo lo use
+    ChangeFeed::instance();
+    registerMetrics();
+    if (initializeDatabase()) {
+        m_ingestQueue.reset(new IngestQueue());
+        m_ingestQueue->start();
+
+        // Los segmentos pendientes ya se reaplicaron en initializeDatabase
+        qint64 firstSegment = IngestJournal::lastSegmentNumber(journalDirectory()) + 1;
+        QSqlQuery query(db);
+        if (QueryStats::exec(query, "SELECT MAX(segment) FROM ingest_journal_applied") && query.next()) {
+            firstSegment = qMax(firstSegment, query.value(0).toLongLong() + 1);
+        }
+        m_journal.reset(new IngestJournal(journalDirectory()));
+        if (m_journal->open(firstSegment)) {
+            m_journal->startCompactor();
+        } else {
+            m_journal.reset();
+        }
+    }
+}
+
+/**
+ * @brief Registra en Metrics los indicadores de la base de datos, la cola y la caché de usuarios.
+ *
+ * Los valores se leen al tomar cada foto de métricas, desde el hilo que la toma: el tamaño de
+ * los archivos con stat y la caché bajo su mutex.
+ */
+void DatabaseManager::registerMetrics()
+{
+    Metrics& metrics = Metrics::instance();
+    metrics.observe("salud_ingest_queue_depth", "Peticiones pendientes en la cola de inserción.",
+                    Metrics::GaugeType, [this]() { return static_cast<double>(pendingInserts()); });
+    metrics.observe("salud_db_file_bytes", "Tamaño del archivo de la base de datos.", Metrics::GaugeType, []() {
+        return static_cast<double>(QFileInfo(databasePath()).size());
+    });
+    metrics.observe("salud_db_wal_bytes", "Tamaño del archivo WAL de la base de datos.", Metrics::GaugeType, []() {
+        return static_cast<double>(QFileInfo(databasePath() + "-wal").size());
+    });
+    metrics.observe("salud_user_cache_entries", "Sesiones en la caché de usuarios.", Metrics::GaugeType, [this]() {
+        QMutexLocker locker(&m_userCacheMutex);
+        return static_cast<double>(m_userCache.size());
+    });
+    metrics.observe("salud_user_cache_hits_total", "Aciertos de la caché de usuarios.", Metrics::CounterType, [this]() {
+        QMutexLocker locker(&m_userCacheMutex);
+        return static_cast<double>(m_userCache.hits());
+    });
+    metrics.observe("salud_user_cache_misses_total", "Fallos de la caché de usuarios.", Metrics::CounterType, [this]() {
+        QMutexLocker locker(&m_userCacheMutex);
+        return static_cast<double>(m_userCache.misses());
+    });
 }
 
 /**
  * @brief Destructor de la clase DatabaseManager.
  *
- * Cierra la conexión a la base de datos si está abierta.
+ * Cierra la base de datos con shutdown() y registra las estadísticas de consultas (nivel debug
+ * de salud.db).
  */
 DatabaseManager::~DatabaseManager()
 {
+    shutdown();
+    qCDebug(lcDb).noquote() << "Estadísticas de consultas:\n" + QueryStats::instance().report();
+}
+
+/**
+ * @brief Detiene los hilos de la base de datos y cierra la conexión principal.
+ *
+ * Compacta la bitácora y confirma las inserciones pendientes antes de cerrar, así que al volver
+ * ningún hilo tiene abierto el archivo, el WAL ni los segmentos de la bitácora. Llamarla más de
+ * una vez no tiene efecto.
+ */
+void DatabaseManager::shutdown()
+{
+    m_journal.reset();
+    m_ingestQueue.reset();
     if (db.isOpen()) {
         db.close();
     }
@@ -52,22 +189,24 @@ DatabaseManager::~DatabaseManager()
  * @brief Inicializa la conexión a la base de datos y crea las tablas necesarias.
  * @return true si la inicialización es exitosa, false en caso contrario.
  *
- * Configura la base de datos SQLite y crea las tablas 'users' y 'health_records' si no existen.
+ * Configura la base de datos SQLite, crea las tablas 'users' y 'health_records' si no existen
+ * y reaplica los segmentos de la bitácora de inserción que quedaron sin compactar.
  */
 bool DatabaseManager::initializeDatabase()
 {
     db = QSqlDatabase::addDatabase("QSQLITE");
-    db.setDatabaseName("health_app.db");
+    db.setDatabaseName(databasePath());
 
     if (!db.open()) {
-        qDebug() << "Error al abrir la base de datos:" << db.lastError().text();
+        qCWarning(lcDb) << "Error al abrir la base de datos:" << db.lastError().text();
         return false;
     }
+    configureConnection(db);
 
     QSqlQuery query;
-    if (db.tables().contains("health_records")) {
-        query.exec("ALTER TABLE health_records RENAME TO health_records_old");
-        query.exec("CREATE TABLE health_records ("
+    if (db.tables().contains("health_records") && needsBloodPressureMigration()) {
+        QueryStats::exec(query, "ALTER TABLE health_records RENAME TO health_records_old");
+        QueryStats::exec(query, "CREATE TABLE health_records ("
                    "id INTEGER PRIMARY KEY AUTOINCREMENT, "
                    "user_id INTEGER NOT NULL, "
                    "date_time DATETIME NOT NULL, "
@@ -75,140 +214,872 @@ bool DatabaseManager::initializeDatabase()
                    "blood_pressure TEXT, "
                    "glucose_level REAL, "
                    "FOREIGN KEY (user_id) REFERENCES users(id))");
-        query.exec("INSERT INTO health_records (id, user_id, date_time, weight, blood_pressure, glucose_level) "
+        QueryStats::exec(query, "INSERT INTO health_records (id, user_id, date_time, weight, blood_pressure, glucose_level) "
                    "SELECT id, user_id, date_time, weight, CAST(blood_pressure AS TEXT), glucose_level "
                    "FROM health_records_old");
-        query.exec("DROP TABLE health_records_old");
+        QueryStats::exec(query, "DROP TABLE health_records_old");
     }
 
-    bool success = query.exec("CREATE TABLE IF NOT EXISTS users ("
+    bool success = QueryStats::exec(query, "CREATE TABLE IF NOT EXISTS users ("
                             "id INTEGER PRIMARY KEY AUTOINCREMENT, "
                             "username TEXT UNIQUE NOT NULL COLLATE NOCASE, "
-                            "password TEXT NOT NULL)");
+                            "password TEXT NOT NULL, "
+                            "kdf TEXT, "
+                            "kdf_iterations INTEGER, "
+                            "salt TEXT, "
+                            "rehash_pending INTEGER NOT NULL DEFAULT 0)");
+
+    if (!success) {
+        qCWarning(lcDb) << "Error al crear la tabla de usuarios:" << query.lastError().text();
+        return false;
+    }
+    if (!migrateUserCredentials()) {
+        return false;
+    }
 
+    success = QueryStats::exec(query, "CREATE TABLE IF NOT EXISTS user_preferences ("
+                         "user_id INTEGER NOT NULL, "
+                         "key TEXT NOT NULL, "
+                         "value TEXT, "
+                         "PRIMARY KEY (user_id, key), "
+                         "FOREIGN KEY (user_id) REFERENCES users(id)) WITHOUT ROWID");
     if (!success) {
-        qDebug() << "Error al crear la tabla de usuarios:" << query.lastError().text();
+        qCWarning(lcDb) << "Error al crear la tabla de preferencias:" << query.lastError().text();
         return false;
     }
 
-    success = query.exec("CREATE TABLE IF NOT EXISTS health_records ("
+    success = QueryStats::exec(query, "CREATE TABLE IF NOT EXISTS health_records ("
                        "id INTEGER PRIMARY KEY AUTOINCREMENT, "
                        "user_id INTEGER NOT NULL, "
                        "date_time DATETIME NOT NULL, "
                        "weight REAL, "
                        "blood_pressure TEXT, "
                        "glucose_level REAL, "
+                       "change_seq INTEGER, "
                        "FOREIGN KEY (user_id) REFERENCES users(id))");
 
     if (!success) {
-        qDebug() << "Error al crear la tabla de registros de salud:" << query.lastError().text();
+        qCWarning(lcDb) << "Error al crear la tabla de registros de salud:" << query.lastError().text();
+        return false;
+    }
+
+    success = QueryStats::exec(query, "CREATE TABLE IF NOT EXISTS ingest_journal_applied ("
+                         "segment INTEGER PRIMARY KEY)");
+    if (!success) {
+        qCWarning(lcDb) << "Error al crear la tabla de segmentos aplicados:" << query.lastError().text();
+        return false;
+    }
+
+    if (!TimeSeriesStore::createSchema(db) || !IncrementalExporter::createSchema(db)) {
+        return false;
+    }
+
+    if (!migrateToUniqueReadings() || !migrateToChangeSequence()) {
+        return false;
+    }
+
+    // Índices que respaldan el filtrado y ordenamiento de la tabla de historial
+    const QStringList indexes = {
+        "CREATE INDEX IF NOT EXISTS idx_health_records_user_weight ON health_records (user_id, weight)",
+        "CREATE INDEX IF NOT EXISTS idx_health_records_user_glucose ON health_records (user_id, glucose_level)",
+        QString("CREATE INDEX IF NOT EXISTS idx_health_records_user_systolic ON health_records (user_id, %1)")
+            .arg(systolicExpression())
+    };
+    for (const QString& statement : indexes) {
+        if (!QueryStats::exec(query, statement)) {
+            qCWarning(lcDb) << "Error al crear índice de registros de salud:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    // Reaplicar las lecturas confirmadas en la bitácora que no alcanzaron a compactarse
+    QVector<RecordChange> replayed;
+    if (!IngestJournal::replay(db, journalDirectory(), replayed)) {
+        qCWarning(lcDb) << "Error al reaplicar la bitácora de inserción";
         return false;
     }
+    ChangeFeed::instance().publish(replayed);
 
-    qDebug() << "Base de datos inicializada correctamente";
+    qCInfo(lcDb) << "Base de datos inicializada correctamente";
     return true;
 }
 
 /**
- * @brief Verifica las credenciales de un usuario.
- * @param username Nombre de usuario.
- * @param password Contraseña del usuario.
- * @return true si las credenciales son válidas, false en caso contrario.
+ * @brief Indica si la base de datos se abrió y su esquema quedó al día.
+ * @return true si la inicialización del constructor (tablas, migraciones y bitácora) fue exitosa.
  *
- * Compara el hash SHA-256 de la contraseña ingresada con la almacenada en la base de datos.
+ * La cola de inserción solo se crea cuando initializeDatabase() termina bien.
  */
-bool DatabaseManager::checkCredentials(const QString& username, const QString& password)
+bool DatabaseManager::isReady() const
 {
-    if (!db.isOpen() && !db.open()) {
-        qDebug() << "No se pudo abrir la base de datos para verificar credenciales:" << db.lastError().text();
+    return m_ingestQueue != nullptr;
+}
+
+/**
+ * @brief Ruta del archivo de la base de datos.
+ * @return Ruta del archivo SQLite usado por todas las conexiones.
+ */
+QString DatabaseManager::databasePath()
+{
+    return configuredDatabasePath();
+}
+
+/**
+ * @brief Cambia la ruta del archivo de la base de datos.
+ * @param path Ruta del archivo SQLite.
+ *
+ * Debe llamarse antes del primer uso de instance(), que abre la base de datos.
+ */
+void DatabaseManager::setDatabasePath(const QString& path)
+{
+    configuredDatabasePath() = path;
+}
+
+/**
+ * @brief Directorio de los segmentos de la bitácora de inserción.
+ * @return Ruta del directorio, junto al archivo de la base de datos.
+ */
+QString DatabaseManager::journalDirectory()
+{
+    return databasePath() + ".ingest";
+}
+
+/**
+ * @brief Aplica a una conexión los ajustes comunes de SQLite.
+ * @param connection Conexión abierta.
+ *
+ * El modo WAL permite que los lectores sigan trabajando mientras el hilo escritor confirma,
+ * synchronous=FULL mantiene la durabilidad de cada commit y busy_timeout evita fallos
+ * inmediatos cuando otra conexión tiene el bloqueo de escritura.
+ */
+void DatabaseManager::configureConnection(QSqlDatabase& connection)
+{
+    QSqlQuery pragma(connection);
+    const QStringList statements = {
+        "PRAGMA journal_mode=WAL",
+        "PRAGMA synchronous=FULL",
+        "PRAGMA busy_timeout=5000"
+    };
+    for (const QString& statement : statements) {
+        if (!QueryStats::exec(pragma, statement)) {
+            qCWarning(lcDb) << "Error al configurar la conexión" << connection.connectionName() << ":" << pragma.lastError().text();
+        }
+    }
+}
+
+/**
+ * @brief Abre una conexión adicional a la base de datos para el hilo que llama.
+ * @param connectionName Nombre único de la conexión.
+ * @return Conexión abierta y configurada; no válida si no se pudo abrir.
+ *
+ * Qt exige que cada hilo use sus propias conexiones. Quien la abre debe cerrarla y llamar a
+ * QSqlDatabase::removeDatabase() desde el mismo hilo al terminar.
+ */
+QSqlDatabase DatabaseManager::openConnection(const QString& connectionName)
+{
+    QSqlDatabase connection = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    connection.setDatabaseName(databasePath());
+    if (!connection.open()) {
+        qCWarning(lcDb) << "Error al abrir la conexión" << connectionName << ":" << connection.lastError().text();
+        return connection;
+    }
+    configureConnection(connection);
+    return connection;
+}
+
+/**
+ * @brief Indica si la tabla health_records conserva el tipo antiguo de la columna blood_pressure.
+ * @return true si blood_pressure no es TEXT y la tabla debe reconstruirse, false en caso contrario.
+ *
+ * Evita copiar la tabla completa en cada arranque: la reconstrucción solo se hace una vez.
+ */
+bool DatabaseManager::needsBloodPressureMigration()
+{
+    QSqlQuery query(db);
+    if (!QueryStats::exec(query, "PRAGMA table_info(health_records)")) {
+        qCWarning(lcDb) << "Error al leer el esquema de health_records:" << query.lastError().text();
         return false;
     }
+    while (query.next()) {
+        if (query.value(1).toString() == "blood_pressure") {
+            return query.value(2).toString().compare("TEXT", Qt::CaseInsensitive) != 0;
+        }
+    }
+    return false;
+}
 
-    QSqlQuery query;
-    QString hashedPassword = QString(QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha256).toHex());
-    qDebug() << "Intentando autenticar usuario:" << username;
-    qDebug() << "Contraseña ingresada (hasheada):" << hashedPassword;
+/**
+ * @brief Agrega a users las columnas de parámetros del hash si la base es anterior a ellas.
+ * @return true si las columnas existen al terminar, false en caso contrario.
+ *
+ * Las filas existentes quedan con kdf NULL, que PasswordHasher trata como SHA-256 sin sal; se
+ * vuelven a derivar en el siguiente inicio de sesión de cada usuario.
+ */
+bool DatabaseManager::migrateUserCredentials()
+{
+    QSqlQuery query(db);
+    if (!QueryStats::exec(query, "PRAGMA table_info(users)")) {
+        qCWarning(lcAuth) << "Error al leer las columnas de users:" << query.lastError().text();
+        return false;
+    }
+    QStringList columns;
+    while (query.next()) {
+        columns << query.value(1).toString();
+    }
+    query.finish();
+
+    const QStringList added = {"kdf TEXT", "kdf_iterations INTEGER", "salt TEXT",
+                               "rehash_pending INTEGER NOT NULL DEFAULT 0"};
+    for (const QString& column : added) {
+        if (columns.contains(column.section(' ', 0, 0))) {
+            continue;
+        }
+        if (!QueryStats::exec(query, "ALTER TABLE users ADD COLUMN " + column)) {
+            qCWarning(lcAuth) << "Error al agregar la columna" << column << "a users:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Combina las filas repetidas de health_records y crea el índice único de usuario y fecha.
+ * @return true si el índice único existe al terminar, false en caso contrario.
+ *
+ * Se ejecuta una sola vez: cuando el índice único ya existe no hace nada. Por cada grupo de
+ * filas con el mismo usuario y fecha se conserva la de menor id, con el valor más reciente no
+ * nulo de cada columna (la misma regla que insertHealthRecords()), y se borran las demás. El
+ * índice único reemplaza a idx_health_records_user_date, que tenía las mismas columnas.
+ */
+bool DatabaseManager::migrateToUniqueReadings()
+{
+    QSqlQuery query(db);
+    if (!QueryStats::exec(query, "SELECT 1 FROM sqlite_master WHERE type = 'index' AND name = 'uq_health_records_user_date'")) {
+        qCWarning(lcDb) << "Error al leer los índices de health_records:" << query.lastError().text();
+        return false;
+    }
+    if (query.next()) {
+        return true;
+    }
+    query.finish();
+
+    if (!db.transaction()) {
+        qCWarning(lcDb) << "Error al iniciar la migración de registros repetidos:" << db.lastError().text();
+        return false;
+    }
+
+    // El índice no único acelera las subconsultas correlacionadas durante la migración
+    const QStringList statements = {
+        "CREATE INDEX IF NOT EXISTS idx_health_records_user_date ON health_records (user_id, date_time)",
+        "UPDATE health_records SET "
+        "weight = (SELECT d.weight FROM health_records d WHERE d.user_id = health_records.user_id "
+        "AND d.date_time = health_records.date_time AND d.weight IS NOT NULL ORDER BY d.id DESC LIMIT 1), "
+        "blood_pressure = (SELECT d.blood_pressure FROM health_records d WHERE d.user_id = health_records.user_id "
+        "AND d.date_time = health_records.date_time AND d.blood_pressure IS NOT NULL ORDER BY d.id DESC LIMIT 1), "
+        "glucose_level = (SELECT d.glucose_level FROM health_records d WHERE d.user_id = health_records.user_id "
+        "AND d.date_time = health_records.date_time AND d.glucose_level IS NOT NULL ORDER BY d.id DESC LIMIT 1) "
+        "WHERE id IN (SELECT MIN(id) FROM health_records GROUP BY user_id, date_time HAVING COUNT(*) > 1)",
+        "DELETE FROM health_records WHERE EXISTS (SELECT 1 FROM health_records d "
+        "WHERE d.user_id = health_records.user_id AND d.date_time = health_records.date_time "
+        "AND d.id < health_records.id)",
+        "DROP INDEX idx_health_records_user_date",
+        "CREATE UNIQUE INDEX uq_health_records_user_date ON health_records (user_id, date_time)"
+    };
+    int removed = 0;
+    for (const QString& statement : statements) {
+        if (!QueryStats::exec(query, statement)) {
+            qCWarning(lcDb) << "Error en la migración de registros repetidos:" << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+        if (statement.startsWith("DELETE")) {
+            removed = query.numRowsAffected();
+        }
+    }
+    if (!db.commit()) {
+        qCWarning(lcDb) << "Error al confirmar la migración de registros repetidos:" << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    qCInfo(lcDb) << "Migración de registros repetidos completada; filas combinadas:" << removed;
+    return true;
+}
+
+/**
+ * @brief Agrega a health_records la secuencia de cambios y los disparadores que la mantienen.
+ * @return true si la columna, el contador y los disparadores existen al terminar.
+ *
+ * change_seq toma un valor nuevo y creciente cada vez que una fila se inserta o cambia, incluso
+ * cuando un registro se combina con una fila existente y conserva su id. Las filas anteriores a
+ * la columna reciben change_seq = id, así que las marcas de exportación guardadas siguen valiendo.
+ * El contador vive en su propia tabla para que borrar la fila más reciente no reutilice su valor.
+ */
+bool DatabaseManager::migrateToChangeSequence()
+{
+    QSqlQuery query(db);
+    if (!QueryStats::exec(query, "PRAGMA table_info(health_records)")) {
+        qCWarning(lcDb) << "Error al leer el esquema de health_records:" << query.lastError().text();
+        return false;
+    }
+    bool hasColumn = false;
+    while (query.next()) {
+        hasColumn = hasColumn || query.value(1).toString() == "change_seq";
+    }
+    query.finish();
+
+    if (!db.transaction()) {
+        qCWarning(lcDb) << "Error al iniciar la migración de la secuencia de cambios:" << db.lastError().text();
+        return false;
+    }
+    QStringList statements;
+    if (!hasColumn) {
+        statements << "ALTER TABLE health_records ADD COLUMN change_seq INTEGER"
+                   << "UPDATE health_records SET change_seq = id";
+    }
+    statements << "CREATE TABLE IF NOT EXISTS health_records_sequence ("
+                  "id INTEGER PRIMARY KEY CHECK (id = 1), value INTEGER NOT NULL)"
+               << "INSERT OR IGNORE INTO health_records_sequence (id, value) "
+                  "SELECT 1, COALESCE(MAX(change_seq), 0) FROM health_records"
+               << "CREATE INDEX IF NOT EXISTS idx_health_records_change_seq ON health_records (change_seq)"
+               << "CREATE TRIGGER IF NOT EXISTS trg_health_records_insert_seq AFTER INSERT ON health_records BEGIN "
+                  "UPDATE health_records_sequence SET value = value + 1; "
+                  "UPDATE health_records SET change_seq = (SELECT value FROM health_records_sequence) WHERE id = NEW.id; "
+                  "END"
+               // change_seq no está en la lista de columnas, así que la segunda sentencia no vuelve a disparar
+               << "CREATE TRIGGER IF NOT EXISTS trg_health_records_update_seq "
+                  "AFTER UPDATE OF user_id, date_time, weight, blood_pressure, glucose_level ON health_records BEGIN "
+                  "UPDATE health_records_sequence SET value = value + 1; "
+                  "UPDATE health_records SET change_seq = (SELECT value FROM health_records_sequence) WHERE id = NEW.id; "
+                  "END";
+    for (const QString& statement : statements) {
+        if (!QueryStats::exec(query, statement)) {
+            qCWarning(lcDb) << "Error en la migración de la secuencia de cambios:" << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    if (!db.commit()) {
+        qCWarning(lcDb) << "Error al confirmar la migración de la secuencia de cambios:" << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Expresión SQL que extrae la presión sistólica de la columna blood_pressure.
+ * @return Expresión SQL con el valor sistólico como REAL.
+ *
+ * Debe usarse tal cual en consultas e índices para que SQLite pueda aprovechar el índice por expresión.
+ */
+QString DatabaseManager::systolicExpression()
+{
+    return "CAST(SUBSTR(blood_pressure, 1, INSTR(blood_pressure, '/') - 1) AS REAL)";
+}
 
-    query.prepare("SELECT COUNT(*) FROM users WHERE LOWER(username) = LOWER(:username) AND password = :password");
+/**
+ * @brief Busca las credenciales guardadas de un usuario.
+ * @param username Nombre de usuario, sin distinguir mayúsculas.
+ * @param user Usuario encontrado.
+ * @param stored Hash guardado y sus parámetros.
+ * @return true si el usuario existe, false si no existe o la consulta falla.
+ *
+ * La búsqueda compara con COLLATE NOCASE, la misma intercalación de la columna, de modo que
+ * SQLite resuelve la fila con el índice UNIQUE de username en lugar de recorrer la tabla.
+ */
+bool DatabaseManager::lookupCredentials(const QString& username, User& user, PasswordHash& stored)
+{
+    if (!db.isOpen() && !db.open()) {
+        qCWarning(lcAuth) << "No se pudo abrir la base de datos para verificar credenciales:" << db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(db);
+    query.prepare("SELECT id, username, password, kdf, kdf_iterations, salt, rehash_pending FROM users "
+                  "WHERE username = :username COLLATE NOCASE");
     query.bindValue(":username", username);
-    query.bindValue(":password", hashedPassword);
+    if (!QueryStats::exec(query)) {
+        qCWarning(lcAuth) << "Error al verificar credenciales:" << query.lastError().text();
+        return false;
+    }
+    if (!query.next()) {
+        return false;
+    }
+
+    user = User(query.value(0).toString(), query.value(1).toString());
+    stored.hash = query.value(2).toString().toLatin1();
+    stored.kdf = query.value(3).toString();
+    stored.iterations = query.value(4).toInt();
+    stored.salt = QByteArray::fromHex(query.value(5).toString().toLatin1());
+    stored.provisional = query.value(6).toInt() != 0;
+    return true;
+}
 
-    if (!query.exec()) {
-        qDebug() << "Error al verificar credenciales:" << query.lastError().text();
+/**
+ * @brief Guarda un hash nuevo de la contraseña de un usuario.
+ * @param userId Identificador del usuario.
+ * @param hash Hash y parámetros.
+ * @return true si se actualiza, false en caso contrario.
+ */
+bool DatabaseManager::updatePasswordHash(const QString& userId, const PasswordHash& hash)
+{
+    QSqlQuery query(db);
+    query.prepare("UPDATE users SET password = :password, kdf = :kdf, kdf_iterations = :iterations, "
+                  "salt = :salt, rehash_pending = :rehash_pending WHERE id = :id");
+    query.bindValue(":password", QString::fromLatin1(hash.hash));
+    query.bindValue(":kdf", hash.kdf);
+    query.bindValue(":iterations", hash.iterations);
+    query.bindValue(":salt", QString::fromLatin1(hash.salt.toHex()));
+    query.bindValue(":rehash_pending", hash.provisional ? 1 : 0);
+    query.bindValue(":id", userId);
+    if (!QueryStats::exec(query)) {
+        qCWarning(lcAuth) << "Error al actualizar el hash de la contraseña:" << query.lastError().text();
         return false;
     }
+    qCInfo(lcAuth) << "Hash de contraseña actualizado a" << hash.kdf << "con" << hash.iterations << "iteraciones";
+    return true;
+}
 
-    if (query.next()) {
-        int count = query.value(0).toInt();
-        qDebug() << "Usuarios encontrados con las credenciales:" << count;
-        if (count > 0) {
-            qDebug() << "Autenticación exitosa para:" << username;
-            return true;
+/**
+ * @brief Autentica a un usuario. Bloquea mientras se deriva la contraseña.
+ * @param username Nombre de usuario, sin distinguir mayúsculas.
+ * @param password Contraseña ingresada.
+ * @return La sesión del usuario si las credenciales son válidas, o una sesión no válida en caso contrario.
+ *
+ * Si el usuario no existe se verifica contra PasswordHasher::dummyHash(), para que el tiempo de
+ * respuesta no revele qué nombres están registrados. Si la contraseña es válida pero su hash usa
+ * parámetros antiguos (SHA-256 sin sal o menos iteraciones), se vuelve a derivar y se guarda.
+ * Desde la interfaz debe usarse authenticateAsync().
+ */
+Session DatabaseManager::authenticate(const QString& username, const QString& password)
+{
+    QueryStats::Scope scope("DatabaseManager::authenticate");
+    PasswordHasher& hasher = PasswordHasher::instance();
+    User user;
+    PasswordHash stored;
+    const bool found = lookupCredentials(username, user, stored);
+
+    if (!hasher.verify(password, found ? stored : hasher.dummyHash()) || !found) {
+        qCInfo(lcAuth) << "Credenciales no válidas para:" << username;
+        return Session();
+    }
+
+    if (hasher.needsRehash(stored)) {
+        updatePasswordHash(user.getId(), hasher.hash(password));
+    }
+    qCInfo(lcAuth) << "Autenticación exitosa para:" << username;
+    return openSession(user);
+}
+
+/**
+ * @brief Autentica a un usuario sin bloquear el hilo que llama.
+ * @param username Nombre de usuario, sin distinguir mayúsculas.
+ * @param password Contraseña ingresada.
+ * @param context Objeto del hilo principal; si se destruye antes, done no se llama.
+ * @param done Recibe la sesión del usuario, o una sesión no válida si las credenciales no lo son.
+ *
+ * La búsqueda del usuario usa un índice y se hace en el hilo que llama; la verificación y, si
+ * hace falta, la nueva derivación corren en el pool de PasswordHasher, y la actualización del
+ * hash vuelve al hilo principal, dueño de la conexión principal. El hilo del pool no consulta
+ * context: QPointer solo es seguro en el hilo del objeto, así que se comprueba al volver.
+ */
+void DatabaseManager::authenticateAsync(const QString& username, const QString& password, QObject* context,
+                                        std::function<void(const Session&)> done)
+{
+    QueryStats::Scope scope("DatabaseManager::authenticateAsync");
+    PasswordHasher& hasher = PasswordHasher::instance();
+    User user;
+    PasswordHash stored;
+    const bool found = lookupCredentials(username, user, stored);
+    const PasswordHash reference = found ? stored : hasher.dummyHash();
+    QPointer<QObject> guard(context);
+
+    hasher.run([this, &hasher, username, password, user, found, reference, guard, done]() {
+        const bool valid = hasher.verify(password, reference) && found;
+        const bool rehash = valid && hasher.needsRehash(reference);
+        const PasswordHash fresh = rehash ? hasher.hash(password) : PasswordHash();
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [this, username, user, valid, rehash, fresh, guard,
+                                                                 done]() {
+            if (!guard) {
+                return;
+            }
+            if (!valid) {
+                qCInfo(lcAuth) << "Credenciales no válidas para:" << username;
+                done(Session());
+                return;
+            }
+            if (rehash) {
+                updatePasswordHash(user.getId(), fresh);
+            }
+            qCInfo(lcAuth) << "Autenticación exitosa para:" << username;
+            done(openSession(user));
+        }, Qt::QueuedConnection);
+    });
+}
+
+/**
+ * @brief Crea la sesión de un usuario recién autenticado.
+ * @param user Usuario, tal como lo devolvió lookupCredentials().
+ * @return Sesión con las preferencias del usuario.
+ *
+ * El nombre ya viene de la consulta de credenciales; solo las preferencias se leen de la base de
+ * datos, y solo si el usuario no está en la caché.
+ */
+Session DatabaseManager::openSession(const User& user)
+{
+    const int userId = user.getId().toInt();
+    {
+        QMutexLocker locker(&m_userCacheMutex);
+        Session cached;
+        if (m_userCache.get(userId, cached) && cached.displayName() == user.getUsername()) {
+            return cached;
         }
     }
 
-    qDebug() << "No se encontraron usuarios con esas credenciales";
-    QSqlQuery debugQuery;
-    debugQuery.prepare("SELECT password FROM users WHERE LOWER(username) = LOWER(:username)");
-    debugQuery.bindValue(":username", username);
-    if (debugQuery.exec() && debugQuery.next()) {
-        qDebug() << "Contraseña almacenada en la base de datos:" << debugQuery.value(0).toString();
-    } else {
-        qDebug() << "Usuario no encontrado en la base de datos o error en la consulta:" << debugQuery.lastError().text();
+    const Session session(userId, user.getUsername(), loadPreferences(userId));
+    QMutexLocker locker(&m_userCacheMutex);
+    m_userCache.put(userId, session);
+    return session;
+}
+
+/**
+ * @brief Obtiene la sesión de un usuario por su identificador, sin verificar credenciales.
+ * @param userId Identificador del usuario.
+ * @return Sesión del usuario, o una sesión no válida si no existe.
+ *
+ * Se resuelve desde la caché de usuarios; solo en un fallo se consultan users y user_preferences.
+ */
+Session DatabaseManager::session(int userId)
+{
+    QueryStats::Scope scope("DatabaseManager::session");
+    {
+        QMutexLocker locker(&m_userCacheMutex);
+        Session cached;
+        if (m_userCache.get(userId, cached)) {
+            return cached;
+        }
     }
-    return false;
+
+    QSqlQuery query(db);
+    query.prepare("SELECT username FROM users WHERE id = :id");
+    query.bindValue(":id", userId);
+    if (!QueryStats::exec(query)) {
+        qCWarning(lcAuth) << "Error al buscar usuario:" << query.lastError().text();
+        return Session();
+    }
+    if (!query.next()) {
+        return Session();
+    }
+
+    const Session session(userId, query.value(0).toString(), loadPreferences(userId));
+    QMutexLocker locker(&m_userCacheMutex);
+    m_userCache.put(userId, session);
+    return session;
 }
 
 /**
- * @brief Registra un nuevo usuario en la base de datos.
+ * @brief Lee las preferencias guardadas de un usuario.
+ * @param userId Identificador del usuario.
+ * @return Preferencias por nombre; vacías si no tiene o si la consulta falla.
+ */
+QHash<QString, QString> DatabaseManager::loadPreferences(int userId)
+{
+    QHash<QString, QString> preferences;
+    QSqlQuery query(db);
+    query.prepare("SELECT key, value FROM user_preferences WHERE user_id = :userId");
+    query.bindValue(":userId", userId);
+    if (!QueryStats::exec(query)) {
+        qCWarning(lcAuth) << "Error al leer las preferencias del usuario:" << query.lastError().text();
+        return preferences;
+    }
+    while (query.next()) {
+        preferences.insert(query.value(0).toString(), query.value(1).toString());
+    }
+    return preferences;
+}
+
+/**
+ * @brief Guarda una preferencia de un usuario.
+ * @param userId Identificador del usuario.
+ * @param key Nombre de la preferencia.
+ * @param value Valor.
+ * @return true si se guarda, false en caso contrario.
+ *
+ * Invalida la entrada del usuario en la caché; la siguiente sesión lee las preferencias de nuevo.
+ */
+bool DatabaseManager::setUserPreference(int userId, const QString& key, const QString& value)
+{
+    QueryStats::Scope scope("DatabaseManager::setUserPreference");
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO user_preferences (user_id, key, value) VALUES (:userId, :key, :value) "
+                  "ON CONFLICT (user_id, key) DO UPDATE SET value = excluded.value");
+    query.bindValue(":userId", userId);
+    query.bindValue(":key", key);
+    query.bindValue(":value", value);
+    if (!QueryStats::exec(query)) {
+        qCWarning(lcAuth) << "Error al guardar la preferencia" << key << ":" << query.lastError().text();
+        return false;
+    }
+    invalidateUser(userId);
+    return true;
+}
+
+/**
+ * @brief Descarta un usuario de la caché para que la siguiente consulta lo lea de la base de datos.
+ * @param userId Identificador del usuario.
+ */
+void DatabaseManager::invalidateUser(int userId)
+{
+    QMutexLocker locker(&m_userCacheMutex);
+    m_userCache.remove(userId);
+}
+
+/**
+ * @brief Cambia el número máximo de usuarios en la caché.
+ * @param capacity Nueva capacidad; como mínimo 1.
+ */
+void DatabaseManager::setUserCacheCapacity(int capacity)
+{
+    QMutexLocker locker(&m_userCacheMutex);
+    m_userCache.setCapacity(static_cast<std::size_t>(qMax(1, capacity)));
+}
+
+/**
+ * @brief Verifica las credenciales de un usuario.
  * @param username Nombre de usuario.
  * @param password Contraseña del usuario.
- * @return true si el registro es exitoso, false en caso contrario.
- *
- * Almacena la contraseña como un hash SHA-256 y verifica que el nombre de usuario sea único.
+ * @return true si las credenciales son válidas, false en caso contrario.
  */
-bool DatabaseManager::registerUser(const QString& username, const QString& password)
+bool DatabaseManager::checkCredentials(const QString& username, const QString& password)
+{
+    QueryStats::Scope scope("DatabaseManager::checkCredentials");
+    return authenticate(username, password).isValid();
+}
+
+/**
+ * @brief Indica si un nombre de usuario ya está registrado.
+ * @param username Nombre de usuario, sin distinguir mayúsculas.
+ * @return true si existe o si la consulta falla, false si está libre.
+ */
+bool DatabaseManager::usernameTaken(const QString& username)
 {
     if (!db.isOpen() && !db.open()) {
-        qDebug() << "No se pudo abrir la base de datos para registrar usuario:" << db.lastError().text();
-        return false;
+        qCWarning(lcAuth) << "No se pudo abrir la base de datos para registrar usuario:" << db.lastError().text();
+        return true;
     }
 
-    QSqlQuery checkQuery;
-    checkQuery.prepare("SELECT COUNT(*) FROM users WHERE LOWER(username) = LOWER(:username)");
+    QSqlQuery checkQuery(db);
+    checkQuery.prepare("SELECT COUNT(*) FROM users WHERE username = :username COLLATE NOCASE");
     checkQuery.bindValue(":username", username);
 
-    if (!checkQuery.exec()) {
-        qDebug() << "Error al verificar si el usuario existe:" << checkQuery.lastError().text();
-        return false;
+    if (!QueryStats::exec(checkQuery)) {
+        qCWarning(lcAuth) << "Error al verificar si el usuario existe:" << checkQuery.lastError().text();
+        return true;
     }
 
     if (checkQuery.next() && checkQuery.value(0).toInt() > 0) {
-        qDebug() << "El usuario ya existe:" << username;
-        return false;
+        qCDebug(lcAuth) << "El usuario ya existe:" << username;
+        return true;
     }
+    return false;
+}
 
-    QString hashedPassword = QString(QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha256).toHex());
-    qDebug() << "Registrando usuario:" << username << "con contraseña hasheada:" << hashedPassword;
+/**
+ * @brief Inserta un usuario con su hash ya derivado.
+ * @param username Nombre de usuario.
+ * @param hash Hash de la contraseña y sus parámetros.
+ * @return true si el registro es exitoso, false en caso contrario.
+ */
+bool DatabaseManager::insertUser(const QString& username, const PasswordHash& hash)
+{
+    qCDebug(lcAuth) << "Registrando usuario:" << username;
 
-    QSqlDatabase::database().transaction();
-    QSqlQuery insertQuery;
-    insertQuery.prepare("INSERT INTO users (username, password) VALUES (:username, :password)");
+    db.transaction();
+    QSqlQuery insertQuery(db);
+    insertQuery.prepare("INSERT INTO users (username, password, kdf, kdf_iterations, salt) "
+                        "VALUES (:username, :password, :kdf, :iterations, :salt)");
     insertQuery.bindValue(":username", username);
-    insertQuery.bindValue(":password", hashedPassword);
+    insertQuery.bindValue(":password", QString::fromLatin1(hash.hash));
+    insertQuery.bindValue(":kdf", hash.kdf);
+    insertQuery.bindValue(":iterations", hash.iterations);
+    insertQuery.bindValue(":salt", QString::fromLatin1(hash.salt.toHex()));
 
-    bool success = insertQuery.exec();
+    bool success = QueryStats::exec(insertQuery);
     if (!success) {
-        qDebug() << "Error al registrar usuario:" << insertQuery.lastError().text();
-        QSqlDatabase::database().rollback();
+        qCWarning(lcAuth) << "Error al registrar usuario:" << insertQuery.lastError().text();
+        db.rollback();
         return false;
     }
 
-    QSqlDatabase::database().commit();
-    qDebug() << "Usuario registrado exitosamente:" << username;
+    if (!db.commit()) {
+        qCWarning(lcAuth) << "Error al confirmar el registro del usuario:" << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    qCInfo(lcAuth) << "Usuario registrado exitosamente:" << username;
     return true;
 }
 
+/**
+ * @brief Registra un nuevo usuario en la base de datos. Bloquea mientras se deriva la contraseña.
+ * @param username Nombre de usuario.
+ * @param password Contraseña del usuario.
+ * @return true si el registro es exitoso, false en caso contrario.
+ *
+ * Almacena la contraseña derivada con PasswordHasher y verifica que el nombre de usuario sea único.
+ * Desde la interfaz debe usarse registerUserAsync().
+ */
+bool DatabaseManager::registerUser(const QString& username, const QString& password)
+{
+    QueryStats::Scope scope("DatabaseManager::registerUser");
+    if (usernameTaken(username)) {
+        return false;
+    }
+    return insertUser(username, PasswordHasher::instance().hash(password));
+}
+
+/**
+ * @brief Registra un nuevo usuario sin bloquear el hilo que llama.
+ * @param username Nombre de usuario.
+ * @param password Contraseña del usuario.
+ * @param context Objeto del hilo principal; si se destruye antes, done no se llama.
+ * @param done Recibe true si el registro es exitoso.
+ *
+ * La derivación corre en el pool de PasswordHasher; la inserción vuelve al hilo principal, donde
+ * también se comprueba si context sigue vivo.
+ */
+void DatabaseManager::registerUserAsync(const QString& username, const QString& password, QObject* context,
+                                        std::function<void(bool)> done)
+{
+    QueryStats::Scope scope("DatabaseManager::registerUserAsync");
+    if (usernameTaken(username)) {
+        done(false);
+        return;
+    }
+
+    PasswordHasher& hasher = PasswordHasher::instance();
+    QPointer<QObject> guard(context);
+    hasher.run([this, &hasher, username, password, guard, done]() {
+        const PasswordHash hash = hasher.hash(password);
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [this, username, hash, guard, done]() {
+            if (!guard) {
+                return;
+            }
+            done(insertUser(username, hash));
+        }, Qt::QueuedConnection);
+    });
+}
+
+/**
+ * @brief Registra un lote de usuarios en una sola transacción.
+ * @param batch Cuentas a registrar.
+ * @return Un resultado por cuenta, en el mismo orden que batch.
+ *
+ * Las contraseñas se derivan en paralelo en el pool de PasswordHasher con
+ * PasswordHasher::kProvisioningIterations, el mínimo admitido, y las cuentas se guardan con
+ * rehash_pending, así que cada una se vuelve a derivar con el costo calibrado en su primer
+ * inicio de sesión. El mínimo sigue siendo caro: el costo del lote es proporcional al número de
+ * cuentas dividido entre los núcleos (ver la prueba registerUsers de salud-benchmarks).
+ *
+ * Los repetidos dentro del lote se detectan sin distinguir mayúsculas solo en ASCII, igual que
+ * COLLATE NOCASE de la columna username.
+ *
+ * Los nombres ya registrados no se consultan uno por uno: INSERT ... ON CONFLICT DO NOTHING
+ * contra el índice UNIQUE de username no inserta la fila y la marca como Duplicate. Si la
+ * inserción falla por otro motivo se revierte el lote completo y todas las cuentas quedan como
+ * Failed. Debe llamarse desde el hilo de la conexión principal.
+ */
+QVector<RegistrationResult> DatabaseManager::registerUsers(const QVector<UserRegistration>& batch)
+{
+    QueryStats::Scope scope("DatabaseManager::registerUsers");
+    QVector<RegistrationResult> results(batch.size());
+    std::vector<std::future<PasswordHash>> hashes(batch.size());
+    PasswordHasher& hasher = PasswordHasher::instance();
+
+    // Validar y descartar repetidos dentro del lote antes de derivar contraseñas
+    QSet<QString> seen;
+    for (int i = 0; i < batch.size(); ++i) {
+        RegistrationResult& result = results[i];
+        result.username = batch[i].username.trimmed();
+        if (result.username.isEmpty() || batch[i].password.isEmpty()) {
+            result.outcome = RegistrationResult::Invalid;
+            continue;
+        }
+        const QString key = asciiCaseFolded(result.username);
+        if (seen.contains(key)) {
+            result.outcome = RegistrationResult::Duplicate;
+            continue;
+        }
+        seen.insert(key);
+        hashes[i] = hasher.hashAsync(batch[i].password, PasswordHasher::kProvisioningIterations);
+    }
+
+    // Sin transacción confirmada ninguna cuenta del lote queda registrada
+    const auto abandon = [&results, &hashes]() {
+        for (std::size_t i = 0; i < hashes.size(); ++i) {
+            if (hashes[i].valid()) {
+                hashes[i].wait();
+                results[static_cast<int>(i)].outcome = RegistrationResult::Failed;
+            }
+        }
+        for (RegistrationResult& result : results) {
+            if (result.outcome == RegistrationResult::Registered) {
+                result.outcome = RegistrationResult::Failed;
+                result.userId = 0;
+            }
+        }
+    };
+
+    if ((!db.isOpen() && !db.open()) || !db.transaction()) {
+        qCWarning(lcAuth) << "No se pudo iniciar el registro en lote:" << db.lastError().text();
+        abandon();
+        return results;
+    }
+
+    QSqlQuery insertQuery(db);
+    insertQuery.prepare("INSERT INTO users (username, password, kdf, kdf_iterations, salt, rehash_pending) "
+                        "VALUES (:username, :password, :kdf, :iterations, :salt, 1) "
+                        "ON CONFLICT (username) DO NOTHING");
+    int registered = 0;
+    for (std::size_t i = 0; i < hashes.size(); ++i) {
+        if (!hashes[i].valid()) {
+            continue;
+        }
+        RegistrationResult& result = results[static_cast<int>(i)];
+        const PasswordHash hash = hashes[i].get();
+        insertQuery.bindValue(":username", result.username);
+        insertQuery.bindValue(":password", QString::fromLatin1(hash.hash));
+        insertQuery.bindValue(":kdf", hash.kdf);
+        insertQuery.bindValue(":iterations", hash.iterations);
+        insertQuery.bindValue(":salt", QString::fromLatin1(hash.salt.toHex()));
+        if (!QueryStats::exec(insertQuery)) {
+            qCWarning(lcAuth) << "Error al registrar usuario en lote:" << result.username << insertQuery.lastError().text();
+            result.outcome = RegistrationResult::Failed;
+            db.rollback();
+            abandon();
+            return results;
+        }
+        if (insertQuery.numRowsAffected() > 0) {
+            result.outcome = RegistrationResult::Registered;
+            result.userId = insertQuery.lastInsertId().toLongLong();
+            ++registered;
+        } else {
+            result.outcome = RegistrationResult::Duplicate;
+        }
+    }
+
+    if (!db.commit()) {
+        qCWarning(lcAuth) << "Error al confirmar el registro en lote:" << db.lastError().text();
+        db.rollback();
+        abandon();
+        return results;
+    }
+
+    scope.addRows(registered);
+    qCInfo(lcAuth) << "Registro en lote:" << registered << "de" << batch.size() << "usuarios registrados";
+    return results;
+}
+
 /**
  * @brief Obtiene los datos de un usuario por su nombre de usuario.
  * @param username Nombre de usuario.
@@ -216,29 +1087,29 @@ bool DatabaseManager::registerUser(const QString& username, const QString& passw
  */
 User DatabaseManager::getUserByUsername(const QString& username)
 {
+    QueryStats::Scope scope("DatabaseManager::getUserByUsername");
     if (!db.isOpen() && !db.open()) {
-        qDebug() << "No se pudo abrir la base de datos para obtener usuario:" << db.lastError().text();
+        qCWarning(lcAuth) << "No se pudo abrir la base de datos para obtener usuario:" << db.lastError().text();
         return User();
     }
 
-    QSqlQuery query;
-    query.prepare("SELECT id, username, password FROM users WHERE LOWER(username) = LOWER(:username)");
+    QSqlQuery query(db);
+    query.prepare("SELECT id, username FROM users WHERE username = :username COLLATE NOCASE");
     query.bindValue(":username", username);
 
-    if (!query.exec()) {
-        qDebug() << "Error al buscar usuario:" << query.lastError().text();
+    if (!QueryStats::exec(query)) {
+        qCWarning(lcAuth) << "Error al buscar usuario:" << query.lastError().text();
         return User();
     }
 
     if (query.next()) {
         QString id = query.value(0).toString();
         QString username = query.value(1).toString();
-        QString password = query.value(2).toString();
-        qDebug() << "Usuario encontrado: ID =" << id << ", Username =" << username;
-        return User(id, username, password);
+        qCDebug(lcAuth) << "Usuario encontrado: ID =" << id << ", Username =" << username;
+        return User(id, username);
     }
 
-    qDebug() << "Usuario no encontrado:" << username;
+    qCDebug(lcAuth) << "Usuario no encontrado:" << username;
     return User();
 }
 
@@ -247,37 +1118,182 @@ User DatabaseManager::getUserByUsername(const QString& username)
  * @param record Registro de salud a añadir.
  * @return true si el registro se añade correctamente, false en caso contrario.
  *
- * Inserta el registro en la tabla health_records usando una transacción.
+ * Envía el registro a la cola de inserción y espera a que su lote se confirme. Las
+ * inserciones concurrentes de otros hilos comparten la misma transacción.
  */
 bool DatabaseManager::addhealthrecord(const healthrecord& record)
 {
-    if (!db.isOpen() && !db.open()) {
-        qDebug() << "No se pudo abrir la base de datos para agregar registro de salud:" << db.lastError().text();
+    QueryStats::Scope scope("DatabaseManager::addhealthrecord");
+    bool success = enqueueHealthRecord(record).get();
+    if (!success) {
+        qCWarning(lcDb) << "Error al guardar registro de salud para user_id:" << record.getUserId();
         return false;
     }
 
-    QSqlDatabase::database().transaction();
-    QSqlQuery query;
-    query.prepare("INSERT INTO health_records (user_id, date_time, weight, blood_pressure, glucose_level) "
-                  "VALUES (:user_id, :date_time, :weight, :blood_pressure, :glucose_level)");
-    query.bindValue(":user_id", record.getUserId());
-    query.bindValue(":date_time", record.getDateTime());
-    query.bindValue(":weight", record.getWeight());
-    query.bindValue(":blood_pressure", record.getBloodPressure());
-    query.bindValue(":glucose_level", record.getGlucose());
-
-    bool success = query.exec();
-    if (!success) {
-        qDebug() << "Error al guardar registro de salud:" << query.lastError().text();
-        QSqlDatabase::database().rollback();
+    qCDebug(lcDb) << "Registro de salud guardado para user_id:" << record.getUserId();
+    return true;
+}
+
+/**
+ * @brief Añade un lote de registros de salud en una sola transacción.
+ * @param records Registros de salud a añadir.
+ * @return true si todo el lote se confirma, false en caso contrario.
+ */
+bool DatabaseManager::addhealthrecords(const QVector<healthrecord>& records)
+{
+    QueryStats::Scope scope("DatabaseManager::addhealthrecords");
+    if (records.isEmpty()) {
+        return true;
+    }
+    bool success = enqueueHealthRecords(records).get();
+    qCDebug(lcDb) << "Lote de" << records.size() << "registros de salud" << (success ? "guardado" : "rechazado");
+    return success;
+}
+
+/**
+ * @brief Añade registros de salud a la bitácora de inserción.
+ * @param records Registros de salud a añadir.
+ * @return true cuando los registros son durables en la bitácora, false en caso contrario.
+ *
+ * Pensado para flujos de dispositivos de alta frecuencia: la escritura secuencial en la
+ * bitácora es mucho más barata que una transacción, y el compactador los lleva a
+ * health_records en segundo plano. Los cambios se publican en ChangeFeed al compactar.
+ */
+bool DatabaseManager::journalHealthRecords(const QVector<healthrecord>& records)
+{
+    QueryStats::Scope scope("DatabaseManager::journalHealthRecords");
+    if (!m_journal) {
+        qCWarning(lcDb) << "La bitácora de inserción no está disponible";
         return false;
     }
+    return m_journal->append(records);
+}
+
+/**
+ * @brief Encola un registro de salud sin esperar a que se confirme.
+ * @param record Registro de salud a añadir.
+ * @return Future que vale true cuando el lote que contiene el registro se confirma.
+ */
+std::future<bool> DatabaseManager::enqueueHealthRecord(const healthrecord& record)
+{
+    return enqueueHealthRecords(QVector<healthrecord>{record});
+}
+
+/**
+ * @brief Encola un lote de registros de salud sin esperar a que se confirme.
+ * @param records Registros de salud a añadir, confirmados de forma atómica.
+ * @return Future que vale true cuando el lote se confirma.
+ */
+std::future<bool> DatabaseManager::enqueueHealthRecords(const QVector<healthrecord>& records)
+{
+    if (!m_ingestQueue) {
+        qCWarning(lcDb) << "La cola de inserción no está disponible";
+        std::promise<bool> failed;
+        failed.set_value(false);
+        return failed.get_future();
+    }
+    return m_ingestQueue->enqueue(records);
+}
+
+/**
+ * @brief Inserta registros de salud con una conexión dada, dentro de la transacción del llamador.
+ * @param connection Conexión abierta en el hilo que llama, con una transacción en curso.
+ * @param records Registros a insertar.
+ * @param changes Vector donde se añaden los cambios para publicarlos tras el commit.
+ * @return true si todas las filas se insertaron, false ante el primer error.
+ *
+ * Cada registro busca primero su fila por el índice único (user_id, date_time): si no existe se
+ * inserta, y si existe se combina con ella y se actualiza solo cuando algún valor cambia. Así el
+ * cambio publicado lleva siempre el id real de la fila y su tipo no se adivina.
+ */
+bool DatabaseManager::insertHealthRecords(QSqlDatabase& connection, const QVector<healthrecord>& records,
+                                          QVector<RecordChange>& changes)
+{
+    QueryStats::Scope scope("DatabaseManager::insertHealthRecords");
+    QSqlQuery existing(connection);
+    existing.setForwardOnly(true);
+    existing.prepare("SELECT id, weight, blood_pressure, glucose_level FROM health_records "
+                     "WHERE user_id = :user_id AND date_time = :date_time");
+    QSqlQuery insert(connection);
+    insert.prepare("INSERT INTO health_records (user_id, date_time, weight, blood_pressure, glucose_level) "
+                   "VALUES (:user_id, :date_time, :weight, :blood_pressure, :glucose_level)");
+    QSqlQuery update(connection);
+    update.prepare("UPDATE health_records SET weight = :weight, blood_pressure = :blood_pressure, "
+                   "glucose_level = :glucose_level WHERE id = :id");
+
+    for (const healthrecord& record : records) {
+        const int userId = record.getUserId().toInt();
+        // NaN y presión vacía marcan un campo que la muestra no trae (importaciones de dispositivos)
+        QVariant weight = std::isnan(record.getWeight()) ? QVariant() : QVariant(record.getWeight());
+        QVariant bloodPressure = record.getBloodPressure().isEmpty() ? QVariant() : QVariant(record.getBloodPressure());
+        QVariant glucose = std::isnan(record.getGlucose()) ? QVariant() : QVariant(record.getGlucose());
 
-    QSqlDatabase::database().commit();
-    qDebug() << "Registro de salud guardado para user_id:" << record.getUserId();
+        existing.bindValue(":user_id", userId);
+        existing.bindValue(":date_time", record.getDateTime());
+        if (!QueryStats::exec(existing)) {
+            qCWarning(lcDb) << "Error al buscar registro de salud:" << existing.lastError().text();
+            return false;
+        }
+
+        RecordChange change;
+        change.userId = userId;
+        if (!existing.next()) {
+            existing.finish();
+            insert.bindValue(":user_id", userId);
+            insert.bindValue(":date_time", record.getDateTime());
+            insert.bindValue(":weight", weight);
+            insert.bindValue(":blood_pressure", bloodPressure);
+            insert.bindValue(":glucose_level", glucose);
+            if (!QueryStats::exec(insert)) {
+                qCWarning(lcDb) << "Error al guardar registro de salud:" << insert.lastError().text();
+                return false;
+            }
+            change.type = RecordChange::Inserted;
+            change.recordId = insert.lastInsertId().toLongLong();
+        } else {
+            // Los campos presentes reemplazan a los de la fila; los ausentes la dejan como está
+            const qint64 id = existing.value(0).toLongLong();
+            const QVariant oldWeight = existing.value(1);
+            const QVariant oldBloodPressure = existing.value(2);
+            const QVariant oldGlucose = existing.value(3);
+            existing.finish();
+            if (weight.isNull()) {
+                weight = oldWeight;
+            }
+            if (bloodPressure.isNull()) {
+                bloodPressure = oldBloodPressure;
+            }
+            if (glucose.isNull()) {
+                glucose = oldGlucose;
+            }
+            if (sameReal(weight, oldWeight) && sameText(bloodPressure, oldBloodPressure) && sameReal(glucose, oldGlucose)) {
+                continue; // La fila ya tenía estos valores
+            }
+            update.bindValue(":weight", weight);
+            update.bindValue(":blood_pressure", bloodPressure);
+            update.bindValue(":glucose_level", glucose);
+            update.bindValue(":id", id);
+            if (!QueryStats::exec(update)) {
+                qCWarning(lcDb) << "Error al combinar registro de salud:" << update.lastError().text();
+                return false;
+            }
+            change.type = RecordChange::Updated;
+            change.recordId = id;
+        }
+        changes.append(change);
+    }
     return true;
 }
 
+/**
+ * @brief Número de peticiones pendientes en la cola de inserción.
+ * @return Profundidad aproximada de la cola.
+ */
+std::size_t DatabaseManager::pendingInserts() const
+{
+    return m_ingestQueue ? m_ingestQueue->depth() : 0;
+}
+
 /**
  * @brief Calcula el promedio de un campo específico para un usuario.
  * @param field Campo de la base de datos (por ejemplo, "weight", "glucose_level").
@@ -288,8 +1304,9 @@ bool DatabaseManager::addhealthrecord(const healthrecord& record)
  */
 double DatabaseManager::calculateAverage(const QString& field, int userId)
 {
+    QueryStats::Scope scope("DatabaseManager::calculateAverage");
     if (!db.isOpen() && !db.open()) {
-        qDebug() << "No se pudo abrir la base de datos para calcular promedio:" << db.lastError().text();
+        qCWarning(lcDb) << "No se pudo abrir la base de datos para calcular promedio:" << db.lastError().text();
         return 0.0;
     }
 
@@ -297,11 +1314,11 @@ double DatabaseManager::calculateAverage(const QString& field, int userId)
     if (field == "weight") {
         queryField = "weight";
     } else if (field == "blood_pressure") {
-        queryField = "CAST(SUBSTR(blood_pressure, 1, INSTR(blood_pressure, '/') - 1) AS REAL)";
+        queryField = systolicExpression();
     } else if (field == "glucose_level") {
         queryField = "glucose_level";
     } else {
-        qDebug() << "Campo no válido para calcular promedio:" << field;
+        qCWarning(lcDb) << "Campo no válido para calcular promedio:" << field;
         return 0.0;
     }
 
@@ -310,20 +1327,20 @@ double DatabaseManager::calculateAverage(const QString& field, int userId)
     query.prepare(queryStr);
     query.bindValue(":user_id", userId);
 
-    qDebug() << "Ejecutando consulta para promedio:" << queryStr << "con user_id:" << userId;
+    qCDebug(lcDb) << "Ejecutando consulta para promedio:" << queryStr << "con user_id:" << userId;
 
-    if (!query.exec()) {
-        qDebug() << "Error al calcular promedio:" << query.lastError().text();
+    if (!QueryStats::exec(query)) {
+        qCWarning(lcDb) << "Error al calcular promedio:" << query.lastError().text();
         return 0.0;
     }
 
     if (query.next()) {
         double result = query.value(0).toDouble();
-        qDebug() << "Promedio calculado para" << queryField << ":" << result;
+        qCDebug(lcDb) << "Promedio calculado para" << queryField << ":" << result;
         return result;
     }
 
-    qDebug() << "No se encontraron datos para calcular el promedio";
+    qCDebug(lcDb) << "No se encontraron datos para calcular el promedio";
     return 0.0;
 }
 
@@ -334,10 +1351,11 @@ double DatabaseManager::calculateAverage(const QString& field, int userId)
  */
 QVector<healthrecord> DatabaseManager::getHealthRecordsByUserId(int userId)
 {
+    QueryStats::Scope scope("DatabaseManager::getHealthRecordsByUserId");
     QVector<healthrecord> records;
 
     if (!db.isOpen() && !db.open()) {
-        qDebug() << "No se pudo abrir la base de datos para obtener los registros de salud:" << db.lastError().text();
+        qCWarning(lcDb) << "No se pudo abrir la base de datos para obtener los registros de salud:" << db.lastError().text();
         return records;
     }
 
@@ -346,8 +1364,8 @@ QVector<healthrecord> DatabaseManager::getHealthRecordsByUserId(int userId)
                   "FROM health_records WHERE user_id = :user_id");
     query.bindValue(":user_id", userId);
 
-    if (!query.exec()) {
-        qDebug() << "Error al obtener los registros de salud:" << query.lastError().text();
+    if (!QueryStats::exec(query)) {
+        qCWarning(lcDb) << "Error al obtener los registros de salud:" << query.lastError().text();
         return records;
     }
 
@@ -363,10 +1381,110 @@ QVector<healthrecord> DatabaseManager::getHealthRecordsByUserId(int userId)
         records.append(record);
     }
 
-    qDebug() << "Registros obtenidos para user_id:" << userId << ", Total:" << records.size();
+    scope.addRows(records.size());
+    qCDebug(lcDb) << "Registros obtenidos para user_id:" << userId << ", Total:" << records.size();
     return records;
 }
 
+/**
+ * @brief Consulta los registros de salud de un usuario aplicando filtros y ordenamiento.
+ * @param userId Identificador del usuario.
+ * @param filter Criterios de filtrado y ordenamiento.
+ * @return Consulta ejecutada, lista para asignarse a un modelo; inactiva si ocurre un error.
+ *
+ * Los criterios se traducen a predicados sobre los índices (user_id, columna), por lo que SQLite
+ * recorre solo el rango pedido y entrega las filas ya ordenadas sin cargar el historial completo.
+ */
+QSqlQuery DatabaseManager::queryHealthRecords(int userId, const RecordFilter& filter)
+{
+    QueryStats::Scope scope("DatabaseManager::queryHealthRecords");
+    QSqlQuery query(db);
+
+    if (!db.isOpen() && !db.open()) {
+        qCWarning(lcDb) << "No se pudo abrir la base de datos para consultar registros:" << db.lastError().text();
+        return query;
+    }
+
+    QString valueColumn;
+    if (filter.valueField == "weight") {
+        valueColumn = "hr.weight";
+    } else if (filter.valueField == "glucose_level") {
+        valueColumn = "hr.glucose_level";
+    } else if (filter.valueField == "blood_pressure") {
+        valueColumn = systolicExpression();
+    }
+
+    QString sortColumn;
+    switch (filter.sortKey) {
+    case RecordFilter::SortByDateTime:
+        sortColumn = "hr.date_time";
+        break;
+    case RecordFilter::SortByWeight:
+        sortColumn = "hr.weight";
+        break;
+    case RecordFilter::SortByBloodPressure:
+        sortColumn = systolicExpression();
+        break;
+    case RecordFilter::SortByGlucose:
+        sortColumn = "hr.glucose_level";
+        break;
+    case RecordFilter::SortById:
+    default:
+        sortColumn = "hr.id";
+        break;
+    }
+    const QString direction = filter.sortOrder == Qt::AscendingOrder ? "ASC" : "DESC";
+
+    QString queryStr =
+        "SELECT hr.id, hr.user_id, u.username, hr.date_time, hr.weight, hr.blood_pressure, hr.glucose_level "
+        "FROM health_records hr "
+        "JOIN users u ON hr.user_id = u.id "
+        "WHERE hr.user_id = :user_id";
+    if (filter.from.isValid()) {
+        queryStr += " AND hr.date_time >= :from";
+    }
+    if (filter.to.isValid()) {
+        queryStr += " AND hr.date_time <= :to";
+    }
+    if (!valueColumn.isEmpty() && filter.hasMinValue) {
+        queryStr += QString(" AND %1 >= :min_value").arg(valueColumn);
+    }
+    if (!valueColumn.isEmpty() && filter.hasMaxValue) {
+        queryStr += QString(" AND %1 <= :max_value").arg(valueColumn);
+    }
+    // hr.id como desempate mantiene un orden estable entre páginas del modelo
+    queryStr += QString(" ORDER BY %1 %2, hr.id %2").arg(sortColumn, direction);
+
+    query.prepare(queryStr);
+    query.bindValue(":user_id", userId);
+    if (filter.from.isValid()) {
+        query.bindValue(":from", filter.from);
+    }
+    if (filter.to.isValid()) {
+        query.bindValue(":to", filter.to);
+    }
+    if (!valueColumn.isEmpty() && filter.hasMinValue) {
+        query.bindValue(":min_value", filter.minValue);
+    }
+    if (!valueColumn.isEmpty() && filter.hasMaxValue) {
+        query.bindValue(":max_value", filter.maxValue);
+    }
+
+    if (!QueryStats::exec(query)) {
+        qCWarning(lcDb) << "Error al consultar registros filtrados:" << query.lastError().text();
+    }
+    return query;
+}
+
+/**
+ * @brief Obtiene el almacén de series temporales sobre la conexión principal.
+ * @return Almacén de series de alta frecuencia (ts_chunks), para usar desde el hilo principal.
+ */
+TimeSeriesStore DatabaseManager::timeSeries()
+{
+    return TimeSeriesStore(db);
+}
+
 /**
  * @brief Obtiene la conexión a la base de datos.
  * @return Objeto QSqlDatabase que representa la conexión activa.
@@ -375,3 +1493,38 @@ QSqlDatabase DatabaseManager::getDatabase()
 {
     return db;
 }
+
+/**
+ * @brief Reconstruye el archivo de la base de datos y actualiza las estadísticas del planificador.
+ * @return true si VACUUM y ANALYZE se completaron, false en caso contrario.
+ *
+ * VACUUM reescribe todas las páginas en el WAL, así que al final se hace un checkpoint que lo
+ * vuelca al archivo principal y lo trunca; de lo contrario el espacio recuperado no se vería hasta
+ * el siguiente checkpoint automático.
+ */
+bool DatabaseManager::vacuum()
+{
+    QueryStats::Scope scope("DatabaseManager::vacuum");
+    if (!db.isOpen() && !db.open()) {
+        qCWarning(lcDb) << "No se pudo abrir la base de datos para compactarla:" << db.lastError().text();
+        return false;
+    }
+
+    const qint64 before = QFileInfo(databasePath()).size();
+    QSqlQuery query(db);
+    if (!QueryStats::exec(query, "VACUUM")) {
+        qCWarning(lcDb) << "Error al compactar la base de datos:" << query.lastError().text();
+        return false;
+    }
+    if (!QueryStats::exec(query, "ANALYZE")) {
+        qCWarning(lcDb) << "Error al actualizar las estadísticas de la base de datos:" << query.lastError().text();
+        return false;
+    }
+    if (!QueryStats::exec(query, "PRAGMA wal_checkpoint(TRUNCATE)")) {
+        qCWarning(lcDb) << "Error al volcar el WAL de la base de datos:" << query.lastError().text();
+    }
+    query.finish();
+
+    qCInfo(lcDb) << "Base de datos compactada:" << before << "->" << QFileInfo(databasePath()).size() << "bytes";
+    return true;
+}
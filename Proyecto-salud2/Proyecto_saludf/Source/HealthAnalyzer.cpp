@@ -6,8 +6,9 @@
  */
 
 #include "HealthAnalyzer.h"
+#include "Logging.h"
+#include "Trace.h"
 #include "DatabaseManager.h"
-#include <QDebug>
 
 /**
  * @brief Constructor de la clase HealthAnalyzer.
@@ -16,8 +17,9 @@
  * Carga los registros de salud del usuario desde la base de datos.
  */
 HealthAnalyzer::HealthAnalyzer(int userId) {
+    TRACE_SPAN("analyzer", "HealthAnalyzer::HealthAnalyzer");
     m_records = DatabaseManager::instance().getHealthRecordsByUserId(userId);
-    qDebug() << "HealthAnalyzer inicializado para user_id:" << userId << ", Registros cargados:" << m_records.size();
+    qCDebug(lcAnalyzer) << "HealthAnalyzer inicializado para user_id:" << userId << ", Registros cargados:" << m_records.size();
 }
 
 /**
@@ -27,8 +29,9 @@ HealthAnalyzer::HealthAnalyzer(int userId) {
  * Ignora valores de peso no válidos (0 o negativos) y registra información de depuración.
  */
 float HealthAnalyzer::averageWeight() const {
+    TRACE_SPAN("analyzer", "HealthAnalyzer::averageWeight");
     if (m_records.isEmpty()) {
-        qDebug() << "No hay registros para calcular el promedio de peso";
+        qCDebug(lcAnalyzer) << "No hay registros para calcular el promedio de peso";
         return 0;
     }
     float total = 0;
@@ -38,15 +41,15 @@ float HealthAnalyzer::averageWeight() const {
         if (value > 0) { // Ignorar valores 0 o negativos
             total += value;
             count++;
-            qDebug() << "Peso incluido en promedio:" << value;
+            SALUD_HOT_DEBUG(lcAnalyzer) << "Peso incluido en promedio:" << value;
         }
     }
     if (count == 0) {
-        qDebug() << "No hay valores válidos de peso para promediar";
+        qCDebug(lcAnalyzer) << "No hay valores válidos de peso para promediar";
         return 0;
     }
     float average = total / count;
-    qDebug() << "Promedio de peso calculado:" << average << "(Total:" << total << ", Conteo:" << count << ")";
+    qCDebug(lcAnalyzer) << "Promedio de peso calculado:" << average << "(Total:" << total << ", Conteo:" << count << ")";
     return average;
 }
 
@@ -57,8 +60,9 @@ float HealthAnalyzer::averageWeight() const {
  * Ignora valores de glucosa no válidos (0 o negativos) y registra información de depuración.
  */
 float HealthAnalyzer::averageGlucose() const {
+    TRACE_SPAN("analyzer", "HealthAnalyzer::averageGlucose");
     if (m_records.isEmpty()) {
-        qDebug() << "No hay registros para calcular el promedio de glucosa";
+        qCDebug(lcAnalyzer) << "No hay registros para calcular el promedio de glucosa";
         return 0;
     }
     float total = 0;
@@ -68,15 +72,15 @@ float HealthAnalyzer::averageGlucose() const {
         if (value > 0) { // Ignorar valores 0 o negativos
             total += value;
             count++;
-            qDebug() << "Glucosa incluida en promedio:" << value;
+            SALUD_HOT_DEBUG(lcAnalyzer) << "Glucosa incluida en promedio:" << value;
         }
     }
     if (count == 0) {
-        qDebug() << "No hay valores válidos de glucosa para promediar";
+        qCDebug(lcAnalyzer) << "No hay valores válidos de glucosa para promediar";
         return 0;
     }
     float average = total / count;
-    qDebug() << "Promedio de glucosa calculado:" << average << "(Total:" << total << ", Conteo:" << count << ")";
+    qCDebug(lcAnalyzer) << "Promedio de glucosa calculado:" << average << "(Total:" << total << ", Conteo:" << count << ")";
     return average;
 }
 
@@ -87,8 +91,9 @@ float HealthAnalyzer::averageGlucose() const {
  * Extrae la presión sistólica del formato "sistólica/diastólica" y registra información de depuración.
  */
 float HealthAnalyzer::averageBloodPressure() const {
+    TRACE_SPAN("analyzer", "HealthAnalyzer::averageBloodPressure");
     if (m_records.isEmpty()) {
-        qDebug() << "No hay registros para calcular el promedio de presión arterial";
+        qCDebug(lcAnalyzer) << "No hay registros para calcular el promedio de presión arterial";
         return 0;
     }
     float total = 0;
@@ -102,16 +107,16 @@ float HealthAnalyzer::averageBloodPressure() const {
             if (ok && value > 0) { // Ignorar valores inválidos o negativos
                 total += value;
                 count++;
-                qDebug() << "Presión arterial (sistólica) incluida en promedio:" << value;
+                SALUD_HOT_DEBUG(lcAnalyzer) << "Presión arterial (sistólica) incluida en promedio:" << value;
             }
         }
     }
     if (count == 0) {
-        qDebug() << "No hay valores válidos de presión arterial para promediar";
+        qCDebug(lcAnalyzer) << "No hay valores válidos de presión arterial para promediar";
         return 0;
     }
     float average = total / count;
-    qDebug() << "Promedio de presión arterial (sistólica) calculado:" << average << "(Total:" << total << ", Conteo:" << count << ")";
+    qCDebug(lcAnalyzer) << "Promedio de presión arterial (sistólica) calculado:" << average << "(Total:" << total << ", Conteo:" << count << ")";
     return average;
 }
 
@@ -0,0 +1,117 @@
+/**
+ * @file HealthRecordsModel.cpp
+ * @brief Implementación de la clase HealthRecordsModel, modelo paginado de la tabla de historial.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "HealthRecordsModel.h"
+#include "Logging.h"
+#include "DatabaseManager.h"
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QElapsedTimer>
+
+/**
+ * @brief Constructor de la clase HealthRecordsModel.
+ * @param userId Identificador del usuario cuyos registros se muestran.
+ * @param parent Objeto padre, por defecto nullptr.
+ */
+HealthRecordsModel::HealthRecordsModel(int userId, QObject *parent)
+    : QSqlQueryModel(parent), m_userId(userId)
+{
+}
+
+/**
+ * @brief Ordena el modelo por una columna de la vista.
+ * @param column Índice de la columna.
+ * @param order Sentido del ordenamiento.
+ *
+ * Las columnas de usuario no aportan orden dentro del historial de un único usuario,
+ * así que se ordenan por ID.
+ */
+void HealthRecordsModel::sort(int column, Qt::SortOrder order)
+{
+    switch (column) {
+    case 3:
+        m_filter.sortKey = RecordFilter::SortByDateTime;
+        break;
+    case 4:
+        m_filter.sortKey = RecordFilter::SortByWeight;
+        break;
+    case 5:
+        m_filter.sortKey = RecordFilter::SortByBloodPressure;
+        break;
+    case 6:
+        m_filter.sortKey = RecordFilter::SortByGlucose;
+        break;
+    default:
+        m_filter.sortKey = RecordFilter::SortById;
+        break;
+    }
+    m_filter.sortOrder = order;
+    refresh();
+}
+
+/**
+ * @brief Aplica nuevos criterios de filtrado conservando el ordenamiento actual.
+ * @param filter Criterios de filtrado.
+ */
+void HealthRecordsModel::setFilter(const RecordFilter& filter)
+{
+    const RecordFilter::SortKey sortKey = m_filter.sortKey;
+    const Qt::SortOrder sortOrder = m_filter.sortOrder;
+    m_filter = filter;
+    m_filter.sortKey = sortKey;
+    m_filter.sortOrder = sortOrder;
+    refresh();
+}
+
+/**
+ * @brief Obtiene los criterios de filtrado y ordenamiento vigentes.
+ * @return Criterios actuales.
+ */
+RecordFilter HealthRecordsModel::filter() const
+{
+    return m_filter;
+}
+
+/**
+ * @brief Vuelve a ejecutar la consulta con los criterios vigentes.
+ * @return true si la consulta se ejecutó sin errores, false en caso contrario.
+ */
+bool HealthRecordsModel::refresh()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QSqlQuery query = DatabaseManager::instance().queryHealthRecords(m_userId, m_filter);
+    if (!query.isActive()) {
+        qCWarning(lcDb) << "Error al actualizar el modelo de registros:" << query.lastError().text();
+        return false;
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 2, 0)
+    setQuery(std::move(query));
+#else
+    setQuery(query);
+#endif
+    applyHeaders();
+
+    qCDebug(lcDb) << "Modelo de registros actualizado en" << timer.elapsed() << "ms. Filas cargadas:" << rowCount();
+    return !lastError().isValid();
+}
+
+/**
+ * @brief Asigna los encabezados de las columnas.
+ */
+void HealthRecordsModel::applyHeaders()
+{
+    setHeaderData(0, Qt::Horizontal, "ID");
+    setHeaderData(1, Qt::Horizontal, "User ID");
+    setHeaderData(2, Qt::Horizontal, "Username");
+    setHeaderData(3, Qt::Horizontal, "Fecha/Hora");
+    setHeaderData(4, Qt::Horizontal, "Peso (kg)");
+    setHeaderData(5, Qt::Horizontal, "Presión Arterial");
+    setHeaderData(6, Qt::Horizontal, "Nivel Glucosa");
+}
@@ -0,0 +1,252 @@
+/**
+ * @file IncrementalExporter.cpp
+ * @brief Implementación de la clase IncrementalExporter, exportación CSV incremental con marcas de agua persistentes.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "IncrementalExporter.h"
+#include "Logging.h"
+#include "CSVExporter.h"
+#include "DatabaseManager.h"
+#include <QFile>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QVariant>
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+/**
+ * @brief Filas entre puntos de control de la marca de agua.
+ */
+const qint64 kCheckpointRows = 50000;
+
+/**
+ * @brief Vacía los buffers de un archivo y lo sincroniza con el disco.
+ * @param file Archivo abierto.
+ * @return true si la sincronización tuvo éxito.
+ */
+bool syncToDisk(QFile& file)
+{
+    if (!file.flush()) {
+        return false;
+    }
+#if defined(Q_OS_WIN)
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+}
+
+/**
+ * @brief Crea la tabla export_watermarks si no existe.
+ * @param connection Conexión abierta.
+ * @return true si el esquema está disponible, false en caso contrario.
+ */
+bool IncrementalExporter::createSchema(QSqlDatabase& connection)
+{
+    // last_id guarda el change_seq de la última fila; conserva el nombre de cuando era el id
+    QSqlQuery query(connection);
+    bool success = query.exec("CREATE TABLE IF NOT EXISTS export_watermarks ("
+                              "destination TEXT NOT NULL, "
+                              "user_id INTEGER NOT NULL, "
+                              "last_id INTEGER NOT NULL, "
+                              "last_date_time TEXT, "
+                              "file_offset INTEGER NOT NULL, "
+                              "updated_at TEXT NOT NULL, "
+                              "PRIMARY KEY (destination, user_id)) WITHOUT ROWID");
+    if (!success) {
+        qCWarning(lcExport) << "Error al crear la tabla de marcas de exportación:" << query.lastError().text();
+    }
+    return success;
+}
+
+/**
+ * @brief Lee la marca de agua de un destino.
+ * @param destination Nombre del destino.
+ * @param userId Identificador del usuario, o 0 para un destino de todos los usuarios.
+ * @return Marca de agua; valid es false si el destino aún no exportó nada.
+ */
+ExportWatermark IncrementalExporter::watermark(const QString& destination, int userId)
+{
+    ExportWatermark mark;
+    QSqlQuery query(DatabaseManager::instance().getDatabase());
+    query.prepare("SELECT last_id, last_date_time, file_offset FROM export_watermarks "
+                  "WHERE destination = :destination AND user_id = :user_id");
+    query.bindValue(":destination", destination);
+    query.bindValue(":user_id", userId);
+    if (!query.exec()) {
+        qCWarning(lcExport) << "Error al leer la marca de exportación:" << query.lastError().text();
+        return mark;
+    }
+    if (query.next()) {
+        mark.valid = true;
+        mark.lastSequence = query.value(0).toLongLong();
+        mark.lastDateTime = query.value(1).toString();
+        mark.fileOffset = query.value(2).toLongLong();
+    }
+    return mark;
+}
+
+/**
+ * @brief Borra la marca de agua de un destino; la siguiente exportación será completa.
+ * @param destination Nombre del destino.
+ * @param userId Identificador del usuario, o 0 para un destino de todos los usuarios.
+ * @return true si la marca se borró, false en caso contrario.
+ */
+bool IncrementalExporter::resetWatermark(const QString& destination, int userId)
+{
+    QSqlQuery query(DatabaseManager::instance().getDatabase());
+    query.prepare("DELETE FROM export_watermarks WHERE destination = :destination AND user_id = :user_id");
+    query.bindValue(":destination", destination);
+    query.bindValue(":user_id", userId);
+    if (!query.exec()) {
+        qCWarning(lcExport) << "Error al borrar la marca de exportación:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Guarda la marca de agua de un destino.
+ * @param destination Nombre del destino.
+ * @param userId Identificador del usuario, o 0 para un destino de todos los usuarios.
+ * @param mark Marca de agua a guardar.
+ * @return true si se guardó, false en caso contrario.
+ */
+bool IncrementalExporter::saveWatermark(const QString& destination, int userId, const ExportWatermark& mark)
+{
+    QSqlQuery query(DatabaseManager::instance().getDatabase());
+    query.prepare("INSERT OR REPLACE INTO export_watermarks "
+                  "(destination, user_id, last_id, last_date_time, file_offset, updated_at) "
+                  "VALUES (:destination, :user_id, :last_id, :last_date_time, :file_offset, datetime('now'))");
+    query.bindValue(":destination", destination);
+    query.bindValue(":user_id", userId);
+    query.bindValue(":last_id", mark.lastSequence);
+    query.bindValue(":last_date_time", mark.lastDateTime);
+    query.bindValue(":file_offset", mark.fileOffset);
+    if (!query.exec()) {
+        qCWarning(lcExport) << "Error al guardar la marca de exportación:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Añade al archivo del destino las filas nuevas desde la última exportación.
+ * @param destination Nombre del destino.
+ * @param filePath Ruta del archivo CSV del destino.
+ * @param userId Identificador del usuario, o 0 para exportar todos los usuarios.
+ * @param options Opciones de formato CSV.
+ * @param exportedRows Si no es nulo, recibe el número de filas añadidas.
+ * @return true si la exportación es exitosa, false en caso contrario.
+ *
+ * La consulta empieza en la marca de agua recorriendo el índice de change_seq, así que el costo es
+ * proporcional a las filas nuevas y no al historial completo. Cada kCheckpointRows filas el
+ * archivo se sincroniza con el disco antes de avanzar la marca, de modo que la marca nunca
+ * apunta más allá de lo que el archivo contiene.
+ */
+bool IncrementalExporter::exportNewRecords(const QString& destination, const QString& filePath, int userId,
+                                           const CSVOptions& options, qint64* exportedRows)
+{
+    ExportWatermark mark = watermark(destination, userId);
+
+    QFile file(filePath);
+    bool freshFile = true;
+    if (mark.valid && file.exists()) {
+        if (file.size() < mark.fileOffset) {
+            qCWarning(lcExport) << "El archivo" << filePath << "es más corto que la marca de exportación de" << destination
+                     << "; se necesita resetWatermark() para volver a exportarlo";
+            return false;
+        }
+        // Recortar lo escrito después del último punto de control de una ejecución interrumpida
+        if (!file.open(QIODevice::ReadWrite) || !file.resize(mark.fileOffset) || !file.seek(mark.fileOffset)) {
+            qCWarning(lcExport) << "Error al reanudar el archivo:" << file.errorString();
+            return false;
+        }
+        freshFile = mark.fileOffset == 0;
+    } else {
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCWarning(lcExport) << "Error al abrir el archivo:" << file.errorString();
+            return false;
+        }
+    }
+
+    CSVWriter writer(&file, options);
+    if (freshFile) {
+        // Archivo nuevo: la marca pasa a apuntar al final de la cabecera antes de exportar filas, así
+        // una ejecución sin filas nuevas o interrumpida antes del primer punto de control no deja
+        // guardado el tamaño del archivo anterior. lastSequence se conserva: el destino ya recibió esas
+        // filas en el archivo que recogió, y para volver a exportarlas está resetWatermark().
+        CSVExporter::writeHeader(writer, options);
+        if (!writer.flush() || !syncToDisk(file)) {
+            qCWarning(lcExport) << "Error al escribir la cabecera de" << filePath << ":" << file.errorString();
+            return false;
+        }
+        mark.valid = true;
+        mark.fileOffset = file.pos();
+        if (!saveWatermark(destination, userId, mark)) {
+            return false;
+        }
+    }
+
+    QSqlQuery query(DatabaseManager::instance().getDatabase());
+    query.setForwardOnly(true);
+    if (userId > 0) {
+        query.prepare(CSVExporter::selectColumnsSql("change_seq")
+                      + " WHERE change_seq > :last_seq AND user_id = :user_id ORDER BY change_seq");
+        query.bindValue(":user_id", userId);
+    } else {
+        query.prepare(CSVExporter::selectColumnsSql("change_seq") + " WHERE change_seq > :last_seq ORDER BY change_seq");
+    }
+    query.bindValue(":last_seq", mark.lastSequence);
+    if (!query.exec()) {
+        qCWarning(lcExport) << "Error al consultar las filas nuevas:" << query.lastError().text();
+        return false;
+    }
+
+    QSqlQuery lastDateTime(DatabaseManager::instance().getDatabase());
+    lastDateTime.prepare("SELECT date_time FROM health_records WHERE change_seq = :change_seq");
+
+    qint64 total = 0;
+    bool success = true;
+    while (success) {
+        // change_seq es la columna 6, después de las seis exportadas
+        qint64 lastSequence = mark.lastSequence;
+        const qint64 rows = CSVExporter::writeRows(query, writer, kCheckpointRows, &lastSequence, 6);
+        if (rows == 0) {
+            break;
+        }
+        total += rows;
+
+        success = writer.flush() && syncToDisk(file);
+        if (success) {
+            lastDateTime.bindValue(":change_seq", lastSequence);
+            if (lastDateTime.exec() && lastDateTime.next()) {
+                mark.lastDateTime = lastDateTime.value(0).toString();
+            }
+            lastDateTime.finish();
+            mark.valid = true;
+            mark.lastSequence = lastSequence;
+            mark.fileOffset = file.pos();
+            success = saveWatermark(destination, userId, mark);
+        }
+        if (rows < kCheckpointRows) {
+            break;
+        }
+    }
+    success = writer.flush() && success;
+    file.close();
+
+    qCInfo(lcExport) << "Exportación incremental a" << destination << ":" << total << "filas nuevas, marca en change_seq" << mark.lastSequence;
+    if (exportedRows) {
+        *exportedRows = total;
+    }
+    return success;
+}
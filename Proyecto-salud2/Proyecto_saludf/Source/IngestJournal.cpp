@@ -0,0 +1,497 @@
+/**
+ * @file IngestJournal.cpp
+ * @brief Implementación de la clase IngestJournal, bitácora binaria de inserciones con compactación hacia SQLite.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "IngestJournal.h"
+#include "Logging.h"
+#include "Checksum.h"
+#include "DatabaseManager.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QtEndian>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+/**
+ * @brief Marca de inicio de cada trama ("HRJ1" en little-endian).
+ */
+const quint32 kFrameMagic = 0x314A5248;
+
+/**
+ * @brief Tamaño de la cabecera de una trama (magic, length, crc32).
+ */
+const int kFrameHeaderSize = 12;
+
+/**
+ * @brief Nombre de la conexión propia del compactador.
+ */
+const char* const kCompactorConnection = "journal_compactor";
+
+/**
+ * @brief Añade un valor little-endian al final de un buffer.
+ * @param buffer Buffer de destino.
+ * @param value Valor a escribir.
+ */
+template <typename T>
+void appendLittleEndian(QByteArray& buffer, T value)
+{
+    char bytes[sizeof(T)];
+    qToLittleEndian<T>(value, bytes);
+    buffer.append(bytes, sizeof(T));
+}
+
+/**
+ * @brief Añade un float como su patrón de bits little-endian.
+ * @param buffer Buffer de destino.
+ * @param value Valor a escribir.
+ */
+void appendFloat(QByteArray& buffer, float value)
+{
+    quint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    appendLittleEndian<quint32>(buffer, bits);
+}
+
+/**
+ * @brief Lee un float almacenado como patrón de bits little-endian.
+ * @param data Puntero a los 4 bytes.
+ * @return Valor leído.
+ */
+float readFloat(const uchar* data)
+{
+    const quint32 bits = qFromLittleEndian<quint32>(data);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Sincroniza con el disco los datos escritos en un archivo.
+ * @param file Archivo abierto.
+ * @return true si la sincronización tuvo éxito.
+ */
+bool syncToDisk(QFile& file)
+{
+    if (!file.flush()) {
+        return false;
+    }
+#if defined(Q_OS_WIN)
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+}
+
+/**
+ * @brief Constructor de la bitácora.
+ * @param directory Directorio donde se guardan los segmentos.
+ * @param options Parámetros de la bitácora y del compactador.
+ */
+IngestJournal::IngestJournal(const QString& directory, const Options& options)
+    : m_directory(directory),
+      m_options(options),
+      m_activeSegment(0),
+      m_stopping(false)
+{
+    QDir().mkpath(m_directory);
+}
+
+/**
+ * @brief Destructor. Detiene el compactador y cierra el segmento activo.
+ */
+IngestJournal::~IngestJournal()
+{
+    stopCompactor();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_activeFile.isOpen()) {
+        m_activeFile.close();
+    }
+}
+
+/**
+ * @brief Abre un segmento activo nuevo.
+ * @param firstSegment Número del primer segmento.
+ * @return true si el segmento se creó, false en caso contrario.
+ */
+bool IngestJournal::open(qint64 firstSegment)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_activeSegment = firstSegment - 1;
+    return rotateLocked();
+}
+
+/**
+ * @brief Ruta del archivo de un segmento.
+ * @param segment Número del segmento.
+ * @return Ruta absoluta del archivo.
+ */
+QString IngestJournal::segmentPath(qint64 segment) const
+{
+    return QDir(m_directory).filePath(QString("segment-%1.log").arg(segment, 12, 10, QChar('0')));
+}
+
+/**
+ * @brief Cierra el segmento activo y abre el siguiente. Requiere m_mutex tomado.
+ * @return true si el nuevo segmento se abrió.
+ */
+bool IngestJournal::rotateLocked()
+{
+    if (m_activeFile.isOpen()) {
+        syncToDisk(m_activeFile);
+        m_activeFile.close();
+    }
+    ++m_activeSegment;
+    m_activeFile.setFileName(segmentPath(m_activeSegment));
+    if (!m_activeFile.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qCWarning(lcDb) << "Error al abrir el segmento de la bitácora:" << m_activeFile.errorString();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Añade registros a la bitácora y los sincroniza con el disco.
+ * @param records Registros a añadir.
+ * @return true cuando los registros son durables, false si la escritura falló.
+ *
+ * Todas las tramas se serializan en un único buffer y se escriben con una sola llamada,
+ * seguida de un fsync si syncOnAppend está activo.
+ */
+bool IngestJournal::append(const QVector<healthrecord>& records)
+{
+    if (records.isEmpty()) {
+        return true;
+    }
+
+    QByteArray buffer;
+    buffer.reserve(records.size() * 48);
+    QByteArray payload;
+    for (const healthrecord& record : records) {
+        const QByteArray bloodPressure = record.getBloodPressure().toUtf8().left(0xFFFF);
+
+        payload.clear();
+        appendLittleEndian<qint32>(payload, record.getUserId().toInt());
+        appendLittleEndian<qint64>(payload, record.getDateTime().toMSecsSinceEpoch());
+        appendFloat(payload, record.getWeight());
+        appendFloat(payload, record.getGlucose());
+        appendLittleEndian<quint16>(payload, static_cast<quint16>(bloodPressure.size()));
+        payload.append(bloodPressure);
+
+        appendLittleEndian<quint32>(buffer, kFrameMagic);
+        appendLittleEndian<quint32>(buffer, static_cast<quint32>(payload.size()));
+        appendLittleEndian<quint32>(buffer, Checksum::crc32(payload.constData(), payload.size()));
+        buffer.append(payload);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_activeFile.isOpen()) {
+        qCWarning(lcDb) << "La bitácora de inserción no tiene un segmento activo";
+        return false;
+    }
+    // Una escritura fallida se recorta para que sus tramas no queden delante de las siguientes
+    const qint64 start = m_activeFile.size();
+    bool written = m_activeFile.write(buffer) == buffer.size();
+    if (!written) {
+        qCWarning(lcDb) << "Error al escribir en la bitácora:" << m_activeFile.errorString();
+    } else if (m_options.syncOnAppend ? !syncToDisk(m_activeFile) : !m_activeFile.flush()) {
+        qCWarning(lcDb) << "Error al sincronizar la bitácora:" << m_activeFile.errorString();
+        written = false;
+    }
+    if (!written) {
+        if (!m_activeFile.resize(start)) {
+            qCCritical(lcDb) << "No se pudo recortar la escritura fallida del segmento" << m_activeFile.fileName();
+        }
+        return false;
+    }
+    if (m_activeFile.size() >= m_options.segmentBytes) {
+        rotateLocked();
+    }
+    return true;
+}
+
+/**
+ * @brief Lista los segmentos de un directorio en orden ascendente.
+ * @param directory Directorio de los segmentos.
+ * @return Pares (número, ruta) ordenados por número.
+ */
+QVector<QPair<qint64, QString>> IngestJournal::listSegments(const QString& directory)
+{
+    QVector<QPair<qint64, QString>> segments;
+    const QFileInfoList files = QDir(directory).entryInfoList(QStringList() << "segment-*.log", QDir::Files);
+    for (const QFileInfo& info : files) {
+        bool ok = false;
+        const qint64 number = info.completeBaseName().mid(8).toLongLong(&ok);
+        if (ok) {
+            segments.append(qMakePair(number, info.absoluteFilePath()));
+        }
+    }
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+/**
+ * @brief Número mayor entre los segmentos presentes en un directorio.
+ * @param directory Directorio de los segmentos.
+ * @return Número del último segmento, o 0 si no hay ninguno.
+ */
+qint64 IngestJournal::lastSegmentNumber(const QString& directory)
+{
+    const QVector<QPair<qint64, QString>> segments = listSegments(directory);
+    return segments.isEmpty() ? 0 : segments.last().first;
+}
+
+/**
+ * @brief Aplica un segmento sellado en una transacción junto con su marca de aplicado.
+ * @param connection Conexión abierta en el hilo que llama.
+ * @param path Ruta del segmento.
+ * @param segment Número del segmento.
+ * @param allowTornTail Si es true, la última trama puede estar incompleta o dañada.
+ * @param changes Vector donde se añaden las filas insertadas.
+ * @return true si el segmento quedó aplicado (ahora o en una ejecución anterior).
+ *
+ * La marca en ingest_journal_applied se escribe en la misma transacción que las filas: si el
+ * proceso muere antes de borrar el archivo, el siguiente arranque lo reconoce y no lo duplica.
+ *
+ * Solo el último segmento, el que estaba activo si el proceso murió escribiendo, puede terminar
+ * en una trama incompleta: esa escritura nunca se confirmó y se descarta. Una trama dañada en
+ * cualquier otro lugar puede ocultar escrituras confirmadas detrás de ella, así que el segmento
+ * no se aplica ni se borra: se aparta con la extensión .corrupt y la función falla.
+ */
+bool IngestJournal::applySegment(QSqlDatabase& connection, const QString& path, qint64 segment,
+                                 bool allowTornTail, QVector<RecordChange>& changes)
+{
+    QSqlQuery query(connection);
+    query.prepare("SELECT 1 FROM ingest_journal_applied WHERE segment = :segment");
+    query.bindValue(":segment", segment);
+    if (!query.exec()) {
+        qCWarning(lcDb) << "Error al consultar segmentos aplicados:" << query.lastError().text();
+        return false;
+    }
+    const bool alreadyApplied = query.next();
+    query.finish();
+
+    if (!alreadyApplied) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qCWarning(lcDb) << "Error al abrir el segmento" << path << ":" << file.errorString();
+            return false;
+        }
+
+        QVector<healthrecord> records;
+        const qint64 size = file.size();
+        const uchar* data = size > 0 ? file.map(0, size) : nullptr;
+        if (size > 0 && !data) {
+            qCWarning(lcDb) << "Error al leer el segmento" << path << ":" << file.errorString();
+            return false;
+        }
+        qint64 offset = 0;
+        bool corrupt = false;
+        bool tornTail = false;
+        while (offset < size) {
+            const uchar* frame = data + offset;
+            if (offset + kFrameHeaderSize > size) {
+                tornTail = true; // Cabecera incompleta al final del archivo
+                break;
+            }
+            const quint32 magic = qFromLittleEndian<quint32>(frame);
+            const quint32 length = qFromLittleEndian<quint32>(frame + 4);
+            const quint32 checksum = qFromLittleEndian<quint32>(frame + 8);
+            if (magic != kFrameMagic) {
+                // Un final relleno con ceros es una escritura que el sistema de archivos no completó
+                tornTail = std::all_of(frame, data + size, [](uchar byte) { return byte == 0; });
+                corrupt = !tornTail;
+                break;
+            }
+            if (length < 22) {
+                corrupt = true;
+                break;
+            }
+            const qint64 frameEnd = offset + kFrameHeaderSize + length;
+            if (frameEnd > size) {
+                tornTail = true; // Carga útil incompleta
+                break;
+            }
+            const uchar* payload = frame + kFrameHeaderSize;
+            if (Checksum::crc32(reinterpret_cast<const char*>(payload), static_cast<int>(length)) != checksum) {
+                // Solo la última trama puede haber quedado a medio escribir
+                tornTail = frameEnd == size;
+                corrupt = !tornTail;
+                break;
+            }
+
+            const qint32 userId = qFromLittleEndian<qint32>(payload);
+            const qint64 msecs = qFromLittleEndian<qint64>(payload + 4);
+            const float weight = readFloat(payload + 12);
+            const float glucose = readFloat(payload + 16);
+            const quint16 bpLength = qFromLittleEndian<quint16>(payload + 20);
+            if (22u + bpLength > length) {
+                corrupt = true;
+                break;
+            }
+            const QString bloodPressure = QString::fromUtf8(reinterpret_cast<const char*>(payload + 22), bpLength);
+
+            records.append(healthrecord("", QString::number(userId), QDateTime::fromMSecsSinceEpoch(msecs),
+                                        weight, bloodPressure, glucose));
+            offset = frameEnd;
+        }
+        file.close();
+
+        if (corrupt || (tornTail && !allowTornTail)) {
+            const QString aside = path + ".corrupt";
+            qCCritical(lcDb) << "Segmento" << path << "dañado en el byte" << offset << "de" << size
+                             << "; no se aplica y se aparta como" << aside;
+            if (!QFile::rename(path, aside)) {
+                qCCritical(lcDb) << "No se pudo apartar el segmento dañado" << path;
+            }
+            return false;
+        }
+        if (tornTail) {
+            qCWarning(lcDb) << "Segmento" << path << "truncado en el byte" << offset << "de" << size
+                     << "(escritura interrumpida no confirmada)";
+        }
+
+        QVector<RecordChange> segmentChanges;
+        bool ok = connection.transaction()
+                  && DatabaseManager::insertHealthRecords(connection, records, segmentChanges);
+        if (ok) {
+            QSqlQuery mark(connection);
+            mark.prepare("INSERT INTO ingest_journal_applied (segment) VALUES (:segment)");
+            mark.bindValue(":segment", segment);
+            ok = mark.exec() && connection.commit();
+        }
+        if (!ok) {
+            qCWarning(lcDb) << "Error al aplicar el segmento" << path << ":" << connection.lastError().text();
+            connection.rollback();
+            return false;
+        }
+        changes += segmentChanges;
+        qCDebug(lcDb) << "Segmento" << segment << "aplicado:" << records.size() << "registros";
+    }
+
+    if (!QFile::remove(path)) {
+        qCWarning(lcDb) << "No se pudo eliminar el segmento aplicado" << path;
+        return true;
+    }
+    QSqlQuery cleanup(connection);
+    cleanup.prepare("DELETE FROM ingest_journal_applied WHERE segment = :segment");
+    cleanup.bindValue(":segment", segment);
+    cleanup.exec();
+    return true;
+}
+
+/**
+ * @brief Aplica a la base de datos todos los segmentos presentes en un directorio.
+ * @param connection Conexión abierta en el hilo que llama.
+ * @param directory Directorio de los segmentos.
+ * @param changes Vector donde se añaden las filas insertadas.
+ * @return true si todos los segmentos se aplicaron, false ante el primer error.
+ */
+bool IngestJournal::replay(QSqlDatabase& connection, const QString& directory, QVector<RecordChange>& changes)
+{
+    const QVector<QPair<qint64, QString>> segments = listSegments(directory);
+    for (const auto& segment : segments) {
+        // El último segmento es el que estaba activo: puede terminar en una escritura interrumpida
+        const bool last = segment.first == segments.last().first;
+        if (!applySegment(connection, segment.second, segment.first, last, changes)) {
+            return false;
+        }
+    }
+    if (!segments.isEmpty()) {
+        qCInfo(lcDb) << "Bitácora reaplicada:" << segments.size() << "segmentos," << changes.size() << "registros";
+    }
+    return true;
+}
+
+/**
+ * @brief Inicia el hilo compactador.
+ */
+void IngestJournal::startCompactor()
+{
+    if (m_compactor.joinable()) {
+        return;
+    }
+    m_stopping.store(false);
+    m_compactor = std::thread(&IngestJournal::runCompactor, this);
+}
+
+/**
+ * @brief Detiene el hilo compactador después de una última ronda de compactación.
+ */
+void IngestJournal::stopCompactor()
+{
+    if (!m_compactor.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopping.store(true);
+        m_wakeCondition.notify_one();
+    }
+    m_compactor.join();
+}
+
+/**
+ * @brief Bucle del hilo compactador.
+ */
+void IngestJournal::runCompactor()
+{
+    {
+        QSqlDatabase connection = DatabaseManager::openConnection(kCompactorConnection);
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(m_wakeMutex);
+                m_wakeCondition.wait_for(lock, std::chrono::milliseconds(m_options.compactIntervalMs),
+                                         [this]() { return m_stopping.load(); });
+            }
+            compactOnce(connection);
+            if (m_stopping.load()) {
+                break;
+            }
+        }
+        connection.close();
+    }
+    QSqlDatabase::removeDatabase(kCompactorConnection);
+}
+
+/**
+ * @brief Sella el segmento activo si tiene datos y aplica todos los segmentos sellados.
+ * @param connection Conexión del compactador.
+ */
+void IngestJournal::compactOnce(QSqlDatabase& connection)
+{
+    qint64 activeSegment;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_activeFile.isOpen() && m_activeFile.size() > 0) {
+            rotateLocked();
+        }
+        activeSegment = m_activeSegment;
+    }
+
+    QVector<RecordChange> changes;
+    const QVector<QPair<qint64, QString>> segments = listSegments(m_directory);
+    for (const auto& segment : segments) {
+        if (segment.first >= activeSegment) {
+            break;
+        }
+        // Los segmentos sellados en marcha terminan siempre en una trama completa
+        if (!applySegment(connection, segment.second, segment.first, false, changes)) {
+            break;
+        }
+    }
+    ChangeFeed::instance().publish(changes);
+}
@@ -0,0 +1,313 @@
+/**
+ * @file IngestPipeline.cpp
+ * @brief Implementación de la clase IngestPipeline, proceso por etapas en paralelo para importar registros de salud.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "IngestPipeline.h"
+#include "Logging.h"
+#include "DatabaseManager.h"
+#include <QThread>
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <map>
+
+namespace {
+/**
+ * @brief Nanosegundos transcurridos desde un instante.
+ * @param since Instante de referencia.
+ * @return Nanosegundos hasta ahora.
+ */
+qint64 nanosecondsSince(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - since).count();
+}
+
+/**
+ * @brief Número de hilos de procesamiento para unas opciones.
+ * @param options Parámetros del proceso.
+ * @return Hilos a usar; al menos 1.
+ */
+int resolveWorkers(const IngestOptions& options)
+{
+    if (options.workers > 0) {
+        return options.workers;
+    }
+    // Un núcleo queda para el hilo que lee y el de escritura, que casi siempre esperan
+    return std::max(1, QThread::idealThreadCount() - 1);
+}
+
+/**
+ * @brief Límite de tareas sin escribir para unas opciones.
+ * @param options Parámetros del proceso.
+ * @param workers Hilos de procesamiento.
+ * @return Límite; al menos 1.
+ */
+qint64 resolveMaxTasksInFlight(const IngestOptions& options, int workers)
+{
+    return options.maxTasksInFlight > 0 ? options.maxTasksInFlight : 4LL * workers;
+}
+}
+
+/**
+ * @brief Constructor. Inicia los hilos de procesamiento y escritura.
+ * @param options Parámetros del proceso.
+ * @param orderedStage Etapa de depuración opcional.
+ */
+IngestPipeline::IngestPipeline(const IngestOptions& options, const OrderedStage& orderedStage)
+    : m_options(options)
+    , m_orderedStage(orderedStage)
+    , m_work(static_cast<std::size_t>(resolveMaxTasksInFlight(options, resolveWorkers(options))))
+    , m_done(static_cast<std::size_t>(resolveMaxTasksInFlight(options, resolveWorkers(options))))
+    , m_nextSequence(0)
+    , m_tasksInFlight(0)
+    , m_maxTasksInFlight(resolveMaxTasksInFlight(options, resolveWorkers(options)))
+    , m_finished(false)
+    , m_started(std::chrono::steady_clock::now())
+{
+    m_options.batchRows = std::max(1, m_options.batchRows);
+    m_options.maxBatchesInFlight = std::max(1, m_options.maxBatchesInFlight);
+
+    const int workers = resolveWorkers(options);
+    m_workers.reserve(static_cast<std::size_t>(workers));
+    for (int i = 0; i < workers; ++i) {
+        m_workers.emplace_back(&IngestPipeline::workerLoop, this);
+    }
+    m_writer = std::thread(&IngestPipeline::writerLoop, this);
+}
+
+/**
+ * @brief Destructor. Termina el proceso si finish() no se llamó.
+ */
+IngestPipeline::~IngestPipeline()
+{
+    finish();
+}
+
+/**
+ * @brief Envía una tarea; bloquea mientras haya demasiadas tareas sin escribir.
+ * @param task Tarea a ejecutar en un hilo de procesamiento.
+ * @return true si se aceptó, false si el proceso ya terminó.
+ */
+bool IngestPipeline::submit(Task task)
+{
+    if (m_finished) {
+        return false;
+    }
+    {
+        std::unique_lock<std::mutex> lock(m_flightMutex);
+        if (m_tasksInFlight >= m_maxTasksInFlight) {
+            const auto waitStart = std::chrono::steady_clock::now();
+            m_flightCondition.wait(lock, [this] { return m_tasksInFlight < m_maxTasksInFlight; });
+            m_reading.blockedNanoseconds += nanosecondsSince(waitStart);
+        }
+        ++m_tasksInFlight;
+    }
+
+    Work work;
+    work.sequence = m_nextSequence++;
+    work.task = std::move(task);
+    if (!m_work.push(std::move(work), nullptr)) {
+        return false;
+    }
+    ++m_reading.tasks;
+    return true;
+}
+
+/**
+ * @brief Espera a que se procesen y confirmen todas las tareas enviadas.
+ * @return Totales del proceso. Llamadas posteriores devuelven el mismo resultado.
+ */
+IngestResult IngestPipeline::finish()
+{
+    if (!m_finished) {
+        m_finished = true;
+        m_reading.busyNanoseconds = nanosecondsSince(m_started) - m_reading.blockedNanoseconds;
+
+        m_work.close();
+        for (std::thread& worker : m_workers) {
+            worker.join();
+        }
+        m_done.close();
+        m_writer.join();
+
+        m_result.metrics = metrics();
+        for (const StageMetrics& stage : m_result.metrics) {
+            qCDebug(lcDb) << "Etapa" << stage.name << ": hilos" << stage.threads << ", tareas" << stage.tasks
+                     << ", registros/s" << qRound64(stage.recordsPerSecond)
+                     << ", ocupada ms" << stage.busyNanoseconds / 1000000
+                     << ", bloqueada ms" << stage.blockedNanoseconds / 1000000
+                     << ", cola máx." << stage.queueHighWater << "/" << stage.queueCapacity;
+        }
+    }
+    return m_result;
+}
+
+/**
+ * @brief Instantánea de las métricas de cada etapa.
+ * @return Métricas de lectura, procesamiento, depuración y escritura.
+ */
+QVector<StageMetrics> IngestPipeline::metrics() const
+{
+    const double elapsedSeconds = std::max<qint64>(1, nanosecondsSince(m_started)) / 1e9;
+    auto snapshot = [elapsedSeconds](const char* name, int threads, const Counters& counters) {
+        StageMetrics stage;
+        stage.name = QString::fromUtf8(name);
+        stage.threads = threads;
+        stage.tasks = counters.tasks.load();
+        stage.records = counters.records.load();
+        stage.busyNanoseconds = counters.busyNanoseconds.load();
+        stage.blockedNanoseconds = counters.blockedNanoseconds.load();
+        stage.recordsPerSecond = stage.records / elapsedSeconds;
+        return stage;
+    };
+
+    StageMetrics reading = snapshot("lectura", 1, m_reading);
+    StageMetrics processing = snapshot("procesamiento", static_cast<int>(m_workers.size()), m_processing);
+    processing.queueDepth = static_cast<qint64>(m_work.size());
+    processing.queueHighWater = static_cast<qint64>(m_work.highWater());
+    processing.queueCapacity = static_cast<qint64>(m_work.capacity());
+    StageMetrics ordering = snapshot("depuración", 1, m_ordering);
+    ordering.queueDepth = static_cast<qint64>(m_done.size());
+    ordering.queueHighWater = static_cast<qint64>(m_done.highWater());
+    ordering.queueCapacity = static_cast<qint64>(m_done.capacity());
+    StageMetrics writing = snapshot("escritura", 1, m_writing);
+
+    return {reading, processing, ordering, writing};
+}
+
+/**
+ * @brief Hilos de la etapa de procesamiento.
+ * @return Número de hilos.
+ */
+int IngestPipeline::workerCount() const
+{
+    return static_cast<int>(m_workers.size());
+}
+
+/**
+ * @brief Bucle de un hilo de procesamiento.
+ */
+void IngestPipeline::workerLoop()
+{
+    Work work;
+    while (m_work.pop(work)) {
+        const auto taskStart = std::chrono::steady_clock::now();
+        Done done;
+        done.sequence = work.sequence;
+        work.task(done.output);
+        work.task = Task();
+        m_processing.busyNanoseconds += nanosecondsSince(taskStart);
+        ++m_processing.tasks;
+        m_processing.records += done.output.records.size();
+
+        qint64 blocked = 0;
+        m_done.push(std::move(done), &blocked);
+        m_processing.blockedNanoseconds += blocked;
+    }
+}
+
+/**
+ * @brief Bucle del hilo de escritura: reordena, depura y agrupa en lotes.
+ *
+ * Los resultados que llegan antes de su turno esperan en un mapa; como el productor no puede
+ * adelantarse más de maxTasksInFlight tareas, el mapa también está acotado.
+ */
+void IngestPipeline::writerLoop()
+{
+    std::map<qint64, IngestOutput> early;
+    qint64 nextSequence = 0;
+    qint64 lineBase = m_options.firstLineNumber;
+
+    QVector<healthrecord> batch;
+    batch.reserve(m_options.batchRows);
+
+    struct PendingBatch
+    {
+        std::future<bool> done;
+        int rows;
+    };
+    std::deque<PendingBatch> inFlight;
+
+    auto collect = [&](std::size_t keep) {
+        while (inFlight.size() > keep) {
+            const auto waitStart = std::chrono::steady_clock::now();
+            PendingBatch& pending = inFlight.front();
+            if (pending.done.get()) {
+                m_result.imported += pending.rows;
+            } else {
+                m_result.failed += pending.rows;
+            }
+            inFlight.pop_front();
+            m_writing.blockedNanoseconds += nanosecondsSince(waitStart);
+        }
+    };
+    auto submitBatch = [&]() {
+        if (batch.isEmpty()) {
+            return;
+        }
+        const int rows = static_cast<int>(batch.size());
+        inFlight.push_back(PendingBatch{DatabaseManager::instance().enqueueHealthRecords(batch), rows});
+        ++m_writing.tasks;
+        m_writing.records += rows;
+        batch = QVector<healthrecord>();
+        batch.reserve(m_options.batchRows);
+        collect(static_cast<std::size_t>(m_options.maxBatchesInFlight));
+    };
+
+    auto write = [&](IngestOutput& output) {
+        auto stageStart = std::chrono::steady_clock::now();
+        m_result.inputs += output.inputs;
+        m_result.rejected += output.rejected;
+        for (RejectedLine& rejected : output.rejectedLines) {
+            if (m_result.rejectedLines.size() >= m_options.maxReportedRejects) {
+                break;
+            }
+            rejected.lineNumber += lineBase;
+            m_result.rejectedLines.append(rejected);
+        }
+        lineBase += output.lineSpan;
+
+        if (m_orderedStage) {
+            m_orderedStage(output);
+        }
+        m_ordering.busyNanoseconds += nanosecondsSince(stageStart);
+        ++m_ordering.tasks;
+        m_ordering.records += output.records.size();
+
+        stageStart = std::chrono::steady_clock::now();
+        for (const healthrecord& record : output.records) {
+            batch.append(record);
+            if (batch.size() >= m_options.batchRows) {
+                submitBatch();
+            }
+        }
+        m_writing.busyNanoseconds += nanosecondsSince(stageStart);
+
+        {
+            std::lock_guard<std::mutex> lock(m_flightMutex);
+            --m_tasksInFlight;
+        }
+        m_flightCondition.notify_one();
+    };
+
+    Done done;
+    qint64 waited = 0;
+    while (m_done.pop(done, &waited)) {
+        if (done.sequence != nextSequence) {
+            early.emplace(done.sequence, std::move(done.output));
+            continue;
+        }
+        write(done.output);
+        ++nextSequence;
+        for (auto it = early.find(nextSequence); it != early.end(); it = early.find(nextSequence)) {
+            write(it->second);
+            early.erase(it);
+            ++nextSequence;
+        }
+    }
+    submitBatch();
+    collect(0);
+}
@@ -0,0 +1,283 @@
+/**
+ * @file IngestQueue.cpp
+ * @brief Implementación de la clase IngestQueue, cola de escritura con commit agrupado para health_records.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "IngestQueue.h"
+#include "Logging.h"
+#include "DatabaseManager.h"
+#include "ChangeFeed.h"
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <chrono>
+
+namespace {
+/**
+ * @brief Nombre de la conexión propia del hilo escritor.
+ */
+const char* const kWriterConnection = "ingest_writer";
+}
+
+/**
+ * @brief Constructor de la cola. No inicia el hilo escritor.
+ * @param options Parámetros de agrupamiento.
+ */
+IngestQueue::IngestQueue(const Options& options)
+    : m_options(options),
+      m_ring(static_cast<std::size_t>(options.capacity)),
+      m_batches(Metrics::instance().counter("salud_ingest_batches_total", "Lotes confirmados por la cola de inserción.")),
+      m_batchLatency(Metrics::instance().histogram("salud_ingest_batch_seconds",
+                                                   "Duración de cada lote de la cola de inserción.")),
+      m_running(false),
+      m_stopping(false),
+      m_sleeping(false),
+      m_producers(0)
+{
+}
+
+/**
+ * @brief Destructor. Confirma las peticiones pendientes y detiene el hilo escritor.
+ */
+IngestQueue::~IngestQueue()
+{
+    stop();
+}
+
+/**
+ * @brief Inicia el hilo escritor.
+ */
+void IngestQueue::start()
+{
+    if (m_writer.joinable()) {
+        return;
+    }
+    m_stopping.store(false);
+    m_running.store(true);
+    m_writer = std::thread(&IngestQueue::run, this);
+}
+
+/**
+ * @brief Confirma las peticiones pendientes y detiene el hilo escritor.
+ *
+ * El escritor no termina mientras quede un productor dentro de enqueue(), así que toda petición
+ * que llegó al anillo antes del cierre se confirma o se rechaza, nunca se abandona.
+ */
+void IngestQueue::stop()
+{
+    if (!m_writer.joinable()) {
+        return;
+    }
+    m_stopping.store(true);
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_wakeCondition.notify_one();
+    }
+    m_writer.join();
+    m_running.store(false);
+
+    // Nadie volverá a leer el anillo: se rechaza lo que quede para no dejar futures sin cumplir
+    Request* request = nullptr;
+    while (m_ring.tryPop(request)) {
+        reject(request);
+    }
+}
+
+/**
+ * @brief Encola un registro de salud.
+ * @param record Registro a insertar.
+ * @return Future que vale true cuando el registro quedó confirmado, false si falló.
+ */
+std::future<bool> IngestQueue::enqueue(const healthrecord& record)
+{
+    return enqueue(QVector<healthrecord>{record});
+}
+
+/**
+ * @brief Encola un lote de registros de salud que se confirma de forma atómica.
+ * @param records Registros a insertar.
+ * @return Future que vale true cuando todo el lote quedó confirmado, false si falló.
+ *
+ * Si el anillo está lleno, el productor cede el procesador hasta que el escritor libere espacio.
+ * El productor se anuncia en m_producers antes de mirar m_stopping: o ve el cierre y rechaza el
+ * lote, o el escritor ve al productor y espera a que termine de encolar antes de salir.
+ */
+std::future<bool> IngestQueue::enqueue(const QVector<healthrecord>& records)
+{
+    Request* request = new Request;
+    request->records = records;
+    std::future<bool> future = request->done.get_future();
+
+    m_producers.fetch_add(1);
+    bool admitted = m_running.load() && !m_stopping.load();
+    while (admitted && !m_ring.tryPush(std::move(request))) {
+        wakeWriter();
+        std::this_thread::yield();
+        admitted = !m_stopping.load();
+    }
+    m_producers.fetch_sub(1);
+
+    if (!admitted) {
+        qCWarning(lcDb) << "Cola de inserción detenida, se rechaza el lote de" << records.size() << "registros";
+        reject(request);
+        return future;
+    }
+    wakeWriter();
+    return future;
+}
+
+/**
+ * @brief Número aproximado de peticiones en espera.
+ * @return Profundidad actual de la cola.
+ */
+std::size_t IngestQueue::depth() const
+{
+    return m_ring.sizeApprox();
+}
+
+/**
+ * @brief Cumple con false el future de una petición que no se confirmará y la libera.
+ * @param request Petición rechazada.
+ */
+void IngestQueue::reject(Request* request)
+{
+    request->done.set_value(false);
+    delete request;
+}
+
+/**
+ * @brief Despierta al hilo escritor si está dormido.
+ *
+ * Los productores solo tocan el mutex cuando el escritor anunció que iba a dormir.
+ */
+void IngestQueue::wakeWriter()
+{
+    if (m_sleeping.load()) {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_wakeCondition.notify_one();
+    }
+}
+
+/**
+ * @brief Bucle del hilo escritor.
+ *
+ * Espera la primera petición, sigue juntando hasta maxBatchRows filas o flushIntervalMs
+ * milisegundos (durmiendo en la variable de condición, no girando) y confirma el lote. Al
+ * detenerse vacía el anillo y solo sale cuando no queda ningún productor encolando.
+ */
+void IngestQueue::run()
+{
+    {
+        QSqlDatabase connection = DatabaseManager::openConnection(kWriterConnection);
+        if (!connection.isOpen()) {
+            qCWarning(lcDb) << "El escritor de la cola no pudo abrir su conexión:" << connection.lastError().text();
+        }
+
+        std::vector<Request*> batch;
+        Request* request = nullptr;
+        while (true) {
+            int rows = 0;
+            if (m_ring.tryPop(request)) {
+                batch.push_back(request);
+                rows += request->records.size();
+
+                const auto deadline = std::chrono::steady_clock::now()
+                                      + std::chrono::milliseconds(m_options.flushIntervalMs);
+                while (rows < m_options.maxBatchRows) {
+                    if (m_ring.tryPop(request)) {
+                        batch.push_back(request);
+                        rows += request->records.size();
+                    } else if (m_stopping.load() || std::chrono::steady_clock::now() >= deadline) {
+                        break;
+                    } else {
+                        std::unique_lock<std::mutex> lock(m_wakeMutex);
+                        m_sleeping.store(true);
+                        if (m_ring.sizeApprox() == 0 && !m_stopping.load()) {
+                            m_wakeCondition.wait_until(lock, deadline);
+                        }
+                        m_sleeping.store(false);
+                    }
+                }
+                commitBatch(batch);
+                continue;
+            }
+
+            if (m_stopping.load()) {
+                if (m_producers.load() == 0 && m_ring.sizeApprox() == 0) {
+                    break;
+                }
+                // Un productor admitido antes del cierre aún está encolando
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_sleeping.store(true);
+            if (m_ring.sizeApprox() == 0 && !m_stopping.load()) {
+                m_wakeCondition.wait_for(lock, std::chrono::milliseconds(50));
+            }
+            m_sleeping.store(false);
+        }
+
+        connection.close();
+    }
+    QSqlDatabase::removeDatabase(kWriterConnection);
+}
+
+/**
+ * @brief Confirma un lote de peticiones en una sola transacción.
+ * @param batch Peticiones a confirmar; se liberan al terminar.
+ *
+ * Si la transacción conjunta falla, cada petición se reintenta en su propia transacción para
+ * que un registro inválido no haga fallar las peticiones de otros productores.
+ */
+void IngestQueue::commitBatch(std::vector<Request*>& batch)
+{
+    QSqlDatabase connection = QSqlDatabase::database(kWriterConnection, false);
+    QVector<RecordChange> changes;
+    const auto start = std::chrono::steady_clock::now();
+    m_batches->add();
+
+    bool committed = connection.transaction();
+    for (Request* request : batch) {
+        if (!committed) {
+            break;
+        }
+        committed = DatabaseManager::insertHealthRecords(connection, request->records, changes);
+    }
+    if (committed) {
+        committed = connection.commit();
+    }
+
+    if (committed) {
+        ChangeFeed::instance().publish(changes);
+        for (Request* request : batch) {
+            request->done.set_value(true);
+            delete request;
+        }
+        batch.clear();
+        m_batchLatency->record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        return;
+    }
+
+    qCWarning(lcDb) << "Error al confirmar el lote agrupado, reintentando por petición:" << connection.lastError().text();
+    connection.rollback();
+    for (Request* request : batch) {
+        QVector<RecordChange> requestChanges;
+        bool ok = connection.transaction()
+                  && DatabaseManager::insertHealthRecords(connection, request->records, requestChanges)
+                  && connection.commit();
+        if (ok) {
+            ChangeFeed::instance().publish(requestChanges);
+        } else {
+            connection.rollback();
+        }
+        request->done.set_value(ok);
+        delete request;
+    }
+    batch.clear();
+    m_batchLatency->record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
@@ -0,0 +1,159 @@
+/**
+ * @file LatencyHistogram.cpp
+ * @brief Implementación de la clase LatencyHistogram, histograma de latencias con precisión relativa fija.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "LatencyHistogram.h"
+#include <limits>
+
+namespace {
+/**
+ * @brief Bits de subdivisión lineal de cada potencia de dos (16 cubetas).
+ */
+const int kSubBits = 4;
+
+/**
+ * @brief Cubetas por potencia de dos.
+ */
+const int kSubBuckets = 1 << kSubBits;
+}
+
+/**
+ * @brief Constructor de un histograma vacío.
+ */
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+/**
+ * @brief Cubeta de un valor.
+ * @param value Valor no negativo.
+ * @return Índice de la cubeta.
+ *
+ * Los valores menores que 16 tienen cubeta propia; para los demás, la cubeta combina la posición
+ * del bit más alto (exponente) con los 4 bits siguientes (subdivisión).
+ */
+int LatencyHistogram::bucketOf(qint64 value)
+{
+    if (value < kSubBuckets) {
+        return value < 0 ? 0 : static_cast<int>(value);
+    }
+    int exponent = 63;
+    while (!(static_cast<quint64>(value) >> exponent)) {
+        --exponent;
+    }
+    const int sub = static_cast<int>((static_cast<quint64>(value) >> (exponent - kSubBits)) & (kSubBuckets - 1));
+    return (exponent - kSubBits + 1) * kSubBuckets + sub;
+}
+
+/**
+ * @brief Valor representativo (punto medio) de una cubeta.
+ * @param bucket Índice de la cubeta.
+ * @return Valor en nanosegundos.
+ */
+qint64 LatencyHistogram::valueOf(int bucket)
+{
+    if (bucket < kSubBuckets) {
+        return bucket;
+    }
+    const int exponent = bucket / kSubBuckets + kSubBits - 1;
+    const int sub = bucket % kSubBuckets;
+    const int shift = exponent - kSubBits;
+    const qint64 lower = static_cast<qint64>(kSubBuckets + sub) << shift;
+    return lower + ((qint64(1) << shift) >> 1);
+}
+
+/**
+ * @brief Registra un valor.
+ * @param nanoseconds Latencia en nanosegundos; los negativos se registran como 0.
+ */
+void LatencyHistogram::record(qint64 nanoseconds)
+{
+    const qint64 value = nanoseconds < 0 ? 0 : nanoseconds;
+    m_counts[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_total.fetch_add(value, std::memory_order_relaxed);
+
+    qint64 current = m_max.load(std::memory_order_relaxed);
+    while (value > current && !m_max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+    current = m_min.load(std::memory_order_relaxed);
+    while (value < current && !m_min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+/**
+ * @brief Número de valores registrados.
+ * @return Cantidad de valores.
+ */
+quint64 LatencyHistogram::count() const
+{
+    return m_count.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Valor bajo el cual queda la fracción indicada de los registros.
+ * @param percentile Percentil entre 0 y 100.
+ * @return Valor representativo de la cubeta del percentil, o 0 si está vacío.
+ */
+qint64 LatencyHistogram::percentile(double percentile) const
+{
+    quint64 total = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        total += m_counts[i].load(std::memory_order_relaxed);
+    }
+    if (total == 0) {
+        return 0;
+    }
+    const double clamped = percentile < 0 ? 0 : (percentile > 100 ? 100 : percentile);
+    quint64 target = static_cast<quint64>(clamped / 100.0 * static_cast<double>(total) + 0.5);
+    target = target == 0 ? 1 : target;
+
+    quint64 seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        seen += m_counts[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return qMin(valueOf(i), m_max.load(std::memory_order_relaxed));
+        }
+    }
+    return m_max.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Calcula el resumen del histograma.
+ * @return Conteo, extremos, promedio y percentiles.
+ */
+LatencyHistogram::Summary LatencyHistogram::summary() const
+{
+    Summary summary;
+    summary.count = count();
+    if (summary.count == 0) {
+        return summary;
+    }
+    summary.min = m_min.load(std::memory_order_relaxed);
+    summary.max = m_max.load(std::memory_order_relaxed);
+    summary.total = m_total.load(std::memory_order_relaxed);
+    summary.mean = summary.total / static_cast<qint64>(summary.count);
+    summary.p50 = percentile(50);
+    summary.p90 = percentile(90);
+    summary.p99 = percentile(99);
+    summary.p999 = percentile(99.9);
+    return summary;
+}
+
+/**
+ * @brief Vacía el histograma.
+ */
+void LatencyHistogram::reset()
+{
+    for (int i = 0; i < kBuckets; ++i) {
+        m_counts[i].store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_total.store(0, std::memory_order_relaxed);
+    m_min.store(std::numeric_limits<qint64>::max(), std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,214 @@
+/**
+ * @file LogSink.cpp
+ * @brief Implementación de la clase LogSink, salida asíncrona de los mensajes de registro.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "LogSink.h"
+#include <QFile>
+#include <chrono>
+
+namespace {
+/**
+ * @brief Líneas que caben en el anillo antes de empezar a descartar.
+ */
+const std::size_t kRingCapacity = 8192;
+}
+
+/**
+ * @brief Obtiene la instancia única de LogSink.
+ * @return Referencia a la instancia singleton.
+ */
+LogSink& LogSink::instance()
+{
+    static LogSink instance;
+    return instance;
+}
+
+/**
+ * @brief Constructor privado. No instala el manejador hasta llamar a install().
+ */
+LogSink::LogSink()
+    : m_ring(kRingCapacity),
+      m_file(nullptr),
+      m_previousHandler(nullptr),
+      m_installed(false),
+      m_stopping(false),
+      m_sleeping(false),
+      m_enqueued(0),
+      m_written(0),
+      m_dropped(0)
+{
+}
+
+/**
+ * @brief Destructor. Restaura el manejador anterior y escribe los mensajes pendientes.
+ */
+LogSink::~LogSink()
+{
+    if (!m_installed.load()) {
+        return;
+    }
+    qInstallMessageHandler(m_previousHandler);
+    m_installed.store(false);
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopping.store(true);
+        m_wakeCondition.notify_one();
+    }
+    m_writer.join();
+    if (m_file) {
+        std::fclose(m_file);
+    }
+}
+
+/**
+ * @brief Instala el manejador de mensajes e inicia el hilo escritor.
+ * @param filePath Archivo al que también se agregan los mensajes; vacío para usar solo stderr.
+ * @return true si se instaló (y el archivo, si se indicó, se pudo abrir).
+ */
+bool LogSink::install(const QString& filePath)
+{
+    if (m_installed.load()) {
+        return true;
+    }
+    bool fileOk = true;
+    if (!filePath.isEmpty()) {
+        m_file = std::fopen(QFile::encodeName(filePath).constData(), "ab");
+        fileOk = m_file != nullptr;
+    }
+
+    m_writer = std::thread(&LogSink::writerLoop, this);
+    m_installed.store(true);
+    m_previousHandler = qInstallMessageHandler(&LogSink::handleMessage);
+    return fileOk;
+}
+
+/**
+ * @brief Espera a que el hilo escritor vacíe los mensajes encolados hasta ahora.
+ */
+void LogSink::flush()
+{
+    if (!m_installed.load()) {
+        return;
+    }
+    const quint64 target = m_enqueued.load();
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    m_wakeCondition.notify_one();
+    m_flushedCondition.wait_for(lock, std::chrono::seconds(2), [this, target]() {
+        return m_written.load() >= target;
+    });
+}
+
+/**
+ * @brief Mensajes descartados porque el anillo estaba lleno.
+ * @return Cantidad de mensajes descartados.
+ */
+quint64 LogSink::dropped() const
+{
+    return m_dropped.load();
+}
+
+/**
+ * @brief Manejador de mensajes instalado en Qt.
+ * @param type Nivel del mensaje.
+ * @param context Archivo, función y categoría del mensaje.
+ * @param message Texto del mensaje.
+ *
+ * El formato sigue QT_MESSAGE_PATTERN (qSetMessagePattern), igual que el manejador por defecto.
+ */
+void LogSink::handleMessage(QtMsgType type, const QMessageLogContext& context, const QString& message)
+{
+    LogSink& sink = instance();
+    QByteArray line = qFormatLogMessage(type, context, message).toLocal8Bit();
+    line.append('\n');
+
+    if (type == QtFatalMsg) {
+        sink.flush();
+        std::lock_guard<std::mutex> lock(sink.m_directMutex);
+        sink.write(line);
+        return;
+    }
+    sink.enqueue(std::move(line));
+}
+
+/**
+ * @brief Encola una línea ya formateada sin bloquear.
+ * @param line Línea a escribir.
+ *
+ * Solo se toma el mutex para despertar al escritor cuando está dormido.
+ */
+void LogSink::enqueue(QByteArray&& line)
+{
+    if (!m_ring.tryPush(std::move(line))) {
+        m_dropped.fetch_add(1);
+        return;
+    }
+    m_enqueued.fetch_add(1);
+    if (m_sleeping.load()) {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_wakeCondition.notify_one();
+    }
+}
+
+/**
+ * @brief Ciclo del hilo escritor.
+ *
+ * Vacía el anillo y duerme hasta que llegue otro mensaje; la espera tiene un límite para no
+ * depender de que el aviso llegue justo después de marcarse como dormido. Los descartes se
+ * informan con una línea propia en cuanto hay lugar.
+ */
+void LogSink::writerLoop()
+{
+    quint64 reportedDrops = 0;
+    for (;;) {
+        QByteArray line;
+        bool wrote = false;
+        while (m_ring.tryPop(line)) {
+            {
+                std::lock_guard<std::mutex> lock(m_directMutex);
+                write(line);
+            }
+            m_written.fetch_add(1);
+            wrote = true;
+        }
+
+        const quint64 drops = m_dropped.load();
+        if (drops != reportedDrops) {
+            std::lock_guard<std::mutex> lock(m_directMutex);
+            write(QByteArray("Registro: ") + QByteArray::number(drops - reportedDrops)
+                  + " mensajes descartados por saturación\n");
+            reportedDrops = drops;
+        }
+
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        if (wrote) {
+            std::fflush(stderr);
+            if (m_file) {
+                std::fflush(m_file);
+            }
+            m_flushedCondition.notify_all();
+        }
+        if (m_stopping.load() && m_ring.sizeApprox() == 0) {
+            break;
+        }
+        m_sleeping.store(true);
+        if (m_ring.sizeApprox() == 0 && !m_stopping.load()) {
+            m_wakeCondition.wait_for(lock, std::chrono::milliseconds(50));
+        }
+        m_sleeping.store(false);
+    }
+}
+
+/**
+ * @brief Escribe una línea en stderr y en el archivo.
+ * @param line Línea a escribir.
+ */
+void LogSink::write(const QByteArray& line)
+{
+    std::fwrite(line.constData(), 1, static_cast<std::size_t>(line.size()), stderr);
+    if (m_file) {
+        std::fwrite(line.constData(), 1, static_cast<std::size_t>(line.size()), m_file);
+    }
+}
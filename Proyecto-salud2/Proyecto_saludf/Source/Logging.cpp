@@ -0,0 +1,67 @@
+/**
+ * @file Logging.cpp
+ * @brief Definición de las categorías de registro y de su configuración en tiempo de ejecución.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "Logging.h"
+#include <QStringList>
+
+Q_LOGGING_CATEGORY(lcDb, "salud.db", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcAuth, "salud.auth", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcAnalyzer, "salud.analyzer", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcExport, "salud.export", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcUi, "salud.ui", QtInfoMsg)
+
+namespace Logging {
+
+/**
+ * @brief Aplica niveles mínimos por categoría.
+ * @param spec Lista "categoría=nivel" separada por comas, por ejemplo "db=debug,auth=warning"; la
+ *        categoría "*" aplica a todas. Niveles: debug, info, warning, critical.
+ * @return true si toda la especificación es válida; las entradas no válidas se ignoran.
+ *
+ * Se traduce a reglas de QLoggingCategory::setFilterRules() sobre "salud.<categoría>", que
+ * activan el nivel indicado y los superiores y desactivan los inferiores.
+ */
+bool configure(const QString& spec)
+{
+    static const char* const levels[] = {"debug", "info", "warning", "critical"};
+    const int levelCount = 4;
+
+    bool valid = true;
+    QStringList rules;
+    const QStringList entries = spec.split(',');
+    for (const QString& entry : entries) {
+        if (entry.trimmed().isEmpty()) {
+            continue;
+        }
+        const QString category = entry.section('=', 0, 0).trimmed();
+        const QString level = entry.section('=', 1).trimmed().toLower();
+        int minimum = -1;
+        for (int i = 0; i < levelCount; ++i) {
+            if (level == QLatin1String(levels[i])) {
+                minimum = i;
+            }
+        }
+        if (category.isEmpty() || minimum < 0) {
+            valid = false;
+            continue;
+        }
+
+        const QString name = category == QLatin1String("*") ? QStringLiteral("salud.*")
+                                                             : QStringLiteral("salud.") + category;
+        for (int i = 0; i < levelCount; ++i) {
+            rules << QStringLiteral("%1.%2=%3").arg(name, QLatin1String(levels[i]),
+                                                   i >= minimum ? QStringLiteral("true") : QStringLiteral("false"));
+        }
+    }
+
+    if (!rules.isEmpty()) {
+        QLoggingCategory::setFilterRules(rules.join('\n'));
+    }
+    return valid;
+}
+
+} // namespace Logging
@@ -0,0 +1,526 @@
+/**
+ * @file Metrics.cpp
+ * @brief Implementación de la clase Metrics, registro de métricas exportables en formato Prometheus y JSON.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "Metrics.h"
+#include "Logging.h"
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QHostAddress>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <cmath>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+namespace {
+/**
+ * @brief Tamaño máximo aceptado para la cabecera de una petición HTTP.
+ */
+const int kMaxRequestBytes = 8192;
+
+/**
+ * @brief Nombre del tipo en el formato de Prometheus.
+ * @param type Tipo de la métrica.
+ * @return "counter", "gauge" o "summary".
+ */
+const char* typeName(Metrics::Type type)
+{
+    switch (type) {
+    case Metrics::CounterType:
+        return "counter";
+    case Metrics::SummaryType:
+        return "summary";
+    default:
+        return "gauge";
+    }
+}
+
+/**
+ * @brief Da formato a un número para Prometheus o JSON.
+ * @param value Valor.
+ * @return Texto del número.
+ */
+QByteArray number(double value)
+{
+    return QByteArray::number(value, 'g', 15);
+}
+
+/**
+ * @brief Escapa un texto para usarlo entre comillas, en Prometheus o JSON.
+ * @param text Texto.
+ * @return Texto UTF-8 con \\, " y saltos de línea escapados.
+ */
+QByteArray escaped(const QString& text)
+{
+    QByteArray out;
+    const QByteArray utf8 = text.toUtf8();
+    out.reserve(utf8.size());
+    for (const char c : utf8) {
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else if (static_cast<unsigned char>(c) >= 0x20) {
+            out += c;
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief Etiquetas en el formato de Prometheus.
+ * @param labels Etiquetas de la muestra.
+ * @param quantile Cuantil a añadir, o nullptr.
+ * @return "{a=\"x\",quantile=\"0.5\"}", o vacío si no hay etiquetas.
+ */
+QByteArray prometheusLabels(const QList<QPair<QString, QString>>& labels, const char* quantile = nullptr)
+{
+    if (labels.isEmpty() && !quantile) {
+        return QByteArray();
+    }
+    QByteArray out = "{";
+    for (const auto& label : labels) {
+        if (out.size() > 1) {
+            out += ',';
+        }
+        out += label.first.toUtf8() + "=\"" + escaped(label.second) + '"';
+    }
+    if (quantile) {
+        if (out.size() > 1) {
+            out += ',';
+        }
+        out += QByteArray("quantile=\"") + quantile + '"';
+    }
+    out += '}';
+    return out;
+}
+
+/**
+ * @brief Segundos a partir de nanosegundos.
+ * @param nanoseconds Duración.
+ * @return Duración en segundos.
+ */
+double seconds(qint64 nanoseconds)
+{
+    return nanoseconds / 1e9;
+}
+
+/**
+ * @brief Memoria residente del proceso.
+ * @return Bytes residentes, o NaN si el sistema no lo informa.
+ */
+double residentBytes()
+{
+#ifdef Q_OS_LINUX
+    QFile statm(QStringLiteral("/proc/self/statm"));
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1) {
+            return fields.at(1).toDouble() * static_cast<double>(sysconf(_SC_PAGESIZE));
+        }
+    }
+#endif
+    return std::nan("");
+}
+}
+
+/**
+ * @brief Obtiene la instancia única de Metrics.
+ * @return Referencia a la instancia singleton.
+ */
+Metrics& Metrics::instance()
+{
+    static Metrics instance;
+    return instance;
+}
+
+/**
+ * @brief Constructor privado. Registra las métricas del proceso.
+ */
+Metrics::Metrics()
+    : m_snapshotting(false),
+      m_server(nullptr)
+{
+    observe("salud_process_resident_bytes", "Memoria residente del proceso.", GaugeType, residentBytes);
+}
+
+/**
+ * @brief Destructor. Detiene las fotos periódicas y el servidor.
+ */
+Metrics::~Metrics()
+{
+    stopSnapshots();
+    stopServing();
+    for (const Entry& entry : m_entries) {
+        delete entry.counter;
+        delete entry.histogram;
+    }
+}
+
+/**
+ * @brief Busca una métrica registrada.
+ * @param name Nombre de la métrica.
+ * @return Entrada, o nullptr. Debe llamarse con m_mutex tomado.
+ */
+Metrics::Entry* Metrics::find(const QString& name)
+{
+    for (Entry& entry : m_entries) {
+        if (entry.name == name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Registra un contador, o devuelve el ya registrado con ese nombre.
+ * @param name Nombre de la métrica.
+ * @param help Descripción.
+ * @return Contador, válido mientras viva la instancia.
+ */
+Metrics::Counter* Metrics::counter(const QString& name, const QString& help)
+{
+    QMutexLocker locker(&m_mutex);
+    if (Entry* existing = find(name)) {
+        return existing->counter;
+    }
+    Entry entry;
+    entry.name = name;
+    entry.help = help;
+    entry.type = CounterType;
+    entry.counter = new Counter;
+    m_entries.append(entry);
+    return entry.counter;
+}
+
+/**
+ * @brief Registra un histograma de duraciones, o devuelve el ya registrado con ese nombre.
+ * @param name Nombre de la métrica; se exporta como resumen en segundos.
+ * @param help Descripción.
+ * @return Histograma en nanosegundos, válido mientras viva la instancia.
+ */
+LatencyHistogram* Metrics::histogram(const QString& name, const QString& help)
+{
+    QMutexLocker locker(&m_mutex);
+    if (Entry* existing = find(name)) {
+        return existing->histogram;
+    }
+    Entry entry;
+    entry.name = name;
+    entry.help = help;
+    entry.type = SummaryType;
+    entry.histogram = new LatencyHistogram;
+    m_entries.append(entry);
+    return entry.histogram;
+}
+
+/**
+ * @brief Registra una métrica cuyo valor se lee al tomar la foto.
+ * @param name Nombre de la métrica.
+ * @param help Descripción.
+ * @param type CounterType o GaugeType.
+ * @param read Función que devuelve el valor; si devuelve NaN, la métrica se omite de esa foto.
+ *
+ * Si ya había una métrica observada con ese nombre, se reemplaza su función.
+ */
+void Metrics::observe(const QString& name, const QString& help, Type type, std::function<double()> read)
+{
+    QMutexLocker locker(&m_mutex);
+    if (Entry* existing = find(name)) {
+        existing->read = std::move(read);
+        return;
+    }
+    Entry entry;
+    entry.name = name;
+    entry.help = help;
+    entry.type = type;
+    entry.read = std::move(read);
+    m_entries.append(entry);
+}
+
+/**
+ * @brief Registra una colección de métricas calculadas al tomar la foto.
+ * @param collector Función que añade sus muestras.
+ */
+void Metrics::collect(Collector collector)
+{
+    QMutexLocker locker(&m_mutex);
+    m_collectors.append(std::move(collector));
+}
+
+/**
+ * @brief Toma una foto de todas las métricas.
+ * @return Muestras en orden de registro.
+ *
+ * Las funciones de lectura y las colecciones se llaman sin el candado tomado, para que puedan
+ * tomar los suyos sin riesgo de interbloqueo.
+ */
+QVector<Metrics::Sample> Metrics::snapshot() const
+{
+    QVector<Entry> entries;
+    QVector<Collector> collectors;
+    {
+        QMutexLocker locker(&m_mutex);
+        entries = m_entries;
+        collectors = m_collectors;
+    }
+
+    QVector<Sample> samples;
+    samples.reserve(entries.size());
+    for (const Entry& entry : entries) {
+        Sample sample;
+        sample.name = entry.name;
+        sample.help = entry.help;
+        sample.type = entry.type;
+        if (entry.counter) {
+            sample.value = static_cast<double>(entry.counter->value());
+        } else if (entry.histogram) {
+            sample.summary = entry.histogram->summary();
+        } else if (entry.read) {
+            sample.value = entry.read();
+            if (std::isnan(sample.value)) {
+                continue;
+            }
+        }
+        samples.append(sample);
+    }
+    for (const Collector& collector : collectors) {
+        collector(samples);
+    }
+    return samples;
+}
+
+/**
+ * @brief Foto en el formato de texto de Prometheus (versión 0.0.4).
+ * @return Texto listo para servir.
+ *
+ * Las muestras de una misma métrica se agrupan bajo una sola pareja de líneas HELP y TYPE. Los
+ * resúmenes se exportan en segundos con los cuantiles 0.5, 0.9, 0.99 y 0.999.
+ */
+QByteArray Metrics::toPrometheus() const
+{
+    const QVector<Sample> samples = snapshot();
+    QVector<QString> order;
+    QHash<QString, QVector<const Sample*>> families;
+    for (const Sample& sample : samples) {
+        auto& family = families[sample.name];
+        if (family.isEmpty()) {
+            order.append(sample.name);
+        }
+        family.append(&sample);
+    }
+
+    QByteArray out;
+    for (const QString& name : order) {
+        const QVector<const Sample*>& family = families.value(name);
+        const QByteArray metric = name.toUtf8();
+        out += "# HELP " + metric + ' ' + escaped(family.first()->help) + '\n';
+        out += "# TYPE " + metric + ' ' + typeName(family.first()->type) + '\n';
+        for (const Sample* sample : family) {
+            if (sample->type != SummaryType) {
+                out += metric + prometheusLabels(sample->labels) + ' ' + number(sample->value) + '\n';
+                continue;
+            }
+            const LatencyHistogram::Summary& summary = sample->summary;
+            const struct { const char* quantile; qint64 value; } quantiles[] = {
+                {"0.5", summary.p50}, {"0.9", summary.p90}, {"0.99", summary.p99}, {"0.999", summary.p999}};
+            for (const auto& quantile : quantiles) {
+                out += metric + prometheusLabels(sample->labels, quantile.quantile) + ' '
+                       + number(seconds(quantile.value)) + '\n';
+            }
+            out += metric + "_sum" + prometheusLabels(sample->labels) + ' ' + number(seconds(summary.total)) + '\n';
+            out += metric + "_count" + prometheusLabels(sample->labels) + ' '
+                   + QByteArray::number(summary.count) + '\n';
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief Foto en JSON.
+ * @return Documento con la marca de tiempo y la lista de métricas.
+ *
+ * Cada métrica lleva nombre, tipo, etiquetas y, según el tipo, "value" o los campos del resumen
+ * en segundos ("count", "sum", "min", "max", "p50", "p90", "p99", "p999").
+ */
+QByteArray Metrics::toJson() const
+{
+    const QVector<Sample> samples = snapshot();
+    QByteArray out = "{\"timestamp_ms\":" + QByteArray::number(QDateTime::currentMSecsSinceEpoch()) + ",\"metrics\":[";
+    for (int i = 0; i < samples.size(); ++i) {
+        const Sample& sample = samples.at(i);
+        out += i == 0 ? "\n" : ",\n";
+        out += "{\"name\":\"" + escaped(sample.name) + "\",\"type\":\"" + typeName(sample.type) + "\",\"labels\":{";
+        for (int j = 0; j < sample.labels.size(); ++j) {
+            out += (j == 0 ? "\"" : ",\"") + escaped(sample.labels.at(j).first) + "\":\""
+                   + escaped(sample.labels.at(j).second) + '"';
+        }
+        out += '}';
+        if (sample.type == SummaryType) {
+            const LatencyHistogram::Summary& summary = sample.summary;
+            out += ",\"count\":" + QByteArray::number(summary.count)
+                   + ",\"sum\":" + number(seconds(summary.total))
+                   + ",\"min\":" + number(seconds(summary.min))
+                   + ",\"max\":" + number(seconds(summary.max))
+                   + ",\"p50\":" + number(seconds(summary.p50))
+                   + ",\"p90\":" + number(seconds(summary.p90))
+                   + ",\"p99\":" + number(seconds(summary.p99))
+                   + ",\"p999\":" + number(seconds(summary.p999));
+        } else {
+            out += ",\"value\":" + number(sample.value);
+        }
+        out += '}';
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+/**
+ * @brief Escribe una foto en un archivo, reemplazándolo de forma atómica.
+ * @param filePath Archivo; si termina en .json se usa JSON y si no, texto de Prometheus.
+ * @return true si se escribió correctamente.
+ *
+ * QSaveFile escribe en un archivo temporal y lo renombra, así que quien lea el archivo (por
+ * ejemplo el recolector de archivos de texto de node_exporter) nunca ve una foto a medias.
+ */
+bool Metrics::writeSnapshot(const QString& filePath) const
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(lcDb) << "No se pudo escribir la foto de métricas en" << filePath << ":" << file.errorString();
+        return false;
+    }
+    file.write(filePath.endsWith(".json", Qt::CaseInsensitive) ? toJson() : toPrometheus());
+    if (!file.commit()) {
+        qCWarning(lcDb) << "Error al guardar la foto de métricas:" << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Escribe una foto cada cierto tiempo desde un hilo propio.
+ * @param filePath Archivo de destino (ver writeSnapshot()).
+ * @param intervalMs Intervalo entre fotos en milisegundos.
+ */
+void Metrics::startSnapshots(const QString& filePath, int intervalMs)
+{
+    stopSnapshots();
+    m_snapshotting.store(true);
+    m_snapshotThread = std::thread(&Metrics::snapshotLoop, this, filePath, qMax(100, intervalMs));
+    qCInfo(lcDb) << "Fotos de métricas cada" << qMax(100, intervalMs) << "ms en" << filePath;
+}
+
+/**
+ * @brief Detiene las fotos periódicas, escribiendo una última foto.
+ */
+void Metrics::stopSnapshots()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        if (!m_snapshotting.exchange(false)) {
+            return;
+        }
+    }
+    m_wakeCondition.notify_all();
+    if (m_snapshotThread.joinable()) {
+        m_snapshotThread.join();
+    }
+}
+
+/**
+ * @brief Ciclo del hilo de fotos periódicas.
+ * @param filePath Archivo de destino.
+ * @param intervalMs Intervalo entre fotos.
+ */
+void Metrics::snapshotLoop(QString filePath, int intervalMs)
+{
+    bool running = true;
+    while (running) {
+        {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            running = !m_wakeCondition.wait_for(lock, std::chrono::milliseconds(intervalMs),
+                                                [this]() { return !m_snapshotting.load(); });
+        }
+        writeSnapshot(filePath);
+    }
+}
+
+/**
+ * @brief Sirve las métricas por HTTP en 127.0.0.1. Debe llamarse desde el hilo principal.
+ * @param port Puerto TCP.
+ * @return true si se pudo escuchar en el puerto.
+ *
+ * Solo se escucha en la interfaz local: la exposición a la red queda en manos del agente de
+ * monitoreo de la máquina. Cada conexión recibe una respuesta HTTP/1.0 y se cierra.
+ */
+bool Metrics::serve(quint16 port)
+{
+    stopServing();
+    m_server = new QTcpServer;
+    if (!m_server->listen(QHostAddress::LocalHost, port)) {
+        qCWarning(lcDb) << "No se pudo servir métricas en el puerto" << port << ":" << m_server->errorString();
+        delete m_server;
+        m_server = nullptr;
+        return false;
+    }
+
+    QTcpServer* server = m_server;
+    QObject::connect(server, &QTcpServer::newConnection, server, [this, server]() {
+        while (QTcpSocket* socket = server->nextPendingConnection()) {
+            QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() {
+                // Basta con la línea de petición; se espera a tener la cabecera completa
+                const QByteArray request = socket->peek(kMaxRequestBytes);
+                if (!request.contains("\r\n\r\n") && !request.contains("\n\n") && request.size() < kMaxRequestBytes) {
+                    return;
+                }
+                socket->readAll();
+                const QList<QByteArray> line = request.left(request.indexOf('\n')).trimmed().split(' ');
+                const QByteArray method = line.value(0);
+                const QByteArray path = line.value(1);
+
+                QByteArray status = "200 OK";
+                QByteArray contentType = "text/plain; version=0.0.4; charset=utf-8";
+                QByteArray body;
+                if (method != "GET") {
+                    status = "405 Method Not Allowed";
+                    body = "Solo se admite GET\n";
+                } else if (path == "/metrics") {
+                    body = toPrometheus();
+                } else if (path == "/metrics.json") {
+                    contentType = "application/json";
+                    body = toJson();
+                } else {
+                    status = "404 Not Found";
+                    body = "Rutas: /metrics, /metrics.json\n";
+                }
+                socket->write("HTTP/1.0 " + status + "\r\nContent-Type: " + contentType
+                              + "\r\nContent-Length: " + QByteArray::number(body.size())
+                              + "\r\nConnection: close\r\n\r\n" + body);
+                socket->disconnectFromHost();
+            });
+        }
+    });
+    qCInfo(lcDb) << "Métricas disponibles en http://127.0.0.1:" + QString::number(server->serverPort()) + "/metrics";
+    return true;
+}
+
+/**
+ * @brief Deja de servir las métricas por HTTP.
+ */
+void Metrics::stopServing()
+{
+    delete m_server;
+    m_server = nullptr;
+}
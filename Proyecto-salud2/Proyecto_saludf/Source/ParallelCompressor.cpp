@@ -0,0 +1,315 @@
+/**
+ * @file ParallelCompressor.cpp
+ * @brief Implementación de la clase ParallelCompressor, dispositivo de escritura que comprime por bloques en paralelo.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "ParallelCompressor.h"
+#include "Logging.h"
+#include "Checksum.h"
+#include <QRunnable>
+#include <QThread>
+#include <QtEndian>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+#ifdef SALUD_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+/**
+ * @brief Bytes del envoltorio de qCompress antes de los datos deflate: longitud (4) y cabecera zlib (2).
+ */
+const int kQCompressPrefix = 6;
+
+/**
+ * @brief Bytes del envoltorio de qCompress después de los datos deflate: Adler-32 de zlib.
+ */
+const int kQCompressSuffix = 4;
+
+/**
+ * @brief Cabecera fija de un miembro gzip: deflate, sin nombre ni fecha, sistema desconocido.
+ */
+const char kGzipHeader[10] = {'\x1f', '\x8b', '\x08', '\x00', '\x00', '\x00', '\x00', '\x00', '\x00', '\xff'};
+
+/**
+ * @brief Comprime un bloque como un miembro gzip completo.
+ * @param input Datos sin comprimir.
+ * @param level Nivel de compresión.
+ * @return Miembro gzip, o vacío si falló.
+ *
+ * qCompress devuelve [longitud][cabecera zlib][deflate][Adler-32]; el miembro gzip es
+ * [cabecera gzip][deflate][CRC-32][longitud mod 2^32], así que basta con reenvolver el deflate.
+ */
+QByteArray gzipMember(const QByteArray& input, int level)
+{
+    const QByteArray zlib = qCompress(input, std::max(1, std::min(level, 9)));
+    if (zlib.size() < kQCompressPrefix + kQCompressSuffix) {
+        return QByteArray();
+    }
+    const int deflateBytes = zlib.size() - kQCompressPrefix - kQCompressSuffix;
+
+    QByteArray member;
+    member.reserve(static_cast<int>(sizeof(kGzipHeader)) + deflateBytes + 8);
+    member.append(kGzipHeader, static_cast<int>(sizeof(kGzipHeader)));
+    member.append(zlib.constData() + kQCompressPrefix, deflateBytes);
+
+    char trailer[8];
+    qToLittleEndian<quint32>(Checksum::crc32(input.constData(), input.size()), trailer);
+    qToLittleEndian<quint32>(static_cast<quint32>(input.size()), trailer + 4);
+    member.append(trailer, 8);
+    return member;
+}
+}
+
+/**
+ * @brief Constructor del compresor.
+ * @param sink Dispositivo de destino, abierto para escritura; no pasa a ser propiedad del compresor.
+ * @param options Parámetros de la compresión.
+ * @param parent Objeto padre, por defecto nullptr.
+ */
+ParallelCompressor::ParallelCompressor(QIODevice* sink, const CompressionOptions& options, QObject* parent)
+    : QIODevice(parent),
+      m_sink(sink),
+      m_options(options),
+      m_maxInFlight(0),
+      m_compressedBytes(0),
+      m_failed(false)
+{
+    const int threads = options.threads > 0 ? options.threads : QThread::idealThreadCount();
+    m_pool.setMaxThreadCount(std::max(1, threads));
+    m_maxInFlight = static_cast<std::size_t>(m_pool.maxThreadCount()) * 2;
+    m_options.blockBytes = std::max(64 * 1024, options.blockBytes);
+}
+
+/**
+ * @brief Destructor. Cierra el compresor si sigue abierto.
+ */
+ParallelCompressor::~ParallelCompressor()
+{
+    if (isOpen()) {
+        close();
+    }
+    m_pool.waitForDone();
+}
+
+/**
+ * @brief Abre el compresor. Solo se admite QIODevice::WriteOnly.
+ * @param mode Modo de apertura.
+ * @return true si se abrió, false en caso contrario.
+ */
+bool ParallelCompressor::open(OpenMode mode)
+{
+    if ((mode & ReadOnly) || !(mode & WriteOnly)) {
+        qCWarning(lcExport) << "El compresor solo admite escritura";
+        return false;
+    }
+    if (!isAvailable(m_options.codec)) {
+        qCWarning(lcExport) << "Formato de compresión no disponible en esta compilación";
+        return false;
+    }
+    if (!m_sink || !m_sink->isWritable()) {
+        qCWarning(lcExport) << "El destino del compresor no está abierto para escritura";
+        return false;
+    }
+    m_pending.reserve(m_options.blockBytes);
+    m_failed = false;
+    m_compressedBytes = 0;
+    return QIODevice::open(WriteOnly | Unbuffered);
+}
+
+/**
+ * @brief Comprime el último bloque, espera a los pendientes y cierra el compresor.
+ */
+void ParallelCompressor::close()
+{
+    if (!isOpen()) {
+        return;
+    }
+    if (!m_pending.isEmpty()) {
+        submitBlock();
+    }
+    drain(0);
+    QIODevice::close();
+}
+
+/**
+ * @brief El compresor es un flujo secuencial.
+ * @return Siempre true.
+ */
+bool ParallelCompressor::isSequential() const
+{
+    return true;
+}
+
+/**
+ * @brief Indica si todas las escrituras al destino tuvieron éxito. Es definitivo tras close().
+ * @return false si algún bloque no se pudo comprimir o escribir.
+ */
+bool ParallelCompressor::ok() const
+{
+    return !m_failed;
+}
+
+/**
+ * @brief Bytes comprimidos escritos en el destino.
+ * @return Número de bytes.
+ */
+qint64 ParallelCompressor::compressedBytes() const
+{
+    return m_compressedBytes;
+}
+
+/**
+ * @brief Indica si un formato está disponible en esta compilación.
+ * @param codec Formato.
+ * @return true si se puede usar.
+ */
+bool ParallelCompressor::isAvailable(CompressionOptions::Codec codec)
+{
+#ifdef SALUD_WITH_ZSTD
+    Q_UNUSED(codec);
+    return true;
+#else
+    return codec == CompressionOptions::Gzip;
+#endif
+}
+
+/**
+ * @brief Deduce el formato de compresión a partir de la extensión de un archivo.
+ * @param filePath Ruta del archivo.
+ * @param codec Formato deducido.
+ * @return true si la ruta termina en .gz o .zst, false si no pide compresión.
+ */
+bool ParallelCompressor::codecForPath(const QString& filePath, CompressionOptions::Codec* codec)
+{
+    if (filePath.endsWith(".gz", Qt::CaseInsensitive)) {
+        *codec = CompressionOptions::Gzip;
+        return true;
+    }
+    if (filePath.endsWith(".zst", Qt::CaseInsensitive)) {
+        *codec = CompressionOptions::Zstd;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Comprime un bloque como un miembro gzip o una trama zstd independiente.
+ * @param input Datos sin comprimir.
+ * @param codec Formato.
+ * @param level Nivel de compresión.
+ * @return Bloque comprimido, o un QByteArray vacío si falló.
+ */
+QByteArray ParallelCompressor::compressBlock(const QByteArray& input, CompressionOptions::Codec codec, int level)
+{
+    if (codec == CompressionOptions::Gzip) {
+        return gzipMember(input, level);
+    }
+#ifdef SALUD_WITH_ZSTD
+    QByteArray frame(static_cast<int>(ZSTD_compressBound(static_cast<size_t>(input.size()))), Qt::Uninitialized);
+    const size_t written = ZSTD_compress(frame.data(), static_cast<size_t>(frame.size()),
+                                         input.constData(), static_cast<size_t>(input.size()), level);
+    if (ZSTD_isError(written)) {
+        qCWarning(lcExport) << "Error de zstd:" << ZSTD_getErrorName(written);
+        return QByteArray();
+    }
+    frame.resize(static_cast<int>(written));
+    return frame;
+#else
+    Q_UNUSED(level);
+    return QByteArray();
+#endif
+}
+
+/**
+ * @brief El compresor no admite lectura.
+ * @param data No se usa.
+ * @param maxSize No se usa.
+ * @return Siempre -1.
+ */
+qint64 ParallelCompressor::readData(char* data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
+
+/**
+ * @brief Acumula datos y despacha los bloques completos a los hilos de compresión.
+ * @param data Datos a escribir.
+ * @param size Número de bytes.
+ * @return size si se aceptaron, -1 si el compresor falló.
+ */
+qint64 ParallelCompressor::writeData(const char* data, qint64 size)
+{
+    if (m_failed) {
+        return -1;
+    }
+    qint64 remaining = size;
+    while (remaining > 0) {
+        const qint64 room = m_options.blockBytes - m_pending.size();
+        const int chunk = static_cast<int>(std::min(room, remaining));
+        m_pending.append(data, chunk);
+        data += chunk;
+        remaining -= chunk;
+        if (m_pending.size() >= m_options.blockBytes) {
+            submitBlock();
+        }
+    }
+    // Escribir lo que ya esté listo sin esperar, y esperar solo si hay demasiados bloques en vuelo
+    drain(m_maxInFlight);
+    return m_failed ? -1 : size;
+}
+
+/**
+ * @brief Envía el bloque acumulado a un hilo de compresión.
+ */
+void ParallelCompressor::submitBlock()
+{
+    auto promise = std::make_shared<std::promise<QByteArray>>();
+    m_inFlight.push_back(promise->get_future());
+
+    const QByteArray input = m_pending;
+    const CompressionOptions::Codec codec = m_options.codec;
+    const int level = m_options.level;
+    m_pool.start(QRunnable::create([promise, input, codec, level]() {
+        promise->set_value(compressBlock(input, codec, level));
+    }));
+
+    m_pending = QByteArray();
+    m_pending.reserve(m_options.blockBytes);
+}
+
+/**
+ * @brief Escribe en el destino los bloques ya comprimidos, en orden.
+ * @param maxInFlight Espera hasta que queden como mucho estos bloques en vuelo.
+ */
+void ParallelCompressor::drain(std::size_t maxInFlight)
+{
+    while (!m_inFlight.empty()) {
+        std::future<QByteArray>& head = m_inFlight.front();
+        const bool mustWait = m_inFlight.size() > maxInFlight;
+        if (!mustWait && head.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return;
+        }
+
+        const QByteArray compressed = head.get();
+        m_inFlight.pop_front();
+        if (m_failed) {
+            continue;
+        }
+        if (compressed.isEmpty()) {
+            qCWarning(lcExport) << "Error al comprimir un bloque de la exportación";
+            m_failed = true;
+        } else if (m_sink->write(compressed) != compressed.size()) {
+            qCWarning(lcExport) << "Error al escribir la salida comprimida:" << m_sink->errorString();
+            m_failed = true;
+        } else {
+            m_compressedBytes += compressed.size();
+        }
+    }
+}
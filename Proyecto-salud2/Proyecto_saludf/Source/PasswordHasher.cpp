@@ -0,0 +1,469 @@
+/**
+ * @file PasswordHasher.cpp
+ * @brief Implementación de la clase PasswordHasher, derivación de claves para contraseñas en un pool de hilos.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "PasswordHasher.h"
+#include "Logging.h"
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QRunnable>
+#include <QThread>
+#include <algorithm>
+#include <memory>
+
+namespace {
+/**
+ * @brief Iteraciones máximas, para acotar el tiempo de inicio de sesión en máquinas muy rápidas.
+ */
+const int kMaxIterations = 10000000;
+
+/**
+ * @brief Iteraciones de la medición de calibración.
+ */
+const int kCalibrationIterations = 20000;
+
+/**
+ * @brief Bytes de sal de cada hash.
+ */
+const int kSaltBytes = 16;
+
+/**
+ * @brief Nombre de la derivación de las cuentas antiguas: SHA-256 de una vuelta, sin sal.
+ */
+const char* const kLegacyKdf = "sha256";
+
+/**
+ * @brief Estado inicial de SHA-256 (FIPS 180-4, 5.3.3).
+ */
+const quint32 kSha256Initial[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+/**
+ * @brief Constantes de las 64 rondas de SHA-256 (FIPS 180-4, 4.2.2).
+ */
+const quint32 kSha256Rounds[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/**
+ * @brief Bytes de un bloque de SHA-256, que también es el tamaño de la clave de HMAC.
+ */
+const int kSha256BlockBytes = 64;
+
+/**
+ * @brief Rota una palabra a la derecha.
+ * @param x Palabra.
+ * @param n Bits, entre 1 y 31.
+ * @return Palabra rotada.
+ */
+inline quint32 rotateRight(quint32 x, int n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+/**
+ * @brief Lee una palabra big endian.
+ * @param p Cuatro bytes.
+ * @return Palabra.
+ */
+inline quint32 loadBigEndian(const char* p)
+{
+    const uchar* b = reinterpret_cast<const uchar*>(p);
+    return (static_cast<quint32>(b[0]) << 24) | (static_cast<quint32>(b[1]) << 16)
+           | (static_cast<quint32>(b[2]) << 8) | static_cast<quint32>(b[3]);
+}
+
+/**
+ * @brief Aplica la función de compresión de SHA-256 a un bloque.
+ * @param state Estado de ocho palabras; se actualiza.
+ * @param block Bloque de 16 palabras.
+ */
+void sha256Compress(quint32 state[8], const quint32 block[16])
+{
+    quint32 w[64];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = block[i];
+    }
+    for (int i = 16; i < 64; ++i) {
+        const quint32 s0 = rotateRight(w[i - 15], 7) ^ rotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        const quint32 s1 = rotateRight(w[i - 2], 17) ^ rotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    quint32 a = state[0], b = state[1], c = state[2], d = state[3];
+    quint32 e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; ++i) {
+        const quint32 t1 = h + (rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25)) + ((e & f) ^ (~e & g))
+                           + kSha256Rounds[i] + w[i];
+        const quint32 t2 = (rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+/**
+ * @brief Procesa el final de un mensaje SHA-256 a partir de un estado que ya consumió bloques completos.
+ * @param state Estado; al volver contiene el resumen.
+ * @param data Bytes restantes del mensaje.
+ * @param size Número de bytes restantes.
+ * @param prefixBytes Bytes ya procesados en state; múltiplo de 64.
+ */
+void sha256Finish(quint32 state[8], const char* data, int size, quint64 prefixBytes)
+{
+    quint32 block[16];
+    while (size >= kSha256BlockBytes) {
+        for (int i = 0; i < 16; ++i) {
+            block[i] = loadBigEndian(data + 4 * i);
+        }
+        sha256Compress(state, block);
+        data += kSha256BlockBytes;
+        size -= kSha256BlockBytes;
+        prefixBytes += kSha256BlockBytes;
+    }
+
+    // Relleno: 0x80, ceros y la longitud total en bits en los últimos ocho bytes
+    char tail[2 * kSha256BlockBytes] = {};
+    for (int i = 0; i < size; ++i) {
+        tail[i] = data[i];
+    }
+    tail[size] = static_cast<char>(0x80);
+    const int tailBytes = size + 9 <= kSha256BlockBytes ? kSha256BlockBytes : 2 * kSha256BlockBytes;
+    const quint64 bits = (prefixBytes + static_cast<quint64>(size)) * 8;
+    for (int i = 0; i < 8; ++i) {
+        tail[tailBytes - 1 - i] = static_cast<char>(bits >> (8 * i));
+    }
+    for (int offset = 0; offset < tailBytes; offset += kSha256BlockBytes) {
+        for (int i = 0; i < 16; ++i) {
+            block[i] = loadBigEndian(tail + offset + 4 * i);
+        }
+        sha256Compress(state, block);
+    }
+}
+
+/**
+ * @struct HmacSha256Key
+ * @brief Estados de SHA-256 tras procesar la clave con ipad y con opad.
+ *
+ * Calcularlos una vez por contraseña ahorra dos de las cuatro compresiones de cada HMAC.
+ */
+struct HmacSha256Key
+{
+    quint32 inner[8];
+    quint32 outer[8];
+};
+
+/**
+ * @brief Prepara los estados interior y exterior de HMAC-SHA256 para una clave.
+ * @param key Clave; si supera un bloque se reemplaza por su SHA-256 (RFC 2104).
+ * @return Estados tras procesar K ^ ipad y K ^ opad.
+ */
+HmacSha256Key prepareHmacKey(const QByteArray& key)
+{
+    char padded[kSha256BlockBytes] = {};
+    if (key.size() > kSha256BlockBytes) {
+        quint32 digest[8];
+        std::copy(kSha256Initial, kSha256Initial + 8, digest);
+        sha256Finish(digest, key.constData(), static_cast<int>(key.size()), 0);
+        for (int i = 0; i < 8; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                padded[4 * i + j] = static_cast<char>(digest[i] >> (24 - 8 * j));
+            }
+        }
+    } else {
+        std::copy(key.constData(), key.constData() + key.size(), padded);
+    }
+
+    quint32 innerBlock[16];
+    quint32 outerBlock[16];
+    for (int i = 0; i < 16; ++i) {
+        const quint32 word = loadBigEndian(padded + 4 * i);
+        innerBlock[i] = word ^ 0x36363636u;
+        outerBlock[i] = word ^ 0x5c5c5c5cu;
+    }
+    HmacSha256Key prepared;
+    std::copy(kSha256Initial, kSha256Initial + 8, prepared.inner);
+    std::copy(kSha256Initial, kSha256Initial + 8, prepared.outer);
+    sha256Compress(prepared.inner, innerBlock);
+    sha256Compress(prepared.outer, outerBlock);
+    return prepared;
+}
+}
+
+const char* const PasswordHasher::kKdf = "pbkdf2-sha256";
+const int PasswordHasher::kMinIterations = 50000;
+const int PasswordHasher::kProvisioningIterations = PasswordHasher::kMinIterations;
+
+/**
+ * @brief Obtiene la instancia única de PasswordHasher.
+ * @return Referencia a la instancia singleton.
+ */
+PasswordHasher& PasswordHasher::instance()
+{
+    static PasswordHasher instance;
+    return instance;
+}
+
+/**
+ * @brief Constructor privado. El costo inicial es el mínimo hasta que se llame a calibrate().
+ */
+PasswordHasher::PasswordHasher()
+    : m_iterations(kMinIterations)
+{
+    m_pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount()));
+}
+
+/**
+ * @brief Mide la máquina y ajusta las iteraciones para que un hash tarde targetMilliseconds.
+ * @param targetMilliseconds Latencia objetivo de un hash.
+ * @return Iteraciones elegidas.
+ *
+ * El resultado se redondea a miles para que pequeñas variaciones entre arranques no cambien el
+ * costo y provoquen rehashes innecesarios.
+ */
+int PasswordHasher::calibrate(int targetMilliseconds)
+{
+    QElapsedTimer timer;
+    timer.start();
+    pbkdf2Sha256("calibracion", "sal-de-calibracion", kCalibrationIterations);
+    const qint64 elapsedNs = std::max<qint64>(1, timer.nsecsElapsed());
+
+    const double perIteration = static_cast<double>(elapsedNs) / kCalibrationIterations;
+    qint64 iterations = static_cast<qint64>(targetMilliseconds * 1e6 / perIteration);
+    iterations = (iterations / 1000) * 1000;
+    iterations = std::min<qint64>(kMaxIterations, std::max<qint64>(kMinIterations, iterations));
+    m_iterations.store(static_cast<int>(iterations));
+
+    qCInfo(lcAuth) << "Costo de contraseñas calibrado:" << iterations << "iteraciones para" << targetMilliseconds << "ms";
+    return static_cast<int>(iterations);
+}
+
+/**
+ * @brief Iteraciones usadas para los hashes nuevos.
+ * @return Número de iteraciones.
+ */
+int PasswordHasher::iterations() const
+{
+    return m_iterations.load();
+}
+
+/**
+ * @brief Fija las iteraciones para los hashes nuevos, sin calibrar.
+ * @param iterations Número de iteraciones; se limita al mínimo admitido.
+ */
+void PasswordHasher::setIterations(int iterations)
+{
+    m_iterations.store(std::max(kMinIterations, iterations));
+}
+
+/**
+ * @brief Deriva el hash de una contraseña con sal nueva. Bloquea.
+ * @param password Contraseña.
+ * @param iterations Iteraciones, o 0 para usar el costo actual; se limita al rango admitido.
+ * @return Hash y parámetros.
+ */
+PasswordHash PasswordHasher::hash(const QString& password, int iterations) const
+{
+    PasswordHash result;
+    result.kdf = QString::fromLatin1(kKdf);
+    result.iterations = iterations > 0 ? std::min(kMaxIterations, std::max(kMinIterations, iterations))
+                                       : this->iterations();
+    result.salt.resize(kSaltBytes);
+    QRandomGenerator::system()->generate(result.salt.begin(), result.salt.end());
+    result.hash = pbkdf2Sha256(password.toUtf8(), result.salt, result.iterations).toHex();
+    return result;
+}
+
+/**
+ * @brief Verifica una contraseña contra un hash guardado. Bloquea.
+ * @param password Contraseña ingresada.
+ * @param stored Hash guardado con sus parámetros.
+ * @return true si la contraseña corresponde al hash.
+ */
+bool PasswordHasher::verify(const QString& password, const PasswordHash& stored) const
+{
+    QByteArray candidate;
+    if (stored.kdf == QLatin1String(kKdf)) {
+        candidate = pbkdf2Sha256(password.toUtf8(), stored.salt, stored.iterations).toHex();
+    } else if (stored.kdf.isEmpty() || stored.kdf == QLatin1String(kLegacyKdf)) {
+        candidate = QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha256).toHex();
+    } else {
+        qCWarning(lcAuth) << "Función de derivación desconocida:" << stored.kdf;
+        return false;
+    }
+    return constantTimeEquals(candidate, stored.hash);
+}
+
+/**
+ * @brief Indica si un hash guardado debe recalcularse con los parámetros actuales.
+ * @param stored Hash guardado.
+ * @return true si es provisional, usa otra función de derivación o bastante menos iteraciones
+ *         que las actuales.
+ *
+ * Se tolera un 25 % menos de iteraciones para no recalcular por el ruido de la calibración; esa
+ * tolerancia no se aplica a los hashes provisionales de las cuentas creadas en lote.
+ */
+bool PasswordHasher::needsRehash(const PasswordHash& stored) const
+{
+    return stored.provisional || stored.kdf != QLatin1String(kKdf) || stored.iterations < iterations() / 4 * 3;
+}
+
+/**
+ * @brief Hash de referencia para comparar cuando el usuario no existe, con el costo actual.
+ * @return Hash que ninguna contraseña verifica.
+ *
+ * Verificar contra él cuesta lo mismo que verificar a un usuario real, así que el tiempo de
+ * respuesta no revela si el nombre está registrado.
+ */
+PasswordHash PasswordHasher::dummyHash() const
+{
+    PasswordHash dummy;
+    dummy.kdf = QString::fromLatin1(kKdf);
+    dummy.iterations = iterations();
+    dummy.salt = QByteArray(kSaltBytes, '\0');
+    dummy.hash = QByteArray(64, 'x');
+    return dummy;
+}
+
+/**
+ * @brief Deriva el hash de una contraseña en el pool.
+ * @param password Contraseña.
+ * @param iterations Iteraciones, o 0 para usar el costo actual; se limita al rango admitido (ver hash()).
+ * @return Futuro con el hash.
+ */
+std::future<PasswordHash> PasswordHasher::hashAsync(const QString& password, int iterations)
+{
+    auto promise = std::make_shared<std::promise<PasswordHash>>();
+    std::future<PasswordHash> future = promise->get_future();
+    run([this, promise, password, iterations]() { promise->set_value(hash(password, iterations)); });
+    return future;
+}
+
+/**
+ * @brief Verifica una contraseña en el pool.
+ * @param password Contraseña ingresada.
+ * @param stored Hash guardado.
+ * @return Futuro con el resultado de la verificación.
+ */
+std::future<bool> PasswordHasher::verifyAsync(const QString& password, const PasswordHash& stored)
+{
+    auto promise = std::make_shared<std::promise<bool>>();
+    std::future<bool> future = promise->get_future();
+    run([this, promise, password, stored]() { promise->set_value(verify(password, stored)); });
+    return future;
+}
+
+/**
+ * @brief Ejecuta un trabajo arbitrario de derivación en el pool.
+ * @param task Trabajo a ejecutar.
+ */
+void PasswordHasher::run(std::function<void()> task)
+{
+    m_pool.start(QRunnable::create(std::move(task)));
+}
+
+/**
+ * @brief PBKDF2-HMAC-SHA256 (RFC 8018).
+ * @param password Contraseña en bytes.
+ * @param salt Sal.
+ * @param iterations Iteraciones.
+ * @param keyLength Bytes de la clave derivada.
+ * @return Clave derivada.
+ *
+ * Los estados de SHA-256 tras K ^ ipad y K ^ opad se calculan una vez por contraseña. Cada
+ * iteración parte de copias de esos estados y solo comprime un bloque interior y uno exterior,
+ * ambos con los 32 bytes del resumen anterior y el relleno fijo de un mensaje de 96 bytes: dos
+ * compresiones por iteración en lugar de las cuatro de un HMAC completo.
+ */
+QByteArray PasswordHasher::pbkdf2Sha256(const QByteArray& password, const QByteArray& salt, int iterations,
+                                        int keyLength)
+{
+    const int hashLength = 32;
+    const HmacSha256Key key = prepareHmacKey(password);
+
+    // Bloque de una iteración: 32 bytes de resumen, 0x80, ceros y la longitud (64 + 32) * 8 bits
+    quint32 block[16] = {};
+    block[8] = 0x80000000u;
+    block[15] = (kSha256BlockBytes + hashLength) * 8;
+
+    QByteArray derived;
+    derived.reserve(keyLength + hashLength);
+    QByteArray first = salt;
+    first.append(4, '\0');
+    for (quint32 blockIndex = 1; derived.size() < keyLength; ++blockIndex) {
+        for (int i = 0; i < 4; ++i) {
+            first[first.size() - 4 + i] = static_cast<char>(blockIndex >> (24 - 8 * i));
+        }
+
+        // U1 = HMAC(P, S || INT(i))
+        quint32 u[8];
+        std::copy(key.inner, key.inner + 8, u);
+        sha256Finish(u, first.constData(), static_cast<int>(first.size()), kSha256BlockBytes);
+        std::copy(u, u + 8, block);
+        std::copy(key.outer, key.outer + 8, u);
+        sha256Compress(u, block);
+
+        quint32 t[8];
+        std::copy(u, u + 8, t);
+        for (int n = 1; n < iterations; ++n) {
+            std::copy(u, u + 8, block);
+            std::copy(key.inner, key.inner + 8, u);
+            sha256Compress(u, block);
+            std::copy(u, u + 8, block);
+            std::copy(key.outer, key.outer + 8, u);
+            sha256Compress(u, block);
+            for (int i = 0; i < 8; ++i) {
+                t[i] ^= u[i];
+            }
+        }
+
+        for (int i = 0; i < 8; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                derived.append(static_cast<char>(t[i] >> (24 - 8 * j)));
+            }
+        }
+    }
+    derived.truncate(keyLength);
+    return derived;
+}
+
+/**
+ * @brief Compara dos cadenas en tiempo que no depende de dónde difieren.
+ * @param a Primera cadena.
+ * @param b Segunda cadena.
+ * @return true si son iguales.
+ */
+bool PasswordHasher::constantTimeEquals(const QByteArray& a, const QByteArray& b)
+{
+    unsigned char difference = a.size() == b.size() ? 0 : 1;
+    const int length = static_cast<int>(std::min(a.size(), b.size()));
+    for (int i = 0; i < length; ++i) {
+        difference |= static_cast<unsigned char>(a[i] ^ b[i]);
+    }
+    return difference == 0;
+}
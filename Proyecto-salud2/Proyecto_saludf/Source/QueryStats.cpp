@@ -0,0 +1,413 @@
+/**
+ * @file QueryStats.cpp
+ * @brief Implementación de la clase QueryStats, latencias por consulta y registro de consultas lentas.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "QueryStats.h"
+#include "Logging.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include <QSqlDriver>
+#include <QSqlQuery>
+#include <QSqlResult>
+#include <QStringList>
+#include <QVariant>
+#include <algorithm>
+#include <memory>
+
+namespace {
+/**
+ * @brief Umbral de consultas lentas por defecto, en milisegundos.
+ */
+const int kDefaultSlowQueryMs = 100;
+
+/**
+ * @brief Bytes que ocupa un parámetro enlazado.
+ * @param value Valor del parámetro.
+ * @return Bytes de texto o binario, 8 para números y 0 para NULL.
+ */
+qint64 boundBytes(const QVariant& value)
+{
+    if (value.isNull()) {
+        return 0;
+    }
+    switch (static_cast<QMetaType::Type>(value.userType())) {
+    case QMetaType::QString:
+        return value.toString().size() * 2;
+    case QMetaType::QByteArray:
+        return value.toByteArray().size();
+    default:
+        return 8;
+    }
+}
+
+/**
+ * @brief Describe un parámetro sin mostrar su valor.
+ * @param value Valor del parámetro.
+ * @return "NULL", "<texto:N>", "<binario:N>" o "<número>".
+ */
+QString redacted(const QVariant& value)
+{
+    if (value.isNull()) {
+        return QStringLiteral("NULL");
+    }
+    switch (static_cast<QMetaType::Type>(value.userType())) {
+    case QMetaType::QString:
+        return QStringLiteral("<texto:%1>").arg(value.toString().size());
+    case QMetaType::QByteArray:
+        return QStringLiteral("<binario:%1>").arg(value.toByteArray().size());
+    case QMetaType::QDateTime:
+    case QMetaType::QDate:
+    case QMetaType::QTime:
+        return QStringLiteral("<fecha>");
+    default:
+        return QStringLiteral("<número>");
+    }
+}
+
+/**
+ * @brief Número de parámetros enlazados de una consulta.
+ * @param query Consulta.
+ * @return Cantidad de parámetros.
+ */
+int boundCount(const QSqlQuery& query)
+{
+    return static_cast<int>(query.boundValues().size());
+}
+}
+
+/**
+ * @brief Inicia la medición.
+ * @param name Nombre del punto de entrada; debe ser una cadena literal.
+ */
+QueryStats::Scope::Scope(const char* name)
+    : m_name(name), m_start(std::chrono::steady_clock::now()), m_rows(0), m_span("db", name)
+{
+}
+
+/**
+ * @brief Registra el tiempo transcurrido y las filas.
+ */
+QueryStats::Scope::~Scope()
+{
+    const qint64 elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - m_start).count();
+    Record* entry = QueryStats::instance().record(EntryPoint, QLatin1String(m_name));
+    entry->latency.record(elapsed);
+    entry->calls.fetch_add(1, std::memory_order_relaxed);
+    if (m_rows > 0) {
+        entry->rows.fetch_add(static_cast<quint64>(m_rows), std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Suma filas devueltas por el punto de entrada.
+ * @param rows Número de filas.
+ */
+void QueryStats::Scope::addRows(qint64 rows)
+{
+    m_rows += rows;
+}
+
+/**
+ * @brief Obtiene la instancia única de QueryStats.
+ * @return Referencia a la instancia singleton.
+ */
+QueryStats& QueryStats::instance()
+{
+    static QueryStats instance;
+    return instance;
+}
+
+/**
+ * @brief Constructor privado. Lee el umbral de SALUD_SLOW_QUERY_MS si está definido.
+ *
+ * Registra en Metrics la latencia de cada punto de entrada (salud_db_call_duration_seconds,
+ * con la etiqueta "entry") y los totales de errores y consultas lentas. Las sentencias no se
+ * exportan una por una, para no usar el texto SQL como etiqueta.
+ */
+QueryStats::QueryStats()
+    : m_slowThresholdNs(static_cast<qint64>(kDefaultSlowQueryMs) * 1000000)
+{
+    bool ok = false;
+    const int milliseconds = qEnvironmentVariableIntValue("SALUD_SLOW_QUERY_MS", &ok);
+    if (ok) {
+        setSlowQueryThreshold(milliseconds);
+    }
+
+    Metrics::instance().collect([this](QVector<Metrics::Sample>& samples) {
+        Metrics::Sample errors;
+        errors.name = QStringLiteral("salud_sql_errors_total");
+        errors.help = QStringLiteral("Sentencias SQL que fallaron.");
+        errors.type = Metrics::CounterType;
+        Metrics::Sample slow;
+        slow.name = QStringLiteral("salud_sql_slow_total");
+        slow.help = QStringLiteral("Sentencias SQL que superaron el umbral de consultas lentas.");
+        slow.type = Metrics::CounterType;
+
+        const QVector<Entry> entries = snapshot();
+        for (const Entry& entry : entries) {
+            if (entry.kind == Statement) {
+                errors.value += static_cast<double>(entry.errors);
+                slow.value += static_cast<double>(entry.slow);
+                continue;
+            }
+            Metrics::Sample call;
+            call.name = QStringLiteral("salud_db_call_duration_seconds");
+            call.help = QStringLiteral("Duración de los métodos públicos de DatabaseManager.");
+            call.type = Metrics::SummaryType;
+            call.labels.append(qMakePair(QStringLiteral("entry"), entry.name));
+            call.summary = entry.latency;
+            samples.append(call);
+        }
+        samples.append(errors);
+        samples.append(slow);
+    });
+}
+
+/**
+ * @brief Destructor. Libera las entradas.
+ */
+QueryStats::~QueryStats()
+{
+    qDeleteAll(m_records);
+}
+
+/**
+ * @brief Ejecuta una consulta preparada y registra su latencia.
+ * @param query Consulta preparada con sus parámetros enlazados.
+ * @return El resultado de QSqlQuery::exec().
+ */
+bool QueryStats::exec(QSqlQuery& query)
+{
+    const qint64 start = Trace::now();
+    const bool ok = query.exec();
+    instance().finishExec(query, ok, start, Trace::now() - start);
+    return ok;
+}
+
+/**
+ * @brief Ejecuta una sentencia directa y registra su latencia.
+ * @param query Consulta sobre la conexión deseada.
+ * @param sql Sentencia a ejecutar.
+ * @return El resultado de QSqlQuery::exec(sql).
+ */
+bool QueryStats::exec(QSqlQuery& query, const QString& sql)
+{
+    const qint64 start = Trace::now();
+    const bool ok = query.exec(sql);
+    instance().finishExec(query, ok, start, Trace::now() - start);
+    return ok;
+}
+
+/**
+ * @brief Cambia el umbral de consultas lentas.
+ * @param milliseconds Umbral en milisegundos; 0 o negativo desactiva el registro.
+ */
+void QueryStats::setSlowQueryThreshold(int milliseconds)
+{
+    m_slowThresholdNs.store(milliseconds > 0 ? static_cast<qint64>(milliseconds) * 1000000 : 0);
+}
+
+/**
+ * @brief Umbral de consultas lentas.
+ * @return Umbral en milisegundos, o 0 si está desactivado.
+ */
+int QueryStats::slowQueryThreshold() const
+{
+    return static_cast<int>(m_slowThresholdNs.load() / 1000000);
+}
+
+/**
+ * @brief Busca o crea la entrada de una sentencia o punto de entrada.
+ * @param kind Tipo de la entrada.
+ * @param name Texto o nombre.
+ * @return Entrada, válida mientras viva la instancia.
+ *
+ * La búsqueda común solo toma el candado de lectura; el de escritura se toma una vez por
+ * sentencia nueva.
+ */
+QueryStats::Record* QueryStats::record(Kind kind, const QString& name)
+{
+    const QString key = (kind == EntryPoint ? QLatin1String("E:") : QLatin1String("S:")) + name;
+    {
+        QReadLocker locker(&m_lock);
+        const auto found = m_records.constFind(key);
+        if (found != m_records.constEnd()) {
+            return found.value();
+        }
+    }
+
+    QWriteLocker locker(&m_lock);
+    Record*& entry = m_records[key];
+    if (!entry) {
+        entry = new Record;
+        entry->kind = kind;
+        entry->name = name;
+        entry->traceName = name.simplified().toUtf8();
+    }
+    return entry;
+}
+
+/**
+ * @brief Registra una ejecución ya terminada.
+ * @param query Consulta ejecutada.
+ * @param ok Resultado de exec().
+ * @param start Inicio de exec(), según Trace::now().
+ * @param nanoseconds Duración de exec().
+ *
+ * Con la traza activa, la ejecución se registra también como intervalo "sql" con el texto de
+ * la sentencia. Para las escrituras se suman las filas afectadas; las lecturas cuentan sus filas en el punto
+ * de entrada que las recorre (Scope::addRows), ya que exec() aún no las conoce.
+ */
+void QueryStats::finishExec(QSqlQuery& query, bool ok, qint64 start, qint64 nanoseconds)
+{
+    Record* entry = record(Statement, query.lastQuery());
+    entry->latency.record(nanoseconds);
+    if (Trace::enabled()) {
+        Trace::complete("sql", entry->traceName.constData(), start, nanoseconds);
+    }
+    entry->calls.fetch_add(1, std::memory_order_relaxed);
+
+    const int parameters = boundCount(query);
+    if (parameters > 0) {
+        qint64 bytes = 0;
+        for (int i = 0; i < parameters; ++i) {
+            bytes += boundBytes(query.boundValue(i));
+        }
+        entry->bytesBound.fetch_add(static_cast<quint64>(bytes), std::memory_order_relaxed);
+    }
+
+    if (!ok) {
+        entry->errors.fetch_add(1, std::memory_order_relaxed);
+    } else if (!query.isSelect()) {
+        const int affected = query.numRowsAffected();
+        if (affected > 0) {
+            entry->rows.fetch_add(static_cast<quint64>(affected), std::memory_order_relaxed);
+        }
+    }
+
+    const qint64 threshold = m_slowThresholdNs.load(std::memory_order_relaxed);
+    if (threshold > 0 && nanoseconds >= threshold) {
+        entry->slow.fetch_add(1, std::memory_order_relaxed);
+        logSlowQuery(query, nanoseconds);
+    }
+}
+
+/**
+ * @brief Registra una consulta lenta con sus parámetros sin valores y su plan.
+ * @param query Consulta ejecutada.
+ * @param nanoseconds Duración de exec().
+ *
+ * El plan se obtiene con una consulta nueva sobre el mismo controlador (y por lo tanto la misma
+ * conexión), con los mismos parámetros enlazados por posición. Las sentencias de esquema
+ * (CREATE, ALTER, PRAGMA) no tienen plan.
+ */
+void QueryStats::logSlowQuery(QSqlQuery& query, qint64 nanoseconds)
+{
+    const QString sql = query.lastQuery();
+    const int parameters = boundCount(query);
+    QStringList described;
+    for (int i = 0; i < parameters; ++i) {
+        described << redacted(query.boundValue(i));
+    }
+
+    qCWarning(lcDb).noquote() << QStringLiteral("Consulta lenta (%1 ms): %2 | parámetros: [%3]")
+                                     .arg(nanoseconds / 1e6, 0, 'f', 1)
+                                     .arg(sql.simplified(), described.join(", "));
+
+    const QString verb = sql.trimmed().section(' ', 0, 0).toUpper();
+    const QStringList explainable = {"SELECT", "INSERT", "UPDATE", "DELETE", "WITH", "REPLACE"};
+    if (!explainable.contains(verb) || !query.driver()) {
+        return;
+    }
+
+    QSqlQuery plan(query.driver()->createResult());
+    if (!plan.prepare("EXPLAIN QUERY PLAN " + sql)) {
+        return;
+    }
+    for (int i = 0; i < parameters; ++i) {
+        plan.bindValue(i, query.boundValue(i));
+    }
+    if (!plan.exec()) {
+        qCDebug(lcDb) << "No se pudo obtener el plan de la consulta lenta";
+        return;
+    }
+    while (plan.next()) {
+        // Columnas de SQLite: id, parent, notused, detail
+        qCWarning(lcDb).noquote() << "  plan:" << plan.value(3).toString();
+    }
+}
+
+/**
+ * @brief Foto de todas las entradas, de mayor a menor tiempo total.
+ * @return Estadísticas por sentencia y por punto de entrada.
+ */
+QVector<QueryStats::Entry> QueryStats::snapshot() const
+{
+    QVector<Entry> entries;
+    QReadLocker locker(&m_lock);
+    entries.reserve(m_records.size());
+    for (const Record* record : m_records) {
+        Entry entry;
+        entry.kind = record->kind;
+        entry.name = record->name;
+        entry.calls = record->calls.load(std::memory_order_relaxed);
+        entry.errors = record->errors.load(std::memory_order_relaxed);
+        entry.rows = record->rows.load(std::memory_order_relaxed);
+        entry.bytesBound = record->bytesBound.load(std::memory_order_relaxed);
+        entry.slow = record->slow.load(std::memory_order_relaxed);
+        entry.latency = record->latency.summary();
+        entries.append(entry);
+    }
+    locker.unlock();
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.latency.total > b.latency.total;
+    });
+    return entries;
+}
+
+/**
+ * @brief Foto en forma de tabla de texto, para registrar o mostrar.
+ * @return Una línea por entrada con llamadas, latencias en microsegundos, filas y bytes.
+ */
+QString QueryStats::report() const
+{
+    QStringList lines;
+    lines << QStringLiteral("tipo  llamadas errores lentas  p50_us  p99_us  max_us  total_ms  filas  bytes  nombre");
+    const QVector<Entry> entries = snapshot();
+    for (const Entry& entry : entries) {
+        lines << QStringLiteral("%1 %2 %3 %4 %5 %6 %7 %8 %9 %10  %11")
+                     .arg(entry.kind == EntryPoint ? "api " : "sql ")
+                     .arg(entry.calls, 8)
+                     .arg(entry.errors, 7)
+                     .arg(entry.slow, 6)
+                     .arg(entry.latency.p50 / 1000, 7)
+                     .arg(entry.latency.p99 / 1000, 7)
+                     .arg(entry.latency.max / 1000, 7)
+                     .arg(entry.latency.total / 1000000, 9)
+                     .arg(entry.rows, 6)
+                     .arg(entry.bytesBound, 6)
+                     .arg(entry.name.simplified());
+    }
+    return lines.join('\n');
+}
+
+/**
+ * @brief Vacía las estadísticas, conservando las entradas conocidas.
+ */
+void QueryStats::reset()
+{
+    QReadLocker locker(&m_lock);
+    for (Record* record : m_records) {
+        record->latency.reset();
+        record->calls.store(0);
+        record->errors.store(0);
+        record->rows.store(0);
+        record->bytesBound.store(0);
+        record->slow.store(0);
+    }
+}
@@ -0,0 +1,327 @@
+/**
+ * @file RecordValidator.cpp
+ * @brief Implementación de la clase RecordValidator, reglas de validación comunes a la captura manual y a los importadores.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "RecordValidator.h"
+#include <QByteArray>
+#include <cmath>
+
+namespace {
+/**
+ * @brief Potencias de diez exactas en doble precisión.
+ */
+const double kPowersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+ * @brief Indica si un byte es un dígito ASCII.
+ * @param c Byte.
+ * @return true si está entre '0' y '9'.
+ */
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/**
+ * @brief Quita espacios y tabuladores a ambos lados de un rango.
+ * @param begin Inicio del rango; se avanza.
+ * @param end Fin del rango; se retrocede.
+ */
+inline void trim(const char*& begin, const char*& end)
+{
+    while (begin < end && (*begin == ' ' || *begin == '\t')) {
+        ++begin;
+    }
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t')) {
+        --end;
+    }
+}
+
+/**
+ * @brief Lee un número de ancho fijo.
+ * @param p Posición; se avanza si la lectura tiene éxito.
+ * @param end Fin del texto.
+ * @param width Número de dígitos.
+ * @param value Valor leído.
+ * @return true si había width dígitos.
+ */
+inline bool readFixed(const char*& p, const char* end, int width, int* value)
+{
+    if (end - p < width) {
+        return false;
+    }
+    int result = 0;
+    for (int i = 0; i < width; ++i) {
+        if (!isDigit(p[i])) {
+            return false;
+        }
+        result = result * 10 + (p[i] - '0');
+    }
+    p += width;
+    *value = result;
+    return true;
+}
+}
+
+/**
+ * @brief Valida los campos tal como los escribe el usuario en el formulario.
+ * @param weight Texto del peso.
+ * @param bloodPressure Texto de la presión arterial.
+ * @param glucose Texto de la glucosa.
+ * @param weightValue Peso convertido, si es válido.
+ * @param glucoseValue Glucosa convertida, si es válida.
+ * @return Resultado de la validación.
+ */
+RecordValidator::Result RecordValidator::validate(const QString& weight, const QString& bloodPressure,
+                                                  const QString& glucose, float* weightValue, float* glucoseValue)
+{
+    const QByteArray weightBytes = weight.toUtf8();
+    const QByteArray bloodPressureBytes = bloodPressure.toUtf8();
+    const QByteArray glucoseBytes = glucose.toUtf8();
+    return validate(weightBytes.constData(), weightBytes.size(),
+                    bloodPressureBytes.constData(), bloodPressureBytes.size(),
+                    glucoseBytes.constData(), glucoseBytes.size(), weightValue, glucoseValue);
+}
+
+/**
+ * @brief Valida campos en bytes (ASCII/UTF-8) sin reservar memoria.
+ * @param weight Inicio del peso.
+ * @param weightSize Bytes del peso.
+ * @param bloodPressure Inicio de la presión arterial.
+ * @param bloodPressureSize Bytes de la presión arterial.
+ * @param glucose Inicio de la glucosa.
+ * @param glucoseSize Bytes de la glucosa.
+ * @param weightValue Peso convertido, si es válido.
+ * @param glucoseValue Glucosa convertida, si es válida.
+ * @return Resultado de la validación.
+ */
+RecordValidator::Result RecordValidator::validate(const char* weight, int weightSize,
+                                                  const char* bloodPressure, int bloodPressureSize,
+                                                  const char* glucose, int glucoseSize,
+                                                  float* weightValue, float* glucoseValue)
+{
+    const char* weightEnd = weight + weightSize;
+    const char* bloodPressureEnd = bloodPressure + bloodPressureSize;
+    const char* glucoseEnd = glucose + glucoseSize;
+    trim(weight, weightEnd);
+    trim(bloodPressure, bloodPressureEnd);
+    trim(glucose, glucoseEnd);
+
+    if (weight == weightEnd || bloodPressure == bloodPressureEnd || glucose == glucoseEnd) {
+        return MissingField;
+    }
+    if (!parseFloat(weight, weightEnd, weightValue) || !parseFloat(glucose, glucoseEnd, glucoseValue)) {
+        return InvalidNumber;
+    }
+    int systolic = 0;
+    int diastolic = 0;
+    if (!parseBloodPressure(bloodPressure, bloodPressureEnd, &systolic, &diastolic)) {
+        return InvalidBloodPressure;
+    }
+    return Valid;
+}
+
+/**
+ * @brief Mensaje para el usuario correspondiente a un resultado.
+ * @param result Resultado de una validación.
+ * @return Mensaje en español.
+ */
+QString RecordValidator::message(Result result)
+{
+    switch (result) {
+    case MissingField:
+        return "Por favor completa todos los campos.";
+    case InvalidNumber:
+        return "Por favor ingresa valores numéricos válidos para peso y glucosa.";
+    case InvalidBloodPressure:
+        return "La presión arterial debe tener el formato 'sistólica/diastólica'.";
+    case InvalidDateTime:
+        return "La fecha y hora no es válida.";
+    case Valid:
+        break;
+    }
+    return QString();
+}
+
+/**
+ * @brief Convierte un número decimal con punto, con signo y exponente opcionales.
+ * @param begin Inicio del texto.
+ * @param end Fin del texto.
+ * @param value Valor convertido.
+ * @return true si todo el texto (salvo espacios a los lados) es un número finito.
+ *
+ * Acumula hasta 19 dígitos significativos en un entero y aplica la potencia de diez al
+ * final, suficiente para la precisión de un float.
+ */
+bool RecordValidator::parseFloat(const char* begin, const char* end, float* value)
+{
+    trim(begin, end);
+    const char* p = begin;
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-')) {
+        negative = *p == '-';
+        ++p;
+    }
+
+    quint64 mantissa = 0;
+    int significant = 0;
+    int exponent = 0;
+    bool anyDigit = false;
+    for (; p < end && isDigit(*p); ++p) {
+        anyDigit = true;
+        if (significant < 19) {
+            mantissa = mantissa * 10 + static_cast<quint64>(*p - '0');
+            significant += mantissa != 0 ? 1 : 0;
+        } else {
+            ++exponent;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && isDigit(*p); ++p) {
+            anyDigit = true;
+            if (significant < 19) {
+                mantissa = mantissa * 10 + static_cast<quint64>(*p - '0');
+                significant += mantissa != 0 ? 1 : 0;
+                --exponent;
+            }
+        }
+    }
+    if (!anyDigit) {
+        return false;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negativeExponent = false;
+        if (p < end && (*p == '+' || *p == '-')) {
+            negativeExponent = *p == '-';
+            ++p;
+        }
+        if (p == end || !isDigit(*p)) {
+            return false;
+        }
+        int explicitExponent = 0;
+        for (; p < end && isDigit(*p); ++p) {
+            if (explicitExponent < 10000) {
+                explicitExponent = explicitExponent * 10 + (*p - '0');
+            }
+        }
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+    }
+    if (p != end) {
+        return false;
+    }
+
+    double result = static_cast<double>(mantissa);
+    if (mantissa != 0) {
+        const int magnitude = exponent < 0 ? -exponent : exponent;
+        const double scale = magnitude <= 22 ? kPowersOfTen[magnitude] : std::pow(10.0, magnitude);
+        result = exponent < 0 ? result / scale : result * scale;
+    }
+    const float narrowed = static_cast<float>(negative ? -result : result);
+    if (!std::isfinite(narrowed)) {
+        return false;
+    }
+    *value = narrowed;
+    return true;
+}
+
+/**
+ * @brief Separa una presión "sistólica/diastólica" en bytes.
+ * @param begin Inicio del texto.
+ * @param end Fin del texto.
+ * @param systolic Presión sistólica resultante.
+ * @param diastolic Presión diastólica resultante.
+ * @return true si ambos valores son enteros positivos, false en caso contrario.
+ *
+ * Se admiten espacios alrededor de cada número, pero no dentro de él.
+ */
+bool RecordValidator::parseBloodPressure(const char* begin, const char* end, int* systolic, int* diastolic)
+{
+    int values[2] = {0, 0};
+    int digits[2] = {0, 0};
+    bool closed[2] = {false, false};
+    int part = 0;
+    for (const char* p = begin; p < end; ++p) {
+        const char c = *p;
+        if (isDigit(c)) {
+            if (closed[part] || values[part] > 9999) {
+                return false;
+            }
+            values[part] = values[part] * 10 + (c - '0');
+            ++digits[part];
+        } else if (c == '/' && part == 0) {
+            part = 1;
+        } else if (c == ' ') {
+            closed[part] = digits[part] > 0;
+        } else {
+            return false;
+        }
+    }
+    if (part != 1 || digits[0] == 0 || digits[1] == 0 || values[0] <= 0 || values[1] <= 0) {
+        return false;
+    }
+    *systolic = values[0];
+    *diastolic = values[1];
+    return true;
+}
+
+/**
+ * @brief Convierte una fecha "yyyy-MM-dd hh:mm[:ss[.zzz]]" (también con 'T') sin reservar memoria.
+ * @param begin Inicio del texto.
+ * @param end Fin del texto.
+ * @param dateTime Fecha y hora resultante, en hora local como las del formulario.
+ * @return true si la fecha es válida, false en caso contrario.
+ *
+ * Una fecha sin hora se interpreta como medianoche. Las fracciones de segundo más allá de
+ * los milisegundos se ignoran.
+ */
+bool RecordValidator::parseDateTime(const char* begin, const char* end, QDateTime* dateTime)
+{
+    trim(begin, end);
+    const char* p = begin;
+    int year = 0;
+    int month = 0;
+    int day = 0;
+    int hour = 0;
+    int minute = 0;
+    int second = 0;
+    int millisecond = 0;
+
+    if (!readFixed(p, end, 4, &year) || p == end || *p++ != '-' || !readFixed(p, end, 2, &month)
+        || p == end || *p++ != '-' || !readFixed(p, end, 2, &day)) {
+        return false;
+    }
+    if (p < end) {
+        if ((*p != ' ' && *p != 'T') || !readFixed(++p, end, 2, &hour) || p == end || *p++ != ':'
+            || !readFixed(p, end, 2, &minute)) {
+            return false;
+        }
+        if (p < end && *p == ':') {
+            if (!readFixed(++p, end, 2, &second)) {
+                return false;
+            }
+            if (p < end && *p == '.') {
+                int scale = 100;
+                for (++p; p < end && isDigit(*p); ++p) {
+                    millisecond += (*p - '0') * scale;
+                    scale /= 10;
+                }
+            }
+        }
+        if (p != end) {
+            return false;
+        }
+    }
+
+    if (!QDate::isValid(year, month, day) || !QTime::isValid(hour, minute, second, millisecond)) {
+        return false;
+    }
+    *dateTime = QDateTime(QDate(year, month, day), QTime(hour, minute, second, millisecond));
+    return true;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file Session.cpp
+ * @brief Implementación de la clase Session, datos del usuario autenticado durante una sesión.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "Session.h"
+#include "DatabaseManager.h"
+
+/**
+ * @brief Constructor de una sesión vacía (no válida).
+ */
+Session::Session()
+    : m_userId(0)
+{
+}
+
+/**
+ * @brief Constructor con los datos del usuario.
+ * @param userId Identificador del usuario.
+ * @param displayName Nombre para mostrar.
+ * @param preferences Preferencias guardadas del usuario.
+ */
+Session::Session(int userId, const QString& displayName, const QHash<QString, QString>& preferences)
+    : m_userId(userId), m_displayName(displayName), m_preferences(preferences)
+{
+}
+
+/**
+ * @brief Indica si la sesión corresponde a un usuario autenticado.
+ * @return true si el identificador es válido.
+ */
+bool Session::isValid() const
+{
+    return m_userId > 0;
+}
+
+/**
+ * @brief Identificador del usuario.
+ * @return Identificador, o 0 si la sesión no es válida.
+ */
+int Session::userId() const
+{
+    return m_userId;
+}
+
+/**
+ * @brief Nombre para mostrar del usuario.
+ * @return Nombre de usuario.
+ */
+QString Session::displayName() const
+{
+    return m_displayName;
+}
+
+/**
+ * @brief Lee una preferencia del usuario.
+ * @param key Nombre de la preferencia.
+ * @param defaultValue Valor si la preferencia no existe.
+ * @return Valor guardado o defaultValue.
+ */
+QString Session::preference(const QString& key, const QString& defaultValue) const
+{
+    return m_preferences.value(key, defaultValue);
+}
+
+/**
+ * @brief Cambia una preferencia y la guarda en la base de datos.
+ * @param key Nombre de la preferencia.
+ * @param value Nuevo valor.
+ * @return true si se guarda, false en caso contrario.
+ *
+ * La copia local solo cambia si la base de datos acepta el valor; DatabaseManager descarta
+ * además la entrada del usuario en su caché, que se vuelve a leer en la próxima consulta.
+ */
+bool Session::setPreference(const QString& key, const QString& value)
+{
+    if (!isValid()) {
+        return false;
+    }
+    if (m_preferences.value(key) == value && m_preferences.contains(key)) {
+        return true;
+    }
+    if (!DatabaseManager::instance().setUserPreference(m_userId, key, value)) {
+        return false;
+    }
+    m_preferences.insert(key, value);
+    return true;
+}
+
+/**
+ * @brief Todas las preferencias del usuario.
+ * @return Preferencias por nombre.
+ */
+QHash<QString, QString> Session::preferences() const
+{
+    return m_preferences;
+}
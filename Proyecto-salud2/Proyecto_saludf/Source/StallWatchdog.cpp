@@ -0,0 +1,304 @@
+/**
+ * @file StallWatchdog.cpp
+ * @brief Implementación de la clase StallWatchdog, detección de bloqueos del bucle de eventos principal.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "StallWatchdog.h"
+#include "Logging.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include <QCoreApplication>
+#include <QKeySequence>
+#include <QMessageBox>
+#include <QMutexLocker>
+#include <QShortcut>
+#include <QStringList>
+#include <QThread>
+#include <QWidget>
+#include <algorithm>
+
+namespace {
+/**
+ * @brief Texto de la atribución cuando no había intervalos abiertos.
+ */
+const QString kNoSpan = QStringLiteral("(sin intervalo activo)");
+
+/**
+ * @brief Convierte nanosegundos a milisegundos con un decimal.
+ * @param nanoseconds Duración.
+ * @return Texto en milisegundos.
+ */
+QString milliseconds(qint64 nanoseconds)
+{
+    return QString::number(nanoseconds / 1e6, 'f', 1);
+}
+}
+
+/**
+ * @brief Obtiene la instancia única de StallWatchdog.
+ * @return Referencia a la instancia singleton.
+ */
+StallWatchdog& StallWatchdog::instance()
+{
+    static StallWatchdog instance;
+    return instance;
+}
+
+/**
+ * @brief Constructor privado para implementar el patrón singleton.
+ *
+ * Registra en Metrics la distribución de los bloqueos (salud_ui_stall_seconds).
+ */
+StallWatchdog::StallWatchdog()
+    : m_heartbeat(nullptr),
+      m_guiThread(nullptr),
+      m_running(false),
+      m_thresholdNs(static_cast<qint64>(kDefaultThresholdMs) * 1000000),
+      m_answeredBeat(-1),
+      m_answeredAt(-1)
+{
+    Metrics::instance().collect([this](QVector<Metrics::Sample>& samples) {
+        Metrics::Sample stalls;
+        stalls.name = QStringLiteral("salud_ui_stall_seconds");
+        stalls.help = QStringLiteral("Bloqueos del bucle de eventos de la interfaz.");
+        stalls.type = Metrics::SummaryType;
+        stalls.summary = summary();
+        samples.append(stalls);
+    });
+}
+
+/**
+ * @brief Destructor. Detiene el hilo vigilante.
+ */
+StallWatchdog::~StallWatchdog()
+{
+    stop();
+}
+
+/**
+ * @brief Inicia el hilo vigilante. Debe llamarse desde el hilo principal.
+ * @param thresholdMs Duración a partir de la cual se considera un bloqueo.
+ * @return true si se inició; false si ya estaba en marcha o no hay QCoreApplication.
+ *
+ * Activa el modo Trace::Marking para que los intervalos abiertos del hilo principal se puedan
+ * consultar desde el vigilante.
+ */
+bool StallWatchdog::start(int thresholdMs)
+{
+    if (m_running.load() || !QCoreApplication::instance()) {
+        return false;
+    }
+    setThreshold(thresholdMs);
+    m_guiThread = QCoreApplication::instance()->thread();
+    m_heartbeat = new QObject;
+    m_answeredBeat.store(-1);
+    Trace::instance().setMarking(true);
+
+    m_running.store(true);
+    m_watcher = std::thread(&StallWatchdog::watchLoop, this);
+    qCInfo(lcUi) << "Vigilancia de bloqueos de la interfaz activada, umbral:" << threshold() << "ms";
+    return true;
+}
+
+/**
+ * @brief Detiene el hilo vigilante. Debe llamarse desde el hilo principal.
+ *
+ * Los latidos aún encolados se descartan al destruir el objeto que los recibe.
+ */
+void StallWatchdog::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        if (!m_running.exchange(false)) {
+            return;
+        }
+    }
+    m_wakeCondition.notify_all();
+    if (m_watcher.joinable()) {
+        m_watcher.join();
+    }
+    Trace::instance().setMarking(false);
+    delete m_heartbeat;
+    m_heartbeat = nullptr;
+}
+
+/**
+ * @brief Indica si el vigilante está en marcha.
+ * @return true entre start() y stop().
+ */
+bool StallWatchdog::isRunning() const
+{
+    return m_running.load();
+}
+
+/**
+ * @brief Cambia el umbral de bloqueo.
+ * @param milliseconds Umbral en milisegundos; los valores menores que 1 se toman como 1.
+ */
+void StallWatchdog::setThreshold(int milliseconds)
+{
+    m_thresholdNs.store(static_cast<qint64>(qMax(1, milliseconds)) * 1000000);
+}
+
+/**
+ * @brief Umbral de bloqueo.
+ * @return Umbral en milisegundos.
+ */
+int StallWatchdog::threshold() const
+{
+    return static_cast<int>(m_thresholdNs.load() / 1000000);
+}
+
+/**
+ * @brief Ciclo del hilo vigilante.
+ *
+ * Envía un latido, y mientras no se atiende revisa cada cuarto de umbral si ya lleva más que el
+ * umbral; en ese caso toma muestras de los intervalos abiertos del hilo principal y conserva la
+ * más profunda. Cuando el latido se atiende, su demora es la duración del bloqueo. Un bloqueo que
+ * empiece entre dos latidos se mide con hasta un cuarto de umbral de menos.
+ */
+void StallWatchdog::watchLoop()
+{
+    qint64 sentAt = -1;
+    QStringList spans;
+
+    while (m_running.load()) {
+        const qint64 threshold = m_thresholdNs.load(std::memory_order_relaxed);
+        const qint64 now = Trace::now();
+
+        if (sentAt < 0) {
+            sentAt = now;
+            spans.clear();
+            const qint64 beat = sentAt;
+            QMetaObject::invokeMethod(m_heartbeat, [this, beat]() {
+                m_answeredAt.store(Trace::now(), std::memory_order_relaxed);
+                m_answeredBeat.store(beat, std::memory_order_release);
+            }, Qt::QueuedConnection);
+        } else if (m_answeredBeat.load(std::memory_order_acquire) == sentAt) {
+            const qint64 delay = m_answeredAt.load(std::memory_order_relaxed) - sentAt;
+            if (delay >= threshold) {
+                recordStall(delay, spans);
+            }
+            sentAt = -1;
+            continue;
+        } else if (now - sentAt >= threshold) {
+            const QStringList sample = Trace::instance().activeSpans(m_guiThread);
+            if (sample.size() > spans.size()) {
+                spans = sample;
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_wakeCondition.wait_for(lock, std::chrono::nanoseconds(qMax<qint64>(threshold / 4, 1000000)),
+                                 [this]() { return !m_running.load(); });
+    }
+}
+
+/**
+ * @brief Registra un bloqueo terminado.
+ * @param nanoseconds Duración del bloqueo.
+ * @param spans Intervalos abiertos durante el bloqueo.
+ */
+void StallWatchdog::recordStall(qint64 nanoseconds, const QStringList& spans)
+{
+    const QString key = spans.isEmpty() ? kNoSpan : spans.join(" > ");
+    m_histogram.record(nanoseconds);
+    {
+        QMutexLocker locker(&m_mutex);
+        Attribution& attribution = m_attributions[key];
+        attribution.spans = key;
+        attribution.count += 1;
+        attribution.total += nanoseconds;
+        attribution.max = qMax(attribution.max, nanoseconds);
+    }
+    qCWarning(lcUi).noquote() << QStringLiteral("Interfaz bloqueada %1 ms en: %2").arg(milliseconds(nanoseconds), key);
+}
+
+/**
+ * @brief Resumen de las duraciones de los bloqueos.
+ * @return Conteo, extremos y percentiles en nanosegundos.
+ */
+LatencyHistogram::Summary StallWatchdog::summary() const
+{
+    return m_histogram.summary();
+}
+
+/**
+ * @brief Bloqueos agrupados por intervalos abiertos, de mayor a menor tiempo total.
+ * @return Una entrada por pila de intervalos distinta.
+ */
+QVector<StallWatchdog::Attribution> StallWatchdog::attributions() const
+{
+    QVector<Attribution> result;
+    {
+        QMutexLocker locker(&m_mutex);
+        result.reserve(m_attributions.size());
+        for (const Attribution& attribution : m_attributions) {
+            result.append(attribution);
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const Attribution& a, const Attribution& b) {
+        return a.total > b.total;
+    });
+    return result;
+}
+
+/**
+ * @brief Informe en texto con el resumen y los puntos calientes.
+ * @return Informe listo para registrar o mostrar.
+ */
+QString StallWatchdog::report() const
+{
+    const LatencyHistogram::Summary stalls = summary();
+    QStringList lines;
+    lines << QStringLiteral("Bloqueos de la interfaz (umbral %1 ms): %2").arg(threshold()).arg(stalls.count);
+    if (!isRunning()) {
+        lines << QStringLiteral("Vigilancia desactivada; se activa con SALUD_STALL_MS=umbral o --stall.");
+    }
+    if (stalls.count == 0) {
+        return lines.join('\n');
+    }
+    lines << QStringLiteral("p50 %1 ms, p90 %2 ms, p99 %3 ms, máximo %4 ms, total %5 ms")
+                 .arg(milliseconds(stalls.p50), milliseconds(stalls.p90), milliseconds(stalls.p99),
+                      milliseconds(stalls.max), milliseconds(stalls.total));
+    lines << QStringLiteral("veces  total_ms  max_ms  intervalos");
+    const QVector<Attribution> entries = attributions();
+    for (const Attribution& entry : entries) {
+        lines << QStringLiteral("%1 %2 %3  %4")
+                     .arg(entry.count, 5)
+                     .arg(milliseconds(entry.total), 9)
+                     .arg(milliseconds(entry.max), 7)
+                     .arg(entry.spans);
+    }
+    return lines.join('\n');
+}
+
+/**
+ * @brief Vacía las estadísticas.
+ */
+void StallWatchdog::reset()
+{
+    m_histogram.reset();
+    QMutexLocker locker(&m_mutex);
+    m_attributions.clear();
+}
+
+/**
+ * @brief Agrega a una ventana el atajo Ctrl+Shift+F12, que registra y muestra el informe.
+ * @param window Ventana; el atajo se destruye con ella.
+ */
+void StallWatchdog::installShortcut(QWidget* window)
+{
+    QShortcut* shortcut = new QShortcut(QKeySequence(QStringLiteral("Ctrl+Shift+F12")), window);
+    QObject::connect(shortcut, &QShortcut::activated, window, [window]() {
+        const QString text = instance().report();
+        qCInfo(lcUi).noquote() << text;
+
+        QMessageBox box(QMessageBox::Information, "Bloqueos de la interfaz",
+                        text.section('\n', 0, 1), QMessageBox::Ok, window);
+        box.setDetailedText(text);
+        box.exec();
+    });
+}
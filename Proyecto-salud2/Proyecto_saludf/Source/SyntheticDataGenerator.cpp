@@ -0,0 +1,259 @@
+/**
+ * @file SyntheticDataGenerator.cpp
+ * @brief Implementación de la clase SyntheticDataGenerator, datos de salud sintéticos y reproducibles.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "SyntheticDataGenerator.h"
+#include <cmath>
+#include <limits>
+
+namespace {
+/**
+ * @brief 2π; M_PI no está disponible en todos los compiladores sin macros adicionales.
+ */
+constexpr double kTwoPi = 6.283185307179586;
+
+/**
+ * @brief Mezcla de splitmix64, usada como generador y para derivar semillas.
+ * @param state Estado; se avanza en cada llamada.
+ * @return Siguiente número de 64 bits.
+ */
+quint64 splitmix64(quint64& state)
+{
+    quint64 z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @class Random
+ * @brief Generador pseudoaleatorio pequeño y reproducible en cualquier plataforma.
+ *
+ * No se usan las distribuciones de <random> porque su salida cambia entre bibliotecas estándar.
+ */
+class Random
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param seed Semilla.
+     */
+    explicit Random(quint64 seed) : m_state(seed) {}
+
+    /**
+     * @brief Número uniforme en [0, 1).
+     * @return Valor con 53 bits de precisión.
+     */
+    double uniform() { return static_cast<double>(splitmix64(m_state) >> 11) * (1.0 / 9007199254740992.0); }
+
+    /**
+     * @brief Número con distribución normal estándar (Box-Muller).
+     * @return Valor con media 0 y desviación 1.
+     */
+    double normal()
+    {
+        const double u1 = 1.0 - uniform();
+        const double u2 = uniform();
+        return std::sqrt(-2.0 * std::log(u1)) * std::cos(kTwoPi * u2);
+    }
+
+private:
+    /**
+     * @brief Estado de splitmix64.
+     */
+    quint64 m_state;
+};
+
+/**
+ * @brief Redondea a una cantidad fija de decimales, como las lecturas de un dispositivo.
+ * @param value Valor.
+ * @param step Resolución (0.1 para el peso, 1 para la glucosa).
+ * @return Valor redondeado.
+ */
+float rounded(double value, double step)
+{
+    return static_cast<float>(std::round(value / step) * step);
+}
+}
+
+/**
+ * @brief Lee las opciones de SALUD_BENCH_SEED, SALUD_BENCH_USERS, SALUD_BENCH_ROWS y SALUD_BENCH_YEARS.
+ * @return Opciones, con los valores por defecto para las variables ausentes o no válidas.
+ */
+SyntheticDataGenerator::Options SyntheticDataGenerator::Options::fromEnvironment()
+{
+    Options options;
+    bool ok = false;
+    const quint64 seed = qEnvironmentVariable("SALUD_BENCH_SEED").toULongLong(&ok);
+    if (ok) {
+        options.seed = seed;
+    }
+    const int users = qEnvironmentVariableIntValue("SALUD_BENCH_USERS", &ok);
+    if (ok && users > 0) {
+        options.users = users;
+    }
+    const qint64 rows = qEnvironmentVariable("SALUD_BENCH_ROWS").toLongLong(&ok);
+    if (ok && rows > 0) {
+        options.rows = rows;
+    }
+    const int years = qEnvironmentVariableIntValue("SALUD_BENCH_YEARS", &ok);
+    if (ok && years > 0) {
+        options.years = years;
+    }
+    return options;
+}
+
+/**
+ * @brief Constructor.
+ * @param options Parámetros del conjunto de datos.
+ */
+SyntheticDataGenerator::SyntheticDataGenerator(const Options& options)
+    : m_options(options)
+{
+}
+
+/**
+ * @brief Parámetros del conjunto de datos.
+ * @return Opciones con las que se creó el generador.
+ */
+const SyntheticDataGenerator::Options& SyntheticDataGenerator::options() const
+{
+    return m_options;
+}
+
+/**
+ * @brief Cuentas de los usuarios sintéticos.
+ * @return Un nombre "sint_000001" y una contraseña por usuario, en orden.
+ */
+QVector<UserRegistration> SyntheticDataGenerator::users() const
+{
+    QVector<UserRegistration> users;
+    users.reserve(m_options.users);
+    for (int i = 0; i < m_options.users; ++i) {
+        const QString number = QString::number(i + 1).rightJustified(6, '0');
+        users.append({QStringLiteral("sint_") + number, QStringLiteral("sintetico-") + number});
+    }
+    return users;
+}
+
+/**
+ * @brief Filas que corresponden a un usuario.
+ * @param index Posición del usuario, desde 0.
+ * @return Número de filas de su serie; el resto de la división va a los primeros usuarios.
+ */
+qint64 SyntheticDataGenerator::rowsForUser(int index) const
+{
+    const qint64 base = m_options.rows / m_options.users;
+    return base + (index < m_options.rows % m_options.users ? 1 : 0);
+}
+
+/**
+ * @brief Serie completa de un usuario, en memoria.
+ * @param index Posición del usuario, desde 0.
+ * @param userId Identificador del usuario en la base de datos.
+ * @return Registros en orden cronológico.
+ */
+QVector<healthrecord> SyntheticDataGenerator::userSeries(int index, const QString& userId) const
+{
+    QVector<healthrecord> series;
+    series.reserve(static_cast<int>(qMin<qint64>(rowsForUser(index), std::numeric_limits<int>::max())));
+    forEachReading(index, userId, [&series](const healthrecord& record) {
+        series.append(record);
+        return true;
+    });
+    return series;
+}
+
+/**
+ * @brief Genera las series de todos los usuarios por lotes.
+ * @param userIds Identificador en la base de datos de cada usuario, en el orden de users().
+ * @param batchRows Filas por lote.
+ * @param sink Recibe cada lote; si devuelve false se detiene la generación.
+ * @return true si se entregaron todas las filas.
+ */
+bool SyntheticDataGenerator::generate(const QVector<int>& userIds, int batchRows,
+                                      const std::function<bool(const QVector<healthrecord>&)>& sink) const
+{
+    QVector<healthrecord> batch;
+    batch.reserve(batchRows);
+    const int users = qMin(m_options.users, static_cast<int>(userIds.size()));
+    for (int i = 0; i < users; ++i) {
+        const bool completed = forEachReading(i, QString::number(userIds.at(i)), [&](const healthrecord& record) {
+            batch.append(record);
+            if (batch.size() < batchRows) {
+                return true;
+            }
+            const bool keepGoing = sink(batch);
+            batch.clear();
+            return keepGoing;
+        });
+        if (!completed) {
+            return false;
+        }
+    }
+    return batch.isEmpty() || sink(batch);
+}
+
+/**
+ * @brief Genera la serie de un usuario, una lectura a la vez.
+ * @param index Posición del usuario, desde 0.
+ * @param userId Identificador del usuario en la base de datos.
+ * @param emit Recibe cada registro; si devuelve false se detiene.
+ * @return false si emit pidió detenerse.
+ *
+ * Las lecturas se reparten a intervalos regulares en los años de la serie, con una variación
+ * de hasta medio intervalo, así que las fechas de un usuario son siempre crecientes y distintas
+ * (la tabla tiene un índice único por usuario y fecha).
+ */
+bool SyntheticDataGenerator::forEachReading(int index, const QString& userId,
+                                            const std::function<bool(const healthrecord&)>& emit) const
+{
+    quint64 seedState = m_options.seed ^ (static_cast<quint64>(index + 1) * 0xD1B54A32D192ED03ULL);
+    Random random(splitmix64(seedState));
+
+    // Perfil del usuario
+    double weight = 55.0 + 50.0 * random.uniform();
+    const bool diabetic = random.uniform() < 0.12;
+    const double glucoseBase = (diabetic ? 130.0 : 82.0) + 15.0 * random.uniform();
+    const double systolicBase = 105.0 + 35.0 * random.uniform();
+    const double weighsOften = 0.5 + 0.5 * random.uniform();
+
+    const qint64 count = rowsForUser(index);
+    if (count <= 0) {
+        return true;
+    }
+    const qint64 startMs = QDateTime(m_options.start, QTime(0, 0), Qt::UTC).toMSecsSinceEpoch();
+    const qint64 spanMs = static_cast<qint64>(m_options.years) * 365 * 24 * 3600 * 1000;
+    const double stepMs = static_cast<double>(spanMs) / static_cast<double>(count);
+
+    for (qint64 k = 0; k < count; ++k) {
+        const qint64 offset = static_cast<qint64>(k * stepMs + random.uniform() * stepMs * 0.5);
+        const QDateTime dateTime = QDateTime::fromMSecsSinceEpoch(startMs + offset, Qt::UTC);
+        const double yearPhase = kTwoPi * dateTime.date().dayOfYear() / 365.0;
+
+        // Deriva lenta, acotada, más un componente estacional (más peso en invierno)
+        weight = qBound(40.0, weight + random.normal() * 0.03, 160.0);
+        const float weightValue = random.uniform() < weighsOften
+                                      ? rounded(weight + 1.2 * std::cos(yearPhase) + random.normal() * 0.4, 0.1)
+                                      : std::nanf("");
+
+        // Ayuno o después de comer
+        const double meal = random.uniform() < 0.35 ? 25.0 + 30.0 * random.uniform() : 0.0;
+        const float glucoseValue = random.uniform() < 0.9
+                                       ? rounded(qBound(55.0, glucoseBase + meal + random.normal() * 10.0, 400.0), 1.0)
+                                       : std::nanf("");
+
+        const int systolic = static_cast<int>(std::lround(systolicBase + random.normal() * 8.0));
+        const int diastolic = static_cast<int>(std::lround(systolic * 0.64 + random.normal() * 4.0));
+        const QString bloodPressure = random.uniform() < 0.95 ? QStringLiteral("%1/%2").arg(systolic).arg(diastolic)
+                                                              : QString();
+
+        if (!emit(healthrecord("", userId, dateTime, weightValue, bloodPressure, glucoseValue))) {
+            return false;
+        }
+    }
+    return true;
+}
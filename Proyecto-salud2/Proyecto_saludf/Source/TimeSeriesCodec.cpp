@@ -0,0 +1,470 @@
+/**
+ * @file TimeSeriesCodec.cpp
+ * @brief Implementación de TimeSeriesCodec, codificación comprimida de series temporales por bloques.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "TimeSeriesCodec.h"
+#include <cstring>
+
+namespace {
+/**
+ * @brief Tamaño de la cabecera del bloque (número de muestras, primera marca y primer valor).
+ */
+const int kHeaderSize = 4 + 8 + 8;
+
+/**
+ * @brief Bits mínimos de cada muestra después de la primera: delta-of-delta 0 y valor repetido.
+ */
+const int kMinBitsPerPoint = 2;
+
+/**
+ * @brief Bytes de un TimeSeriesTail serializado: marca, delta, valor, ventana y longitud.
+ */
+const int kTailSize = 8 + 8 + 8 + 1 + 1 + 8;
+
+/**
+ * @brief Escritor de bits, del más significativo al menos significativo.
+ */
+class BitWriter
+{
+public:
+    explicit BitWriter(QByteArray& out) : m_out(out), m_current(0), m_used(0), m_written(0) {}
+
+    /**
+     * @brief Continúa un flujo cuyo último byte de out tiene usedBits bits útiles.
+     */
+    BitWriter(QByteArray& out, int usedBits) : m_out(out), m_current(0), m_used(0), m_written(0)
+    {
+        if (usedBits > 0) {
+            m_current = static_cast<quint8>(m_out.at(m_out.size() - 1));
+            m_out.chop(1);
+            m_used = usedBits;
+        }
+    }
+
+    /**
+     * @brief Escribe los count bits menos significativos de value.
+     */
+    void write(quint64 value, int count)
+    {
+        m_written += count;
+        while (count > 0) {
+            const int room = 8 - m_used;
+            const int take = count < room ? count : room;
+            const quint8 bits = static_cast<quint8>((value >> (count - take)) & ((1u << take) - 1));
+            m_current = static_cast<quint8>(m_current | (bits << (room - take)));
+            m_used += take;
+            count -= take;
+            if (m_used == 8) {
+                m_out.append(static_cast<char>(m_current));
+                m_current = 0;
+                m_used = 0;
+            }
+        }
+    }
+
+    /**
+     * @brief Completa el último byte con ceros.
+     */
+    void flush()
+    {
+        if (m_used > 0) {
+            m_out.append(static_cast<char>(m_current));
+            m_current = 0;
+            m_used = 0;
+        }
+    }
+
+    /**
+     * @brief Bits escritos desde la construcción.
+     */
+    qint64 written() const { return m_written; }
+
+private:
+    QByteArray& m_out;
+    quint8 m_current;
+    int m_used;
+    qint64 m_written;
+};
+
+/**
+ * @brief Lector de bits complementario de BitWriter.
+ */
+class BitReader
+{
+public:
+    BitReader(const uchar* data, int size) : m_data(data), m_size(size), m_bitPos(0) {}
+
+    /**
+     * @brief Lee count bits (hasta 64). Marca error si se termina el bloque.
+     */
+    quint64 read(int count)
+    {
+        quint64 value = 0;
+        while (count > 0) {
+            const int byteIndex = static_cast<int>(m_bitPos >> 3);
+            if (byteIndex >= m_size) {
+                m_overrun = true;
+                return 0;
+            }
+            const int offset = static_cast<int>(m_bitPos & 7);
+            const int room = 8 - offset;
+            const int take = count < room ? count : room;
+            const quint8 bits = static_cast<quint8>((m_data[byteIndex] >> (room - take)) & ((1u << take) - 1));
+            value = (value << take) | bits;
+            m_bitPos += take;
+            count -= take;
+        }
+        return value;
+    }
+
+    bool overrun() const { return m_overrun; }
+
+private:
+    const uchar* m_data;
+    int m_size;
+    qint64 m_bitPos;
+    bool m_overrun = false;
+};
+
+quint64 doubleBits(double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double bitsToDouble(quint64 bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+int leadingZeros(quint64 value)
+{
+    int count = 0;
+    for (quint64 mask = quint64(1) << 63; mask && !(value & mask); mask >>= 1) {
+        ++count;
+    }
+    return count;
+}
+
+int trailingZeros(quint64 value)
+{
+    int count = 0;
+    for (quint64 mask = 1; mask && !(value & mask); mask <<= 1) {
+        ++count;
+    }
+    return count;
+}
+
+void appendBigEndian(QByteArray& out, quint64 value, int bytes)
+{
+    for (int i = bytes - 1; i >= 0; --i) {
+        out.append(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+quint64 readBigEndian(const uchar* data, int bytes)
+{
+    quint64 value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+/**
+ * @brief Extiende el signo de un entero de width bits.
+ */
+qint64 signExtend(quint64 value, int width)
+{
+    const quint64 signBit = quint64(1) << (width - 1);
+    return static_cast<qint64>((value ^ signBit) - signBit);
+}
+
+/**
+ * @brief Codifica una muestra a continuación del estado y lo avanza.
+ * @param writer Flujo de bits del bloque.
+ * @param state Estado del codificador tras la muestra anterior.
+ * @param point Muestra, no anterior a state.lastTimestampMs.
+ */
+void encodePoint(BitWriter& writer, TimeSeriesTail& state, const TimePoint& point)
+{
+    const qint64 delta = point.timestampMs - state.lastTimestampMs;
+    const qint64 deltaOfDelta = delta - state.lastDeltaMs;
+    if (deltaOfDelta == 0) {
+        writer.write(0, 1);
+    } else if (deltaOfDelta >= -64 && deltaOfDelta <= 63) {
+        writer.write(0x2, 2);
+        writer.write(static_cast<quint64>(deltaOfDelta), 7);
+    } else if (deltaOfDelta >= -256 && deltaOfDelta <= 255) {
+        writer.write(0x6, 3);
+        writer.write(static_cast<quint64>(deltaOfDelta), 9);
+    } else if (deltaOfDelta >= -2048 && deltaOfDelta <= 2047) {
+        writer.write(0xE, 4);
+        writer.write(static_cast<quint64>(deltaOfDelta), 12);
+    } else {
+        writer.write(0xF, 4);
+        writer.write(static_cast<quint64>(deltaOfDelta), 64);
+    }
+    state.lastDeltaMs = delta;
+    state.lastTimestampMs = point.timestampMs;
+
+    const quint64 bits = doubleBits(point.value);
+    const quint64 xorValue = bits ^ state.lastValueBits;
+    state.lastValueBits = bits;
+    if (xorValue == 0) {
+        writer.write(0, 1);
+        return;
+    }
+
+    int leading = leadingZeros(xorValue);
+    const int trailing = trailingZeros(xorValue);
+    if (leading > 63) {
+        leading = 63;
+    }
+    if (state.windowLeading >= 0 && leading >= state.windowLeading && trailing >= state.windowTrailing) {
+        const int length = 64 - state.windowLeading - state.windowTrailing;
+        writer.write(0x2, 2);
+        writer.write(xorValue >> state.windowTrailing, length);
+    } else {
+        const int length = 64 - leading - trailing;
+        writer.write(0x3, 2);
+        writer.write(static_cast<quint64>(leading), 6);
+        writer.write(static_cast<quint64>(length - 1), 6);
+        writer.write(xorValue >> trailing, length);
+        state.windowLeading = leading;
+        state.windowTrailing = trailing;
+    }
+}
+}
+
+/**
+ * @brief Codifica un bloque de muestras ordenadas por marca de tiempo.
+ * @param points Muestras en orden ascendente de marca de tiempo.
+ * @param tail Si no es nulo, recibe el estado del codificador al final del bloque.
+ * @return Bloque codificado; vacío si no hay muestras.
+ *
+ * Cubetas del delta-of-delta: '0' para cero; '10' + 7 bits, '110' + 9 bits y '1110' + 12 bits
+ * en complemento a dos, es decir [-64, 63], [-256, 255] y [-2048, 2047]; '1111' + 64 bits en
+ * cualquier otro caso. Para los valores, '0' indica
+ * XOR cero; '10' reutiliza la ventana de bits significativos anterior; '11' + 6 bits de ceros
+ * iniciales + 6 bits de longitud abre una ventana nueva.
+ */
+QByteArray TimeSeriesCodec::encode(const QVector<TimePoint>& points, TimeSeriesTail* tail)
+{
+    QByteArray out;
+    TimeSeriesTail state;
+    if (points.isEmpty()) {
+        if (tail) {
+            *tail = state;
+        }
+        return out;
+    }
+    out.reserve(kHeaderSize + points.size() * 2);
+
+    appendBigEndian(out, static_cast<quint64>(points.size()), 4);
+    appendBigEndian(out, static_cast<quint64>(points[0].timestampMs), 8);
+    appendBigEndian(out, doubleBits(points[0].value), 8);
+
+    BitWriter writer(out);
+    state.lastTimestampMs = points[0].timestampMs;
+    state.lastValueBits = doubleBits(points[0].value);
+    for (int i = 1; i < points.size(); ++i) {
+        encodePoint(writer, state, points[i]);
+    }
+    writer.flush();
+    state.bitLength = writer.written();
+    if (tail) {
+        *tail = state;
+    }
+    return out;
+}
+
+/**
+ * @brief Añade muestras al final de un bloque continuando su flujo de bits.
+ * @param block Bloque producido por encode() o append(); se modifica.
+ * @param tail Estado del codificador al final del bloque; se actualiza.
+ * @param points Muestras en orden ascendente, todas posteriores a tail.lastTimestampMs.
+ * @return true si se añadieron; false sin modificar nada si el bloque no corresponde al estado o
+ *         las muestras no son posteriores.
+ *
+ * El resultado es idéntico, bit a bit, al de codificar todas las muestras de una vez, así que
+ * decode() no distingue un bloque del otro. Solo se reescribe el último byte parcial y el
+ * número de muestras de la cabecera.
+ */
+bool TimeSeriesCodec::append(QByteArray& block, TimeSeriesTail& tail, const QVector<TimePoint>& points)
+{
+    if (points.isEmpty()) {
+        return true;
+    }
+    if (block.size() < kHeaderSize || tail.bitLength < 0
+        || block.size() - kHeaderSize != (tail.bitLength + 7) / 8) {
+        return false;
+    }
+    qint64 previous = tail.lastTimestampMs;
+    for (const TimePoint& point : points) {
+        if (point.timestampMs <= previous) {
+            return false;
+        }
+        previous = point.timestampMs;
+    }
+    const quint64 count = readBigEndian(reinterpret_cast<const uchar*>(block.constData()), 4) + points.size();
+    if (count > 0xFFFFFFFFu) {
+        return false;
+    }
+
+    TimeSeriesTail state = tail;
+    BitWriter writer(block, static_cast<int>(state.bitLength % 8));
+    for (const TimePoint& point : points) {
+        encodePoint(writer, state, point);
+    }
+    writer.flush();
+    state.bitLength += writer.written();
+    for (int i = 0; i < 4; ++i) {
+        block[i] = static_cast<char>((count >> (8 * (3 - i))) & 0xFF);
+    }
+    tail = state;
+    return true;
+}
+
+/**
+ * @brief Serializa el estado del codificador para guardarlo junto al bloque.
+ * @param tail Estado.
+ * @return Bytes del estado.
+ */
+QByteArray TimeSeriesCodec::saveTail(const TimeSeriesTail& tail)
+{
+    QByteArray out;
+    out.reserve(kTailSize);
+    appendBigEndian(out, static_cast<quint64>(tail.lastTimestampMs), 8);
+    appendBigEndian(out, static_cast<quint64>(tail.lastDeltaMs), 8);
+    appendBigEndian(out, tail.lastValueBits, 8);
+    out.append(static_cast<char>(tail.windowLeading));
+    out.append(static_cast<char>(tail.windowTrailing));
+    appendBigEndian(out, static_cast<quint64>(tail.bitLength), 8);
+    return out;
+}
+
+/**
+ * @brief Lee un estado guardado con saveTail().
+ * @param data Bytes del estado.
+ * @param tail Estado leído.
+ * @return true si los bytes son un estado válido.
+ */
+bool TimeSeriesCodec::loadTail(const QByteArray& data, TimeSeriesTail* tail)
+{
+    if (data.size() != kTailSize) {
+        return false;
+    }
+    const uchar* bytes = reinterpret_cast<const uchar*>(data.constData());
+    TimeSeriesTail state;
+    state.lastTimestampMs = static_cast<qint64>(readBigEndian(bytes, 8));
+    state.lastDeltaMs = static_cast<qint64>(readBigEndian(bytes + 8, 8));
+    state.lastValueBits = readBigEndian(bytes + 16, 8);
+    state.windowLeading = static_cast<qint8>(bytes[24]);
+    state.windowTrailing = static_cast<qint8>(bytes[25]);
+    state.bitLength = static_cast<qint64>(readBigEndian(bytes + 26, 8));
+    if (state.windowLeading < -1 || state.windowLeading > 63 || state.windowTrailing < 0
+        || state.windowTrailing > 63 || (state.windowLeading >= 0 && state.windowLeading + state.windowTrailing > 63)
+        || state.bitLength < 0) {
+        return false;
+    }
+    *tail = state;
+    return true;
+}
+
+/**
+ * @brief Decodifica un bloque completo.
+ * @param block Bloque producido por encode().
+ * @param ok Si no es nulo, recibe false cuando el bloque está dañado.
+ * @return Muestras del bloque, en orden.
+ *
+ * El número de muestras de la cabecera se contrasta con lo que caben en el bloque a
+ * kMinBitsPerPoint bits cada una antes de reservar memoria: un bloque dañado no puede pedir
+ * más de lo que su propio tamaño justifica.
+ */
+QVector<TimePoint> TimeSeriesCodec::decode(const QByteArray& block, bool* ok)
+{
+    QVector<TimePoint> points;
+    if (ok) {
+        *ok = true;
+    }
+    if (block.isEmpty()) {
+        return points;
+    }
+    if (block.size() < kHeaderSize) {
+        if (ok) {
+            *ok = false;
+        }
+        return points;
+    }
+
+    const uchar* data = reinterpret_cast<const uchar*>(block.constData());
+    const quint64 count = readBigEndian(data, 4);
+    const quint64 capacity = 1 + static_cast<quint64>(block.size() - kHeaderSize) * 8 / kMinBitsPerPoint;
+    if (count == 0 || count > capacity) {
+        if (ok) {
+            *ok = false;
+        }
+        return points;
+    }
+    TimePoint point;
+    point.timestampMs = static_cast<qint64>(readBigEndian(data + 4, 8));
+    quint64 previousBits = readBigEndian(data + 12, 8);
+    point.value = bitsToDouble(previousBits);
+    points.reserve(static_cast<int>(count));
+    points.append(point);
+
+    BitReader reader(data + kHeaderSize, block.size() - kHeaderSize);
+    qint64 previousDelta = 0;
+    int windowLeading = 0;
+    int windowTrailing = 0;
+
+    for (quint64 i = 1; i < count; ++i) {
+        qint64 deltaOfDelta = 0;
+        if (reader.read(1) != 0) {
+            if (reader.read(1) == 0) {
+                deltaOfDelta = signExtend(reader.read(7), 7);
+            } else if (reader.read(1) == 0) {
+                deltaOfDelta = signExtend(reader.read(9), 9);
+            } else if (reader.read(1) == 0) {
+                deltaOfDelta = signExtend(reader.read(12), 12);
+            } else {
+                deltaOfDelta = static_cast<qint64>(reader.read(64));
+            }
+        }
+        previousDelta += deltaOfDelta;
+        point.timestampMs += previousDelta;
+
+        if (reader.read(1) != 0) {
+            if (reader.read(1) != 0) {
+                windowLeading = static_cast<int>(reader.read(6));
+                const int length = static_cast<int>(reader.read(6)) + 1;
+                windowTrailing = 64 - windowLeading - length;
+                if (windowTrailing < 0) {
+                    if (ok) {
+                        *ok = false;
+                    }
+                    break;
+                }
+            }
+            const int length = 64 - windowLeading - windowTrailing;
+            previousBits ^= reader.read(length) << windowTrailing;
+        }
+        point.value = bitsToDouble(previousBits);
+
+        if (reader.overrun()) {
+            if (ok) {
+                *ok = false;
+            }
+            break;
+        }
+        points.append(point);
+    }
+    return points;
+}
@@ -0,0 +1,402 @@
+/**
+ * @file TimeSeriesStore.cpp
+ * @brief Implementación de la clase TimeSeriesStore, almacén de series de alta frecuencia de dispositivos portátiles.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "TimeSeriesStore.h"
+#include "Logging.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QVariant>
+#include <algorithm>
+#include <limits>
+
+const qint64 TimeSeriesStore::kChunkMs;
+
+/**
+ * @brief Constructor del almacén.
+ * @param connection Conexión abierta en el hilo que usará el almacén.
+ */
+TimeSeriesStore::TimeSeriesStore(const QSqlDatabase& connection)
+    : m_connection(connection)
+{
+}
+
+/**
+ * @brief Crea la tabla ts_chunks si no existe y le agrega la columna tail si es anterior a ella.
+ * @param connection Conexión abierta.
+ * @return true si el esquema está disponible, false en caso contrario.
+ *
+ * La clave primaria (user_id, metric, chunk_start) es el índice de los recorridos por rango;
+ * WITHOUT ROWID guarda los bloques directamente en ese árbol. Los bloques existentes quedan con
+ * tail NULL y lo reciben la próxima vez que append() los vuelve a codificar.
+ */
+bool TimeSeriesStore::createSchema(QSqlDatabase& connection)
+{
+    QSqlQuery query(connection);
+    bool success = query.exec("CREATE TABLE IF NOT EXISTS ts_chunks ("
+                              "user_id INTEGER NOT NULL, "
+                              "metric INTEGER NOT NULL, "
+                              "chunk_start INTEGER NOT NULL, "
+                              "point_count INTEGER NOT NULL, "
+                              "first_ts INTEGER NOT NULL, "
+                              "last_ts INTEGER NOT NULL, "
+                              "min_value REAL, "
+                              "max_value REAL, "
+                              "sum_value REAL, "
+                              "data BLOB NOT NULL, "
+                              "tail BLOB, "
+                              "PRIMARY KEY (user_id, metric, chunk_start)) WITHOUT ROWID");
+    if (!success) {
+        qCWarning(lcDb) << "Error al crear la tabla de series temporales:" << query.lastError().text();
+        return false;
+    }
+
+    if (!query.exec("PRAGMA table_info(ts_chunks)")) {
+        qCWarning(lcDb) << "Error al leer las columnas de ts_chunks:" << query.lastError().text();
+        return false;
+    }
+    bool hasTail = false;
+    while (query.next()) {
+        if (query.value(1).toString() == "tail") {
+            hasTail = true;
+        }
+    }
+    query.finish();
+    if (!hasTail && !query.exec("ALTER TABLE ts_chunks ADD COLUMN tail BLOB")) {
+        qCWarning(lcDb) << "Error al agregar la columna tail a ts_chunks:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Inicio del bloque que contiene una marca de tiempo.
+ * @param timestampMs Marca de tiempo.
+ * @return Inicio del bloque.
+ */
+qint64 TimeSeriesStore::chunkStartFor(qint64 timestampMs)
+{
+    qint64 start = timestampMs - timestampMs % kChunkMs;
+    if (timestampMs < 0 && timestampMs % kChunkMs != 0) {
+        start -= kChunkMs;
+    }
+    return start;
+}
+
+/**
+ * @brief Añade muestras a una serie.
+ * @param userId Identificador del usuario.
+ * @param metric Métrica de la serie.
+ * @param points Muestras en cualquier orden.
+ * @return true si todas las muestras se guardaron, false en caso contrario.
+ *
+ * Si todas las muestras de un bloque son posteriores a la última guardada, el caso normal de un
+ * dispositivo que sincroniza en orden, se añaden con TimeSeriesCodec::append() a partir del tail
+ * guardado y el costo es proporcional a las muestras nuevas. Las muestras atrasadas o repetidas,
+ * y los bloques sin tail, se combinan decodificando y volviendo a codificar el bloque.
+ */
+bool TimeSeriesStore::append(int userId, int metric, QVector<TimePoint> points)
+{
+    if (points.isEmpty()) {
+        return true;
+    }
+    std::stable_sort(points.begin(), points.end(), [](const TimePoint& a, const TimePoint& b) {
+        return a.timestampMs < b.timestampMs;
+    });
+
+    if (!m_connection.transaction()) {
+        qCWarning(lcDb) << "Error al iniciar la transacción de series temporales:" << m_connection.lastError().text();
+        return false;
+    }
+
+    QSqlQuery select(m_connection);
+    select.prepare("SELECT data, tail, point_count, min_value, max_value, sum_value FROM ts_chunks "
+                   "WHERE user_id = :user_id AND metric = :metric AND chunk_start = :chunk_start");
+    QSqlQuery upsert(m_connection);
+    upsert.prepare("INSERT OR REPLACE INTO ts_chunks "
+                   "(user_id, metric, chunk_start, point_count, first_ts, last_ts, min_value, max_value, sum_value, "
+                   "data, tail) "
+                   "VALUES (:user_id, :metric, :chunk_start, :point_count, :first_ts, :last_ts, "
+                   ":min_value, :max_value, :sum_value, :data, :tail)");
+    QSqlQuery extend(m_connection);
+    extend.prepare("UPDATE ts_chunks SET point_count = :point_count, last_ts = :last_ts, min_value = :min_value, "
+                   "max_value = :max_value, sum_value = :sum_value, data = :data, tail = :tail "
+                   "WHERE user_id = :user_id AND metric = :metric AND chunk_start = :chunk_start");
+
+    int begin = 0;
+    while (begin < points.size()) {
+        const qint64 chunkStart = chunkStartFor(points[begin].timestampMs);
+        int end = begin;
+        bool increasing = true;
+        while (end < points.size() && points[end].timestampMs < chunkStart + kChunkMs) {
+            if (end > begin && points[end].timestampMs == points[end - 1].timestampMs) {
+                increasing = false;
+            }
+            ++end;
+        }
+
+        select.bindValue(":user_id", userId);
+        select.bindValue(":metric", metric);
+        select.bindValue(":chunk_start", chunkStart);
+        if (!select.exec()) {
+            qCWarning(lcDb) << "Error al leer el bloque de la serie:" << select.lastError().text();
+            m_connection.rollback();
+            return false;
+        }
+        const bool found = select.next();
+        QByteArray data;
+        TimeSeriesTail tail;
+        bool hasTail = false;
+        qint64 storedCount = 0;
+        double minValue = std::numeric_limits<double>::max();
+        double maxValue = std::numeric_limits<double>::lowest();
+        double sum = 0.0;
+        if (found) {
+            data = select.value(0).toByteArray();
+            hasTail = TimeSeriesCodec::loadTail(select.value(1).toByteArray(), &tail);
+            storedCount = select.value(2).toLongLong();
+            minValue = select.value(3).toDouble();
+            maxValue = select.value(4).toDouble();
+            sum = select.value(5).toDouble();
+        }
+        select.finish();
+
+        // Muestras posteriores a la última del bloque: se continúa el flujo de bits sin decodificarlo
+        if (found && hasTail && increasing && points[begin].timestampMs > tail.lastTimestampMs
+            && TimeSeriesCodec::append(data, tail, points.mid(begin, end - begin))) {
+            for (int k = begin; k < end; ++k) {
+                minValue = std::min(minValue, points[k].value);
+                maxValue = std::max(maxValue, points[k].value);
+                sum += points[k].value;
+            }
+            extend.bindValue(":point_count", storedCount + (end - begin));
+            extend.bindValue(":last_ts", points[end - 1].timestampMs);
+            extend.bindValue(":min_value", minValue);
+            extend.bindValue(":max_value", maxValue);
+            extend.bindValue(":sum_value", sum);
+            extend.bindValue(":data", data);
+            extend.bindValue(":tail", TimeSeriesCodec::saveTail(tail));
+            extend.bindValue(":user_id", userId);
+            extend.bindValue(":metric", metric);
+            extend.bindValue(":chunk_start", chunkStart);
+            if (!extend.exec()) {
+                qCWarning(lcDb) << "Error al extender el bloque de la serie:" << extend.lastError().text();
+                m_connection.rollback();
+                return false;
+            }
+            begin = end;
+            continue;
+        }
+
+        QVector<TimePoint> existing;
+        if (found) {
+            bool ok = true;
+            existing = TimeSeriesCodec::decode(data, &ok);
+            if (!ok) {
+                qCWarning(lcDb) << "Bloque dañado en la serie" << userId << metric << chunkStart << ", se conservan las muestras legibles";
+            }
+        }
+
+        // Combinar las muestras nuevas con las del bloque; en empate gana la nueva
+        QVector<TimePoint> merged;
+        merged.reserve(existing.size() + (end - begin));
+        int i = 0;
+        int j = begin;
+        while (i < existing.size() || j < end) {
+            if (j >= end || (i < existing.size() && existing[i].timestampMs < points[j].timestampMs)) {
+                merged.append(existing[i++]);
+            } else {
+                if (i < existing.size() && existing[i].timestampMs == points[j].timestampMs) {
+                    ++i;
+                }
+                if (!merged.isEmpty() && merged.last().timestampMs == points[j].timestampMs) {
+                    merged.last() = points[j];
+                } else {
+                    merged.append(points[j]);
+                }
+                ++j;
+            }
+        }
+
+        minValue = std::numeric_limits<double>::max();
+        maxValue = std::numeric_limits<double>::lowest();
+        sum = 0.0;
+        for (const TimePoint& point : merged) {
+            minValue = std::min(minValue, point.value);
+            maxValue = std::max(maxValue, point.value);
+            sum += point.value;
+        }
+
+        upsert.bindValue(":user_id", userId);
+        upsert.bindValue(":metric", metric);
+        upsert.bindValue(":chunk_start", chunkStart);
+        upsert.bindValue(":point_count", merged.size());
+        upsert.bindValue(":first_ts", merged.first().timestampMs);
+        upsert.bindValue(":last_ts", merged.last().timestampMs);
+        upsert.bindValue(":min_value", minValue);
+        upsert.bindValue(":max_value", maxValue);
+        upsert.bindValue(":sum_value", sum);
+        upsert.bindValue(":data", TimeSeriesCodec::encode(merged, &tail));
+        upsert.bindValue(":tail", TimeSeriesCodec::saveTail(tail));
+        if (!upsert.exec()) {
+            qCWarning(lcDb) << "Error al guardar el bloque de la serie:" << upsert.lastError().text();
+            m_connection.rollback();
+            return false;
+        }
+        begin = end;
+    }
+
+    if (!m_connection.commit()) {
+        qCWarning(lcDb) << "Error al confirmar las muestras de la serie:" << m_connection.lastError().text();
+        m_connection.rollback();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Lee las muestras de una serie en un rango de tiempo.
+ * @param userId Identificador del usuario.
+ * @param metric Métrica de la serie.
+ * @param fromMs Inicio del rango (inclusive).
+ * @param toMs Fin del rango (exclusive).
+ * @return Muestras del rango en orden ascendente.
+ */
+QVector<TimePoint> TimeSeriesStore::scan(int userId, int metric, qint64 fromMs, qint64 toMs)
+{
+    QVector<TimePoint> result;
+    if (toMs <= fromMs) {
+        return result;
+    }
+
+    QSqlQuery query(m_connection);
+    query.setForwardOnly(true);
+    query.prepare("SELECT data FROM ts_chunks "
+                  "WHERE user_id = :user_id AND metric = :metric "
+                  "AND chunk_start >= :from_chunk AND chunk_start < :to "
+                  "ORDER BY chunk_start");
+    query.bindValue(":user_id", userId);
+    query.bindValue(":metric", metric);
+    query.bindValue(":from_chunk", chunkStartFor(fromMs));
+    query.bindValue(":to", toMs);
+    if (!query.exec()) {
+        qCWarning(lcDb) << "Error al recorrer la serie:" << query.lastError().text();
+        return result;
+    }
+
+    while (query.next()) {
+        const QVector<TimePoint> points = TimeSeriesCodec::decode(query.value(0).toByteArray());
+        for (const TimePoint& point : points) {
+            if (point.timestampMs >= fromMs && point.timestampMs < toMs) {
+                result.append(point);
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Resume una serie en intervalos de igual duración, para graficar rangos largos.
+ * @param userId Identificador del usuario.
+ * @param metric Métrica de la serie.
+ * @param fromMs Inicio del rango (inclusive).
+ * @param toMs Fin del rango (exclusive).
+ * @param buckets Número de intervalos.
+ * @return Un DecimatedPoint por intervalo con muestras, en orden.
+ *
+ * Un bloque que cae completo dentro de un intervalo y del rango se resume con sus estadísticas
+ * almacenadas; solo los bloques que cruzan un borde se decodifican.
+ */
+QVector<DecimatedPoint> TimeSeriesStore::decimate(int userId, int metric, qint64 fromMs, qint64 toMs, int buckets)
+{
+    QVector<DecimatedPoint> result;
+    if (toMs <= fromMs || buckets <= 0) {
+        return result;
+    }
+
+    const qint64 bucketMs = std::max<qint64>(1, (toMs - fromMs + buckets - 1) / buckets);
+    QVector<DecimatedPoint> summary(buckets);
+    for (int b = 0; b < buckets; ++b) {
+        summary[b].bucketStartMs = fromMs + b * bucketMs;
+        summary[b].minValue = std::numeric_limits<double>::max();
+        summary[b].maxValue = std::numeric_limits<double>::lowest();
+    }
+    QVector<double> sums(buckets, 0.0);
+
+    auto accumulate = [&](int bucket, qint64 count, double minValue, double maxValue, double sum) {
+        DecimatedPoint& point = summary[bucket];
+        point.count += count;
+        point.minValue = std::min(point.minValue, minValue);
+        point.maxValue = std::max(point.maxValue, maxValue);
+        sums[bucket] += sum;
+    };
+
+    QSqlQuery query(m_connection);
+    query.setForwardOnly(true);
+    query.prepare("SELECT first_ts, last_ts, point_count, min_value, max_value, sum_value, data FROM ts_chunks "
+                  "WHERE user_id = :user_id AND metric = :metric "
+                  "AND chunk_start >= :from_chunk AND chunk_start < :to "
+                  "ORDER BY chunk_start");
+    query.bindValue(":user_id", userId);
+    query.bindValue(":metric", metric);
+    query.bindValue(":from_chunk", chunkStartFor(fromMs));
+    query.bindValue(":to", toMs);
+    if (!query.exec()) {
+        qCWarning(lcDb) << "Error al decimar la serie:" << query.lastError().text();
+        return result;
+    }
+
+    while (query.next()) {
+        const qint64 firstTs = query.value(0).toLongLong();
+        const qint64 lastTs = query.value(1).toLongLong();
+        if (lastTs < fromMs || firstTs >= toMs) {
+            continue;
+        }
+        const int firstBucket = static_cast<int>((firstTs - fromMs) / bucketMs);
+        const int lastBucket = static_cast<int>((lastTs - fromMs) / bucketMs);
+        if (firstTs >= fromMs && lastTs < toMs && firstBucket == lastBucket) {
+            accumulate(firstBucket, query.value(2).toLongLong(), query.value(3).toDouble(),
+                       query.value(4).toDouble(), query.value(5).toDouble());
+            continue;
+        }
+
+        const QVector<TimePoint> points = TimeSeriesCodec::decode(query.value(6).toByteArray());
+        for (const TimePoint& point : points) {
+            if (point.timestampMs < fromMs || point.timestampMs >= toMs) {
+                continue;
+            }
+            const int bucket = static_cast<int>((point.timestampMs - fromMs) / bucketMs);
+            accumulate(bucket, 1, point.value, point.value, point.value);
+        }
+    }
+
+    for (int b = 0; b < buckets; ++b) {
+        if (summary[b].count > 0) {
+            summary[b].average = sums[b] / summary[b].count;
+            result.append(summary[b]);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Bytes ocupados por los bloques de una serie.
+ * @param userId Identificador del usuario.
+ * @param metric Métrica de la serie.
+ * @return Suma del tamaño de los BLOB de la serie.
+ */
+qint64 TimeSeriesStore::storedBytes(int userId, int metric)
+{
+    QSqlQuery query(m_connection);
+    query.prepare("SELECT COALESCE(SUM(LENGTH(data)), 0) FROM ts_chunks WHERE user_id = :user_id AND metric = :metric");
+    query.bindValue(":user_id", userId);
+    query.bindValue(":metric", metric);
+    if (!query.exec() || !query.next()) {
+        qCWarning(lcDb) << "Error al medir la serie:" << query.lastError().text();
+        return 0;
+    }
+    return query.value(0).toLongLong();
+}
@@ -0,0 +1,346 @@
+/**
+ * @file Trace.cpp
+ * @brief Implementación de la clase Trace, trazas por intervalos en formato Chrome / Perfetto.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "Trace.h"
+#include "Logging.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QMutexLocker>
+#include <QThread>
+
+std::atomic<int> Trace::s_mode{0};
+
+namespace {
+/**
+ * @brief Búfer del hilo actual; pertenece a Trace, que lo libera al destruirse.
+ */
+thread_local void* t_buffer = nullptr;
+
+/**
+ * @brief Añade una cadena JSON escapada.
+ * @param out Destino.
+ * @param text Texto UTF-8 terminado en cero.
+ */
+void appendJsonString(QByteArray& out, const char* text)
+{
+    out += '"';
+    for (const char* c = text; *c; ++c) {
+        const unsigned char ch = static_cast<unsigned char>(*c);
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+            out += static_cast<char>(ch);
+        } else if (ch < 0x20) {
+            out += ' ';
+        } else {
+            out += static_cast<char>(ch);
+        }
+    }
+    out += '"';
+}
+
+/**
+ * @brief Añade un tiempo en microsegundos, la unidad de los archivos de Chrome.
+ * @param out Destino.
+ * @param nanoseconds Tiempo en nanosegundos.
+ */
+void appendMicroseconds(QByteArray& out, qint64 nanoseconds)
+{
+    out += QByteArray::number(nanoseconds / 1000.0, 'f', 3);
+}
+}
+
+/**
+ * @brief Toma el tiempo de inicio y publica el intervalo como abierto, según m_mode.
+ *
+ * La profundidad se publica después del nombre (release), así que quien la lea (acquire) ve
+ * los nombres de todos los niveles que cuenta.
+ */
+void Trace::Span::begin()
+{
+    if (m_mode & Marking) {
+        ThreadBuffer* buffer = instance().threadBuffer();
+        const int depth = buffer->depth.load(std::memory_order_relaxed);
+        if (depth < kMaxDepth) {
+            buffer->open[depth].store(m_name, std::memory_order_relaxed);
+        }
+        buffer->depth.store(depth + 1, std::memory_order_release);
+    }
+    if (m_mode & Recording) {
+        m_start = now();
+    }
+}
+
+/**
+ * @brief Registra el intervalo y lo retira de la pila de abiertos, según m_mode.
+ */
+void Trace::Span::end()
+{
+    if (m_start >= 0) {
+        complete(m_category, m_name, m_start, now() - m_start);
+    }
+    if (m_mode & Marking) {
+        ThreadBuffer* buffer = instance().threadBuffer();
+        buffer->depth.store(buffer->depth.load(std::memory_order_relaxed) - 1, std::memory_order_release);
+    }
+}
+
+/**
+ * @brief Obtiene la instancia única de Trace.
+ * @return Referencia a la instancia singleton.
+ */
+Trace& Trace::instance()
+{
+    static Trace instance;
+    return instance;
+}
+
+/**
+ * @brief Constructor privado para implementar el patrón singleton.
+ */
+Trace::Trace()
+    : m_origin(now())
+{
+}
+
+/**
+ * @brief Destructor. Libera los búferes de los hilos.
+ */
+Trace::~Trace()
+{
+    s_mode.store(0);
+    for (ThreadBuffer* buffer : m_buffers) {
+        for (int i = 0; i < kMaxChunks; ++i) {
+            delete[] buffer->chunks[i].load();
+        }
+        delete buffer;
+    }
+}
+
+/**
+ * @brief Búfer del hilo actual, creado en su primer intervalo.
+ * @return Búfer del hilo.
+ *
+ * El candado solo se toma la primera vez que un hilo registra un intervalo.
+ */
+Trace::ThreadBuffer* Trace::threadBuffer()
+{
+    if (t_buffer) {
+        return static_cast<ThreadBuffer*>(t_buffer);
+    }
+
+    ThreadBuffer* buffer = new ThreadBuffer;
+    QThread* thread = QThread::currentThread();
+    QMutexLocker locker(&m_mutex);
+    buffer->tid = m_buffers.size() + 1;
+    buffer->thread = thread;
+    if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+        buffer->name = QStringLiteral("GUI");
+    } else if (thread && !thread->objectName().isEmpty()) {
+        buffer->name = QStringLiteral("%1 %2").arg(thread->objectName()).arg(buffer->tid);
+    } else {
+        buffer->name = QStringLiteral("hilo %1").arg(buffer->tid);
+    }
+    m_buffers.append(buffer);
+    t_buffer = buffer;
+    return buffer;
+}
+
+/**
+ * @brief Registra un intervalo ya terminado en el búfer del hilo actual.
+ * @param category Categoría; el puntero debe seguir siendo válido hasta escribir la traza.
+ * @param name Nombre; el puntero debe seguir siendo válido hasta escribir la traza.
+ * @param start Inicio, según now().
+ * @param duration Duración en nanosegundos.
+ *
+ * El evento se escribe antes de publicar el contador (release), así que quien lea el contador
+ * (acquire) ve el evento completo.
+ */
+void Trace::complete(const char* category, const char* name, qint64 start, qint64 duration)
+{
+    if (!enabled()) {
+        return;
+    }
+    ThreadBuffer* buffer = instance().threadBuffer();
+    const quint64 index = buffer->count.load(std::memory_order_relaxed);
+    const quint64 chunkIndex = index / kChunkEvents;
+    if (chunkIndex >= static_cast<quint64>(kMaxChunks)) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Event* chunk = buffer->chunks[chunkIndex].load(std::memory_order_relaxed);
+    if (!chunk) {
+        chunk = new Event[kChunkEvents];
+        buffer->chunks[chunkIndex].store(chunk, std::memory_order_release);
+    }
+    Event& event = chunk[index % kChunkEvents];
+    event.category = category;
+    event.name = name;
+    event.start = start;
+    event.duration = duration;
+    buffer->count.store(index + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Empieza a registrar intervalos.
+ * @param filePath Archivo JSON que escribirán flush() y stop().
+ */
+void Trace::start(const QString& filePath)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_filePath = filePath;
+        m_origin = now();
+    }
+    s_mode.fetch_or(Recording);
+    qCInfo(lcUi) << "Traza activada, se escribirá en" << filePath;
+}
+
+/**
+ * @brief Deja de registrar y escribe el archivo.
+ * @return true si se escribió correctamente.
+ */
+bool Trace::stop()
+{
+    if (!(s_mode.fetch_and(~Recording) & Recording)) {
+        return false;
+    }
+    return writeFile();
+}
+
+/**
+ * @brief Escribe el archivo con los intervalos registrados hasta ahora, sin detener la traza.
+ * @return true si se escribió correctamente.
+ */
+bool Trace::flush()
+{
+    return writeFile();
+}
+
+/**
+ * @brief Intervalos descartados porque el búfer de su hilo estaba lleno.
+ * @return Cantidad de intervalos descartados.
+ */
+quint64 Trace::dropped() const
+{
+    QMutexLocker locker(&m_mutex);
+    quint64 total = 0;
+    for (const ThreadBuffer* buffer : m_buffers) {
+        total += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+/**
+ * @brief Activa o desactiva la publicación de la pila de intervalos abiertos de cada hilo.
+ * @param enabled true para publicarla.
+ *
+ * Los intervalos ya abiertos conservan el modo con el que se abrieron, así que la pila de cada
+ * hilo queda equilibrada aunque el modo cambie a mitad de un intervalo.
+ */
+void Trace::setMarking(bool enabled)
+{
+    if (enabled) {
+        s_mode.fetch_or(Marking);
+    } else {
+        s_mode.fetch_and(~Marking);
+    }
+}
+
+/**
+ * @brief Intervalos abiertos en un hilo, del más externo al más interno.
+ * @param thread Hilo a consultar.
+ * @return Nombres de los intervalos; vacío si el hilo no tiene ninguno o no se está marcando.
+ */
+QStringList Trace::activeSpans(const QThread* thread) const
+{
+    QStringList spans;
+    QMutexLocker locker(&m_mutex);
+    const ThreadBuffer* found = nullptr;
+    for (const ThreadBuffer* buffer : m_buffers) {
+        if (buffer->thread == thread) {
+            found = buffer;
+        }
+    }
+    if (!found) {
+        return spans;
+    }
+    const int depth = qMin(found->depth.load(std::memory_order_acquire), static_cast<int>(kMaxDepth));
+    for (int i = 0; i < depth; ++i) {
+        spans << QString::fromUtf8(found->open[i].load(std::memory_order_relaxed));
+    }
+    return spans;
+}
+
+/**
+ * @brief Escribe el JSON de la traza.
+ * @return true si se escribió correctamente.
+ *
+ * Formato "Trace Event" de Chrome: un evento "X" (intervalo completo) por span y un evento "M"
+ * con el nombre de cada hilo. Los hilos pueden seguir registrando mientras se escribe; solo se
+ * leen los eventos ya publicados.
+ */
+bool Trace::writeFile()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_filePath.isEmpty()) {
+        return false;
+    }
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(lcUi) << "No se pudo escribir la traza en" << m_filePath << ":" << file.errorString();
+        return false;
+    }
+
+    const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+    QByteArray out;
+    out.reserve(1 << 20);
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    quint64 written = 0;
+    quint64 dropped = 0;
+
+    for (const ThreadBuffer* buffer : m_buffers) {
+        const QByteArray tid = QByteArray::number(buffer->tid);
+        out += first ? "\n" : ",\n";
+        first = false;
+        out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid + ",\"tid\":" + tid + ",\"args\":{\"name\":";
+        appendJsonString(out, buffer->name.toUtf8().constData());
+        out += "}}";
+
+        const quint64 count = buffer->count.load(std::memory_order_acquire);
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+        for (quint64 i = 0; i < count; ++i) {
+            const Event* chunk = buffer->chunks[i / kChunkEvents].load(std::memory_order_acquire);
+            const Event& event = chunk[i % kChunkEvents];
+            out += ",\n{\"name\":";
+            appendJsonString(out, event.name);
+            out += ",\"cat\":";
+            appendJsonString(out, event.category);
+            out += ",\"ph\":\"X\",\"ts\":";
+            appendMicroseconds(out, event.start - m_origin);
+            out += ",\"dur\":";
+            appendMicroseconds(out, event.duration);
+            out += ",\"pid\":" + pid + ",\"tid\":" + tid + "}";
+            ++written;
+
+            if (out.size() > (1 << 20)) {
+                file.write(out);
+                out.clear();
+            }
+        }
+    }
+    out += "\n]}\n";
+    file.write(out);
+    if (!file.flush()) {
+        qCWarning(lcUi) << "Error al escribir la traza:" << file.errorString();
+        return false;
+    }
+
+    qCInfo(lcUi) << "Traza escrita en" << m_filePath << ":" << written << "intervalos," << dropped << "descartados";
+    return true;
+}
@@ -10,10 +10,10 @@
 /**
  * @brief Constructor por defecto de la clase User.
  *
- * Inicializa un objeto User con valores vacíos para id, nombre de usuario y contraseña.
+ * Inicializa un objeto User con valores vacíos para id y nombre de usuario.
  */
 User::User()
-    : m_id(""), m_username(""), m_password("")
+    : m_id(""), m_username("")
 {
 }
 
@@ -21,12 +21,11 @@ User::User()
  * @brief Constructor con parámetros de la clase User.
  * @param id Identificador único del usuario.
  * @param username Nombre de usuario.
- * @param password Contraseña del usuario.
  *
  * Inicializa los atributos del usuario con los valores proporcionados.
  */
-User::User(const QString& id, const QString& username, const QString& password)
-    : m_id(id), m_username(username), m_password(password)
+User::User(const QString& id, const QString& username)
+    : m_id(id), m_username(username)
 {
 }
 
@@ -48,15 +47,6 @@ QString User::getUsername() const
     return m_username;
 }
 
-/**
- * @brief Obtiene la contraseña del usuario.
- * @return Contraseña del usuario.
- */
-QString User::getPassword() const
-{
-    return m_password;
-}
-
 /**
  * @brief Establece el identificador del usuario.
  * @param id Nuevo identificador del usuario.
@@ -74,12 +64,3 @@ void User::setUsername(const QString& username)
 {
     m_username = username;
 }
-
-/**
- * @brief Establece la contraseña del usuario.
- * @param password Nueva contraseña del usuario.
- */
-void User::setPassword(const QString& password)
-{
-    m_password = password;
-}
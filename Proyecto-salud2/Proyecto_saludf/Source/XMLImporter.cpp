@@ -0,0 +1,669 @@
+/**
+ * @file XMLImporter.cpp
+ * @brief Implementación de la clase XMLImporter para importar exportaciones XML de teléfonos y relojes.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "XMLImporter.h"
+#include "Logging.h"
+#include "RecordValidator.h"
+#include "healthrecord.h"
+#include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QTimeZone>
+#include <QVector>
+#include <QXmlStreamReader>
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace {
+/**
+ * @brief Campo de healthrecord al que corresponde una muestra.
+ */
+enum Kind
+{
+    Unknown,
+    Weight,
+    Glucose,
+    Systolic,
+    Diastolic
+};
+
+/**
+ * @brief Tipo de muestra reconocido y su campo.
+ */
+struct TypeMapping
+{
+    const char* type;
+    Kind kind;
+};
+
+/**
+ * @brief Tipos de muestra reconocidos: identificadores de HealthKit y nombres genéricos.
+ */
+const TypeMapping kTypes[] = {
+    {"HKQuantityTypeIdentifierBodyMass", Weight},
+    {"HKQuantityTypeIdentifierBloodGlucose", Glucose},
+    {"HKQuantityTypeIdentifierBloodPressureSystolic", Systolic},
+    {"HKQuantityTypeIdentifierBloodPressureDiastolic", Diastolic},
+    {"weight", Weight},
+    {"body_mass", Weight},
+    {"glucose", Glucose},
+    {"blood_glucose", Glucose},
+    {"systolic", Systolic},
+    {"blood_pressure_systolic", Systolic},
+    {"diastolic", Diastolic},
+    {"blood_pressure_diastolic", Diastolic}
+};
+
+/**
+ * @brief Factor de mmol/L a mg/dL para la glucosa.
+ */
+const double kGlucoseMmolToMgDl = 18.0182;
+
+/**
+ * @brief Busca el campo que corresponde a un tipo de muestra.
+ * @param type Valor del atributo type.
+ * @return Campo, o Unknown si el tipo no se importa.
+ */
+template <typename View>
+Kind kindForType(const View& type)
+{
+    for (const TypeMapping& mapping : kTypes) {
+        if (type == QLatin1String(mapping.type)) {
+            return mapping.kind;
+        }
+    }
+    return Unknown;
+}
+
+/**
+ * @brief Factor para llevar una muestra a la unidad de la base de datos.
+ * @param kind Campo de la muestra.
+ * @param unit Valor del atributo unit; vacío si no lo tiene.
+ * @param scale Factor resultante.
+ * @return true si la unidad es conocida para ese campo.
+ */
+template <typename View>
+bool unitScale(Kind kind, const View& unit, double* scale)
+{
+    *scale = 1.0;
+    if (unit.isEmpty()) {
+        return true;
+    }
+    switch (kind) {
+    case Weight:
+        if (unit == QLatin1String("kg")) {
+            return true;
+        }
+        if (unit == QLatin1String("lb") || unit == QLatin1String("lbs")) {
+            *scale = 0.45359237;
+            return true;
+        }
+        if (unit == QLatin1String("g")) {
+            *scale = 0.001;
+            return true;
+        }
+        if (unit == QLatin1String("st")) {
+            *scale = 6.35029318;
+            return true;
+        }
+        return false;
+    case Glucose:
+        if (unit == QLatin1String("mg/dL")) {
+            return true;
+        }
+        // HealthKit escribe la unidad molar como "mmol<180.15588...>/L"
+        if (unit.startsWith(QLatin1String("mmol"))) {
+            *scale = kGlucoseMmolToMgDl;
+            return true;
+        }
+        return false;
+    case Systolic:
+    case Diastolic:
+        return unit == QLatin1String("mmHg");
+    case Unknown:
+        break;
+    }
+    return false;
+}
+
+/**
+ * @brief Indica si un rango de bytes son todos dígitos.
+ * @param p Inicio.
+ * @param count Número de bytes.
+ * @return true si los count bytes son dígitos.
+ */
+bool allDigits(const char* p, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        if (p[i] < '0' || p[i] > '9') {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Convierte la fecha de una muestra, con o sin desplazamiento horario, a hora local.
+ * @param text Texto de la fecha ("2024-03-01 08:15:00 -0500", "2024-03-01T13:15:00Z"...).
+ * @param dateTime Fecha y hora resultante en hora local, como las del formulario.
+ * @return true si la fecha es válida.
+ */
+bool parseSampleDate(const QByteArray& text, QDateTime* dateTime)
+{
+    const char* begin = text.constData();
+    const char* end = begin + text.size();
+    while (end > begin && end[-1] == ' ') {
+        --end;
+    }
+
+    bool hasOffset = false;
+    int offsetSeconds = 0;
+    // Solo se busca desplazamiento después de "yyyy-MM-ddThh:mm"
+    if (end - begin > 16) {
+        if (end[-1] == 'Z') {
+            hasOffset = true;
+            --end;
+        } else {
+            const char* sign = nullptr;
+            int hours = 0;
+            int minutes = 0;
+            if ((end[-5] == '+' || end[-5] == '-') && allDigits(end - 4, 4)) {
+                sign = end - 5;
+                hours = (end[-4] - '0') * 10 + (end[-3] - '0');
+                minutes = (end[-2] - '0') * 10 + (end[-1] - '0');
+            } else if ((end[-6] == '+' || end[-6] == '-') && end[-3] == ':'
+                       && allDigits(end - 5, 2) && allDigits(end - 2, 2)) {
+                sign = end - 6;
+                hours = (end[-5] - '0') * 10 + (end[-4] - '0');
+                minutes = (end[-2] - '0') * 10 + (end[-1] - '0');
+            }
+            if (sign) {
+                hasOffset = true;
+                offsetSeconds = (hours * 60 + minutes) * 60 * (*sign == '-' ? -1 : 1);
+                end = sign;
+            }
+        }
+    }
+
+    QDateTime parsed;
+    if (!RecordValidator::parseDateTime(begin, end, &parsed)) {
+        return false;
+    }
+    *dateTime = hasOffset
+                    ? QDateTime(parsed.date(), parsed.time(), QTimeZone(offsetSeconds)).toLocalTime()
+                    : parsed;
+    return true;
+}
+
+/**
+ * @brief Huella de una muestra para detectar repetidas.
+ * @param kind Campo de la muestra.
+ * @param seconds Fecha en segundos desde la época.
+ * @param value Valor en centésimas (o sistólica*1000+diastólica para presiones).
+ * @return Huella de 64 bits.
+ */
+quint64 fingerprint(Kind kind, qint64 seconds, qint64 value)
+{
+    quint64 h = static_cast<quint64>(kind) * 0x9E3779B97F4A7C15ULL;
+    h ^= static_cast<quint64>(seconds) + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+    h ^= static_cast<quint64>(value) + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+    return h;
+}
+
+/**
+ * @class RecentSet
+ * @brief Conjunto de huellas que olvida las más antiguas al llenarse.
+ */
+class RecentSet
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param capacity Huellas que se recuerdan.
+     */
+    explicit RecentSet(int capacity)
+        : m_capacity(static_cast<std::size_t>(std::max(1, capacity)))
+    {
+        m_keys.reserve(static_cast<int>(m_capacity));
+    }
+
+    /**
+     * @brief Añade una huella.
+     * @param key Huella.
+     * @return true si es nueva, false si ya estaba entre las recientes.
+     */
+    bool insert(quint64 key)
+    {
+        if (m_keys.contains(key)) {
+            return false;
+        }
+        m_keys.insert(key);
+        m_order.push_back(key);
+        if (m_order.size() > m_capacity) {
+            m_keys.remove(m_order.front());
+            m_order.pop_front();
+        }
+        return true;
+    }
+
+private:
+    /**
+     * @brief Número máximo de huellas.
+     */
+    std::size_t m_capacity;
+
+    /**
+     * @brief Huellas recordadas.
+     */
+    QSet<quint64> m_keys;
+
+    /**
+     * @brief Huellas en orden de llegada.
+     */
+    std::deque<quint64> m_order;
+};
+
+/**
+ * @brief Presión arterial a medio emparejar.
+ */
+struct PendingPressure
+{
+    QDateTime dateTime;
+    int systolic = 0;
+    int diastolic = 0;
+};
+
+/**
+ * @brief Muestra tal como la lee el hilo del parser, antes de convertirla.
+ */
+struct RawSample
+{
+    Kind kind;
+    double scale;
+    QByteArray value;
+    QByteArray date;
+    qint64 correlation;
+};
+
+/**
+ * @brief Texto de presión arterial, con una mitad vacía si la muestra está incompleta.
+ * @param pressure Presión.
+ * @return "sistólica/diastólica", "sistólica/" o "/diastólica".
+ *
+ * Las mitades sueltas solo viajan de los hilos de procesamiento a la etapa de depuración, que
+ * las empareja o las descarta; nunca llegan a la base de datos.
+ */
+QString pressureText(const PendingPressure& pressure)
+{
+    return (pressure.systolic > 0 ? QString::number(pressure.systolic) : QString()) + '/'
+           + (pressure.diastolic > 0 ? QString::number(pressure.diastolic) : QString());
+}
+
+/**
+ * @brief Convierte un grupo de muestras. Se ejecuta en un hilo de IngestPipeline.
+ * @param samples Muestras leídas del archivo.
+ * @param userIdText Usuario al que se asignan los registros.
+ * @param output Resultado de la tarea.
+ *
+ * Las presiones de un mismo Correlation llegan juntas en la misma tarea y se emparejan aquí.
+ */
+void convertSamples(const std::vector<RawSample>& samples, const QString& userIdText, IngestOutput& output)
+{
+    const float noValue = std::numeric_limits<float>::quiet_NaN();
+    PendingPressure correlated;
+    qint64 correlation = 0;
+    auto flushCorrelation = [&]() {
+        if (correlation != 0 && (correlated.systolic > 0 || correlated.diastolic > 0)) {
+            output.records.append(healthrecord(QString(), userIdText, correlated.dateTime, noValue,
+                                               pressureText(correlated), noValue));
+        }
+        correlated = PendingPressure();
+        correlation = 0;
+    };
+
+    for (const RawSample& sample : samples) {
+        ++output.inputs;
+        if (sample.correlation != correlation) {
+            flushCorrelation();
+            correlation = sample.correlation;
+        }
+
+        float value = 0.0f;
+        QDateTime dateTime;
+        if (!RecordValidator::parseFloat(sample.value.constData(), sample.value.constData() + sample.value.size(), &value)
+            || value <= 0.0f || !parseSampleDate(sample.date, &dateTime)) {
+            ++output.rejected;
+            continue;
+        }
+        const float converted = static_cast<float>(value * sample.scale);
+
+        if (sample.kind == Systolic || sample.kind == Diastolic) {
+            PendingPressure loose;
+            PendingPressure& pressure = correlation != 0 ? correlated : loose;
+            if (!pressure.dateTime.isValid()) {
+                pressure.dateTime = dateTime;
+            }
+            (sample.kind == Systolic ? pressure.systolic : pressure.diastolic) = qRound(converted);
+            if (correlation == 0) {
+                output.records.append(healthrecord(QString(), userIdText, dateTime, noValue, pressureText(loose), noValue));
+            }
+        } else if (sample.kind == Weight) {
+            output.records.append(healthrecord(QString(), userIdText, dateTime, converted, QString(), noValue));
+        } else {
+            output.records.append(healthrecord(QString(), userIdText, dateTime, noValue, QString(), converted));
+        }
+    }
+    flushCorrelation();
+}
+
+/**
+ * @class SampleFilter
+ * @brief Etapa de depuración: empareja presiones sueltas y descarta muestras repetidas.
+ *
+ * Se ejecuta en el único hilo de depuración de IngestPipeline, en el orden del archivo, así que
+ * su estado no necesita sincronización.
+ */
+class SampleFilter
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param options Parámetros de la importación.
+     * @param userIdText Usuario al que se asignan las presiones emparejadas.
+     */
+    SampleFilter(const XMLImportOptions& options, const QString& userIdText)
+        : m_userIdText(userIdText)
+        , m_recent(options.dedupeWindow)
+        , m_pairingWindow(static_cast<std::size_t>(std::max(1, options.pairingWindow)))
+        , m_duplicates(0)
+        , m_unpaired(0)
+    {
+    }
+
+    /**
+     * @brief Filtra el resultado de una tarea.
+     * @param output Resultado de la tarea; sus registros se reemplazan por los que sobreviven.
+     */
+    void apply(IngestOutput& output)
+    {
+        QVector<healthrecord> kept;
+        kept.reserve(output.records.size());
+        for (const healthrecord& record : output.records) {
+            const QString bloodPressure = record.getBloodPressure();
+            const qint64 seconds = record.getDateTime().toSecsSinceEpoch();
+            if (bloodPressure.isEmpty()) {
+                const bool isWeight = !std::isnan(record.getWeight());
+                const float value = isWeight ? record.getWeight() : record.getGlucose();
+                if (m_recent.insert(fingerprint(isWeight ? Weight : Glucose, seconds, qRound64(value * 100.0)))) {
+                    kept.append(record);
+                } else {
+                    ++m_duplicates;
+                }
+                continue;
+            }
+
+            const int slash = bloodPressure.indexOf('/');
+            PendingPressure pressure;
+            pressure.dateTime = record.getDateTime();
+            pressure.systolic = bloodPressure.left(slash).toInt();
+            pressure.diastolic = bloodPressure.mid(slash + 1).toInt();
+            if (pressure.systolic > 0 && pressure.diastolic > 0) {
+                keepPressure(pressure, kept);
+            } else {
+                addLoose(pressure, seconds, kept);
+            }
+        }
+        output.records = kept;
+    }
+
+    /**
+     * @brief Muestras descartadas por repetidas.
+     * @return Número de muestras.
+     */
+    qint64 duplicates() const
+    {
+        return m_duplicates;
+    }
+
+    /**
+     * @brief Presiones que no encontraron pareja, incluidas las que aún esperan.
+     * @return Número de presiones.
+     */
+    qint64 unpaired() const
+    {
+        return m_unpaired + m_loose.size();
+    }
+
+private:
+    /**
+     * @brief Conserva una presión completa si no es repetida.
+     * @param pressure Presión.
+     * @param kept Registros que sobreviven.
+     */
+    void keepPressure(const PendingPressure& pressure, QVector<healthrecord>& kept)
+    {
+        const qint64 seconds = pressure.dateTime.toSecsSinceEpoch();
+        if (!m_recent.insert(fingerprint(Systolic, seconds, pressure.systolic * 1000LL + pressure.diastolic))) {
+            ++m_duplicates;
+            return;
+        }
+        const float noValue = std::numeric_limits<float>::quiet_NaN();
+        kept.append(healthrecord(QString(), m_userIdText, pressure.dateTime, noValue, pressureText(pressure), noValue));
+    }
+
+    /**
+     * @brief Guarda media presión hasta que llegue la otra mitad con la misma fecha.
+     * @param pressure Media presión.
+     * @param seconds Fecha en segundos desde la época.
+     * @param kept Registros que sobreviven.
+     */
+    void addLoose(const PendingPressure& pressure, qint64 seconds, QVector<healthrecord>& kept)
+    {
+        auto it = m_loose.find(seconds);
+        if (it == m_loose.end()) {
+            it = m_loose.insert(seconds, PendingPressure());
+            it->dateTime = pressure.dateTime;
+            m_looseOrder.push_back(seconds);
+        }
+        if (pressure.systolic > 0) {
+            it->systolic = pressure.systolic;
+        }
+        if (pressure.diastolic > 0) {
+            it->diastolic = pressure.diastolic;
+        }
+        if (it->systolic > 0 && it->diastolic > 0) {
+            keepPressure(*it, kept);
+            m_loose.erase(it);
+        }
+        while (m_looseOrder.size() > m_pairingWindow) {
+            if (m_loose.remove(m_looseOrder.front()) > 0) {
+                ++m_unpaired;
+            }
+            m_looseOrder.pop_front();
+        }
+    }
+
+    /**
+     * @brief Usuario al que se asignan las presiones emparejadas.
+     */
+    QString m_userIdText;
+
+    /**
+     * @brief Huellas de las muestras recientes.
+     */
+    RecentSet m_recent;
+
+    /**
+     * @brief Medias presiones sueltas por fecha.
+     */
+    QHash<qint64, PendingPressure> m_loose;
+
+    /**
+     * @brief Fechas de las medias presiones en orden de llegada.
+     */
+    std::deque<qint64> m_looseOrder;
+
+    /**
+     * @brief Medias presiones que se pueden retener.
+     */
+    std::size_t m_pairingWindow;
+
+    /**
+     * @brief Muestras descartadas por repetidas.
+     */
+    qint64 m_duplicates;
+
+    /**
+     * @brief Medias presiones descartadas al salir de la ventana.
+     */
+    qint64 m_unpaired;
+};
+}
+
+/**
+ * @brief Constructor del importador.
+ * @param parent Objeto padre, por defecto nullptr.
+ */
+XMLImporter::XMLImporter(QObject *parent)
+    : QObject(parent)
+    , m_cancelled(false)
+{
+}
+
+/**
+ * @brief Solicita la cancelación; la importación se detiene en el siguiente aviso de progreso.
+ */
+void XMLImporter::cancel()
+{
+    m_cancelled.store(true);
+}
+
+/**
+ * @brief Importa un archivo XML para un usuario. Bloquea hasta terminar.
+ * @param filePath Ruta del archivo.
+ * @param userId Usuario al que se asignan los registros.
+ * @param options Parámetros de la importación.
+ * @return Informe con los totales.
+ *
+ * La memoria usada está acotada por las tareas en vuelo de IngestPipeline y por las ventanas
+ * de duplicados y emparejamiento, no por el tamaño del archivo.
+ */
+XMLImportReport XMLImporter::importFile(const QString& filePath, int userId, const XMLImportOptions& options)
+{
+    XMLImportReport report;
+    m_cancelled.store(false);
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        report.error = "No se pudo abrir el archivo: " + file.errorString();
+        return report;
+    }
+    const qint64 fileSize = file.size();
+
+    const QString userIdText = QString::number(userId);
+    const std::size_t samplesPerTask = static_cast<std::size_t>(std::max(1, options.samplesPerTask));
+    const int progressInterval = std::max(1, options.progressInterval);
+
+    SampleFilter filter(options, userIdText);
+    IngestPipeline pipeline(options.ingest, [&filter](IngestOutput& output) { filter.apply(output); });
+
+    std::vector<RawSample> samples;
+    samples.reserve(samplesPerTask);
+    auto submitSamples = [&]() {
+        if (samples.empty()) {
+            return;
+        }
+        auto task = std::make_shared<std::vector<RawSample>>(std::move(samples));
+        pipeline.submit([task, userIdText](IngestOutput& output) { convertSamples(*task, userIdText, output); });
+        samples = std::vector<RawSample>();
+        samples.reserve(samplesPerTask);
+    };
+
+    qint64 correlation = 0;
+    bool inCorrelation = false;
+
+    QXmlStreamReader reader(&file);
+    qint64 elements = 0;
+    bool cancelled = false;
+    while (!reader.atEnd()) {
+        const QXmlStreamReader::TokenType token = reader.readNext();
+        if (token == QXmlStreamReader::EndElement) {
+            if (inCorrelation && reader.name() == QLatin1String("Correlation")) {
+                inCorrelation = false;
+            }
+            continue;
+        }
+        if (token != QXmlStreamReader::StartElement) {
+            continue;
+        }
+
+        if (++elements % progressInterval == 0) {
+            emit progress(file.pos(), fileSize);
+            if (m_cancelled.load()) {
+                cancelled = true;
+                break;
+            }
+        }
+
+        if (reader.name() == QLatin1String("Correlation")) {
+            inCorrelation = true;
+            ++correlation;
+            continue;
+        }
+        if (reader.name() != QLatin1String("Record")) {
+            continue;
+        }
+
+        const QXmlStreamAttributes attributes = reader.attributes();
+        RawSample sample;
+        sample.kind = kindForType(attributes.value(QLatin1String("type")));
+        if (sample.kind == Unknown) {
+            continue;
+        }
+        ++report.samples;
+        if (!unitScale(sample.kind, attributes.value(QLatin1String("unit")), &sample.scale)) {
+            ++report.invalid;
+            continue;
+        }
+        sample.value = attributes.value(QLatin1String("value")).toLatin1();
+        sample.date = attributes.value(QLatin1String("startDate")).toLatin1();
+        sample.correlation = inCorrelation ? correlation : 0;
+        samples.push_back(std::move(sample));
+
+        // Un Correlation nunca se reparte entre dos tareas
+        if (samples.size() >= samplesPerTask && !inCorrelation) {
+            submitSamples();
+        }
+    }
+    submitSamples();
+
+    const IngestResult result = pipeline.finish();
+    emit progress(cancelled ? file.pos() : fileSize, fileSize);
+
+    report.imported = result.imported;
+    report.invalid += result.rejected;
+    report.duplicates = filter.duplicates();
+    report.unpaired = filter.unpaired();
+    report.metrics = result.metrics;
+    if (cancelled) {
+        report.error = "Importación cancelada.";
+    } else if (reader.hasError()) {
+        report.error = QString("Error de XML en la línea %1: %2").arg(reader.lineNumber()).arg(reader.errorString());
+    } else if (result.failed > 0) {
+        report.error = QString("No se pudieron guardar %1 registros.").arg(result.failed);
+    }
+    report.ok = report.error.isEmpty();
+
+    qCInfo(lcDb) << "Importación XML de" << filePath << ": muestras" << report.samples << ", importadas" << report.imported
+             << ", repetidas" << report.duplicates << ", sin pareja" << report.unpaired << ", no válidas" << report.invalid
+             << ", hilos" << pipeline.workerCount();
+    return report;
+}
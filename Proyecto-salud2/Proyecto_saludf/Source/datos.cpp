@@ -6,32 +6,100 @@
  */
 
 #include "datos.h"
+#include "Logging.h"
+#include "Trace.h"
 #include "ui_datos.h"
 #include "DatabaseManager.h"
 #include "CSVExporter.h"
+#include "CSVImporter.h"
+#include "ColumnarFormat.h"
+#include "HealthRecordsModel.h"
+#include "ChangeFeed.h"
+#include "RecordValidator.h"
+#include "StallWatchdog.h"
+#include "XMLImporter.h"
 #include <QMessageBox>
 #include <QSqlQuery>
 #include <QSqlError>
-#include <QDebug>
-#include <QSqlQueryModel>
 #include <QSqlRecord>
 #include <QFileDialog>
 #include <QTimer>
+#include <QHeaderView>
+#include <QProgressDialog>
+#include <QFileInfo>
+#include <QEventLoop>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+namespace {
+/**
+ * @brief Preferencia con la última carpeta usada para importar o exportar.
+ */
+const QString kFolderPreference = QStringLiteral("carpeta_archivos");
+
+/**
+ * @brief Función de progreso de una importación: recibe lo procesado y el total, y devuelve false para cancelar.
+ */
+using ImportProgress = std::function<bool(qint64 done, qint64 total)>;
+
+/**
+ * @brief Ejecuta una importación en otro hilo mientras un diálogo de progreso modal mantiene viva la ventana.
+ * @param parent Ventana dueña del diálogo.
+ * @param work Importación; recibe la función de progreso que debe llamar entre fragmentos.
+ *
+ * La interfaz sigue procesando eventos en un QEventLoop local, así que la tabla se actualiza con
+ * ChangeFeed mientras llegan los lotes. Cancelar no interrumpe el lote en curso: la importación
+ * se detiene en la siguiente llamada a la función de progreso.
+ */
+void runImport(QWidget* parent, const std::function<void(const ImportProgress&)>& work)
+{
+    QProgressDialog progressDialog("Importando datos...", "Cancelar", 0, 1000, parent);
+    progressDialog.setWindowModality(Qt::WindowModal);
+    progressDialog.setMinimumDuration(0);
+    progressDialog.show();
+
+    std::atomic<bool> canceled(false);
+    QObject::connect(&progressDialog, &QProgressDialog::canceled, [&canceled]() { canceled = true; });
+
+    // El diálogo vive hasta después de join(); los avisos que queden en cola se descartan con él
+    QProgressDialog* dialog = &progressDialog;
+    const ImportProgress progress = [dialog, &canceled](qint64 done, qint64 total) {
+        const int value = total > 0 ? static_cast<int>(done * 1000 / total) : 0;
+        QMetaObject::invokeMethod(dialog, [dialog, value]() {
+            if (!dialog->wasCanceled()) {
+                dialog->setValue(value);
+            }
+        }, Qt::QueuedConnection);
+        return !canceled.load();
+    };
+
+    QEventLoop loop;
+    std::thread worker([&work, &progress, &loop]() {
+        work(progress);
+        QMetaObject::invokeMethod(&loop, "quit", Qt::QueuedConnection);
+    });
+    loop.exec();
+    worker.join();
+    progressDialog.reset();
+}
+}
 
 /**
  * @brief Constructor de la clase datos.
  * @param parent Puntero al widget padre, por defecto nullptr.
- * @param userId Identificador del usuario autenticado para cargar sus datos de salud.
+ * @param session Sesión del usuario autenticado cuyos datos de salud se cargan.
  *
  * Inicializa la interfaz, aplica estilos visuales, configura el modelo de datos, y muestra un mensaje
- * de bienvenida al usuario autenticado.
+ * de bienvenida al usuario autenticado. El nombre viene de la sesión, sin consultar la base de datos.
  */
-datos::datos(QWidget *parent, const QString& userId) :
+datos::datos(QWidget *parent, const Session& session) :
     QWidget(parent),
     ui(new Ui::datos),
-    currentUserId(userId),
+    m_session(session),
     model(nullptr),
-    welcomeMessageShown(false)
+    welcomeMessageShown(false),
+    refreshPending(false)
 {
     ui->setupUi(this);
 
@@ -202,27 +270,39 @@ datos::datos(QWidget *parent, const QString& userId) :
     ui->comboBox->addItem("Presión Arterial", "blood_pressure");
     ui->comboBox->addItem("Nivel de Glucosa", "glucose_level");
 
+    // Configurar filtros de la tabla
+    ui->filtroCampo->addItem("Peso (Kg)", "weight");
+    ui->filtroCampo->addItem("Presión Arterial", "blood_pressure");
+    ui->filtroCampo->addItem("Nivel de Glucosa", "glucose_level");
+    ui->filtroDesdeInput->setDateTime(QDateTime::currentDateTime().addMonths(-1));
+    ui->filtroHastaInput->setDateTime(QDateTime::currentDateTime());
+
     // Conectar botones
     connect(ui->btnCerrarSesion, &QPushButton::clicked, this, &datos::onbtnCerrarSesionClicked);
     connect(ui->guardarbutton, &QPushButton::clicked, this, &datos::onGuardarClicked);
     connect(ui->promediarButton, &QPushButton::clicked, this, &datos::onPromediarClicked);
     connect(ui->Exportar, &QPushButton::clicked, this, &datos::onExportButtonClicked);
+    connect(ui->importarButton, &QPushButton::clicked, this, &datos::onImportarClicked);
+    connect(ui->filtrarButton, &QPushButton::clicked, this, &datos::onFiltrarClicked);
+    connect(ui->limpiarFiltroButton, &QPushButton::clicked, this, &datos::onLimpiarFiltroClicked);
+
+    // Actualizar la tabla cuando cambien los registros del usuario, sin importar quién los escriba
+    connect(&ChangeFeed::instance(), &ChangeFeed::recordsChanged, this, &datos::onRecordsChanged);
 
     // Configurar tabla
     setupModelAndView();
 
+    // Ctrl+Shift+F12 muestra el informe de bloqueos de la interfaz
+    StallWatchdog::installShortcut(this);
+
     // Mostrar mensaje de bienvenida
     QTimer::singleShot(100, this, [=]() {
         if (!welcomeMessageShown) {
             welcomeMessageShown = true;
-            QSqlQuery query(DatabaseManager::instance().getDatabase());
-            query.prepare("SELECT username FROM users WHERE id = :userId");
-            query.bindValue(":userId", currentUserId.toInt());
-            if (query.exec() && query.next()) {
-                QString username = query.value(0).toString();
-                QMessageBox::information(this, "Bienvenido", "Has iniciado sesión como: " + username);
+            if (m_session.isValid()) {
+                QMessageBox::information(this, "Bienvenido", "Has iniciado sesión como: " + m_session.displayName());
             } else {
-                qDebug() << "Error al obtener nombre de usuario para user_id:" << currentUserId << ", Error:" << query.lastError().text();
+                qCWarning(lcUi) << "Ventana de datos abierta sin una sesión válida";
                 QMessageBox::warning(this, "Advertencia", "No se pudo obtener el nombre de usuario.");
             }
         }
@@ -248,77 +328,56 @@ datos::~datos()
 /**
  * @brief Configura el modelo de datos y la vista para mostrar los registros de salud.
  *
- * Inicializa el modelo QSqlQueryModel con los datos del usuario y configura la tabla
- * para mostrar los registros de salud.
+ * Inicializa el modelo HealthRecordsModel con los datos del usuario y configura la tabla
+ * para mostrar los registros de salud. El ordenamiento por columna se resuelve en SQL.
  */
 void datos::setupModelAndView()
 {
-    qDebug() << "Configurando modelo para user_id:" << currentUserId;
-
-    model = new QSqlQueryModel(this);
-    QString queryStr = QString(
-        "SELECT hr.id, hr.user_id, u.username, hr.date_time, hr.weight, hr.blood_pressure, hr.glucose_level "
-        "FROM health_records hr "
-        "JOIN users u ON hr.user_id = u.id "
-        "WHERE hr.user_id = %1"
-    ).arg(currentUserId.toInt());
-    model->setQuery(queryStr, DatabaseManager::instance().getDatabase());
-
-    if (model->lastError().isValid()) {
-        qDebug() << "Error al cargar datos en la tabla:" << model->lastError().text();
+    qCDebug(lcUi) << "Configurando modelo para user_id:" << m_session.userId();
+
+    model = new HealthRecordsModel(m_session.userId(), this);
+    if (!model->refresh()) {
+        qCWarning(lcUi) << "Error al cargar datos en la tabla:" << model->lastError().text();
     } else {
-        qDebug() << "Datos cargados en la tabla. Filas:" << model->rowCount();
+        qCDebug(lcUi) << "Datos cargados en la tabla. Filas:" << model->rowCount();
     }
 
-    model->setHeaderData(0, Qt::Horizontal, "ID");
-    model->setHeaderData(1, Qt::Horizontal, "User ID");
-    model->setHeaderData(2, Qt::Horizontal, "Username");
-    model->setHeaderData(3, Qt::Horizontal, "Fecha/Hora");
-    model->setHeaderData(4, Qt::Horizontal, "Peso (kg)");
-    model->setHeaderData(5, Qt::Horizontal, "Presión Arterial");
-    model->setHeaderData(6, Qt::Horizontal, "Nivel Glucosa");
-
     ui->tableView->setModel(model);
     ui->tableView->resizeColumnsToContents();
     ui->tableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
     ui->tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
     ui->tableView->setSelectionMode(QAbstractItemView::SingleSelection);
     ui->tableView->setAlternatingRowColors(true);
+    ui->tableView->horizontalHeader()->setSortIndicator(0, Qt::AscendingOrder);
+    ui->tableView->setSortingEnabled(true);
 }
 
 /**
  * @brief Slot para manejar el clic en el botón de guardar.
  *
- * Valida y guarda un nuevo registro de salud en la base de datos, actualizando la tabla
- * si la operación es exitosa.
+ * Valida y guarda un nuevo registro de salud en la base de datos. La tabla se actualiza
+ * al recibir el cambio desde ChangeFeed.
  */
 void datos::onGuardarClicked()
 {
+    TRACE_SPAN("ui", "datos::onGuardarClicked");
     QString weight = ui->pesoInput->text();
     QString bloodPressure = ui->presionInput->text();
     QString glucose = ui->glucosaInput->text();
     QDateTime dateTime = ui->fechahoraInput->dateTime();
 
-    if (weight.isEmpty() || bloodPressure.isEmpty() || glucose.isEmpty()) {
-        QMessageBox::warning(this, "Datos incompletos", "Por favor completa todos los campos.");
+    // Las mismas reglas se aplican a las importaciones (ver RecordValidator)
+    float weightVal = 0.0f;
+    float glucoseVal = 0.0f;
+    const RecordValidator::Result validation =
+        RecordValidator::validate(weight, bloodPressure, glucose, &weightVal, &glucoseVal);
+    if (validation != RecordValidator::Valid) {
+        QMessageBox::warning(this, validation == RecordValidator::MissingField ? "Datos incompletos" : "Datos inválidos",
+                             RecordValidator::message(validation));
         return;
     }
 
-    bool weightOk, glucoseOk;
-    float weightVal = weight.toFloat(&weightOk);
-    float glucoseVal = glucose.toFloat(&glucoseOk);
-
-    if (!weightOk || !glucoseOk) {
-        QMessageBox::warning(this, "Datos inválidos", "Por favor ingresa valores numéricos válidos para peso y glucosa.");
-        return;
-    }
-
-    if (!bloodPressure.contains("/")) {
-        QMessageBox::warning(this, "Datos inválidos", "La presión arterial debe tener el formato 'sistólica/diastólica'.");
-        return;
-    }
-
-    healthrecord record("", currentUserId, dateTime, weightVal, bloodPressure, glucoseVal);
+    healthrecord record("", QString::number(m_session.userId()), dateTime, weightVal, bloodPressure, glucoseVal);
 
     if (DatabaseManager::instance().addhealthrecord(record)) {
         QMessageBox::information(this, "Éxito", "Registro guardado correctamente.");
@@ -326,22 +385,96 @@ void datos::onGuardarClicked()
         ui->presionInput->clear();
         ui->glucosaInput->clear();
         ui->fechahoraInput->setDateTime(QDateTime::currentDateTime());
-
-        QString queryStr = QString(
-            "SELECT hr.id, hr.user_id, u.username, hr.date_time, hr.weight, hr.blood_pressure, hr.glucose_level "
-            "FROM health_records hr "
-            "JOIN users u ON hr.user_id = u.id "
-            "WHERE hr.user_id = %1"
-        ).arg(currentUserId.toInt());
-        model->setQuery(queryStr, DatabaseManager::instance().getDatabase());
-        if (model->lastError().isValid()) {
-            qDebug() << "Error al actualizar la tabla después de guardar:" << model->lastError().text();
-        }
     } else {
         QMessageBox::critical(this, "Error", "No se pudo guardar el registro.");
     }
 }
 
+/**
+ * @brief Slot para manejar el clic en el botón de filtrar.
+ *
+ * Construye los criterios a partir de los controles de filtro y los aplica al modelo.
+ * Los umbrales vacíos no se aplican.
+ */
+void datos::onFiltrarClicked()
+{
+    TRACE_SPAN("ui", "datos::onFiltrarClicked");
+    RecordFilter filter;
+    if (ui->filtroDesdeCheck->isChecked()) {
+        filter.from = ui->filtroDesdeInput->dateTime();
+    }
+    if (ui->filtroHastaCheck->isChecked()) {
+        filter.to = ui->filtroHastaInput->dateTime();
+    }
+    filter.valueField = ui->filtroCampo->currentData().toString();
+
+    const QString minText = ui->filtroMinInput->text().trimmed();
+    const QString maxText = ui->filtroMaxInput->text().trimmed();
+    bool minOk = true;
+    bool maxOk = true;
+    if (!minText.isEmpty()) {
+        filter.minValue = minText.toDouble(&minOk);
+        filter.hasMinValue = minOk;
+    }
+    if (!maxText.isEmpty()) {
+        filter.maxValue = maxText.toDouble(&maxOk);
+        filter.hasMaxValue = maxOk;
+    }
+    if (!minOk || !maxOk) {
+        QMessageBox::warning(this, "Datos inválidos", "Los umbrales del filtro deben ser valores numéricos.");
+        return;
+    }
+
+    model->setFilter(filter);
+}
+
+/**
+ * @brief Slot para manejar el clic en el botón de limpiar filtro.
+ *
+ * Restablece los controles de filtro y muestra de nuevo todos los registros.
+ */
+void datos::onLimpiarFiltroClicked()
+{
+    TRACE_SPAN("ui", "datos::onLimpiarFiltroClicked");
+    ui->filtroDesdeCheck->setChecked(false);
+    ui->filtroHastaCheck->setChecked(false);
+    ui->filtroMinInput->clear();
+    ui->filtroMaxInput->clear();
+    model->setFilter(RecordFilter());
+}
+
+/**
+ * @brief Slot que recibe los cambios confirmados en health_records.
+ * @param changes Cambios de una transacción.
+ *
+ * Ignora los cambios de otros usuarios y agrupa ráfagas de lotes en una sola actualización
+ * de la tabla por vuelta del bucle de eventos.
+ */
+void datos::onRecordsChanged(const QVector<RecordChange>& changes)
+{
+    TRACE_SPAN("ui", "datos::onRecordsChanged");
+    const int userId = m_session.userId();
+    bool affectsUser = false;
+    for (const RecordChange& change : changes) {
+        if (change.userId == userId) {
+            affectsUser = true;
+            break;
+        }
+    }
+    if (!affectsUser || refreshPending) {
+        return;
+    }
+
+    refreshPending = true;
+    QTimer::singleShot(0, this, [this]() {
+        TRACE_SPAN("ui", "datos::refresh");
+        refreshPending = false;
+        if (!model->refresh()) {
+            qCWarning(lcUi) << "Error al actualizar la tabla tras cambios en los registros:" << model->lastError().text();
+        }
+    });
+}
+
 /**
  * @brief Slot para manejar el clic en el botón de cerrar sesión.
  *
@@ -360,8 +493,9 @@ void datos::onbtnCerrarSesionClicked()
  */
 void datos::onPromediarClicked()
 {
+    TRACE_SPAN("ui", "datos::onPromediarClicked");
     QString selectedField = ui->comboBox->currentData().toString();
-    double promedio = DatabaseManager::instance().calculateAverage(selectedField, currentUserId.toInt());
+    double promedio = DatabaseManager::instance().calculateAverage(selectedField, m_session.userId());
     QString fieldText = ui->comboBox->currentText();
     QMessageBox::information(this, "Promedio Calculado",
                              "El promedio de " + fieldText + " es: " + QString::number(promedio, 'f', 2));
@@ -370,18 +504,132 @@ void datos::onPromediarClicked()
 /**
  * @brief Slot para manejar el clic en el botón de exportar.
  *
- * Exporta los registros de salud del usuario a un archivo CSV seleccionado por el usuario.
+ * Exporta los registros de salud del usuario a un archivo CSV seleccionado por el usuario,
+ * leyéndolos directamente de la base de datos. Si el archivo tiene extensión .hrc se usa el
+ * formato binario por columnas de ColumnarFormat.
  */
 void datos::onExportButtonClicked()
 {
-    QVector<healthrecord> records = DatabaseManager::instance().getHealthRecordsByUserId(currentUserId.toInt());
-    QString filePath = QFileDialog::getSaveFileName(this, "Guardar como CSV", "", "Archivos CSV (*.csv)");
+    TRACE_SPAN("ui", "datos::onExportButtonClicked");
+    QString filePath = QFileDialog::getSaveFileName(this, "Guardar como CSV", m_session.preference(kFolderPreference),
+                                                    "Archivos CSV (*.csv);;Archivos CSV comprimidos (*.csv.gz);;"
+                                                    "Archivos por columnas (*.hrc)");
     if (filePath.isEmpty()) {
         return;
     }
-    if (CSVExporter::exportToCSV(filePath, records)) {
+    m_session.setPreference(kFolderPreference, QFileInfo(filePath).absolutePath());
+    if (filePath.endsWith(".hrc", Qt::CaseInsensitive)) {
+        if (ColumnarFormat::exportUserRecords(filePath, m_session.userId())) {
+            QMessageBox::information(this, "Éxito", "Datos exportados en formato por columnas correctamente.");
+        } else {
+            QMessageBox::warning(this, "Error", "No se pudo exportar los datos en formato por columnas.");
+        }
+        return;
+    }
+    if (CSVExporter::exportUserRecords(filePath, m_session.userId())) {
         QMessageBox::information(this, "Éxito", "Datos exportados a CSV correctamente.");
     } else {
         QMessageBox::warning(this, "Error", "No se pudo exportar los datos a CSV.");
     }
 }
+
+/**
+ * @brief Slot para manejar el clic en el botón de importar.
+ *
+ * Importa los registros de un archivo CSV, .hrc (formato por columnas) o .xml (exportación de
+ * un teléfono o reloj) para el usuario actual. Las líneas que no pasan la validación se omiten
+ * y se listan en el resumen; la tabla se actualiza al recibir los cambios desde ChangeFeed.
+ * CSV y .hrc se importan en otro hilo con runImport(); el diálogo de progreso permite cancelar.
+ */
+void datos::onImportarClicked()
+{
+    TRACE_SPAN("ui", "datos::onImportarClicked");
+    QString filePath = QFileDialog::getOpenFileName(this, "Importar datos", m_session.preference(kFolderPreference),
+                                                    "Archivos CSV (*.csv);;Archivos por columnas (*.hrc);;"
+                                                    "Exportaciones de salud (*.xml)");
+    if (filePath.isEmpty()) {
+        return;
+    }
+    m_session.setPreference(kFolderPreference, QFileInfo(filePath).absolutePath());
+
+    if (filePath.endsWith(".xml", Qt::CaseInsensitive)) {
+        QProgressDialog progressDialog("Importando datos...", "Cancelar", 0, 1000, this);
+        progressDialog.setWindowModality(Qt::WindowModal);
+        progressDialog.setMinimumDuration(500);
+
+        XMLImporter importer;
+        connect(&importer, &XMLImporter::progress, &progressDialog, [&progressDialog](qint64 bytesRead, qint64 bytesTotal) {
+            progressDialog.setValue(bytesTotal > 0 ? static_cast<int>(bytesRead * 1000 / bytesTotal) : 0);
+        });
+        connect(&progressDialog, &QProgressDialog::canceled, &importer, &XMLImporter::cancel);
+
+        const XMLImportReport report = importer.importFile(filePath, m_session.userId());
+        progressDialog.reset();
+
+        QString summary = QString("Se importaron %1 de %2 mediciones.").arg(report.imported).arg(report.samples);
+        if (report.duplicates > 0 || report.unpaired > 0 || report.invalid > 0) {
+            summary += QString("\nRepetidas: %1. Presiones sin pareja: %2. No válidas: %3.")
+                           .arg(report.duplicates).arg(report.unpaired).arg(report.invalid);
+        }
+        if (!report.error.isEmpty()) {
+            summary += "\n" + report.error;
+        }
+        if (report.ok) {
+            QMessageBox::information(this, "Importación terminada", summary);
+        } else {
+            QMessageBox::warning(this, "Error", summary);
+        }
+        return;
+    }
+
+    const int userId = m_session.userId();
+    if (filePath.endsWith(".hrc", Qt::CaseInsensitive)) {
+        qint64 rows = 0;
+        bool success = false;
+        bool canceled = false;
+        runImport(this, [&](const ImportProgress& progress) {
+            success = ColumnarFormat::importFile(filePath, userId, &rows, [&](qint64 done, qint64 total) {
+                canceled = !progress(done, total);
+                return !canceled;
+            });
+        });
+        if (success) {
+            QMessageBox::information(this, "Éxito", QString("Se importaron %1 registros.").arg(rows));
+        } else if (canceled) {
+            QMessageBox::information(this, "Importación cancelada",
+                                     QString("Se importaron %1 registros antes de cancelar.").arg(rows));
+        } else {
+            QMessageBox::warning(this, "Error", "No se pudo importar el archivo.");
+        }
+        return;
+    }
+
+    CSVImportReport report;
+    runImport(this, [&](const ImportProgress& progress) {
+        CSVImportOptions options;
+        options.progress = progress;
+        report = CSVImporter::importFile(filePath, userId, options);
+    });
+
+    QString summary = QString("Se importaron %1 de %2 registros.").arg(report.imported).arg(report.lines);
+    if (!report.error.isEmpty()) {
+        summary += "\n" + report.error;
+    }
+
+    const bool finished = report.ok || report.canceled;
+    QMessageBox box(finished ? QMessageBox::Information : QMessageBox::Warning,
+                    report.ok ? "Importación terminada" : (report.canceled ? "Importación cancelada" : "Error"),
+                    summary, QMessageBox::Ok, this);
+    if (report.rejected > 0) {
+        box.setInformativeText(QString("%1 líneas fueron rechazadas.").arg(report.rejected));
+        QStringList details;
+        for (const RejectedLine& line : report.rejectedLines) {
+            details << QString("Línea %1: %2 (%3)").arg(line.lineNumber).arg(line.reason, line.text);
+        }
+        if (report.rejected > report.rejectedLines.size()) {
+            details << QString("... y %1 más.").arg(report.rejected - report.rejectedLines.size());
+        }
+        box.setDetailedText(details.join("\n"));
+    }
+    box.exec();
+}
@@ -6,6 +6,7 @@
  */
 
 #include "healthrecord.h"
+#include "RecordValidator.h"
 #include <QUuid>
 
 /**
@@ -79,3 +80,19 @@ float healthrecord::getGlucose() const
 {
     return m_glucose;
 }
+
+/**
+ * @brief Separa una presión arterial con formato "sistólica/diastólica" en sus dos valores.
+ * @param bloodPressure Texto de la presión arterial.
+ * @param systolic Presión sistólica resultante.
+ * @param diastolic Presión diastólica resultante.
+ * @return true si ambos valores son enteros positivos, false en caso contrario.
+ *
+ * Aplica la misma regla que RecordValidator usa al validar formularios e importaciones.
+ */
+bool healthrecord::parseBloodPressure(const QString& bloodPressure, int* systolic, int* diastolic)
+{
+    const QByteArray bytes = bloodPressure.toLatin1();
+    return RecordValidator::parseBloodPressure(bytes.constData(), bytes.constData() + bytes.size(),
+                                               systolic, diastolic);
+}
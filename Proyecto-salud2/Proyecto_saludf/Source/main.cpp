@@ -2,11 +2,45 @@
 #include <QLocale>
 #include <QTranslator>
 #include "mainwindow.h"
+#include "PasswordHasher.h"
+#include "Logging.h"
+#include "LogSink.h"
+#include "Metrics.h"
+#include "StallWatchdog.h"
+#include "Trace.h"
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
 
+    // Registro asíncrono; niveles con SALUD_LOG o --log=, por ejemplo --log=db=debug,auth=info
+    if (qEnvironmentVariableIsEmpty("QT_MESSAGE_PATTERN")) {
+        qSetMessagePattern("%{time hh:mm:ss.zzz} %{type} %{category}: %{message}");
+    }
+    LogSink::instance().install(qEnvironmentVariable("SALUD_LOG_FILE"));
+    QString logSpec = qEnvironmentVariable("SALUD_LOG");
+    for (const QString& argument : a.arguments()) {
+        if (argument.startsWith("--log=")) {
+            logSpec = argument.mid(6);
+        }
+    }
+    if (!logSpec.isEmpty() && !Logging::configure(logSpec)) {
+        qCWarning(lcUi) << "Configuración de registro no válida:" << logSpec;
+    }
+
+    // Traza de intervalos para chrome://tracing o ui.perfetto.dev: SALUD_TRACE=archivo o --trace[=archivo]
+    QString tracePath = qEnvironmentVariable("SALUD_TRACE");
+    for (const QString& argument : a.arguments()) {
+        if (argument == "--trace") {
+            tracePath = "salud-trace.json";
+        } else if (argument.startsWith("--trace=")) {
+            tracePath = argument.mid(8);
+        }
+    }
+    if (!tracePath.isEmpty()) {
+        Trace::instance().start(tracePath);
+    }
+
     QTranslator translator;
     const QStringList uiLanguages = QLocale::system().uiLanguages();
     for (const QString &locale : uiLanguages) {
@@ -16,7 +50,52 @@ int main(int argc, char *argv[])
             break;
         }
     }
+    // Ajustar el costo de las contraseñas a esta máquina antes del primer inicio de sesión
+    PasswordHasher::instance().calibrate();
+
+    // Vigilancia de bloqueos de la interfaz, solo si se pide: SALUD_STALL_MS=umbral o --stall[=umbral].
+    // Activa el marcado de intervalos de Trace, que cuesta en cada TRACE_SPAN y cada consulta.
+    int stallMs = qEnvironmentVariableIntValue("SALUD_STALL_MS");
+    for (const QString& argument : a.arguments()) {
+        if (argument == "--stall") {
+            stallMs = StallWatchdog::kDefaultThresholdMs;
+        } else if (argument.startsWith("--stall=")) {
+            stallMs = argument.mid(8).toInt();
+        }
+    }
+    if (stallMs > 0) {
+        StallWatchdog::instance().start(stallMs);
+    }
+
+    // Métricas: SALUD_METRICS_FILE (foto cada SALUD_METRICS_INTERVAL_MS, 15 s por defecto; .json
+    // para JSON) y SALUD_METRICS_PORT (HTTP en 127.0.0.1 con /metrics para Prometheus)
+    Metrics& metrics = Metrics::instance();
+    metrics.observe("salud_log_messages_dropped_total", "Mensajes de registro descartados por anillo lleno.",
+                    Metrics::CounterType, []() { return static_cast<double>(LogSink::instance().dropped()); });
+    metrics.observe("salud_trace_spans_dropped_total", "Intervalos de traza descartados por búfer lleno.",
+                    Metrics::CounterType, []() { return static_cast<double>(Trace::instance().dropped()); });
+    const QString metricsFile = qEnvironmentVariable("SALUD_METRICS_FILE");
+    if (!metricsFile.isEmpty()) {
+        bool intervalOk = false;
+        const int interval = qEnvironmentVariableIntValue("SALUD_METRICS_INTERVAL_MS", &intervalOk);
+        metrics.startSnapshots(metricsFile, intervalOk ? interval : 15000);
+    }
+    const int metricsPort = qEnvironmentVariableIntValue("SALUD_METRICS_PORT");
+    if (metricsPort > 0 && metricsPort < 65536) {
+        metrics.serve(static_cast<quint16>(metricsPort));
+    }
+
     MainWindow w;
     w.show();
-    return a.exec();
+    const int result = a.exec();
+
+    metrics.stopServing();
+    metrics.stopSnapshots();
+
+    StallWatchdog::instance().stop();
+    if (StallWatchdog::instance().summary().count > 0) {
+        qCInfo(lcUi).noquote() << StallWatchdog::instance().report();
+    }
+    Trace::instance().stop();
+    return result;
 }
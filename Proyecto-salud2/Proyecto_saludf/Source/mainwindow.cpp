@@ -6,10 +6,13 @@
  */
 
 #include "mainwindow.h"
+#include "Logging.h"
 #include "ui_mainwindow.h"
 #include "DatabaseManager.h"
+#include "StallWatchdog.h"
+#include "Trace.h"
 #include <QMessageBox>
-#include <QDebug>
+#include <QApplication>
 #include <QDir>
 
 /**
@@ -64,9 +67,9 @@ MainWindow::MainWindow(QWidget *parent)
     );
 
     if (QFile::exists("health_app.db")) {
-        qDebug() << "✅ Base de datos encontrada y lista para usar.";
+        qCInfo(lcUi) << "✅ Base de datos encontrada y lista para usar.";
     } else {
-        qDebug() << "⚠️ Archivo de base de datos no encontrado. Se creará uno nuevo.";
+        qCWarning(lcUi) << "⚠️ Archivo de base de datos no encontrado. Se creará uno nuevo.";
     }
 
     // Desconectar cualquier conexión automática
@@ -78,6 +81,9 @@ MainWindow::MainWindow(QWidget *parent)
     // Configurar el botón como no predeterminado
     ui->inibutton->setDefault(false);
     ui->inibutton->setAutoDefault(false);
+
+    // Ctrl+Shift+F12 muestra el informe de bloqueos de la interfaz
+    StallWatchdog::installShortcut(this);
 }
 
 /**
@@ -104,6 +110,7 @@ MainWindow::~MainWindow()
  */
 void MainWindow::on_rebutton_clicked()
 {
+    TRACE_SPAN("ui", "MainWindow::on_rebutton_clicked");
     this->hide();
     if (!registroWindow) {
         registroWindow = new registro(nullptr);
@@ -120,18 +127,20 @@ void MainWindow::on_rebutton_clicked()
 /**
  * @brief Slot para manejar el clic en el botón de iniciar sesión.
  *
- * Valida las credenciales ingresadas, muestra la ventana de datos si son correctas, o un mensaje
- * de error si no lo son. Utiliza isProcessing para evitar clics múltiples.
+ * Valida las credenciales ingresadas sin bloquear la interfaz, muestra la ventana de datos si son
+ * correctas, o un mensaje de error si no lo son. Utiliza isProcessing para evitar clics múltiples
+ * mientras la verificación está en curso.
  */
 void MainWindow::on_inibutton_clicked()
 {
+    TRACE_SPAN("ui", "MainWindow::on_inibutton_clicked");
     if (isProcessing) {
-        qDebug() << "Procesamiento en curso, ignorando clic adicional.";
+        qCDebug(lcUi) << "Procesamiento en curso, ignorando clic adicional.";
         return;
     }
 
     isProcessing = true;
-    qDebug() << "Iniciando procesamiento de inicio de sesión";
+    qCDebug(lcUi) << "Iniciando procesamiento de inicio de sesión";
 
     QString username = ui->lineEditusuario->text();
     QString password = ui->lineEditcontrasena->text();
@@ -142,27 +151,33 @@ void MainWindow::on_inibutton_clicked()
         return;
     }
 
-    DatabaseManager& dbManager = DatabaseManager::instance();
-    if (dbManager.checkCredentials(username, password)) {
-        User user = dbManager.getUserByUsername(username);
-        qDebug() << "Usuario autenticado. ID:" << user.getId() << ", Username:" << user.getUsername();
-
-        this->hide();
-        if (!datosWindow) {
-            datosWindow = new datos(nullptr, user.getId());
-            connect(datosWindow, &datos::cerrarSesion, this, [=]() {
-                this->show();
-                ui->lineEditcontrasena->clear();
-                datosWindow->deleteLater();
-                datosWindow = nullptr;
-            });
-            datosWindow->setAttribute(Qt::WA_DeleteOnClose);
+    // La contraseña se deriva en el pool de PasswordHasher; la ventana sigue respondiendo
+    ui->inibutton->setEnabled(false);
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    DatabaseManager::instance().authenticateAsync(username, password, this, [this](const Session& session) {
+        QApplication::restoreOverrideCursor();
+        ui->inibutton->setEnabled(true);
+
+        if (session.isValid()) {
+            qCDebug(lcUi) << "Usuario autenticado. ID:" << session.userId() << ", Username:" << session.displayName();
+
+            this->hide();
+            if (!datosWindow) {
+                datosWindow = new datos(nullptr, session);
+                connect(datosWindow, &datos::cerrarSesion, this, [=]() {
+                    this->show();
+                    ui->lineEditcontrasena->clear();
+                    datosWindow->deleteLater();
+                    datosWindow = nullptr;
+                });
+                datosWindow->setAttribute(Qt::WA_DeleteOnClose);
+            }
+            datosWindow->show();
+        } else {
+            QMessageBox::critical(this, "Error", "Usuario o contraseña incorrectos.");
         }
-        datosWindow->show();
-    } else {
-        QMessageBox::critical(this, "Error", "Usuario o contraseña incorrectos.");
-    }
 
-    isProcessing = false;
-    qDebug() << "Procesamiento de inicio de sesión finalizado";
+        isProcessing = false;
+        qCDebug(lcUi) << "Procesamiento de inicio de sesión finalizado";
+    });
 }
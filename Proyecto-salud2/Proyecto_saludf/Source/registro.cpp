@@ -6,10 +6,12 @@
  */
 
 #include "registro.h"
+#include "Logging.h"
+#include "Trace.h"
 #include "ui_registro.h"
 #include "DatabaseManager.h"
 #include <QMessageBox>
-#include <QDebug>
+#include <QApplication>
 
 /**
  * @brief Constructor de la clase registro.
@@ -93,9 +95,10 @@ registro::~registro() {
  * y emite la señal registroCerrado al completar el registro.
  */
 void registro::on_rebutton2_clicked() {
+    TRACE_SPAN("ui", "registro::on_rebutton2_clicked");
     // Evitar procesamiento múltiple
     if (isProcessing) {
-        qDebug() << "Clic ignorado: procesamiento en curso";
+        qCDebug(lcUi) << "Clic ignorado: procesamiento en curso";
         return;
     }
     isProcessing = true;
@@ -117,23 +120,29 @@ void registro::on_rebutton2_clicked() {
     }
 
     DatabaseManager& dbManager = DatabaseManager::instance();
-    qDebug() << "Intentando registrar usuario:" << username;
+    qCDebug(lcUi) << "Intentando registrar usuario:" << username;
 
-    bool registered = dbManager.registerUser(username, password);
-    qDebug() << "Resultado de registerUser:" << registered;
+    // La contraseña se deriva en el pool de PasswordHasher; la ventana sigue respondiendo
+    ui->rebutton2->setEnabled(false);
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    dbManager.registerUserAsync(username, password, this, [this](bool registered) {
+        QApplication::restoreOverrideCursor();
+        ui->rebutton2->setEnabled(true);
+        qCDebug(lcUi) << "Resultado de registerUser:" << registered;
 
-    if (registered) {
-        qDebug() << "Mostrando mensaje de éxito";
-        QMessageBox::information(this, "Registro Exitoso", "Usuario registrado correctamente.");
-        qDebug() << "Emitiendo registroCerrado y cerrando ventana";
-        emit registroCerrado();
-        this->close();
-    } else {
-        qDebug() << "Mostrando mensaje de error";
-        QMessageBox::critical(this, "Error", "No se pudo registrar el usuario. Intenta con otro nombre.");
-    }
+        if (registered) {
+            qCDebug(lcUi) << "Mostrando mensaje de éxito";
+            QMessageBox::information(this, "Registro Exitoso", "Usuario registrado correctamente.");
+            qCDebug(lcUi) << "Emitiendo registroCerrado y cerrando ventana";
+            emit registroCerrado();
+            this->close();
+        } else {
+            qCDebug(lcUi) << "Mostrando mensaje de error";
+            QMessageBox::critical(this, "Error", "No se pudo registrar el usuario. Intenta con otro nombre.");
+        }
 
-    isProcessing = false;
+        isProcessing = false;
+    });
 }
 
 /**
@@ -142,6 +151,7 @@ void registro::on_rebutton2_clicked() {
  * Emite la señal registroCerrado y cierra la ventana de registro.
  */
 void registro::on_cabutton_clicked() {
+    TRACE_SPAN("ui", "registro::on_cabutton_clicked");
     emit registroCerrado();
     this->close();
 }
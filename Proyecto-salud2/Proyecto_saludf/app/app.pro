@@ -0,0 +1,40 @@
+QT += core gui
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+CONFIG += c++17
+
+TARGET = Proyecto-salud2
+
+include(../core/core.pri)
+
+# You can make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+SOURCES += \
+    ../Source/StallWatchdog.cpp \
+    ../Source/datos.cpp \
+    ../Source/main.cpp \
+    ../Source/mainwindow.cpp \
+    ../Source/registro.cpp
+
+HEADERS += \
+    ../header/StallWatchdog.h \
+    ../header/datos.h \
+    ../header/mainwindow.h \
+    ../header/registro.h
+
+FORMS += \
+    ../forms/datos.ui \
+    ../forms/mainwindow.ui \
+    ../forms/registro.ui
+
+TRANSLATIONS += \
+    ../Proyecto-salud2_es_CO.ts
+CONFIG += lrelease
+CONFIG += embed_translations
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,485 @@
+/**
+ * @file CoreBenchmarks.cpp
+ * @brief Pruebas de rendimiento de los motores de datos, análisis y exportación.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "BenchmarkReport.h"
+#include "CSVExporter.h"
+#include "CSVImporter.h"
+#include "ColumnarFormat.h"
+#include "DatabaseManager.h"
+#include "HealthAnalyzer.h"
+#include "Logging.h"
+#include "SyntheticDataGenerator.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QtTest>
+
+/**
+ * @class CoreBenchmarks
+ * @brief Suite QBENCHMARK sobre una base de datos temporal llenada con datos sintéticos.
+ *
+ * El tamaño del conjunto se elige con SALUD_BENCH_ROWS, SALUD_BENCH_USERS, SALUD_BENCH_YEARS y
+ * SALUD_BENCH_SEED (ver SyntheticDataGenerator::Options), el de registerUsers() con
+ * SALUD_BENCH_ACCOUNTS (10000 por defecto), y los resultados se escriben en
+ * SALUD_BENCH_JSON. Las opciones habituales de QtTest (-iterations, -minimumvalue, -tickcounter,
+ * nombres de pruebas) siguen disponibles.
+ */
+class CoreBenchmarks : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructor.
+     */
+    CoreBenchmarks();
+
+private slots:
+    /**
+     * @brief Crea la base de datos temporal, registra los usuarios y carga el conjunto de datos.
+     */
+    void initTestCase();
+
+    /**
+     * @brief Escribe el informe JSON y cierra la base de datos temporal.
+     */
+    void cleanupTestCase();
+
+    /**
+     * @brief Inserción de un registro con DatabaseManager::addhealthrecord().
+     */
+    void addhealthrecord();
+
+    /**
+     * @brief Inserción de un lote de kBulkRows registros en una transacción.
+     */
+    void bulkInsert();
+
+    /**
+     * @brief Campos de calculateAverage().
+     */
+    void calculateAverage_data();
+
+    /**
+     * @brief Promedio de un campo de un usuario con DatabaseManager::calculateAverage().
+     */
+    void calculateAverage();
+
+    /**
+     * @brief Lectura de la serie completa de un usuario.
+     */
+    void getHealthRecordsByUserId();
+
+    /**
+     * @brief Construcción de HealthAnalyzer y cálculo de los tres promedios.
+     */
+    void healthAnalyzer();
+
+    /**
+     * @brief Exportación a CSV de un usuario leyendo de la base de datos con un cursor.
+     */
+    void exportUserRecords();
+
+    /**
+     * @brief Exportación a CSV de registros que ya están en memoria.
+     */
+    void exportToCSV();
+
+    /**
+     * @brief Alta en lote de SALUD_BENCH_ACCOUNTS cuentas con DatabaseManager::registerUsers().
+     */
+    void registerUsers();
+
+    /**
+     * @brief Importación de la serie del usuario de lectura desde CSV con CSVImporter::importFile().
+     */
+    void importCSV();
+
+    /**
+     * @brief Importación de la misma serie desde el formato por columnas con ColumnarFormat::importFile().
+     */
+    void importColumnar();
+
+private:
+    /**
+     * @brief Registros por lote en la carga inicial y en bulkInsert().
+     */
+    static const int kBulkRows = 10000;
+
+    /**
+     * @brief Nombre de la prueba en curso, con la etiqueta de datos si la tiene.
+     * @return Por ejemplo "calculateAverage/weight".
+     */
+    static QString currentName();
+
+    /**
+     * @brief Registra un usuario vacío que recibe una importación.
+     * @param username Nombre del usuario.
+     * @return Identificador del usuario, o 0 si no se pudo registrar.
+     */
+    static int registerImportTarget(const QString& username);
+
+    /**
+     * @brief Directorio de la base de datos y de las exportaciones.
+     */
+    QTemporaryDir m_directory;
+
+    /**
+     * @brief Generador del conjunto de datos.
+     */
+    SyntheticDataGenerator m_generator;
+
+    /**
+     * @brief Informe de resultados.
+     */
+    BenchmarkReport m_report;
+
+    /**
+     * @brief Identificadores de los usuarios sintéticos, en el orden del generador.
+     */
+    QVector<int> m_userIds;
+
+    /**
+     * @brief Usuario de las pruebas de escritura; no forma parte del conjunto medido en lectura.
+     */
+    int m_writerId;
+
+    /**
+     * @brief Usuario de las pruebas de lectura.
+     */
+    int m_readerId;
+
+    /**
+     * @brief Serie del usuario de lectura, para exportToCSV().
+     */
+    QVector<healthrecord> m_readerSeries;
+};
+
+/**
+ * @brief Constructor.
+ */
+CoreBenchmarks::CoreBenchmarks()
+    : m_generator(SyntheticDataGenerator::Options::fromEnvironment()),
+      m_report(QStringLiteral("salud-core")),
+      m_writerId(0),
+      m_readerId(0)
+{
+}
+
+/**
+ * @brief Nombre de la prueba en curso, con la etiqueta de datos si la tiene.
+ * @return Por ejemplo "calculateAverage/weight".
+ */
+QString CoreBenchmarks::currentName()
+{
+    const QString name = QString::fromLatin1(QTest::currentTestFunction());
+    const char* tag = QTest::currentDataTag();
+    return tag && *tag ? name + '/' + QString::fromLatin1(tag) : name;
+}
+
+/**
+ * @brief Registra un usuario vacío que recibe una importación.
+ * @param username Nombre del usuario.
+ * @return Identificador del usuario, o 0 si no se pudo registrar.
+ */
+int CoreBenchmarks::registerImportTarget(const QString& username)
+{
+    const QVector<RegistrationResult> registered =
+        DatabaseManager::instance().registerUsers({{username, QStringLiteral("sintetico-importacion")}});
+    if (registered.size() != 1 || registered.first().outcome != RegistrationResult::Registered) {
+        return 0;
+    }
+    return static_cast<int>(registered.first().userId);
+}
+
+/**
+ * @brief Crea la base de datos temporal, registra los usuarios y carga el conjunto de datos.
+ *
+ * La carga se mide una vez y se informa como "dataset_load"; con millones de filas es también
+ * la prueba de inserción masiva más representativa.
+ */
+void CoreBenchmarks::initTestCase()
+{
+    // Los mensajes informativos por operación distorsionan las mediciones
+    const QString logSpec = qEnvironmentVariable("SALUD_LOG");
+    Logging::configure(logSpec.isEmpty() ? QStringLiteral("*=warning") : logSpec);
+
+    QVERIFY(m_directory.isValid());
+    DatabaseManager::setDatabasePath(m_directory.filePath("benchmark.db"));
+    DatabaseManager& database = DatabaseManager::instance();
+
+    const SyntheticDataGenerator::Options& options = m_generator.options();
+    m_report.setParameter("rows", static_cast<double>(options.rows));
+    m_report.setParameter("users", options.users);
+    m_report.setParameter("years", options.years);
+    m_report.setParameter("seed", QString::number(options.seed));
+    m_report.setParameter("batch_rows", kBulkRows);
+
+    QVector<UserRegistration> users = m_generator.users();
+    users.append({QStringLiteral("sint_escritura"), QStringLiteral("sintetico-escritura")});
+    const QVector<RegistrationResult> registered = database.registerUsers(users);
+    QCOMPARE(registered.size(), users.size());
+    for (const RegistrationResult& result : registered) {
+        QCOMPARE(result.outcome, RegistrationResult::Registered);
+        m_userIds.append(static_cast<int>(result.userId));
+    }
+    m_writerId = m_userIds.takeLast();
+    m_readerId = m_userIds.first();
+
+    QElapsedTimer timer;
+    timer.start();
+    const bool loaded = m_generator.generate(m_userIds, kBulkRows, [&database](const QVector<healthrecord>& batch) {
+        return database.addhealthrecords(batch);
+    });
+    QVERIFY2(loaded, "No se pudo cargar el conjunto de datos sintético");
+    m_report.record("dataset_load", 1, timer.nsecsElapsed(), options.rows);
+
+    m_readerSeries = database.getHealthRecordsByUserId(m_readerId);
+    QCOMPARE(static_cast<qint64>(m_readerSeries.size()), m_generator.rowsForUser(0));
+}
+
+/**
+ * @brief Escribe el informe JSON y cierra la base de datos temporal.
+ *
+ * DatabaseManager es estático y se destruiría después que m_directory: se cierra aquí para que
+ * sus hilos y la conexión no sigan usando el directorio cuando QTemporaryDir lo borra.
+ */
+void CoreBenchmarks::cleanupTestCase()
+{
+    DatabaseManager::instance().shutdown();
+
+    const QString path = BenchmarkReport::outputPath();
+    QVERIFY2(m_report.write(path), qPrintable("No se pudo escribir " + path));
+    qInfo().noquote() << "Resultados escritos en" << QDir::toNativeSeparators(path);
+}
+
+/**
+ * @brief Inserción de un registro con DatabaseManager::addhealthrecord().
+ *
+ * Cada iteración usa una fecha nueva, posterior a la serie sintética, para medir siempre una
+ * inserción y no la actualización de una fila existente.
+ */
+void CoreBenchmarks::addhealthrecord()
+{
+    DatabaseManager& database = DatabaseManager::instance();
+    const QString userId = QString::number(m_writerId);
+    QDateTime dateTime(QDate(2100, 1, 1), QTime(0, 0), Qt::UTC);
+
+    BenchmarkReport::Measurement measurement(m_report, currentName(), 1);
+    QBENCHMARK {
+        dateTime = dateTime.addSecs(60);
+        QVERIFY(database.addhealthrecord(healthrecord("", userId, dateTime, 72.5f, "120/80", 95.0f)));
+        measurement.iteration();
+    }
+}
+
+/**
+ * @brief Inserción de un lote de kBulkRows registros en una transacción.
+ *
+ * El lote se desplaza un año en cada iteración, así que todas sus filas son nuevas; copiar el
+ * lote con la fecha desplazada es parte del tiempo medido, pero es despreciable frente a la
+ * escritura.
+ */
+void CoreBenchmarks::bulkInsert()
+{
+    DatabaseManager& database = DatabaseManager::instance();
+    const QString userId = QString::number(m_writerId);
+    QVector<healthrecord> batch;
+    batch.reserve(kBulkRows);
+    for (int i = 0; i < kBulkRows && i < m_readerSeries.size(); ++i) {
+        const healthrecord& source = m_readerSeries.at(i);
+        batch.append(healthrecord("", userId, source.getDateTime(), source.getWeight(),
+                                  source.getBloodPressure(), source.getGlucose()));
+    }
+    QVERIFY2(!batch.isEmpty(), "El usuario de lectura no tiene registros");
+
+    int round = 0;
+    BenchmarkReport::Measurement measurement(m_report, currentName(), batch.size());
+    QBENCHMARK {
+        ++round;
+        QVector<healthrecord> shifted;
+        shifted.reserve(batch.size());
+        for (const healthrecord& record : batch) {
+            shifted.append(healthrecord("", userId, record.getDateTime().addYears(200 + round), record.getWeight(),
+                                        record.getBloodPressure(), record.getGlucose()));
+        }
+        QVERIFY(database.addhealthrecords(shifted));
+        measurement.iteration();
+    }
+}
+
+/**
+ * @brief Campos de calculateAverage().
+ */
+void CoreBenchmarks::calculateAverage_data()
+{
+    QTest::addColumn<QString>("field");
+    QTest::newRow("weight") << QStringLiteral("weight");
+    QTest::newRow("glucose_level") << QStringLiteral("glucose_level");
+    QTest::newRow("blood_pressure") << QStringLiteral("blood_pressure");
+}
+
+/**
+ * @brief Promedio de un campo de un usuario con DatabaseManager::calculateAverage().
+ */
+void CoreBenchmarks::calculateAverage()
+{
+    QFETCH(QString, field);
+    DatabaseManager& database = DatabaseManager::instance();
+    double average = 0;
+
+    BenchmarkReport::Measurement measurement(m_report, currentName(), m_readerSeries.size());
+    QBENCHMARK {
+        average = database.calculateAverage(field, m_readerId);
+        measurement.iteration();
+    }
+    QVERIFY(average > 0);
+}
+
+/**
+ * @brief Lectura de la serie completa de un usuario.
+ */
+void CoreBenchmarks::getHealthRecordsByUserId()
+{
+    DatabaseManager& database = DatabaseManager::instance();
+    int rows = 0;
+
+    BenchmarkReport::Measurement measurement(m_report, currentName(), m_readerSeries.size());
+    QBENCHMARK {
+        rows = database.getHealthRecordsByUserId(m_readerId).size();
+        measurement.iteration();
+    }
+    QCOMPARE(rows, m_readerSeries.size());
+}
+
+/**
+ * @brief Construcción de HealthAnalyzer y cálculo de los tres promedios.
+ */
+void CoreBenchmarks::healthAnalyzer()
+{
+    float total = 0;
+
+    BenchmarkReport::Measurement measurement(m_report, currentName(), m_readerSeries.size());
+    QBENCHMARK {
+        HealthAnalyzer analyzer(m_readerId);
+        total = analyzer.averageWeight() + analyzer.averageGlucose() + analyzer.averageBloodPressure();
+        measurement.iteration();
+    }
+    QVERIFY(total > 0);
+}
+
+/**
+ * @brief Exportación a CSV de un usuario leyendo de la base de datos con un cursor.
+ */
+void CoreBenchmarks::exportUserRecords()
+{
+    const QString path = m_directory.filePath("usuario.csv");
+
+    BenchmarkReport::Measurement measurement(m_report, currentName(), m_readerSeries.size());
+    QBENCHMARK {
+        QVERIFY(CSVExporter::exportUserRecords(path, m_readerId));
+        measurement.iteration();
+    }
+}
+
+/**
+ * @brief Exportación a CSV de registros que ya están en memoria.
+ */
+void CoreBenchmarks::exportToCSV()
+{
+    const QString path = m_directory.filePath("memoria.csv");
+
+    BenchmarkReport::Measurement measurement(m_report, currentName(), m_readerSeries.size());
+    QBENCHMARK {
+        QVERIFY(CSVExporter::exportToCSV(path, m_readerSeries));
+        measurement.iteration();
+    }
+}
+
+/**
+ * @brief Alta en lote de SALUD_BENCH_ACCOUNTS cuentas con DatabaseManager::registerUsers().
+ *
+ * Domina la derivación de contraseñas con PasswordHasher::kProvisioningIterations repartida
+ * entre los núcleos. Se mide una sola vez: cada ronda necesita nombres nuevos y con diez mil
+ * cuentas tarda del orden de segundos.
+ */
+void CoreBenchmarks::registerUsers()
+{
+    bool ok = false;
+    const int accounts = qEnvironmentVariableIntValue("SALUD_BENCH_ACCOUNTS", &ok);
+    const int count = ok && accounts > 0 ? accounts : 10000;
+
+    QVector<UserRegistration> batch;
+    batch.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        batch.append({QStringLiteral("alta_%1").arg(i), QStringLiteral("clave-alta-%1").arg(i)});
+    }
+
+    DatabaseManager& database = DatabaseManager::instance();
+    QVector<RegistrationResult> registered;
+    BenchmarkReport::Measurement measurement(m_report, currentName(), count);
+    QBENCHMARK_ONCE {
+        registered = database.registerUsers(batch);
+        measurement.iteration();
+    }
+    QCOMPARE(registered.size(), count);
+    for (const RegistrationResult& result : registered) {
+        QCOMPARE(result.outcome, RegistrationResult::Registered);
+    }
+}
+
+/**
+ * @brief Importación de la serie del usuario de lectura desde CSV con CSVImporter::importFile().
+ *
+ * Se mide una sola vez hacia un usuario nuevo: repetirla sobre el mismo usuario solo combinaría
+ * filas idénticas. Se compara con importColumnar(), que carga la misma serie.
+ */
+void CoreBenchmarks::importCSV()
+{
+    const QString path = m_directory.filePath("importacion.csv");
+    QVERIFY(CSVExporter::exportUserRecords(path, m_readerId));
+    const int userId = registerImportTarget(QStringLiteral("sint_csv"));
+    QVERIFY(userId > 0);
+
+    CSVImportReport report;
+    BenchmarkReport::Measurement measurement(m_report, currentName(), m_readerSeries.size());
+    QBENCHMARK_ONCE {
+        report = CSVImporter::importFile(path, userId);
+        measurement.iteration();
+    }
+    QVERIFY2(report.ok, qPrintable(report.error));
+    QCOMPARE(report.imported, static_cast<qint64>(m_readerSeries.size()));
+}
+
+/**
+ * @brief Importación de la misma serie desde el formato por columnas con ColumnarFormat::importFile().
+ *
+ * Los grupos pasan por la misma cola de inserción y en lotes del mismo tamaño que importCSV(),
+ * así que la diferencia es el costo de leer y validar cada formato.
+ */
+void CoreBenchmarks::importColumnar()
+{
+    const QString path = m_directory.filePath("importacion.hrc");
+    QVERIFY(ColumnarFormat::exportUserRecords(path, m_readerId));
+    const int userId = registerImportTarget(QStringLiteral("sint_hrc"));
+    QVERIFY(userId > 0);
+
+    bool imported = false;
+    qint64 rows = 0;
+    BenchmarkReport::Measurement measurement(m_report, currentName(), m_readerSeries.size());
+    QBENCHMARK_ONCE {
+        imported = ColumnarFormat::importFile(path, userId, &rows);
+        measurement.iteration();
+    }
+    QVERIFY(imported);
+    QCOMPARE(rows, static_cast<qint64>(m_readerSeries.size()));
+}
+
+
+QTEST_GUILESS_MAIN(CoreBenchmarks)
+
+#include "CoreBenchmarks.moc"
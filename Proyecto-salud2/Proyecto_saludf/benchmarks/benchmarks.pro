@@ -0,0 +1,15 @@
+# Pruebas de rendimiento de los motores de datos, análisis y exportación.
+# Tamaño del conjunto: SALUD_BENCH_ROWS, SALUD_BENCH_USERS, SALUD_BENCH_YEARS, SALUD_BENCH_SEED.
+# Resultados en JSON: SALUD_BENCH_JSON (por defecto benchmark-results.json), SALUD_BENCH_LABEL.
+QT += testlib
+QT -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = salud-benchmarks
+
+include(../core/core.pri)
+
+SOURCES += \
+    Source/CoreBenchmarks.cpp
@@ -0,0 +1,632 @@
+/**
+ * @file CommandLineTool.cpp
+ * @brief Implementación de la clase CommandLineTool, las órdenes de salud-cli.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "CommandLineTool.h"
+#include "BenchmarkReport.h"
+#include "BulkExportJob.h"
+#include "CSVExporter.h"
+#include "CSVImporter.h"
+#include "ColumnarFormat.h"
+#include "DatabaseManager.h"
+#include "HealthAnalyzer.h"
+#include "IncrementalExporter.h"
+#include "Logging.h"
+#include "Metrics.h"
+#include "SyntheticDataGenerator.h"
+#include "Trace.h"
+#include "XMLImporter.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QThread>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+
+namespace {
+/**
+ * @brief Descripción de cada orden para --help.
+ */
+const char* const kCommandHelp =
+    "Órdenes:\n"
+    "  import <archivo>...   Importa CSV, .hrc o .xml (--user, --create-user, --password)\n"
+    "  export <ruta>         Exporta a CSV (.csv, .csv.gz, .csv.zst) o .hrc (--user o --all, --incremental);\n"
+    "                        con --all y una ruta sin extensión, un directorio de fragmentos en paralelo\n"
+    "  stats                 Totales de la base de datos, o promedios y tendencias de --user (--json)\n"
+    "  migrate               Aplica las migraciones pendientes y muestra el esquema\n"
+    "  vacuum                Compacta el archivo y actualiza las estadísticas del planificador\n"
+    "  benchmark             Carga datos sintéticos y mide el núcleo (--rows, --users, --seed, --repeat,\n"
+    "                        --report, --json); sin --db usa una base de datos temporal";
+
+/**
+ * @brief Número de líneas rechazadas que se listan tras una importación CSV.
+ */
+const int kRejectedLinesShown = 10;
+
+/**
+ * @brief Convierte un valor de HealthAnalyzer a JSON, con null para los promedios sin datos.
+ * @param value Valor.
+ * @return Número, o null si no es finito.
+ */
+QJsonValue jsonNumber(double value)
+{
+    return std::isfinite(value) ? QJsonValue(value) : QJsonValue();
+}
+}
+
+/**
+ * @brief Constructor. Define las opciones de la línea de comandos.
+ */
+CommandLineTool::CommandLineTool()
+    : m_out(stdout),
+      m_err(stderr),
+      m_dbOption(QStringList{"d", "db"}, "Archivo de la base de datos.", "ruta", DatabaseManager::databasePath()),
+      m_userOption(QStringList{"u", "user"}, "Nombre del usuario.", "nombre"),
+      m_createUserOption("create-user", "Crea el usuario de --user si no existe (import)."),
+      m_passwordOption("password", "Contraseña del usuario creado; también SALUD_CLI_PASSWORD.", "clave"),
+      m_allOption("all", "Todos los usuarios (export)."),
+      m_incrementalOption("incremental", "Exporta solo las filas nuevas desde la última exportación a este destino.",
+                          "destino"),
+      m_threadsOption("threads", "Tareas paralelas de la exportación de --all a un directorio.", "n"),
+      m_jsonOption("json", "Resultados en JSON (stats, benchmark)."),
+      m_rowsOption("rows", "Filas sintéticas (benchmark); también SALUD_BENCH_ROWS.", "n"),
+      m_usersOption("users", "Usuarios sintéticos (benchmark); también SALUD_BENCH_USERS.", "n"),
+      m_seedOption("seed", "Semilla de los datos sintéticos (benchmark); también SALUD_BENCH_SEED.", "n"),
+      m_repeatOption("repeat", "Repeticiones de cada medición (benchmark).", "n", "5"),
+      m_reportOption("report", "Archivo JSON con los resultados (benchmark).", "archivo"),
+      m_logOption("log", "Niveles de registro, por ejemplo db=debug,*=info; también SALUD_LOG.", "niveles"),
+      m_metricsOption("metrics", "Escribe una foto de las métricas al terminar (.json o Prometheus).", "archivo")
+{
+    m_parser.setApplicationDescription(QString::fromUtf8("Operaciones por lotes sobre la base de datos de salud.\n\n")
+                                       + QString::fromUtf8(kCommandHelp));
+    m_parser.addHelpOption();
+    m_parser.addOptions({m_dbOption, m_userOption, m_createUserOption, m_passwordOption, m_allOption,
+                         m_incrementalOption, m_threadsOption, m_jsonOption, m_rowsOption, m_usersOption,
+                         m_seedOption, m_repeatOption, m_reportOption, m_logOption, m_metricsOption});
+    m_parser.addPositionalArgument("orden", "import, export, stats, migrate, vacuum o benchmark.");
+    m_parser.addPositionalArgument("argumentos", "Archivos o ruta de la orden.", "[argumentos...]");
+}
+
+/**
+ * @brief Ejecuta la orden indicada en los argumentos.
+ * @param arguments Argumentos del proceso, incluido el nombre del programa.
+ * @return Código de salida.
+ */
+int CommandLineTool::run(const QStringList& arguments)
+{
+    if (!m_parser.parse(arguments)) {
+        return usageError(m_parser.errorText());
+    }
+    if (m_parser.isSet("help")) {
+        m_out << m_parser.helpText();
+        return Success;
+    }
+
+    // Registro en la salida de error; sin configuración solo avisos y errores
+    const QString logSpec = m_parser.isSet(m_logOption) ? m_parser.value(m_logOption) : qEnvironmentVariable("SALUD_LOG");
+    if (!Logging::configure(logSpec.isEmpty() ? QStringLiteral("*=warning") : logSpec)) {
+        return usageError("Configuración de registro no válida: " + logSpec);
+    }
+    const QString tracePath = qEnvironmentVariable("SALUD_TRACE");
+    if (!tracePath.isEmpty()) {
+        Trace::instance().start(tracePath);
+    }
+
+    QStringList positional = m_parser.positionalArguments();
+    if (positional.isEmpty()) {
+        return usageError("Falta la orden. Use --help para ver las órdenes disponibles.");
+    }
+    const QString command = positional.takeFirst();
+
+    int exitCode = UsageError;
+    if (command == "import") {
+        exitCode = positional.isEmpty() ? usageError("import necesita al menos un archivo.") : importFiles(positional);
+    } else if (command == "export") {
+        exitCode = positional.size() != 1 ? usageError("export necesita una ruta de salida.") : exportRecords(positional.first());
+    } else if (command == "stats" || command == "migrate" || command == "vacuum" || command == "benchmark") {
+        if (!positional.isEmpty()) {
+            exitCode = usageError(command + " no acepta argumentos: " + positional.join(' '));
+        } else if (command == "stats") {
+            exitCode = showStats();
+        } else if (command == "migrate") {
+            exitCode = migrate();
+        } else if (command == "vacuum") {
+            exitCode = vacuum();
+        } else {
+            exitCode = benchmark();
+        }
+    } else {
+        exitCode = usageError("Orden desconocida: " + command);
+    }
+
+    if (m_parser.isSet(m_metricsOption) && !Metrics::instance().writeSnapshot(m_parser.value(m_metricsOption))) {
+        m_err << "No se pudieron escribir las métricas en " << m_parser.value(m_metricsOption) << '\n';
+    }
+    if (!tracePath.isEmpty()) {
+        Trace::instance().stop();
+    }
+    return exitCode;
+}
+
+/**
+ * @brief Importa archivos CSV, .hrc o .xml.
+ * @param files Archivos a importar.
+ * @return Código de salida; Failure si algún archivo no se importó completo.
+ *
+ * Los archivos .hrc pueden importarse sin --user: cada fila conserva su usuario, como al
+ * restaurar una exportación de toda la base de datos.
+ */
+int CommandLineTool::importFiles(const QStringList& files)
+{
+    if (!openDatabase(m_parser.value(m_dbOption))) {
+        return Failure;
+    }
+    bool needsUser = false;
+    for (const QString& file : files) {
+        needsUser = needsUser || !file.endsWith(".hrc", Qt::CaseInsensitive);
+    }
+    int userId = 0;
+    if (!resolveUser(needsUser, &userId)) {
+        return needsUser && !m_parser.isSet(m_userOption) ? UsageError : Failure;
+    }
+
+    bool allOk = true;
+    for (const QString& file : files) {
+        if (file.endsWith(".xml", Qt::CaseInsensitive)) {
+            XMLImporter importer;
+            const XMLImportReport report = importer.importFile(file, userId);
+            m_out << file << ": " << report.imported << " de " << report.samples << " mediciones importadas"
+                  << " (repetidas " << report.duplicates << ", presiones sin pareja " << report.unpaired
+                  << ", no válidas " << report.invalid << ")\n";
+            if (!report.ok) {
+                m_err << file << ": " << report.error << '\n';
+                allOk = false;
+            }
+        } else if (file.endsWith(".hrc", Qt::CaseInsensitive)) {
+            qint64 rows = 0;
+            if (ColumnarFormat::importFile(file, userId, &rows)) {
+                m_out << file << ": " << rows << " registros importados\n";
+            } else {
+                m_err << file << ": no se pudo importar el archivo\n";
+                allOk = false;
+            }
+        } else {
+            const CSVImportReport report = CSVImporter::importFile(file, userId);
+            m_out << file << ": " << report.imported << " de " << report.lines << " registros importados, "
+                  << report.rejected << " líneas rechazadas\n";
+            for (int i = 0; i < report.rejectedLines.size() && i < kRejectedLinesShown; ++i) {
+                const RejectedLine& line = report.rejectedLines.at(i);
+                m_err << file << ":" << line.lineNumber << ": " << line.reason << " (" << line.text << ")\n";
+            }
+            if (!report.ok) {
+                m_err << file << ": " << report.error << '\n';
+                allOk = false;
+            }
+        }
+    }
+    return allOk ? Success : Failure;
+}
+
+/**
+ * @brief Exporta los registros de un usuario o de todos.
+ * @param path Archivo de salida, o directorio para la exportación en paralelo de --all.
+ * @return Código de salida.
+ */
+int CommandLineTool::exportRecords(const QString& path)
+{
+    const bool all = m_parser.isSet(m_allOption);
+    if (all == m_parser.isSet(m_userOption)) {
+        return usageError("export necesita --user o --all, pero no ambos.");
+    }
+    const bool columnar = path.endsWith(".hrc", Qt::CaseInsensitive);
+    const bool incremental = m_parser.isSet(m_incrementalOption);
+    const bool sharded = all && !columnar && !incremental && QFileInfo(path).suffix().isEmpty();
+    if (incremental && columnar) {
+        return usageError("--incremental solo admite CSV.");
+    }
+    if (all && !columnar && !incremental && !sharded) {
+        return usageError("export --all escribe un directorio de fragmentos, un archivo .hrc o, con --incremental, un CSV.");
+    }
+    qint64 threads = 0;
+    if (!positiveValue(m_threadsOption, QThread::idealThreadCount(), &threads)) {
+        return UsageError;
+    }
+    if (!openDatabase(m_parser.value(m_dbOption))) {
+        return Failure;
+    }
+    int userId = 0;
+    if (!all && !resolveUser(true, &userId)) {
+        return Failure;
+    }
+
+    if (incremental) {
+        qint64 rows = 0;
+        if (!IncrementalExporter::exportNewRecords(m_parser.value(m_incrementalOption), path, userId, CSVOptions(), &rows)) {
+            m_err << "No se pudo exportar a " << path << '\n';
+            return Failure;
+        }
+        m_out << path << ": " << rows << " filas nuevas\n";
+        return Success;
+    }
+
+    if (columnar) {
+        const bool ok = all ? ColumnarFormat::exportAllRecords(path) : ColumnarFormat::exportUserRecords(path, userId);
+        if (!ok) {
+            m_err << "No se pudo exportar a " << path << '\n';
+            return Failure;
+        }
+        m_out << path << ": " << QFileInfo(path).size() << " bytes\n";
+        return Success;
+    }
+
+    if (sharded) {
+        // Directorio de fragmentos con manifiesto; finished() se emite desde la última tarea
+        if (!QDir().mkpath(path)) {
+            m_err << "No se pudo crear el directorio " << path << '\n';
+            return Failure;
+        }
+        BulkExportJob job(path);
+        job.setThreadCount(static_cast<int>(threads));
+        bool success = false;
+        QObject::connect(&job, &BulkExportJob::finished, [&success](bool ok, const QString&) { success = ok; });
+        if (!job.start()) {
+            m_err << "No hay registros que exportar\n";
+            return Failure;
+        }
+        job.waitForFinished();
+        if (!success) {
+            m_err << "La exportación en paralelo falló; ver " << job.manifestPath() << '\n';
+            return Failure;
+        }
+        m_out << job.manifestPath() << '\n';
+        return Success;
+    }
+
+    if (!CSVExporter::exportUserRecords(path, userId)) {
+        m_err << "No se pudo exportar a " << path << '\n';
+        return Failure;
+    }
+    m_out << path << ": " << QFileInfo(path).size() << " bytes\n";
+    return Success;
+}
+
+/**
+ * @brief Muestra estadísticas de la base de datos o de un usuario.
+ * @return Código de salida.
+ */
+int CommandLineTool::showStats()
+{
+    if (!openDatabase(m_parser.value(m_dbOption))) {
+        return Failure;
+    }
+    int userId = 0;
+    if (!resolveUser(false, &userId)) {
+        return Failure;
+    }
+
+    QJsonObject stats;
+    stats.insert("database", QDir::toNativeSeparators(QFileInfo(DatabaseManager::databasePath()).absoluteFilePath()));
+    stats.insert("file_bytes", static_cast<double>(QFileInfo(DatabaseManager::databasePath()).size()));
+    stats.insert("wal_bytes", static_cast<double>(QFileInfo(DatabaseManager::databasePath() + "-wal").size()));
+
+    QSqlQuery query(DatabaseManager::instance().getDatabase());
+    if (userId > 0) {
+        query.prepare("SELECT COUNT(*), MIN(date_time), MAX(date_time) FROM health_records WHERE user_id = :user_id");
+        query.bindValue(":user_id", userId);
+    } else {
+        query.prepare("SELECT COUNT(*), MIN(date_time), MAX(date_time), (SELECT COUNT(*) FROM users) FROM health_records");
+    }
+    if (!query.exec() || !query.next()) {
+        m_err << "Error al consultar las estadísticas: " << query.lastError().text() << '\n';
+        return Failure;
+    }
+    stats.insert("records", static_cast<double>(query.value(0).toLongLong()));
+    stats.insert("first", query.value(1).toString());
+    stats.insert("last", query.value(2).toString());
+    if (userId == 0) {
+        stats.insert("users", static_cast<double>(query.value(3).toLongLong()));
+    } else {
+        const HealthAnalyzer analyzer(userId);
+        stats.insert("user", m_parser.value(m_userOption));
+        stats.insert("average_weight", jsonNumber(analyzer.averageWeight()));
+        stats.insert("average_glucose", jsonNumber(analyzer.averageGlucose()));
+        stats.insert("average_systolic", jsonNumber(analyzer.averageBloodPressure()));
+        stats.insert("weight_trend", jsonNumber(analyzer.weightTrend()));
+        stats.insert("glucose_trend", jsonNumber(analyzer.glucoseTrend()));
+        stats.insert("systolic_trend", jsonNumber(analyzer.bloodPressureTrend()));
+    }
+
+    if (m_parser.isSet(m_jsonOption)) {
+        m_out << QJsonDocument(stats).toJson(QJsonDocument::Indented);
+        return Success;
+    }
+    const QStringList keys = {"database", "file_bytes", "wal_bytes", "users", "user", "records", "first", "last",
+                              "average_weight", "average_glucose", "average_systolic",
+                              "weight_trend", "glucose_trend", "systolic_trend"};
+    for (const QString& key : keys) {
+        if (stats.contains(key)) {
+            const QJsonValue value = stats.value(key);
+            m_out << key.leftJustified(18) << (value.isDouble() ? QString::number(value.toDouble(), 'g', 10)
+                                                                : value.isNull() ? QStringLiteral("-") : value.toString())
+                  << '\n';
+        }
+    }
+    return Success;
+}
+
+/**
+ * @brief Abre la base de datos, lo que aplica las migraciones pendientes, y muestra el esquema.
+ * @return Código de salida.
+ *
+ * DatabaseManager migra el esquema y reaplica la bitácora de inserción al abrir; esta orden
+ * permite hacerlo de forma explícita (por ejemplo, antes de desplegar una versión nueva) y
+ * falla si algún paso no se completó.
+ */
+int CommandLineTool::migrate()
+{
+    if (!openDatabase(m_parser.value(m_dbOption))) {
+        return Failure;
+    }
+    QSqlQuery query(DatabaseManager::instance().getDatabase());
+    if (!query.exec("SELECT type, name FROM sqlite_master WHERE name NOT LIKE 'sqlite_%' ORDER BY type DESC, name")) {
+        m_err << "Error al leer el esquema: " << query.lastError().text() << '\n';
+        return Failure;
+    }
+    m_out << "Esquema al día en " << DatabaseManager::databasePath() << '\n';
+    while (query.next()) {
+        m_out << "  " << query.value(0).toString().leftJustified(6) << query.value(1).toString() << '\n';
+    }
+    return Success;
+}
+
+/**
+ * @brief Compacta la base de datos y actualiza las estadísticas del planificador.
+ * @return Código de salida.
+ */
+int CommandLineTool::vacuum()
+{
+    if (!openDatabase(m_parser.value(m_dbOption))) {
+        return Failure;
+    }
+    const QString path = DatabaseManager::databasePath();
+    const qint64 before = QFileInfo(path).size() + QFileInfo(path + "-wal").size();
+    if (!DatabaseManager::instance().vacuum()) {
+        m_err << "No se pudo compactar la base de datos\n";
+        return Failure;
+    }
+    const qint64 after = QFileInfo(path).size() + QFileInfo(path + "-wal").size();
+    m_out << path << ": " << before << " -> " << after << " bytes\n";
+    return Success;
+}
+
+/**
+ * @brief Carga datos sintéticos y mide las operaciones principales del núcleo.
+ * @return Código de salida.
+ *
+ * Registra los usuarios sintéticos, carga sus series por lotes y mide, sobre el primer usuario,
+ * calculateAverage, getHealthRecordsByUserId, HealthAnalyzer y la exportación CSV. Los usuarios
+ * sintéticos no deben existir: sobre una base de datos con datos se mediría una mezcla de
+ * inserciones y actualizaciones.
+ */
+int CommandLineTool::benchmark()
+{
+    SyntheticDataGenerator::Options options = SyntheticDataGenerator::Options::fromEnvironment();
+    qint64 rows = 0;
+    qint64 users = 0;
+    qint64 seed = 0;
+    qint64 repeat = 0;
+    if (!positiveValue(m_rowsOption, options.rows, &rows) || !positiveValue(m_usersOption, options.users, &users)
+        || !positiveValue(m_seedOption, static_cast<qint64>(options.seed), &seed)
+        || !positiveValue(m_repeatOption, 5, &repeat)) {
+        return UsageError;
+    }
+    options.rows = rows;
+    options.users = static_cast<int>(qMin<qint64>(users, rows));
+    options.seed = static_cast<quint64>(seed);
+
+    QTemporaryDir directory;
+    if (!directory.isValid()) {
+        m_err << "No se pudo crear un directorio temporal\n";
+        return Failure;
+    }
+    const QString dbPath = m_parser.isSet(m_dbOption) ? m_parser.value(m_dbOption) : directory.filePath("benchmark.db");
+    const int exitCode = openDatabase(dbPath) ? runBenchmark(options, repeat, directory.filePath("usuario.csv")) : Failure;
+
+    // DatabaseManager es estático: se cierra antes de que QTemporaryDir borre su archivo y su bitácora
+    DatabaseManager::instance().shutdown();
+    return exitCode;
+}
+
+/**
+ * @brief Carga el conjunto sintético en la base de datos abierta y mide las operaciones.
+ * @param options Tamaño y semilla del conjunto.
+ * @param repeat Repeticiones de cada medición.
+ * @param csvPath Archivo de la exportación medida.
+ * @return Código de salida.
+ */
+int CommandLineTool::runBenchmark(const SyntheticDataGenerator::Options& options, qint64 repeat, const QString& csvPath)
+{
+    DatabaseManager& database = DatabaseManager::instance();
+
+    const SyntheticDataGenerator generator(options);
+    BenchmarkReport report(QStringLiteral("salud-cli"));
+    report.setParameter("rows", static_cast<double>(options.rows));
+    report.setParameter("users", options.users);
+    report.setParameter("years", options.years);
+    report.setParameter("seed", QString::number(options.seed));
+    report.setParameter("repeat", static_cast<double>(repeat));
+
+    QVector<int> userIds;
+    const QVector<RegistrationResult> registered = database.registerUsers(generator.users());
+    for (const RegistrationResult& result : registered) {
+        if (result.outcome != RegistrationResult::Registered) {
+            m_err << "No se pudo registrar el usuario sintético " << result.username
+                  << "; use una base de datos vacía\n";
+            return Failure;
+        }
+        userIds.append(static_cast<int>(result.userId));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const bool loaded = generator.generate(userIds, 10000, [&database](const QVector<healthrecord>& batch) {
+        return database.addhealthrecords(batch);
+    });
+    if (!loaded) {
+        m_err << "No se pudo cargar el conjunto de datos sintético\n";
+        return Failure;
+    }
+    report.record("dataset_load", 1, timer.nsecsElapsed(), options.rows);
+
+    const int userId = userIds.first();
+    const qint64 userRows = generator.rowsForUser(0);
+    const auto measure = [&](const QString& name, const std::function<bool()>& operation) {
+        QElapsedTimer elapsed;
+        elapsed.start();
+        for (qint64 i = 0; i < repeat; ++i) {
+            if (!operation()) {
+                return false;
+            }
+        }
+        report.record(name, repeat, elapsed.nsecsElapsed(), userRows);
+        return true;
+    };
+    const QStringList fields = {"weight", "glucose_level", "blood_pressure"};
+    bool ok = true;
+    for (const QString& field : fields) {
+        ok = ok && measure("calculateAverage/" + field, [&]() { return database.calculateAverage(field, userId) > 0; });
+    }
+    ok = ok && measure("getHealthRecordsByUserId", [&]() {
+        return database.getHealthRecordsByUserId(userId).size() == userRows;
+    });
+    ok = ok && measure("healthAnalyzer", [&]() {
+        const HealthAnalyzer analyzer(userId);
+        return analyzer.averageWeight() + analyzer.averageGlucose() + analyzer.averageBloodPressure() > 0;
+    });
+    ok = ok && measure("exportUserRecords", [&]() { return CSVExporter::exportUserRecords(csvPath, userId); });
+    if (!ok) {
+        m_err << "Una de las operaciones medidas falló\n";
+        return Failure;
+    }
+
+    if (m_parser.isSet(m_reportOption) && !report.write(m_parser.value(m_reportOption))) {
+        m_err << "No se pudo escribir " << m_parser.value(m_reportOption) << '\n';
+        return Failure;
+    }
+    if (m_parser.isSet(m_jsonOption)) {
+        m_out << QJsonDocument(report.toJson()).toJson(QJsonDocument::Indented);
+        return Success;
+    }
+    m_out << QStringLiteral("%1 %2 %3").arg("prueba", -28).arg("ms/iter", 12).arg("filas/s", 14) << '\n';
+    for (const BenchmarkReport::Result& result : report.results()) {
+        const double rowsPerSecond = result.nsPerIteration > 0 ? result.rowsPerIteration * 1e9 / result.nsPerIteration : 0;
+        m_out << QStringLiteral("%1 %2 %3")
+                     .arg(result.name, -28)
+                     .arg(result.nsPerIteration / 1e6, 12, 'f', 3)
+                     .arg(rowsPerSecond, 14, 'f', 0)
+              << '\n';
+    }
+    return Success;
+}
+
+/**
+ * @brief Apunta DatabaseManager a la ruta indicada y la abre.
+ * @param path Archivo de la base de datos.
+ * @return true si la base de datos quedó lista.
+ */
+bool CommandLineTool::openDatabase(const QString& path)
+{
+    DatabaseManager::setDatabasePath(path);
+    if (!DatabaseManager::instance().isReady()) {
+        m_err << "No se pudo abrir o inicializar la base de datos " << path << '\n';
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Identificador del usuario de --user, creándolo si se pidió --create-user.
+ * @param required Si es true, falta de --user es un error.
+ * @param userId Recibe el identificador, o 0 si no se indicó usuario.
+ * @return true si el usuario existe (o se creó), o no se indicó y no era obligatorio.
+ *
+ * La cuenta se crea con el costo de contraseña de aprovisionamiento, que se eleva al costo
+ * calibrado en el primer inicio de sesión, igual que en el registro en lote.
+ */
+bool CommandLineTool::resolveUser(bool required, int* userId)
+{
+    *userId = 0;
+    if (!m_parser.isSet(m_userOption)) {
+        if (required) {
+            usageError("Falta --user.");
+        }
+        return !required;
+    }
+
+    const QString username = m_parser.value(m_userOption);
+    DatabaseManager& database = DatabaseManager::instance();
+    const User user = database.getUserByUsername(username);
+    if (!user.getId().isEmpty()) {
+        *userId = user.getId().toInt();
+        return true;
+    }
+    if (!m_parser.isSet(m_createUserOption)) {
+        m_err << "El usuario " << username << " no existe (use --create-user para crearlo)\n";
+        return false;
+    }
+
+    const QString password = m_parser.isSet(m_passwordOption) ? m_parser.value(m_passwordOption)
+                                                               : qEnvironmentVariable("SALUD_CLI_PASSWORD");
+    const QVector<RegistrationResult> results = database.registerUsers({UserRegistration{username, password}});
+    if (results.isEmpty() || results.first().outcome != RegistrationResult::Registered) {
+        m_err << "No se pudo crear el usuario " << username
+              << (password.isEmpty() ? " (falta --password o SALUD_CLI_PASSWORD)" : "") << '\n';
+        return false;
+    }
+    *userId = static_cast<int>(results.first().userId);
+    m_out << "Usuario " << username << " creado\n";
+    return true;
+}
+
+/**
+ * @brief Entero positivo de una opción.
+ * @param option Opción.
+ * @param fallback Valor si la opción no se indicó.
+ * @param value Recibe el valor.
+ * @return false si la opción no es un entero positivo.
+ */
+bool CommandLineTool::positiveValue(const QCommandLineOption& option, qint64 fallback, qint64* value)
+{
+    *value = fallback;
+    if (!m_parser.isSet(option)) {
+        return true;
+    }
+    bool ok = false;
+    *value = m_parser.value(option).toLongLong(&ok);
+    if (!ok || *value <= 0) {
+        usageError(QStringLiteral("--%1 debe ser un entero positivo: %2").arg(option.names().last(), m_parser.value(option)));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Escribe un error y devuelve el código de uso incorrecto.
+ * @param message Descripción del error.
+ * @return UsageError.
+ */
+int CommandLineTool::usageError(const QString& message)
+{
+    m_err << QCoreApplication::applicationName() << ": " << message << '\n';
+    return UsageError;
+}
@@ -0,0 +1,15 @@
+#include <QCoreApplication>
+#include "CommandLineTool.h"
+
+int main(int argc, char *argv[])
+{
+    // Sin QtGui ni QtWidgets: funciona sin pantalla
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("salud-cli");
+    if (qEnvironmentVariableIsEmpty("QT_MESSAGE_PATTERN")) {
+        qSetMessagePattern("%{time hh:mm:ss.zzz} %{type} %{category}: %{message}");
+    }
+
+    CommandLineTool tool;
+    return tool.run(a.arguments());
+}
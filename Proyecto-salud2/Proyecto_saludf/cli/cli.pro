@@ -0,0 +1,24 @@
+# salud-cli: importación, exportación, estadísticas, migración, compactación y pruebas de
+# rendimiento por lotes, sin pantalla ni QtWidgets.
+QT -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = salud-cli
+
+include(../core/core.pri)
+
+INCLUDEPATH += header
+
+SOURCES += \
+    Source/CommandLineTool.cpp \
+    Source/main.cpp
+
+HEADERS += \
+    header/CommandLineTool.h
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,220 @@
+/**
+ * @file CommandLineTool.h
+ * @brief Declaración de la clase CommandLineTool, las órdenes de salud-cli.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef COMMANDLINETOOL_H
+#define COMMANDLINETOOL_H
+
+#include "SyntheticDataGenerator.h"
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QStringList>
+#include <QTextStream>
+
+/**
+ * @class CommandLineTool
+ * @brief Operaciones por lotes sobre una base de datos, sin pantalla ni QtWidgets.
+ *
+ * Órdenes: import, export, stats, migrate, vacuum y benchmark. Todas trabajan sobre el archivo
+ * indicado con --db (health_app.db por defecto) usando el mismo núcleo que la aplicación de
+ * escritorio. Los resultados se escriben en la salida estándar y los mensajes de registro
+ * (desde warning, o según --log / SALUD_LOG) en la salida de error.
+ */
+class CommandLineTool
+{
+public:
+    /**
+     * @brief Códigos de salida del proceso.
+     */
+    enum ExitCode {
+        Success = 0,   ///< La orden terminó bien.
+        Failure = 1,   ///< La orden falló.
+        UsageError = 2 ///< Orden u opciones no válidas.
+    };
+
+    /**
+     * @brief Constructor. Define las opciones de la línea de comandos.
+     */
+    CommandLineTool();
+
+    /**
+     * @brief Ejecuta la orden indicada en los argumentos.
+     * @param arguments Argumentos del proceso, incluido el nombre del programa.
+     * @return Código de salida.
+     */
+    int run(const QStringList& arguments);
+
+private:
+    /**
+     * @brief Importa archivos CSV, .hrc o .xml.
+     * @param files Archivos a importar.
+     * @return Código de salida.
+     */
+    int importFiles(const QStringList& files);
+
+    /**
+     * @brief Exporta los registros de un usuario o de todos.
+     * @param path Archivo de salida, o directorio para la exportación en paralelo de --all.
+     * @return Código de salida.
+     */
+    int exportRecords(const QString& path);
+
+    /**
+     * @brief Muestra estadísticas de la base de datos o de un usuario.
+     * @return Código de salida.
+     */
+    int showStats();
+
+    /**
+     * @brief Abre la base de datos, lo que aplica las migraciones pendientes, y muestra el esquema.
+     * @return Código de salida.
+     */
+    int migrate();
+
+    /**
+     * @brief Compacta la base de datos y actualiza las estadísticas del planificador.
+     * @return Código de salida.
+     */
+    int vacuum();
+
+    /**
+     * @brief Carga datos sintéticos y mide las operaciones principales del núcleo.
+     * @return Código de salida.
+     */
+    int benchmark();
+
+    /**
+     * @brief Carga el conjunto sintético en la base de datos abierta y mide las operaciones.
+     * @param options Tamaño y semilla del conjunto.
+     * @param repeat Repeticiones de cada medición.
+     * @param csvPath Archivo de la exportación medida.
+     * @return Código de salida.
+     */
+    int runBenchmark(const SyntheticDataGenerator::Options& options, qint64 repeat, const QString& csvPath);
+
+    /**
+     * @brief Apunta DatabaseManager a la ruta indicada y la abre.
+     * @param path Archivo de la base de datos.
+     * @return true si la base de datos quedó lista.
+     */
+    bool openDatabase(const QString& path);
+
+    /**
+     * @brief Identificador del usuario de --user, creándolo si se pidió --create-user.
+     * @param required Si es true, falta de --user es un error.
+     * @param userId Recibe el identificador, o 0 si no se indicó usuario.
+     * @return true si el usuario existe (o se creó), o no se indicó y no era obligatorio.
+     */
+    bool resolveUser(bool required, int* userId);
+
+    /**
+     * @brief Entero positivo de una opción.
+     * @param option Opción.
+     * @param fallback Valor si la opción no se indicó.
+     * @param value Recibe el valor.
+     * @return false si la opción no es un entero positivo.
+     */
+    bool positiveValue(const QCommandLineOption& option, qint64 fallback, qint64* value);
+
+    /**
+     * @brief Escribe un error y devuelve el código de uso incorrecto.
+     * @param message Descripción del error.
+     * @return UsageError.
+     */
+    int usageError(const QString& message);
+
+    /**
+     * @brief Analizador de la línea de comandos.
+     */
+    QCommandLineParser m_parser;
+
+    /**
+     * @brief Salida estándar, para los resultados.
+     */
+    QTextStream m_out;
+
+    /**
+     * @brief Salida de error, para los errores y avisos.
+     */
+    QTextStream m_err;
+
+    /**
+     * @brief --db: archivo de la base de datos.
+     */
+    QCommandLineOption m_dbOption;
+
+    /**
+     * @brief --user: nombre del usuario.
+     */
+    QCommandLineOption m_userOption;
+
+    /**
+     * @brief --create-user: crear el usuario de --user si no existe (import).
+     */
+    QCommandLineOption m_createUserOption;
+
+    /**
+     * @brief --password: contraseña del usuario creado con --create-user.
+     */
+    QCommandLineOption m_passwordOption;
+
+    /**
+     * @brief --all: todos los usuarios (export).
+     */
+    QCommandLineOption m_allOption;
+
+    /**
+     * @brief --incremental: exportar solo lo nuevo desde la última exportación a un destino.
+     */
+    QCommandLineOption m_incrementalOption;
+
+    /**
+     * @brief --threads: tareas paralelas de la exportación de --all a un directorio.
+     */
+    QCommandLineOption m_threadsOption;
+
+    /**
+     * @brief --json: resultados en JSON (stats, benchmark).
+     */
+    QCommandLineOption m_jsonOption;
+
+    /**
+     * @brief --rows: filas sintéticas (benchmark).
+     */
+    QCommandLineOption m_rowsOption;
+
+    /**
+     * @brief --users: usuarios sintéticos (benchmark).
+     */
+    QCommandLineOption m_usersOption;
+
+    /**
+     * @brief --seed: semilla de los datos sintéticos (benchmark).
+     */
+    QCommandLineOption m_seedOption;
+
+    /**
+     * @brief --repeat: repeticiones de cada medición (benchmark).
+     */
+    QCommandLineOption m_repeatOption;
+
+    /**
+     * @brief --report: archivo JSON con los resultados (benchmark).
+     */
+    QCommandLineOption m_reportOption;
+
+    /**
+     * @brief --log: niveles de registro por categoría.
+     */
+    QCommandLineOption m_logOption;
+
+    /**
+     * @brief --metrics: archivo donde se escribe una foto de las métricas al terminar.
+     */
+    QCommandLineOption m_metricsOption;
+};
+
+#endif // COMMANDLINETOOL_H
@@ -0,0 +1,15 @@
+# Enlace con el núcleo (core.pro) para los proyectos hermanos: app, cli y benchmarks.
+QT += core sql network
+
+INCLUDEPATH += $$PWD/../header
+DEPENDPATH += $$PWD/../header
+
+SALUD_CORE_DIR = $$OUT_PWD/../core
+win32:CONFIG(release, debug|release): SALUD_CORE_DIR = $$SALUD_CORE_DIR/release
+else:win32:CONFIG(debug, debug|release): SALUD_CORE_DIR = $$SALUD_CORE_DIR/debug
+
+LIBS += -L$$SALUD_CORE_DIR -lsaludcore
+win32:!win32-g++: PRE_TARGETDEPS += $$SALUD_CORE_DIR/saludcore.lib
+else: PRE_TARGETDEPS += $$SALUD_CORE_DIR/libsaludcore.a
+
+salud_zstd: LIBS += -lzstd
@@ -0,0 +1,87 @@
+# Núcleo sin widgets: base de datos, importación, exportación, análisis y diagnóstico.
+# Lo enlazan la aplicación de escritorio, salud-cli y las pruebas de rendimiento.
+TEMPLATE = lib
+CONFIG += staticlib c++17
+QT += core sql network
+QT -= gui
+
+TARGET = saludcore
+
+INCLUDEPATH += ../header
+DEPENDPATH += ../header
+
+# Exportaciones comprimidas con zstd (.zst): qmake CONFIG+=salud_zstd. gzip (.gz) no necesita dependencias adicionales.
+salud_zstd: DEFINES += SALUD_WITH_ZSTD
+
+SOURCES += \
+    ../Source/BenchmarkReport.cpp \
+    ../Source/BulkExportJob.cpp \
+    ../Source/CSVExporter.cpp \
+    ../Source/CSVImporter.cpp \
+    ../Source/CSVScanner.cpp \
+    ../Source/CSVWriter.cpp \
+    ../Source/ChangeFeed.cpp \
+    ../Source/Checksum.cpp \
+    ../Source/ColumnarFormat.cpp \
+    ../Source/DatabaseManager.cpp \
+    ../Source/HealthAnalyzer.cpp \
+    ../Source/HealthRecordsModel.cpp \
+    ../Source/IncrementalExporter.cpp \
+    ../Source/IngestJournal.cpp \
+    ../Source/IngestPipeline.cpp \
+    ../Source/IngestQueue.cpp \
+    ../Source/LatencyHistogram.cpp \
+    ../Source/LogSink.cpp \
+    ../Source/Logging.cpp \
+    ../Source/Metrics.cpp \
+    ../Source/ParallelCompressor.cpp \
+    ../Source/PasswordHasher.cpp \
+    ../Source/QueryStats.cpp \
+    ../Source/RecordValidator.cpp \
+    ../Source/Session.cpp \
+    ../Source/SyntheticDataGenerator.cpp \
+    ../Source/TimeSeriesCodec.cpp \
+    ../Source/TimeSeriesStore.cpp \
+    ../Source/Trace.cpp \
+    ../Source/User.cpp \
+    ../Source/XMLImporter.cpp \
+    ../Source/healthrecord.cpp
+
+HEADERS += \
+    ../header/BenchmarkReport.h \
+    ../header/BoundedQueue.h \
+    ../header/BulkExportJob.h \
+    ../header/CSVExporter.h \
+    ../header/CSVImporter.h \
+    ../header/CSVScanner.h \
+    ../header/CSVWriter.h \
+    ../header/ChangeFeed.h \
+    ../header/Checksum.h \
+    ../header/ColumnarFormat.h \
+    ../header/DatabaseManager.h \
+    ../header/HealthAnalyzer.h \
+    ../header/HealthRecordsModel.h \
+    ../header/IncrementalExporter.h \
+    ../header/IngestJournal.h \
+    ../header/IngestPipeline.h \
+    ../header/IngestQueue.h \
+    ../header/LatencyHistogram.h \
+    ../header/LogSink.h \
+    ../header/Logging.h \
+    ../header/LruCache.h \
+    ../header/Metrics.h \
+    ../header/MpscRing.h \
+    ../header/ParallelCompressor.h \
+    ../header/PasswordHasher.h \
+    ../header/QueryStats.h \
+    ../header/RecordFilter.h \
+    ../header/RecordValidator.h \
+    ../header/Session.h \
+    ../header/SyntheticDataGenerator.h \
+    ../header/TimeSeriesCodec.h \
+    ../header/TimeSeriesStore.h \
+    ../header/Trace.h \
+    ../header/User.h \
+    ../header/UserRegistration.h \
+    ../header/XMLImporter.h \
+    ../header/healthrecord.h
@@ -0,0 +1,176 @@
+/**
+ * @file BenchmarkReport.h
+ * @brief Declaración de la clase BenchmarkReport, resultados de las pruebas de rendimiento en JSON.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef BENCHMARKREPORT_H
+#define BENCHMARKREPORT_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+
+/**
+ * @class BenchmarkReport
+ * @brief Acumula los resultados de una suite de rendimiento y los escribe en un archivo JSON.
+ *
+ * QtTest solo informa los resultados de QBENCHMARK en texto, XML o CSV y sin los parámetros
+ * del conjunto de datos; este informe añade la versión de Qt, la plataforma, una etiqueta
+ * (SALUD_BENCH_LABEL, por ejemplo el commit) y el tamaño de los datos, para comparar versiones.
+ */
+class BenchmarkReport
+{
+public:
+    /**
+     * @struct Result
+     * @brief Resultado de una prueba.
+     */
+    struct Result
+    {
+        /**
+         * @brief Nombre de la prueba, con la etiqueta de datos si la tiene ("calculateAverage/weight").
+         */
+        QString name;
+
+        /**
+         * @brief Iteraciones medidas.
+         */
+        qint64 iterations = 0;
+
+        /**
+         * @brief Tiempo medio por iteración en nanosegundos.
+         */
+        double nsPerIteration = 0;
+
+        /**
+         * @brief Filas procesadas en cada iteración, o 0 si no aplica.
+         */
+        qint64 rowsPerIteration = 0;
+    };
+
+    /**
+     * @class Measurement
+     * @brief Mide las iteraciones de un bloque QBENCHMARK y las registra al destruirse.
+     *
+     * Se crea antes del bloque y se llama a iteration() dentro de él; el tiempo medio incluye
+     * las iteraciones de calibración de QtTest, que ejecutan el mismo código.
+     */
+    class Measurement
+    {
+    public:
+        /**
+         * @brief Constructor. Inicia el cronómetro.
+         * @param report Informe donde se registra el resultado.
+         * @param name Nombre de la prueba.
+         * @param rowsPerIteration Filas procesadas en cada iteración, o 0.
+         */
+        Measurement(BenchmarkReport& report, const QString& name, qint64 rowsPerIteration = 0);
+
+        /**
+         * @brief Destructor. Registra el resultado si hubo iteraciones.
+         */
+        ~Measurement();
+
+        /**
+         * @brief Cuenta una iteración.
+         */
+        void iteration() { ++m_iterations; }
+
+    private:
+        Measurement(const Measurement&) = delete;
+        Measurement& operator=(const Measurement&) = delete;
+
+        /**
+         * @brief Informe donde se registra el resultado.
+         */
+        BenchmarkReport& m_report;
+
+        /**
+         * @brief Nombre de la prueba.
+         */
+        QString m_name;
+
+        /**
+         * @brief Filas procesadas en cada iteración.
+         */
+        qint64 m_rowsPerIteration;
+
+        /**
+         * @brief Iteraciones contadas.
+         */
+        qint64 m_iterations;
+
+        /**
+         * @brief Cronómetro desde la construcción.
+         */
+        QElapsedTimer m_timer;
+    };
+
+    /**
+     * @brief Constructor.
+     * @param suite Nombre de la suite.
+     */
+    explicit BenchmarkReport(const QString& suite);
+
+    /**
+     * @brief Añade un parámetro del conjunto de datos (filas, usuarios, semilla...).
+     * @param key Nombre del parámetro.
+     * @param value Valor.
+     */
+    void setParameter(const QString& key, const QJsonValue& value);
+
+    /**
+     * @brief Registra el resultado de una prueba.
+     * @param name Nombre de la prueba.
+     * @param iterations Iteraciones medidas.
+     * @param elapsedNs Tiempo total de las iteraciones en nanosegundos.
+     * @param rowsPerIteration Filas procesadas en cada iteración, o 0.
+     */
+    void record(const QString& name, qint64 iterations, qint64 elapsedNs, qint64 rowsPerIteration = 0);
+
+    /**
+     * @brief Resultados registrados, en orden.
+     * @return Lista de resultados.
+     */
+    const QVector<Result>& results() const;
+
+    /**
+     * @brief Documento JSON del informe.
+     * @return Objeto con la suite, el entorno, los parámetros y los resultados.
+     */
+    QJsonObject toJson() const;
+
+    /**
+     * @brief Escribe el informe en un archivo, reemplazándolo de forma atómica.
+     * @param filePath Archivo de destino.
+     * @return true si se escribió correctamente.
+     */
+    bool write(const QString& filePath) const;
+
+    /**
+     * @brief Archivo de salida configurado.
+     * @return SALUD_BENCH_JSON, o "benchmark-results.json" si no está definida.
+     */
+    static QString outputPath();
+
+private:
+    /**
+     * @brief Nombre de la suite.
+     */
+    QString m_suite;
+
+    /**
+     * @brief Parámetros del conjunto de datos.
+     */
+    QJsonObject m_parameters;
+
+    /**
+     * @brief Resultados registrados.
+     */
+    QVector<Result> m_results;
+};
+
+#endif // BENCHMARKREPORT_H
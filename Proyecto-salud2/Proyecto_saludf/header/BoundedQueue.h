@@ -0,0 +1,185 @@
+/**
+ * @file BoundedQueue.h
+ * @brief Declaración de la plantilla BoundedQueue, cola bloqueante de capacidad fija entre etapas de un proceso.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <QtGlobal>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+/**
+ * @class BoundedQueue
+ * @brief Cola de capacidad fija para varios productores y varios consumidores.
+ *
+ * push() bloquea mientras la cola está llena y pop() mientras está vacía, de modo que una etapa
+ * rápida se frena al ritmo de la siguiente en lugar de acumular memoria. close() despierta a
+ * todos: los productores dejan de encolar y los consumidores vacían lo que quede.
+ *
+ * A diferencia de MpscRing, aquí se espera con una variable de condición: está pensada para
+ * elementos gruesos (lotes, fragmentos de archivo) donde el costo del mutex es despreciable.
+ *
+ * @tparam T Tipo de los elementos; debe poder moverse.
+ */
+template <typename T>
+class BoundedQueue
+{
+public:
+    /**
+     * @brief Constructor de la cola.
+     * @param capacity Número máximo de elementos; como mínimo 1.
+     */
+    explicit BoundedQueue(std::size_t capacity)
+        : m_capacity(capacity > 0 ? capacity : 1)
+        , m_highWater(0)
+        , m_closed(false)
+    {
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * @brief Encola un elemento, esperando si la cola está llena.
+     * @param value Elemento a encolar.
+     * @param waitedNanoseconds Si no es nulo, se le suma el tiempo que se esperó por espacio.
+     * @return true si se encoló, false si la cola se cerró.
+     */
+    bool push(T&& value, qint64* waitedNanoseconds = nullptr)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_items.size() >= m_capacity && !m_closed) {
+            const auto waitStart = std::chrono::steady_clock::now();
+            m_notFull.wait(lock, [this] { return m_items.size() < m_capacity || m_closed; });
+            if (waitedNanoseconds) {
+                *waitedNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                          std::chrono::steady_clock::now() - waitStart).count();
+            }
+        }
+        if (m_closed) {
+            return false;
+        }
+        m_items.push_back(std::move(value));
+        if (m_items.size() > m_highWater) {
+            m_highWater = m_items.size();
+        }
+        lock.unlock();
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Desencola un elemento, esperando si la cola está vacía.
+     * @param out Destino del elemento.
+     * @param waitedNanoseconds Si no es nulo, se le suma el tiempo que se esperó por un elemento.
+     * @return true si se obtuvo un elemento, false si la cola está cerrada y vacía.
+     */
+    bool pop(T& out, qint64* waitedNanoseconds = nullptr)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_items.empty() && !m_closed) {
+            const auto waitStart = std::chrono::steady_clock::now();
+            m_notEmpty.wait(lock, [this] { return !m_items.empty() || m_closed; });
+            if (waitedNanoseconds) {
+                *waitedNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                          std::chrono::steady_clock::now() - waitStart).count();
+            }
+        }
+        if (m_items.empty()) {
+            return false;
+        }
+        out = std::move(m_items.front());
+        m_items.pop_front();
+        lock.unlock();
+        m_notFull.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Cierra la cola: no admite más elementos y despierta a quienes esperan.
+     */
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_notFull.notify_all();
+        m_notEmpty.notify_all();
+    }
+
+    /**
+     * @brief Elementos encolados en este momento.
+     * @return Profundidad de la cola.
+     */
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_items.size();
+    }
+
+    /**
+     * @brief Mayor profundidad alcanzada desde la creación.
+     * @return Máximo histórico de elementos encolados.
+     */
+    std::size_t highWater() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_highWater;
+    }
+
+    /**
+     * @brief Capacidad de la cola.
+     * @return Número máximo de elementos.
+     */
+    std::size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+private:
+    /**
+     * @brief Capacidad máxima.
+     */
+    const std::size_t m_capacity;
+
+    /**
+     * @brief Elementos en orden de llegada.
+     */
+    std::deque<T> m_items;
+
+    /**
+     * @brief Mayor profundidad alcanzada.
+     */
+    std::size_t m_highWater;
+
+    /**
+     * @brief Indica que la cola se cerró.
+     */
+    bool m_closed;
+
+    /**
+     * @brief Protege el estado de la cola.
+     */
+    mutable std::mutex m_mutex;
+
+    /**
+     * @brief Se notifica cuando hay espacio libre.
+     */
+    std::condition_variable m_notFull;
+
+    /**
+     * @brief Se notifica cuando hay un elemento disponible.
+     */
+    std::condition_variable m_notEmpty;
+};
+
+#endif // BOUNDEDQUEUE_H
@@ -0,0 +1,174 @@
+/**
+ * @file BulkExportJob.h
+ * @brief Declaración de la clase BulkExportJob, exportación paralela de todos los usuarios en archivos fragmentados.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef BULKEXPORTJOB_H
+#define BULKEXPORTJOB_H
+
+#include "CSVWriter.h"
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QMutex>
+#include <QThreadPool>
+#include <atomic>
+
+/**
+ * @class BulkExportJob
+ * @brief Trabajo de operación que exporta toda la base de datos en paralelo.
+ *
+ * Reparte los usuarios en fragmentos de tamaño parecido (por número de filas) y los procesa en
+ * un QThreadPool. Cada tarea abre su propia conexión de lectura, escribe su propio archivo de
+ * fragmento con CSVWriter y, al terminar todas, se genera un manifiesto JSON con los fragmentos,
+ * sus usuarios, filas y bytes. El progreso se informa por filas y el trabajo se puede cancelar.
+ */
+class BulkExportJob : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @struct Shard
+     * @brief Resultado de un fragmento de la exportación.
+     */
+    struct Shard
+    {
+        int index = 0;
+        QString fileName;
+        QVector<int> userIds;
+        qint64 expectedRows = 0;
+        qint64 rows = 0;
+        qint64 bytes = 0;
+        bool ok = false;
+    };
+
+    /**
+     * @brief Constructor del trabajo.
+     * @param outputDirectory Directorio donde se escriben los fragmentos y el manifiesto.
+     * @param options Opciones de formato CSV de los fragmentos.
+     * @param parent Objeto padre, por defecto nullptr.
+     */
+    explicit BulkExportJob(const QString& outputDirectory, const CSVOptions& options = CSVOptions(),
+                           QObject *parent = nullptr);
+
+    /**
+     * @brief Destructor. Cancela y espera a las tareas en curso.
+     */
+    ~BulkExportJob();
+
+    /**
+     * @brief Número de tareas paralelas; por defecto, el número de núcleos.
+     * @param threads Número de hilos.
+     */
+    void setThreadCount(int threads);
+
+    /**
+     * @brief Inicia la exportación sin bloquear al llamador.
+     * @return true si el trabajo arrancó, false si no hay datos que exportar o ya está en curso.
+     */
+    bool start();
+
+    /**
+     * @brief Solicita la cancelación; las tareas terminan en la siguiente fila.
+     */
+    void cancel();
+
+    /**
+     * @brief Espera a que terminen todas las tareas.
+     */
+    void waitForFinished();
+
+    /**
+     * @brief Ruta del manifiesto del trabajo.
+     * @return Ruta del archivo manifest.json.
+     */
+    QString manifestPath() const;
+
+signals:
+    /**
+     * @brief Progreso de la exportación.
+     * @param rowsDone Filas exportadas hasta el momento.
+     * @param rowsTotal Filas totales a exportar.
+     */
+    void progress(qint64 rowsDone, qint64 rowsTotal);
+
+    /**
+     * @brief Señal emitida al terminar, con éxito, error o cancelación.
+     * @param success true si todos los fragmentos se escribieron y el manifiesto se generó.
+     * @param manifestPath Ruta del manifiesto.
+     */
+    void finished(bool success, const QString& manifestPath);
+
+private:
+    /**
+     * @brief Reparte los usuarios en fragmentos equilibrados por número de filas.
+     * @return true si se pudieron leer los conteos por usuario.
+     */
+    bool planShards();
+
+    /**
+     * @brief Exporta un fragmento. Se ejecuta en un hilo del pool.
+     * @param shardIndex Índice del fragmento.
+     */
+    void exportShard(int shardIndex);
+
+    /**
+     * @brief Escribe el manifiesto y emite finished(). La llama la última tarea en terminar.
+     */
+    void finish();
+
+    /**
+     * @brief Directorio de salida.
+     */
+    QString m_outputDirectory;
+
+    /**
+     * @brief Opciones de formato CSV.
+     */
+    CSVOptions m_options;
+
+    /**
+     * @brief Pool de hilos propio del trabajo.
+     */
+    QThreadPool m_pool;
+
+    /**
+     * @brief Fragmentos planificados y sus resultados.
+     */
+    QVector<Shard> m_shards;
+
+    /**
+     * @brief Protege los resultados de los fragmentos.
+     */
+    QMutex m_mutex;
+
+    /**
+     * @brief Filas totales a exportar.
+     */
+    qint64 m_totalRows;
+
+    /**
+     * @brief Filas exportadas por todas las tareas.
+     */
+    std::atomic<qint64> m_rowsDone;
+
+    /**
+     * @brief Fragmentos que faltan por terminar.
+     */
+    std::atomic<int> m_pendingShards;
+
+    /**
+     * @brief Indica que se solicitó la cancelación.
+     */
+    std::atomic<bool> m_cancelled;
+
+    /**
+     * @brief Indica que el trabajo está en curso.
+     */
+    std::atomic<bool> m_running;
+};
+
+#endif // BULKEXPORTJOB_H
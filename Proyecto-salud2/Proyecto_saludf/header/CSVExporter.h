@@ -9,6 +9,8 @@
 #define CSVEXPORTER_H
 
 #include "healthrecord.h"
+#include "CSVWriter.h"
+#include <QSqlQuery>
 #include <QString>
 #include <QVector>
 
@@ -17,7 +19,8 @@
  * @brief Clase para exportar registros de salud a un archivo CSV.
  *
  * Proporciona una interfaz estática para exportar un conjunto de registros de salud
- * a un archivo en formato CSV.
+ * a un archivo en formato CSV, ya sea desde memoria o leyendo las filas directamente
+ * de la base de datos con un cursor.
  */
 class CSVExporter {
 public:
@@ -25,9 +28,46 @@ public:
      * @brief Exporta registros de salud a un archivo CSV.
      * @param filePath Ruta del archivo CSV donde se guardarán los datos.
      * @param records Vector de registros de salud a exportar.
+     * @param options Opciones de formato CSV.
      * @return true si la exportación es exitosa, false en caso contrario.
      */
-    static bool exportToCSV(const QString& filePath, const QVector<healthrecord>& records);
+    static bool exportToCSV(const QString& filePath, const QVector<healthrecord>& records,
+                            const CSVOptions& options = CSVOptions());
+
+    /**
+     * @brief Exporta los registros de un usuario leyéndolos de la base de datos con un cursor.
+     * @param filePath Ruta del archivo CSV donde se guardarán los datos.
+     * @param userId Identificador del usuario.
+     * @param options Opciones de formato CSV.
+     * @return true si la exportación es exitosa, false en caso contrario.
+     */
+    static bool exportUserRecords(const QString& filePath, int userId, const CSVOptions& options = CSVOptions());
+
+    /**
+     * @brief Consulta SQL que produce las columnas en el orden que espera writeRows().
+     * @param extraColumns Columnas adicionales después de las seis exportadas, o vacío.
+     * @return Sentencia SELECT sin cláusula WHERE ni ORDER BY.
+     */
+    static QString selectColumnsSql(const QString& extraColumns = QString());
+
+    /**
+     * @brief Escribe la fila de cabecera si las opciones lo piden.
+     * @param writer Escritor CSV.
+     * @param options Opciones de formato.
+     */
+    static void writeHeader(CSVWriter& writer, const CSVOptions& options);
+
+    /**
+     * @brief Escribe como filas CSV el resultado de una consulta basada en selectColumnsSql().
+     * @param query Consulta ejecutada, preferiblemente en modo forwardOnly.
+     * @param writer Escritor CSV.
+     * @param maxRows Número máximo de filas a escribir en esta llamada, o -1 para todas.
+     * @param lastKey Si no es nulo y se escribió alguna fila, recibe la columna keyColumn de la última.
+     * @param keyColumn Columna de la consulta que se devuelve en lastKey; 0 es el id.
+     * @return Número de filas escritas.
+     */
+    static qint64 writeRows(QSqlQuery& query, CSVWriter& writer, qint64 maxRows = -1, qint64* lastKey = nullptr,
+                            int keyColumn = 0);
 };
 
 #endif // CSVEXPORTER_H
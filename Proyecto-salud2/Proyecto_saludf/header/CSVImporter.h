@@ -0,0 +1,128 @@
+/**
+ * @file CSVImporter.h
+ * @brief Declaración de la clase CSVImporter para importar registros de salud desde archivos CSV.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef CSVIMPORTER_H
+#define CSVIMPORTER_H
+
+#include "IngestPipeline.h"
+#include <QString>
+#include <QVector>
+#include <functional>
+
+/**
+ * @struct CSVImportOptions
+ * @brief Parámetros de la importación CSV.
+ */
+struct CSVImportOptions
+{
+    /**
+     * @brief Separador de campos.
+     */
+    char delimiter = ',';
+
+    /**
+     * @brief Carácter de comillas.
+     */
+    char quote = '"';
+
+    /**
+     * @brief Tamaño aproximado de los fragmentos del archivo que se procesan en paralelo.
+     */
+    int chunkBytes = 1 << 20;
+
+    /**
+     * @brief Parámetros del proceso por etapas (hilos, lotes, rechazos detallados).
+     */
+    IngestOptions ingest;
+
+    /**
+     * @brief Si no es nulo, se llama con los bytes leídos y el tamaño del archivo antes de cada
+     * fragmento y al terminar; si devuelve false la importación se cancela.
+     *
+     * Se llama en el hilo que ejecuta importFile().
+     */
+    std::function<bool(qint64 bytesRead, qint64 bytesTotal)> progress;
+};
+
+/**
+ * @struct CSVImportReport
+ * @brief Resultado de una importación.
+ */
+struct CSVImportReport
+{
+    /**
+     * @brief Indica si el archivo se leyó completo y todos los lotes se confirmaron.
+     */
+    bool ok = false;
+
+    /**
+     * @brief Indica si la importación se canceló desde CSVImportOptions::progress.
+     */
+    bool canceled = false;
+
+    /**
+     * @brief Descripción del error que detuvo la importación, si lo hubo.
+     */
+    QString error;
+
+    /**
+     * @brief Líneas de datos leídas (sin cabecera ni líneas vacías).
+     */
+    qint64 lines = 0;
+
+    /**
+     * @brief Registros insertados.
+     */
+    qint64 imported = 0;
+
+    /**
+     * @brief Líneas rechazadas por la validación.
+     */
+    qint64 rejected = 0;
+
+    /**
+     * @brief Detalle de las primeras líneas rechazadas.
+     */
+    QVector<RejectedLine> rejectedLines;
+
+    /**
+     * @brief Métricas de cada etapa de la importación.
+     */
+    QVector<StageMetrics> metrics;
+};
+
+/**
+ * @class CSVImporter
+ * @brief Importa registros de salud desde CSV, incluidos los archivos producidos por CSVExporter.
+ *
+ * El archivo se mapea en memoria y se corta en fragmentos de unos chunkBytes que terminan en un
+ * salto de línea fuera de comillas; cada fragmento se procesa en un hilo de IngestPipeline. Los
+ * delimitadores, comillas y saltos de línea se localizan de 16 en 16 bytes con SSE2 cuando el
+ * procesador lo permite, y los números y fechas se convierten directamente desde el mapeo con
+ * RecordValidator, con las mismas reglas que el formulario de datos. Los registros se escriben
+ * en el orden del archivo.
+ *
+ * Si la primera línea es una cabecera, las columnas se ubican por nombre ("DateTime",
+ * "Weight", "Blood Pressure", "Glucose Level" o los nombres de columna de health_records);
+ * si no, se asume el orden de CSVExporter. La columna de usuario del archivo se ignora: los
+ * registros se asignan al usuario indicado.
+ */
+class CSVImporter
+{
+public:
+    /**
+     * @brief Importa un archivo CSV para un usuario.
+     * @param filePath Ruta del archivo.
+     * @param userId Usuario al que se asignan los registros.
+     * @param options Parámetros de la importación.
+     * @return Informe con los totales y las líneas rechazadas.
+     */
+    static CSVImportReport importFile(const QString& filePath, int userId,
+                                      const CSVImportOptions& options = CSVImportOptions());
+};
+
+#endif // CSVIMPORTER_H
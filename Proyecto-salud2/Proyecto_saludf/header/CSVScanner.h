@@ -0,0 +1,121 @@
+/**
+ * @file CSVScanner.h
+ * @brief Declaración de la clase CSVScanner, separación de líneas CSV y corte en fragmentos sobre bytes.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef CSVSCANNER_H
+#define CSVSCANNER_H
+
+#include <QtGlobal>
+#include <vector>
+
+/**
+ * @struct CSVField
+ * @brief Un campo de la línea actual: apunta al texto original o, si tenía comillas escapadas, al buffer auxiliar.
+ */
+struct CSVField
+{
+    /**
+     * @brief Inicio del campo, sin las comillas que lo rodean.
+     */
+    const char* data;
+
+    /**
+     * @brief Bytes del campo.
+     */
+    int size;
+
+    /**
+     * @brief Posición del campo en el buffer auxiliar, o -1 si apunta al texto original.
+     */
+    int scratchOffset;
+};
+
+/**
+ * @class CSVScanner
+ * @brief Recorre texto CSV (RFC 4180) en memoria sin copiarlo, para CSVImporter.
+ *
+ * Las búsquedas de caracteres especiales usan SSE2 cuando el compilador lo ofrece; las variantes
+ * escalares dan el mismo resultado en cualquier plataforma y sirven de referencia en las pruebas.
+ */
+class CSVScanner
+{
+public:
+    /**
+     * @brief Campos que se conservan por línea; los siguientes se ignoran.
+     */
+    static const int kMaxFields = 32;
+
+    /**
+     * @brief Indica si las búsquedas se compilaron con SSE2.
+     * @return true si findSpecial() y countByte() usan SSE2.
+     */
+    static bool hasSse2();
+
+    /**
+     * @brief Busca el siguiente delimitador, comilla o salto de línea.
+     * @param p Inicio de la búsqueda.
+     * @param end Fin del texto.
+     * @param delimiter Separador de campos.
+     * @param quote Carácter de comillas.
+     * @return Posición del primer carácter especial, o end si no hay ninguno.
+     */
+    static const char* findSpecial(const char* p, const char* end, char delimiter, char quote);
+
+    /**
+     * @brief Versión byte a byte de findSpecial().
+     * @param p Inicio de la búsqueda.
+     * @param end Fin del texto.
+     * @param delimiter Separador de campos.
+     * @param quote Carácter de comillas.
+     * @return Posición del primer carácter especial, o end si no hay ninguno.
+     */
+    static const char* findSpecialScalar(const char* p, const char* end, char delimiter, char quote);
+
+    /**
+     * @brief Cuenta las apariciones de un byte en un rango.
+     * @param p Inicio del rango.
+     * @param end Fin del rango.
+     * @param c Byte a contar.
+     * @return Número de apariciones.
+     */
+    static qint64 countByte(const char* p, const char* end, char c);
+
+    /**
+     * @brief Versión byte a byte de countByte().
+     * @param p Inicio del rango.
+     * @param end Fin del rango.
+     * @param c Byte a contar.
+     * @return Número de apariciones.
+     */
+    static qint64 countByteScalar(const char* p, const char* end, char c);
+
+    /**
+     * @brief Busca el final de un fragmento: el primer salto de línea fuera de comillas tras target bytes.
+     * @param p Inicio del fragmento, al comienzo de una línea.
+     * @param end Fin del texto.
+     * @param target Tamaño aproximado del fragmento.
+     * @param quote Carácter de comillas.
+     * @return Inicio del fragmento siguiente, o end.
+     */
+    static const char* nextChunkEnd(const char* p, const char* end, qint64 target, char quote);
+
+    /**
+     * @brief Separa una línea CSV en campos.
+     * @param p Inicio de la línea.
+     * @param end Fin del texto.
+     * @param delimiter Separador de campos.
+     * @param quote Carácter de comillas.
+     * @param fields Campos de la línea; debe tener espacio para kMaxFields.
+     * @param fieldCount Número de campos.
+     * @param scratch Buffer para los campos con comillas escapadas; se reutiliza entre líneas.
+     * @param newlines Saltos de línea contenidos dentro de campos entre comillas.
+     * @return Inicio de la línea siguiente.
+     */
+    static const char* splitLine(const char* p, const char* end, char delimiter, char quote, CSVField* fields,
+                                 int* fieldCount, std::vector<char>& scratch, qint64* newlines);
+};
+
+#endif // CSVSCANNER_H
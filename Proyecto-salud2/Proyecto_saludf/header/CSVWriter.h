@@ -0,0 +1,212 @@
+/**
+ * @file CSVWriter.h
+ * @brief Declaración de la clase CSVWriter, escritor CSV con buffer reutilizable y formato numérico sin asignaciones.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef CSVWRITER_H
+#define CSVWRITER_H
+
+#include <QIODevice>
+#include <QString>
+#include <vector>
+
+/**
+ * @struct CSVOptions
+ * @brief Opciones de formato CSV según RFC 4180.
+ */
+struct CSVOptions
+{
+    /**
+     * @brief Política de entrecomillado de los campos de texto.
+     */
+    enum QuoteMode {
+        QuoteMinimal,   ///< Solo si el campo contiene delimitador, comillas o saltos de línea (RFC 4180).
+        QuoteAll,       ///< Todos los campos de texto entre comillas.
+        QuoteNone       ///< Nunca; el delimitador dentro de un campo se reemplaza por ';'.
+    };
+
+    /**
+     * @brief Separador de campos.
+     */
+    char delimiter = ',';
+
+    /**
+     * @brief Carácter de comillas; dentro de un campo se escapa duplicándolo.
+     */
+    char quote = '"';
+
+    /**
+     * @brief Política de entrecomillado.
+     */
+    QuoteMode quoteMode = QuoteMinimal;
+
+    /**
+     * @brief Escribir la fila de cabecera.
+     */
+    bool writeHeader = true;
+
+    /**
+     * @brief Terminar las filas con CRLF (RFC 4180) en lugar de LF.
+     */
+    bool crlf = true;
+
+    /**
+     * @brief Tamaño del buffer de salida; se vacía con una sola escritura al llenarse.
+     */
+    int bufferBytes = 1 << 20;
+};
+
+/**
+ * @class CSVWriter
+ * @brief Escritor CSV que formatea directamente sobre un buffer de bytes reutilizable.
+ *
+ * Los números se formatean con std::to_chars y las fechas con un formateador de ancho fijo,
+ * sin crear QString intermedios. El buffer se vacía al dispositivo con escrituras grandes y
+ * secuenciales, así que la memoria usada es constante sin importar el número de filas.
+ */
+class CSVWriter
+{
+public:
+    /**
+     * @brief Constructor del escritor.
+     * @param device Dispositivo abierto para escritura (se recomienda sin modo texto).
+     * @param options Opciones de formato.
+     */
+    CSVWriter(QIODevice* device, const CSVOptions& options = CSVOptions());
+
+    /**
+     * @brief Destructor. Vacía el buffer pendiente.
+     */
+    ~CSVWriter();
+
+    CSVWriter(const CSVWriter&) = delete;
+    CSVWriter& operator=(const CSVWriter&) = delete;
+
+    /**
+     * @brief Escribe un campo entero.
+     * @param value Valor.
+     */
+    void writeInt(qint64 value);
+
+    /**
+     * @brief Escribe un campo real con la representación más corta que conserva el valor.
+     * @param value Valor.
+     */
+    void writeFloat(float value);
+
+    /**
+     * @brief Escribe un campo real con la representación más corta que conserva el valor.
+     * @param value Valor.
+     */
+    void writeDouble(double value);
+
+    /**
+     * @brief Escribe una fecha y hora con formato fijo "yyyy-MM-dd hh:mm:ss".
+     * @param year Año (0-9999).
+     * @param month Mes (1-12).
+     * @param day Día (1-31).
+     * @param hour Hora (0-23).
+     * @param minute Minuto (0-59).
+     * @param second Segundo (0-59).
+     */
+    void writeDateTime(int year, int month, int day, int hour, int minute, int second);
+
+    /**
+     * @brief Escribe una fecha y hora a partir de segundos desde la época, sin conversión de zona.
+     * @param epochSeconds Segundos desde 1970-01-01 00:00:00 de la misma zona en que se guardó la fecha.
+     */
+    void writeEpochSeconds(qint64 epochSeconds);
+
+    /**
+     * @brief Escribe un campo de texto, entrecomillado según las opciones.
+     * @param text Texto del campo.
+     */
+    void writeText(const QString& text);
+
+    /**
+     * @brief Escribe un campo de texto ASCII/UTF-8 ya codificado.
+     * @param text Bytes del campo.
+     * @param size Número de bytes.
+     */
+    void writeText(const char* text, int size);
+
+    /**
+     * @brief Escribe un campo vacío (por ejemplo, un valor NULL).
+     */
+    void writeEmpty();
+
+    /**
+     * @brief Termina la fila actual.
+     */
+    void endRow();
+
+    /**
+     * @brief Escribe en el dispositivo el contenido del buffer.
+     * @return true si la escritura tuvo éxito.
+     */
+    bool flush();
+
+    /**
+     * @brief Indica si todas las escrituras han tenido éxito.
+     * @return false si alguna escritura al dispositivo falló.
+     */
+    bool ok() const;
+
+    /**
+     * @brief Bytes producidos hasta el momento (incluye los que siguen en el buffer).
+     * @return Número de bytes.
+     */
+    qint64 bytesWritten() const;
+
+private:
+    /**
+     * @brief Garantiza espacio para bytes más en el buffer y devuelve dónde escribirlos.
+     * @param bytes Número de bytes a reservar.
+     * @return Puntero a la zona libre del buffer.
+     */
+    char* reserve(int bytes);
+
+    /**
+     * @brief Escribe el delimitador si no es el primer campo de la fila.
+     */
+    void beginField();
+
+    /**
+     * @brief Dispositivo de salida.
+     */
+    QIODevice* m_device;
+
+    /**
+     * @brief Opciones de formato.
+     */
+    CSVOptions m_options;
+
+    /**
+     * @brief Buffer de salida reutilizable.
+     */
+    std::vector<char> m_buffer;
+
+    /**
+     * @brief Bytes ocupados del buffer.
+     */
+    std::size_t m_used;
+
+    /**
+     * @brief Bytes ya enviados al dispositivo.
+     */
+    qint64 m_flushed;
+
+    /**
+     * @brief Indica que el próximo campo es el primero de la fila.
+     */
+    bool m_firstField;
+
+    /**
+     * @brief Indica si todas las escrituras han tenido éxito.
+     */
+    bool m_ok;
+};
+
+#endif // CSVWRITER_H
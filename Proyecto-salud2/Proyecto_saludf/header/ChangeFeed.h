@@ -0,0 +1,108 @@
+/**
+ * @file ChangeFeed.h
+ * @brief Declaración de la clase ChangeFeed, canal de notificaciones de cambios en health_records.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef CHANGEFEED_H
+#define CHANGEFEED_H
+
+#include "Metrics.h"
+#include <QObject>
+#include <QVector>
+#include <QMetaType>
+
+/**
+ * @struct RecordChange
+ * @brief Describe un cambio confirmado sobre una fila de health_records.
+ */
+struct RecordChange
+{
+    /**
+     * @brief Tipo de cambio aplicado a la fila.
+     */
+    enum Type {
+        Inserted,
+        Updated,
+        Deleted
+    };
+
+    /**
+     * @brief Tipo de cambio.
+     */
+    Type type = Inserted;
+
+    /**
+     * @brief Identificador (id) de la fila afectada; una fila combinada al insertar conserva el suyo.
+     */
+    qint64 recordId = 0;
+
+    /**
+     * @brief Identificador del usuario dueño de la fila.
+     */
+    int userId = 0;
+};
+
+Q_DECLARE_METATYPE(RecordChange)
+Q_DECLARE_METATYPE(QVector<RecordChange>)
+
+/**
+ * @class ChangeFeed
+ * @brief Canal singleton que anuncia los cambios de health_records después de cada commit.
+ *
+ * DatabaseManager publica un lote por transacción confirmada. Los receptores pueden vivir en
+ * cualquier hilo: con conexiones automáticas Qt entrega el lote en el hilo del receptor, de modo
+ * que modelos, cachés y agregados aplican el delta sin volver a consultar todo.
+ */
+class ChangeFeed : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Obtiene la instancia única de ChangeFeed.
+     * @return Referencia a la instancia singleton.
+     */
+    static ChangeFeed& instance();
+
+    /**
+     * @brief Publica los cambios de una transacción confirmada.
+     * @param changes Cambios aplicados en la transacción; si está vacío no se emite nada.
+     *
+     * Puede llamarse desde cualquier hilo.
+     */
+    void publish(const QVector<RecordChange>& changes);
+
+signals:
+    /**
+     * @brief Señal emitida una vez por transacción confirmada.
+     * @param changes Cambios aplicados en la transacción, en orden.
+     */
+    void recordsChanged(const QVector<RecordChange>& changes);
+
+private:
+    /**
+     * @brief Constructor privado para implementar el patrón singleton.
+     *
+     * Registra los tipos de los cambios para poder entregarlos entre hilos.
+     */
+    ChangeFeed();
+
+    /**
+     * @brief Filas insertadas publicadas (salud_records_inserted_total).
+     */
+    Metrics::Counter* m_inserted;
+
+    /**
+     * @brief Filas actualizadas publicadas (salud_records_updated_total).
+     */
+    Metrics::Counter* m_updated;
+
+    /**
+     * @brief Filas eliminadas publicadas (salud_records_deleted_total).
+     */
+    Metrics::Counter* m_deleted;
+};
+
+#endif // CHANGEFEED_H
@@ -0,0 +1,30 @@
+/**
+ * @file Checksum.h
+ * @brief Declaración de la clase Checksum, sumas de verificación compartidas por la bitácora y los exportadores.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <QtGlobal>
+
+/**
+ * @class Checksum
+ * @brief Funciones de suma de verificación sin dependencias externas.
+ */
+class Checksum
+{
+public:
+    /**
+     * @brief Calcula el CRC-32 (polinomio IEEE 802.3, el de gzip y zip) de un bloque de bytes.
+     * @param data Datos.
+     * @param size Número de bytes.
+     * @param crc CRC acumulado de los bloques anteriores, o 0 para empezar.
+     * @return CRC-32 de los datos.
+     */
+    static quint32 crc32(const char* data, qint64 size, quint32 crc = 0);
+};
+
+#endif // CHECKSUM_H
@@ -0,0 +1,221 @@
+/**
+ * @file ColumnarFormat.h
+ * @brief Declaración de la clase ColumnarFormat, formato binario por columnas para exportar e importar registros de salud.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef COLUMNARFORMAT_H
+#define COLUMNARFORMAT_H
+
+#include "healthrecord.h"
+#include <QSqlQuery>
+#include <QString>
+#include <QVector>
+#include <functional>
+#include <limits>
+
+/**
+ * @struct ColumnarOptions
+ * @brief Parámetros de escritura del formato por columnas.
+ */
+struct ColumnarOptions
+{
+    /**
+     * @brief Filas por grupo. Cada grupo guarda un bloque por columna con sus estadísticas.
+     */
+    int rowsPerGroup = 65536;
+
+    /**
+     * @brief Comprimir cada bloque con zlib (qCompress); se guarda sin comprimir si no reduce el tamaño.
+     */
+    bool compress = true;
+
+    /**
+     * @brief Nivel de compresión zlib (1-9).
+     */
+    int compressionLevel = 6;
+};
+
+/**
+ * @struct ColumnStats
+ * @brief Estadísticas de un bloque de columna.
+ */
+struct ColumnStats
+{
+    /**
+     * @brief Número de valores nulos del bloque.
+     */
+    quint32 nullCount = 0;
+
+    /**
+     * @brief Valor mínimo no nulo del bloque.
+     */
+    double minValue = 0.0;
+
+    /**
+     * @brief Valor máximo no nulo del bloque.
+     */
+    double maxValue = 0.0;
+};
+
+/**
+ * @struct ColumnarRowGroup
+ * @brief Un grupo de filas decodificado, con una columna tipada por campo.
+ *
+ * Los nulos de weight y glucose se representan con NaN; los de systolic y diastolic con 0.
+ */
+struct ColumnarRowGroup
+{
+    /**
+     * @brief Fecha y hora como segundos desde 1970-01-01 00:00:00, sin conversión de zona.
+     */
+    QVector<qint64> timestamps;
+
+    /**
+     * @brief Identificador del usuario.
+     */
+    QVector<qint32> userIds;
+
+    /**
+     * @brief Peso en kilogramos.
+     */
+    QVector<float> weights;
+
+    /**
+     * @brief Nivel de glucosa.
+     */
+    QVector<float> glucose;
+
+    /**
+     * @brief Presión sistólica.
+     */
+    QVector<qint16> systolic;
+
+    /**
+     * @brief Presión diastólica.
+     */
+    QVector<qint16> diastolic;
+
+    /**
+     * @brief Estadísticas de cada bloque, indexadas por ColumnarFormat::Column.
+     */
+    ColumnStats stats[6];
+
+    /**
+     * @brief Número de filas del grupo.
+     * @return Filas del grupo.
+     */
+    int size() const { return timestamps.size(); }
+};
+
+/**
+ * @class ColumnarFormat
+ * @brief Exportación e importación de health_records en un formato binario por columnas ("HRC1").
+ *
+ * Complementa a CSVExporter para mover datos entre instalaciones: los valores viajan tipados,
+ * sin formatear ni analizar texto, y comprimen mucho mejor agrupados por columna.
+ *
+ * Disposición del archivo (little-endian):
+ * | sección        | contenido                                                          |
+ * |----------------|--------------------------------------------------------------------|
+ * | cabecera (32)  | magic "HRC1", versión u16, columnas u16, filas u64, grupos u32,    |
+ * |                | reservado u32, fecha de creación i64 (segundos UTC)                |
+ * | grupos         | por grupo: magic "HRG1", filas u32, reservado u32 + u32, y un      |
+ * |                | bloque por columna en el orden de Column                           |
+ * | índice         | desplazamiento u64 de cada grupo                                   |
+ * | pie (16)       | desplazamiento u64 del índice, magic "HRCE", reservado u32         |
+ *
+ * Cada bloque de columna empieza con 32 bytes: columna u8, tipo u8 (1=i64, 2=i32, 3=f32, 4=i16),
+ * codificación u8 (0=plana, 1=delta), comprimido u8, bytes almacenados u32, nulos u32,
+ * reservado u32, mínimo f64 y máximo f64; le siguen los datos, rellenos hasta múltiplo de 8.
+ * Fecha y usuario se codifican como diferencias con el valor anterior del bloque.
+ */
+class ColumnarFormat
+{
+public:
+    /**
+     * @brief Columnas del formato, en el orden en que se escriben.
+     */
+    enum Column {
+        TimestampColumn = 0,
+        UserIdColumn,
+        WeightColumn,
+        GlucoseColumn,
+        SystolicColumn,
+        DiastolicColumn,
+        ColumnCount
+    };
+
+    /**
+     * @brief Exporta los registros de un usuario.
+     * @param filePath Ruta del archivo de salida.
+     * @param userId Identificador del usuario.
+     * @param options Parámetros de escritura.
+     * @return true si la exportación es exitosa, false en caso contrario.
+     */
+    static bool exportUserRecords(const QString& filePath, int userId,
+                                  const ColumnarOptions& options = ColumnarOptions());
+
+    /**
+     * @brief Exporta los registros de todos los usuarios.
+     * @param filePath Ruta del archivo de salida.
+     * @param options Parámetros de escritura.
+     * @return true si la exportación es exitosa, false en caso contrario.
+     */
+    static bool exportAllRecords(const QString& filePath, const ColumnarOptions& options = ColumnarOptions());
+
+    /**
+     * @brief Escribe en un archivo el resultado de una consulta basada en selectColumnsSql().
+     * @param query Consulta ejecutada, preferiblemente en modo forwardOnly.
+     * @param filePath Ruta del archivo de salida.
+     * @param options Parámetros de escritura.
+     * @param rows Si no es nulo, recibe el número de filas escritas.
+     * @return true si la escritura es exitosa, false en caso contrario.
+     */
+    static bool writeQuery(QSqlQuery& query, const QString& filePath, const ColumnarOptions& options,
+                           qint64* rows = nullptr);
+
+    /**
+     * @brief Consulta SQL que produce las columnas en el orden que espera writeQuery().
+     * @return Sentencia SELECT sin cláusula WHERE ni ORDER BY.
+     */
+    static QString selectColumnsSql();
+
+    /**
+     * @brief Recorre los grupos de un archivo mapeado en memoria.
+     * @param filePath Ruta del archivo.
+     * @param visitor Función llamada con cada grupo; si devuelve false, el recorrido se detiene.
+     * @param fromSeconds Los grupos que terminan antes de este instante se saltan sin decodificar.
+     * @param toSeconds Los grupos que empiezan después de este instante se saltan sin decodificar.
+     * @return true si el archivo es válido y se recorrió completo, false en caso contrario.
+     */
+    static bool readFile(const QString& filePath, const std::function<bool(const ColumnarRowGroup&)>& visitor,
+                         qint64 fromSeconds = std::numeric_limits<qint64>::min(),
+                         qint64 toSeconds = std::numeric_limits<qint64>::max());
+
+    /**
+     * @brief Importa un archivo a health_records por la cola de inserción, en lotes acotados.
+     * @param filePath Ruta del archivo.
+     * @param targetUserId Si es mayor que 0, todas las filas se asignan a este usuario.
+     * @param importedRows Si no es nulo, recibe el número de filas confirmadas.
+     * @param progress Si no es nulo, se llama con las filas enviadas y el total antes de cada grupo
+     * y al terminar; si devuelve false la importación se cancela.
+     * @return true si el archivo se importó completo, false en caso contrario.
+     *
+     * Puede llamarse desde cualquier hilo: no usa la conexión del llamador.
+     */
+    static bool importFile(const QString& filePath, int targetUserId = 0, qint64* importedRows = nullptr,
+                           const std::function<bool(qint64 rows, qint64 totalRows)>& progress = nullptr);
+
+private:
+    /**
+     * @brief Convierte las filas de un grupo en registros de salud.
+     * @param group Grupo decodificado.
+     * @param targetUserId Si es mayor que 0, todas las filas se asignan a este usuario.
+     * @return Registros en el orden del grupo.
+     */
+    static QVector<healthrecord> toRecords(const ColumnarRowGroup& group, int targetUserId);
+};
+
+#endif // COLUMNARFORMAT_H
@@ -8,17 +8,36 @@
 #ifndef DATABASEMANAGER_H
 #define DATABASEMANAGER_H
 
+#include <QHash>
+#include <QMutex>
 #include <QSqlDatabase>
+#include <QSqlQuery>
 #include <QVector>
+#include <functional>
+#include <future>
+#include <memory>
 #include "healthrecord.h"
 #include "User.h"
+#include "Session.h"
+#include "LruCache.h"
+#include "UserRegistration.h"
+#include "RecordFilter.h"
+#include "ChangeFeed.h"
+#include "TimeSeriesStore.h"
+
+class IngestQueue;
+class IngestJournal;
+class QObject;
+struct PasswordHash;
 
 /**
  * @class DatabaseManager
  * @brief Clase singleton para gestionar la conexión y operaciones con la base de datos.
  *
  * Proporciona métodos para inicializar la base de datos, autenticar usuarios, registrar usuarios
- * y gestionar registros de salud.
+ * y gestionar registros de salud. Las sesiones de los usuarios recientes (nombre y preferencias)
+ * se guardan en una caché LRU acotada, de modo que abrir un espacio de trabajo no repite
+ * consultas a users.
  */
 class DatabaseManager
 {
@@ -42,6 +61,67 @@ public:
      */
     bool initializeDatabase();
 
+    /**
+     * @brief Indica si la base de datos se abrió y su esquema quedó al día.
+     * @return true si la inicialización del constructor (tablas, migraciones y bitácora) fue exitosa.
+     */
+    bool isReady() const;
+
+    /**
+     * @brief Detiene la cola de inserción y la bitácora y cierra la conexión principal.
+     *
+     * Para quien deba liberar el archivo antes de que termine el proceso (por ejemplo, para
+     * borrar un directorio temporal). Después isReady() devuelve false y la instancia no debe
+     * usarse: las operaciones que reabren la conexión volverían a crear el archivo.
+     */
+    void shutdown();
+
+    /**
+     * @brief Autentica a un usuario. Bloquea mientras se deriva la contraseña.
+     * @param username Nombre de usuario, sin distinguir mayúsculas.
+     * @param password Contraseña ingresada.
+     * @return La sesión del usuario si las credenciales son válidas, o una sesión no válida en caso contrario.
+     */
+    Session authenticate(const QString& username, const QString& password);
+
+    /**
+     * @brief Autentica a un usuario sin bloquear el hilo que llama.
+     * @param username Nombre de usuario, sin distinguir mayúsculas.
+     * @param password Contraseña ingresada.
+     * @param context Objeto del hilo principal; si se destruye antes, done no se llama.
+     * @param done Recibe la sesión del usuario, o una sesión no válida si las credenciales no lo son.
+     */
+    void authenticateAsync(const QString& username, const QString& password, QObject* context,
+                           std::function<void(const Session&)> done);
+
+    /**
+     * @brief Obtiene la sesión de un usuario por su identificador, sin verificar credenciales.
+     * @param userId Identificador del usuario.
+     * @return Sesión del usuario, o una sesión no válida si no existe.
+     */
+    Session session(int userId);
+
+    /**
+     * @brief Guarda una preferencia de un usuario.
+     * @param userId Identificador del usuario.
+     * @param key Nombre de la preferencia.
+     * @param value Valor.
+     * @return true si se guarda, false en caso contrario.
+     */
+    bool setUserPreference(int userId, const QString& key, const QString& value);
+
+    /**
+     * @brief Descarta un usuario de la caché para que la siguiente consulta lo lea de la base de datos.
+     * @param userId Identificador del usuario.
+     */
+    void invalidateUser(int userId);
+
+    /**
+     * @brief Cambia el número máximo de usuarios en la caché.
+     * @param capacity Nueva capacidad; como mínimo 1.
+     */
+    void setUserCacheCapacity(int capacity);
+
     /**
      * @brief Verifica las credenciales de un usuario.
      * @param username Nombre de usuario.
@@ -58,6 +138,23 @@ public:
      */
     bool registerUser(const QString& username, const QString& password);
 
+    /**
+     * @brief Registra un nuevo usuario sin bloquear el hilo que llama.
+     * @param username Nombre de usuario.
+     * @param password Contraseña del usuario.
+     * @param context Objeto del hilo principal; si se destruye antes, done no se llama.
+     * @param done Recibe true si el registro es exitoso.
+     */
+    void registerUserAsync(const QString& username, const QString& password, QObject* context,
+                           std::function<void(bool)> done);
+
+    /**
+     * @brief Registra un lote de usuarios en una sola transacción.
+     * @param batch Cuentas a registrar.
+     * @return Un resultado por cuenta, en el mismo orden que batch.
+     */
+    QVector<RegistrationResult> registerUsers(const QVector<UserRegistration>& batch);
+
     /**
      * @brief Obtiene los datos de un usuario por su nombre de usuario.
      * @param username Nombre de usuario.
@@ -72,6 +169,55 @@ public:
      */
     bool addhealthrecord(const healthrecord& record);
 
+    /**
+     * @brief Añade un lote de registros de salud en una sola transacción.
+     * @param records Registros de salud a añadir.
+     * @return true si todo el lote se confirma, false en caso contrario.
+     */
+    bool addhealthrecords(const QVector<healthrecord>& records);
+
+    /**
+     * @brief Encola un registro de salud en la cola de commit agrupado sin bloquear.
+     * @param record Registro de salud a añadir.
+     * @return Future que vale true cuando el lote que lo contiene se confirma.
+     */
+    std::future<bool> enqueueHealthRecord(const healthrecord& record);
+
+    /**
+     * @brief Encola un lote de registros de salud en la cola de commit agrupado sin bloquear.
+     * @param records Registros de salud a añadir, confirmados de forma atómica.
+     * @return Future que vale true cuando el lote se confirma.
+     */
+    std::future<bool> enqueueHealthRecords(const QVector<healthrecord>& records);
+
+    /**
+     * @brief Añade registros de salud a la bitácora de inserción, compactada en segundo plano.
+     * @param records Registros de salud a añadir.
+     * @return true cuando los registros son durables en la bitácora, false en caso contrario.
+     */
+    bool journalHealthRecords(const QVector<healthrecord>& records);
+
+    /**
+     * @brief Número de peticiones pendientes en la cola de inserción.
+     * @return Profundidad aproximada de la cola.
+     */
+    std::size_t pendingInserts() const;
+
+    /**
+     * @brief Inserta registros de salud con una conexión dada, dentro de la transacción del llamador.
+     * @param connection Conexión abierta en el hilo que llama, con una transacción en curso.
+     * @param records Registros a insertar.
+     * @param changes Vector donde se añaden los cambios para publicarlos tras el commit.
+     * @return true si todas las filas se insertaron, false ante el primer error.
+     *
+     * Un peso o glucosa NaN, o una presión vacía, se guardan como NULL. Si ya existe una fila con
+     * el mismo usuario y fecha, los campos no nulos del registro reemplazan a los de la fila y los
+     * nulos la dejan como está; si nada cambia, la fila no se reescribe ni se publica. Reintentar
+     * un lote o reimportar un archivo no duplica filas. Cada cambio lleva el id real de la fila.
+     */
+    static bool insertHealthRecords(QSqlDatabase& connection, const QVector<healthrecord>& records,
+                                    QVector<RecordChange>& changes);
+
     /**
      * @brief Calcula el promedio de un campo específico para un usuario.
      * @param field Campo de la base de datos (por ejemplo, "weight", "glucose").
@@ -87,22 +233,184 @@ public:
      */
     QVector<healthrecord> getHealthRecordsByUserId(int userId);
 
+    /**
+     * @brief Consulta los registros de salud de un usuario aplicando filtros y ordenamiento.
+     * @param userId Identificador del usuario.
+     * @param filter Criterios de filtrado (rango de fechas, umbrales) y ordenamiento.
+     * @return Consulta ejecutada con las columnas de la tabla de historial.
+     */
+    QSqlQuery queryHealthRecords(int userId, const RecordFilter& filter);
+
+    /**
+     * @brief Expresión SQL que extrae la presión sistólica de la columna blood_pressure.
+     * @return Expresión SQL, idéntica a la del índice por expresión.
+     */
+    static QString systolicExpression();
+
+    /**
+     * @brief Ruta del archivo de la base de datos.
+     * @return Ruta del archivo SQLite usado por todas las conexiones.
+     */
+    static QString databasePath();
+
+    /**
+     * @brief Cambia la ruta del archivo de la base de datos.
+     * @param path Ruta del archivo SQLite; por defecto "health_app.db" en el directorio actual.
+     *
+     * Debe llamarse antes del primer uso de instance(), que abre la base de datos.
+     */
+    static void setDatabasePath(const QString& path);
+
+    /**
+     * @brief Abre una conexión adicional para el hilo que llama.
+     * @param connectionName Nombre único de la conexión.
+     * @return Conexión abierta y configurada; quien la abre debe cerrarla y eliminarla.
+     */
+    static QSqlDatabase openConnection(const QString& connectionName);
+
+    /**
+     * @brief Directorio de los segmentos de la bitácora de inserción.
+     * @return Ruta del directorio, junto al archivo de la base de datos.
+     */
+    static QString journalDirectory();
+
+    /**
+     * @brief Obtiene el almacén de series temporales sobre la conexión principal.
+     * @return Almacén de series de alta frecuencia de dispositivos portátiles.
+     */
+    TimeSeriesStore timeSeries();
+
     /**
      * @brief Obtiene la conexión a la base de datos.
      * @return Objeto QSqlDatabase que representa la conexión activa.
      */
     QSqlDatabase getDatabase();
 
+    /**
+     * @brief Reconstruye el archivo de la base de datos y actualiza las estadísticas del planificador.
+     * @return true si VACUUM y ANALYZE se completaron, false en caso contrario.
+     *
+     * Necesita acceso exclusivo: espera a que terminen las escrituras de las demás conexiones
+     * (hasta busy_timeout) y falla si alguna sigue activa.
+     */
+    bool vacuum();
+
 private:
     /**
      * @brief Constructor privado para implementar el patrón singleton.
      */
     DatabaseManager();
 
+    /**
+     * @brief Indica si health_records debe reconstruirse para convertir blood_pressure a TEXT.
+     * @return true si la migración es necesaria.
+     */
+    bool needsBloodPressureMigration();
+
+    /**
+     * @brief Combina las filas repetidas de health_records y crea el índice único de usuario y fecha.
+     * @return true si el índice único existe al terminar, false en caso contrario.
+     */
+    bool migrateToUniqueReadings();
+
+    /**
+     * @brief Agrega a health_records la secuencia de cambios y los disparadores que la mantienen.
+     * @return true si la columna, el contador y los disparadores existen al terminar.
+     */
+    bool migrateToChangeSequence();
+
+    /**
+     * @brief Agrega a users las columnas de parámetros del hash si la base es anterior a ellas.
+     * @return true si las columnas existen al terminar, false en caso contrario.
+     */
+    bool migrateUserCredentials();
+
+    /**
+     * @brief Busca las credenciales guardadas de un usuario.
+     * @param username Nombre de usuario, sin distinguir mayúsculas.
+     * @param user Usuario encontrado.
+     * @param stored Hash guardado y sus parámetros.
+     * @return true si el usuario existe, false si no existe o la consulta falla.
+     */
+    bool lookupCredentials(const QString& username, User& user, PasswordHash& stored);
+
+    /**
+     * @brief Guarda un hash nuevo de la contraseña de un usuario.
+     * @param userId Identificador del usuario.
+     * @param hash Hash y parámetros.
+     * @return true si se actualiza, false en caso contrario.
+     */
+    bool updatePasswordHash(const QString& userId, const PasswordHash& hash);
+
+    /**
+     * @brief Indica si un nombre de usuario ya está registrado.
+     * @param username Nombre de usuario, sin distinguir mayúsculas.
+     * @return true si existe o si la consulta falla, false si está libre.
+     */
+    bool usernameTaken(const QString& username);
+
+    /**
+     * @brief Inserta un usuario con su hash ya derivado.
+     * @param username Nombre de usuario.
+     * @param hash Hash de la contraseña y sus parámetros.
+     * @return true si el registro es exitoso, false en caso contrario.
+     */
+    bool insertUser(const QString& username, const PasswordHash& hash);
+
+    /**
+     * @brief Crea la sesión de un usuario recién autenticado.
+     * @param user Usuario, tal como lo devolvió lookupCredentials().
+     * @return Sesión con las preferencias del usuario.
+     */
+    Session openSession(const User& user);
+
+    /**
+     * @brief Lee las preferencias guardadas de un usuario.
+     * @param userId Identificador del usuario.
+     * @return Preferencias por nombre; vacías si no tiene o si la consulta falla.
+     */
+    QHash<QString, QString> loadPreferences(int userId);
+
+    /**
+     * @brief Aplica a una conexión los ajustes comunes de SQLite (WAL, durabilidad, espera).
+     * @param connection Conexión abierta.
+     */
+    static void configureConnection(QSqlDatabase& connection);
+
+    /**
+     * @brief Registra en Metrics los indicadores de la base de datos, la cola y la caché de usuarios.
+     */
+    void registerMetrics();
+
     /**
      * @brief Conexión a la base de datos.
      */
     QSqlDatabase db;
+
+    /**
+     * @brief Cola de commit agrupado dueña de la conexión de escritura.
+     */
+    std::unique_ptr<IngestQueue> m_ingestQueue;
+
+    /**
+     * @brief Bitácora de inserción para flujos de dispositivos, con su compactador.
+     */
+    std::unique_ptr<IngestJournal> m_journal;
+
+    /**
+     * @brief Capacidad inicial de la caché de usuarios.
+     */
+    static constexpr int kUserCacheCapacity = 256;
+
+    /**
+     * @brief Sesiones recientes por identificador de usuario (nombre y preferencias, sin credenciales).
+     */
+    LruCache<int, Session> m_userCache;
+
+    /**
+     * @brief Protege m_userCache.
+     */
+    QMutex m_userCacheMutex;
 };
 
 #endif // DATABASEMANAGER_H
@@ -0,0 +1,78 @@
+/**
+ * @file HealthRecordsModel.h
+ * @brief Declaración de la clase HealthRecordsModel, modelo paginado de la tabla de historial.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef HEALTHRECORDSMODEL_H
+#define HEALTHRECORDSMODEL_H
+
+#include <QSqlQueryModel>
+#include "RecordFilter.h"
+
+/**
+ * @class HealthRecordsModel
+ * @brief Modelo de solo lectura para los registros de salud de un usuario.
+ *
+ * Delega el ordenamiento y el filtrado en DatabaseManager::queryHealthRecords, de modo que cada
+ * cambio se resuelve con una consulta indexada. QSqlQueryModel carga las filas por páginas
+ * (fetchMore) a medida que la vista las necesita, sin traer el historial completo a memoria.
+ */
+class HealthRecordsModel : public QSqlQueryModel
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructor de la clase HealthRecordsModel.
+     * @param userId Identificador del usuario cuyos registros se muestran.
+     * @param parent Objeto padre, por defecto nullptr.
+     */
+    explicit HealthRecordsModel(int userId, QObject *parent = nullptr);
+
+    /**
+     * @brief Ordena el modelo por una columna de la vista.
+     * @param column Índice de la columna.
+     * @param order Sentido del ordenamiento.
+     *
+     * Reemplaza el ordenamiento en memoria de QAbstractItemModel por un ORDER BY indexado.
+     */
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    /**
+     * @brief Aplica nuevos criterios de filtrado conservando el ordenamiento actual.
+     * @param filter Criterios de filtrado.
+     */
+    void setFilter(const RecordFilter& filter);
+
+    /**
+     * @brief Obtiene los criterios de filtrado y ordenamiento vigentes.
+     * @return Criterios actuales.
+     */
+    RecordFilter filter() const;
+
+    /**
+     * @brief Vuelve a ejecutar la consulta con los criterios vigentes.
+     * @return true si la consulta se ejecutó sin errores, false en caso contrario.
+     */
+    bool refresh();
+
+private:
+    /**
+     * @brief Identificador del usuario cuyos registros se muestran.
+     */
+    int m_userId;
+
+    /**
+     * @brief Criterios de filtrado y ordenamiento vigentes.
+     */
+    RecordFilter m_filter;
+
+    /**
+     * @brief Asigna los encabezados de las columnas.
+     */
+    void applyHeaders();
+};
+
+#endif // HEALTHRECORDSMODEL_H
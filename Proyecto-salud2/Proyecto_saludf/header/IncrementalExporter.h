@@ -0,0 +1,111 @@
+/**
+ * @file IncrementalExporter.h
+ * @brief Declaración de la clase IncrementalExporter, exportación CSV incremental con marcas de agua persistentes.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef INCREMENTALEXPORTER_H
+#define INCREMENTALEXPORTER_H
+
+#include "CSVWriter.h"
+#include <QSqlDatabase>
+#include <QString>
+
+/**
+ * @struct ExportWatermark
+ * @brief Última fila entregada a un destino, tal como se guarda en export_watermarks.
+ */
+struct ExportWatermark
+{
+    /**
+     * @brief Indica si el destino ya tiene una marca de agua guardada.
+     */
+    bool valid = false;
+
+    /**
+     * @brief change_seq de la última fila exportada (columna last_id de export_watermarks).
+     */
+    qint64 lastSequence = 0;
+
+    /**
+     * @brief Fecha y hora de la última fila exportada, tal como está almacenada.
+     */
+    QString lastDateTime;
+
+    /**
+     * @brief Tamaño del archivo de destino tras la última fila exportada.
+     */
+    qint64 fileOffset = 0;
+};
+
+/**
+ * @class IncrementalExporter
+ * @brief Exporta a CSV solo las filas de health_records que un destino aún no ha recibido.
+ *
+ * Cada destino (un nombre elegido por el llamador, por ejemplo "laboratorio-nocturno") tiene una
+ * marca de agua por usuario en la tabla export_watermarks, o una sola con user_id 0 si exporta a
+ * todos los usuarios. Cada ejecución lee desde la marca en orden de change_seq, añade las filas al
+ * archivo y avanza la marca en puntos de control junto con el tamaño del archivo en ese momento.
+ *
+ * Si una ejecución se interrumpe, la siguiente recorta el archivo al tamaño del último punto de
+ * control y continúa desde ahí, sin duplicar ni perder filas. Si el archivo ya no existe (el
+ * destino lo recogió), se empieza uno nuevo con cabecera y se continúa desde la marca: lastSequence se
+ * conserva y el tamaño guardado pasa a ser el de la cabecera antes de exportar ninguna fila.
+ *
+ * La marca avanza por change_seq, que health_records renueva con un valor creciente en cada
+ * inserción o cambio de una fila. Ni el id ni date_time sirven: una lectura combinada con una
+ * fila existente conserva su id, y la fecha la elige el usuario, así que en ambos casos la fila
+ * quedaría detrás de la marca. Una fila que cambia después de exportarse se vuelve a añadir con
+ * sus valores nuevos y el mismo id. lastDateTime se guarda como referencia para el destino.
+ */
+class IncrementalExporter
+{
+public:
+    /**
+     * @brief Crea la tabla export_watermarks si no existe.
+     * @param connection Conexión abierta.
+     * @return true si el esquema está disponible, false en caso contrario.
+     */
+    static bool createSchema(QSqlDatabase& connection);
+
+    /**
+     * @brief Lee la marca de agua de un destino.
+     * @param destination Nombre del destino.
+     * @param userId Identificador del usuario, o 0 para un destino de todos los usuarios.
+     * @return Marca de agua; valid es false si el destino aún no exportó nada.
+     */
+    static ExportWatermark watermark(const QString& destination, int userId);
+
+    /**
+     * @brief Borra la marca de agua de un destino; la siguiente exportación será completa.
+     * @param destination Nombre del destino.
+     * @param userId Identificador del usuario, o 0 para un destino de todos los usuarios.
+     * @return true si la marca se borró, false en caso contrario.
+     */
+    static bool resetWatermark(const QString& destination, int userId);
+
+    /**
+     * @brief Añade al archivo del destino las filas nuevas desde la última exportación.
+     * @param destination Nombre del destino.
+     * @param filePath Ruta del archivo CSV del destino.
+     * @param userId Identificador del usuario, o 0 para exportar todos los usuarios.
+     * @param options Opciones de formato CSV.
+     * @param exportedRows Si no es nulo, recibe el número de filas añadidas.
+     * @return true si la exportación es exitosa, false en caso contrario.
+     */
+    static bool exportNewRecords(const QString& destination, const QString& filePath, int userId,
+                                 const CSVOptions& options = CSVOptions(), qint64* exportedRows = nullptr);
+
+private:
+    /**
+     * @brief Guarda la marca de agua de un destino.
+     * @param destination Nombre del destino.
+     * @param userId Identificador del usuario, o 0 para un destino de todos los usuarios.
+     * @param mark Marca de agua a guardar.
+     * @return true si se guardó, false en caso contrario.
+     */
+    static bool saveWatermark(const QString& destination, int userId, const ExportWatermark& mark);
+};
+
+#endif // INCREMENTALEXPORTER_H
@@ -0,0 +1,216 @@
+/**
+ * @file IngestJournal.h
+ * @brief Declaración de la clase IngestJournal, bitácora binaria de inserciones con compactación hacia SQLite.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef INGESTJOURNAL_H
+#define INGESTJOURNAL_H
+
+#include "healthrecord.h"
+#include "ChangeFeed.h"
+#include <QFile>
+#include <QPair>
+#include <QSqlDatabase>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/**
+ * @class IngestJournal
+ * @brief Bitácora secuencial en disco para lecturas de dispositivos de alta frecuencia.
+ *
+ * Una inserción se confirma en cuanto sus tramas se escriben y sincronizan al final del segmento
+ * activo, lo que cuesta mucho menos que una transacción SQLite. Un hilo compactador sella el
+ * segmento activo periódicamente, aplica los segmentos sellados a health_records en lotes grandes
+ * y los elimina. Al arrancar, DatabaseManager::initializeDatabase reaplica los segmentos que no
+ * alcanzaron a compactarse.
+ *
+ * Formato de cada trama (little-endian):
+ * | campo    | tipo   | descripción                                   |
+ * |----------|--------|-----------------------------------------------|
+ * | magic    | uint32 | 0x314A5248 ("HRJ1")                           |
+ * | length   | uint32 | bytes de la carga útil                        |
+ * | crc32    | uint32 | CRC-32 (IEEE) de la carga útil                |
+ * | payload  | bytes  | user_id int32, date_time int64 (ms UTC),      |
+ * |          |        | weight float32, glucose float32,              |
+ * |          |        | longitud uint16 + blood_pressure en UTF-8     |
+ *
+ * Una trama incompleta o con CRC inválido al final del último segmento corresponde a una
+ * escritura interrumpida que nunca se confirmó al productor y se descarta. En cualquier otro
+ * lugar es daño: el segmento se aparta con la extensión .corrupt, sin aplicarlo ni borrarlo, y
+ * la reaplicación falla.
+ */
+class IngestJournal
+{
+public:
+    /**
+     * @struct Options
+     * @brief Parámetros de la bitácora y del compactador.
+     */
+    struct Options
+    {
+        /**
+         * @brief Tamaño a partir del cual el segmento activo se sella y se abre uno nuevo.
+         */
+        qint64 segmentBytes = 16 * 1024 * 1024;
+
+        /**
+         * @brief Intervalo, en milisegundos, entre rondas de compactación.
+         */
+        int compactIntervalMs = 1000;
+
+        /**
+         * @brief Sincronizar con el disco (fsync) antes de confirmar cada escritura.
+         */
+        bool syncOnAppend = true;
+    };
+
+    /**
+     * @brief Constructor de la bitácora.
+     * @param directory Directorio donde se guardan los segmentos.
+     * @param options Parámetros de la bitácora y del compactador.
+     */
+    explicit IngestJournal(const QString& directory, const Options& options = Options());
+
+    /**
+     * @brief Destructor. Detiene el compactador y cierra el segmento activo.
+     */
+    ~IngestJournal();
+
+    /**
+     * @brief Abre un segmento activo nuevo.
+     * @param firstSegment Número del primer segmento; debe ser mayor que cualquier segmento ya aplicado.
+     * @return true si el segmento se creó, false en caso contrario.
+     */
+    bool open(qint64 firstSegment);
+
+    /**
+     * @brief Añade registros a la bitácora y los sincroniza con el disco.
+     * @param records Registros a añadir.
+     * @return true cuando los registros son durables, false si la escritura falló.
+     */
+    bool append(const QVector<healthrecord>& records);
+
+    /**
+     * @brief Inicia el hilo compactador.
+     */
+    void startCompactor();
+
+    /**
+     * @brief Detiene el hilo compactador después de una última ronda de compactación.
+     */
+    void stopCompactor();
+
+    /**
+     * @brief Aplica a la base de datos todos los segmentos presentes en un directorio.
+     * @param connection Conexión abierta en el hilo que llama.
+     * @param directory Directorio de los segmentos.
+     * @param changes Vector donde se añaden las filas insertadas.
+     * @return true si todos los segmentos se aplicaron, false ante el primer error.
+     */
+    static bool replay(QSqlDatabase& connection, const QString& directory, QVector<RecordChange>& changes);
+
+    /**
+     * @brief Número mayor entre los segmentos presentes en un directorio.
+     * @param directory Directorio de los segmentos.
+     * @return Número del último segmento, o 0 si no hay ninguno.
+     */
+    static qint64 lastSegmentNumber(const QString& directory);
+
+private:
+    /**
+     * @brief Aplica un segmento sellado en una transacción junto con su marca de aplicado.
+     * @param connection Conexión abierta en el hilo que llama.
+     * @param path Ruta del segmento.
+     * @param segment Número del segmento.
+     * @param allowTornTail Si es true, la última trama puede estar incompleta o dañada.
+     * @param changes Vector donde se añaden las filas insertadas.
+     * @return true si el segmento quedó aplicado (ahora o en una ejecución anterior); false si
+     *         falló o estaba dañado, en cuyo caso se apartó como .corrupt.
+     */
+    static bool applySegment(QSqlDatabase& connection, const QString& path, qint64 segment,
+                             bool allowTornTail, QVector<RecordChange>& changes);
+
+    /**
+     * @brief Lista los segmentos de un directorio en orden ascendente.
+     * @param directory Directorio de los segmentos.
+     * @return Pares (número, ruta) ordenados por número.
+     */
+    static QVector<QPair<qint64, QString>> listSegments(const QString& directory);
+
+    /**
+     * @brief Ruta del archivo de un segmento.
+     * @param segment Número del segmento.
+     * @return Ruta absoluta del archivo.
+     */
+    QString segmentPath(qint64 segment) const;
+
+    /**
+     * @brief Cierra el segmento activo y abre el siguiente. Requiere m_mutex tomado.
+     * @return true si el nuevo segmento se abrió.
+     */
+    bool rotateLocked();
+
+    /**
+     * @brief Bucle del hilo compactador.
+     */
+    void runCompactor();
+
+    /**
+     * @brief Sella el segmento activo si tiene datos y aplica todos los segmentos sellados.
+     * @param connection Conexión del compactador.
+     */
+    void compactOnce(QSqlDatabase& connection);
+
+    /**
+     * @brief Directorio de los segmentos.
+     */
+    QString m_directory;
+
+    /**
+     * @brief Parámetros de la bitácora y del compactador.
+     */
+    Options m_options;
+
+    /**
+     * @brief Protege el segmento activo.
+     */
+    std::mutex m_mutex;
+
+    /**
+     * @brief Archivo del segmento activo.
+     */
+    QFile m_activeFile;
+
+    /**
+     * @brief Número del segmento activo.
+     */
+    qint64 m_activeSegment;
+
+    /**
+     * @brief Hilo compactador.
+     */
+    std::thread m_compactor;
+
+    /**
+     * @brief Indica que el compactador debe terminar.
+     */
+    std::atomic<bool> m_stopping;
+
+    /**
+     * @brief Mutex asociado a la espera del compactador.
+     */
+    std::mutex m_wakeMutex;
+
+    /**
+     * @brief Variable de condición para despertar al compactador.
+     */
+    std::condition_variable m_wakeCondition;
+};
+
+#endif // INGESTJOURNAL_H
@@ -0,0 +1,414 @@
+/**
+ * @file IngestPipeline.h
+ * @brief Declaración de la clase IngestPipeline, proceso por etapas en paralelo para importar registros de salud.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef INGESTPIPELINE_H
+#define INGESTPIPELINE_H
+
+#include "BoundedQueue.h"
+#include "healthrecord.h"
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @struct RejectedLine
+ * @brief Línea (o muestra) de la entrada que no pasó la validación.
+ */
+struct RejectedLine
+{
+    /**
+     * @brief Número de línea, empezando en 1.
+     */
+    qint64 lineNumber = 0;
+
+    /**
+     * @brief Motivo del rechazo.
+     */
+    QString reason;
+
+    /**
+     * @brief Comienzo del texto de la línea.
+     */
+    QString text;
+};
+
+/**
+ * @struct IngestOutput
+ * @brief Resultado de una tarea de la etapa de procesamiento.
+ */
+struct IngestOutput
+{
+    /**
+     * @brief Registros válidos producidos por la tarea, en el orden de la entrada.
+     */
+    QVector<healthrecord> records;
+
+    /**
+     * @brief Elementos de entrada procesados (líneas de datos, muestras...).
+     */
+    qint64 inputs = 0;
+
+    /**
+     * @brief Líneas físicas que abarca la tarea; sirven para numerar los rechazos de las siguientes.
+     */
+    qint64 lineSpan = 0;
+
+    /**
+     * @brief Elementos rechazados por la validación.
+     */
+    qint64 rejected = 0;
+
+    /**
+     * @brief Detalle de los rechazos; lineNumber es relativo al inicio de la tarea (desde 0).
+     */
+    QVector<RejectedLine> rejectedLines;
+};
+
+/**
+ * @struct IngestOptions
+ * @brief Parámetros del proceso de importación.
+ */
+struct IngestOptions
+{
+    /**
+     * @brief Hilos de la etapa de procesamiento; 0 usa los núcleos disponibles menos uno.
+     */
+    int workers = 0;
+
+    /**
+     * @brief Tareas enviadas y aún no escritas antes de frenar al productor; 0 usa 4 por hilo.
+     */
+    int maxTasksInFlight = 0;
+
+    /**
+     * @brief Registros por lote enviado a la cola de inserción.
+     */
+    int batchRows = 5000;
+
+    /**
+     * @brief Lotes que pueden estar esperando confirmación.
+     */
+    int maxBatchesInFlight = 4;
+
+    /**
+     * @brief Máximo de rechazos que se detallan en el resultado; los demás solo se cuentan.
+     */
+    int maxReportedRejects = 1000;
+
+    /**
+     * @brief Número de línea de la entrada donde empieza la primera tarea.
+     */
+    qint64 firstLineNumber = 1;
+};
+
+/**
+ * @struct StageMetrics
+ * @brief Instantánea de rendimiento de una etapa.
+ */
+struct StageMetrics
+{
+    /**
+     * @brief Nombre de la etapa.
+     */
+    QString name;
+
+    /**
+     * @brief Hilos que ejecutan la etapa.
+     */
+    int threads = 0;
+
+    /**
+     * @brief Tareas que pasaron por la etapa.
+     */
+    qint64 tasks = 0;
+
+    /**
+     * @brief Registros que salieron de la etapa.
+     */
+    qint64 records = 0;
+
+    /**
+     * @brief Tiempo de trabajo, sumado entre los hilos de la etapa.
+     */
+    qint64 busyNanoseconds = 0;
+
+    /**
+     * @brief Tiempo esperando a la etapa siguiente (contrapresión).
+     */
+    qint64 blockedNanoseconds = 0;
+
+    /**
+     * @brief Registros por segundo desde el inicio del proceso.
+     */
+    double recordsPerSecond = 0.0;
+
+    /**
+     * @brief Profundidad actual de la cola de entrada de la etapa.
+     */
+    qint64 queueDepth = 0;
+
+    /**
+     * @brief Mayor profundidad alcanzada por la cola de entrada.
+     */
+    qint64 queueHighWater = 0;
+
+    /**
+     * @brief Capacidad de la cola de entrada.
+     */
+    qint64 queueCapacity = 0;
+};
+
+/**
+ * @struct IngestResult
+ * @brief Totales de un proceso de importación terminado.
+ */
+struct IngestResult
+{
+    /**
+     * @brief Elementos de entrada procesados.
+     */
+    qint64 inputs = 0;
+
+    /**
+     * @brief Registros insertados.
+     */
+    qint64 imported = 0;
+
+    /**
+     * @brief Registros que no se pudieron guardar.
+     */
+    qint64 failed = 0;
+
+    /**
+     * @brief Elementos rechazados por la validación.
+     */
+    qint64 rejected = 0;
+
+    /**
+     * @brief Detalle de los primeros rechazos, con números de línea absolutos.
+     */
+    QVector<RejectedLine> rejectedLines;
+
+    /**
+     * @brief Métricas finales de cada etapa.
+     */
+    QVector<StageMetrics> metrics;
+};
+
+/**
+ * @class IngestPipeline
+ * @brief Ejecuta parse → validación → normalización en paralelo y depuración → escritura en orden.
+ *
+ * El importador solo describe el trabajo: parte la entrada en tareas (un fragmento del archivo,
+ * un grupo de muestras) y las envía con submit(). Las etapas son:
+ *  - lectura: el hilo que llama a submit(); se bloquea cuando hay maxTasksInFlight tareas sin
+ *    escribir, así que la memoria queda acotada aunque el archivo sea enorme;
+ *  - procesamiento: workers hilos ejecutan las tareas, cada una produce un IngestOutput;
+ *  - depuración: una función opcional que recibe los resultados en el orden de envío, en un
+ *    solo hilo, para quitar duplicados o combinar registros sin sincronización;
+ *  - escritura: agrupa los registros en lotes de batchRows y los envía a la cola de commit
+ *    agrupado de DatabaseManager, con a lo sumo maxBatchesInFlight lotes sin confirmar.
+ *
+ * Los resultados se escriben en el orden de envío aunque las tareas terminen desordenadas, de
+ * modo que los ids quedan en el orden del archivo. Cada etapa lleva tareas, registros, tiempo de
+ * trabajo y tiempo bloqueado, y metrics() da una instantánea en cualquier momento.
+ */
+class IngestPipeline
+{
+public:
+    /**
+     * @brief Tarea de la etapa de procesamiento; escribe su resultado en el IngestOutput recibido.
+     */
+    using Task = std::function<void(IngestOutput&)>;
+
+    /**
+     * @brief Etapa de depuración; puede quitar, cambiar o añadir registros del resultado.
+     */
+    using OrderedStage = std::function<void(IngestOutput&)>;
+
+    /**
+     * @brief Constructor. Inicia los hilos de procesamiento y escritura.
+     * @param options Parámetros del proceso.
+     * @param orderedStage Etapa de depuración opcional.
+     */
+    explicit IngestPipeline(const IngestOptions& options = IngestOptions(),
+                            const OrderedStage& orderedStage = OrderedStage());
+
+    /**
+     * @brief Destructor. Termina el proceso si finish() no se llamó.
+     */
+    ~IngestPipeline();
+
+    IngestPipeline(const IngestPipeline&) = delete;
+    IngestPipeline& operator=(const IngestPipeline&) = delete;
+
+    /**
+     * @brief Envía una tarea; bloquea mientras haya demasiadas tareas sin escribir.
+     * @param task Tarea a ejecutar en un hilo de procesamiento.
+     * @return true si se aceptó, false si el proceso ya terminó.
+     */
+    bool submit(Task task);
+
+    /**
+     * @brief Espera a que se procesen y confirmen todas las tareas enviadas.
+     * @return Totales del proceso. Llamadas posteriores devuelven el mismo resultado.
+     */
+    IngestResult finish();
+
+    /**
+     * @brief Instantánea de las métricas de cada etapa.
+     * @return Métricas de lectura, procesamiento, depuración y escritura.
+     */
+    QVector<StageMetrics> metrics() const;
+
+    /**
+     * @brief Hilos de la etapa de procesamiento.
+     * @return Número de hilos.
+     */
+    int workerCount() const;
+
+private:
+    /**
+     * @struct Work
+     * @brief Tarea numerada en la cola de procesamiento.
+     */
+    struct Work
+    {
+        qint64 sequence = 0;
+        Task task;
+    };
+
+    /**
+     * @struct Done
+     * @brief Resultado numerado en la cola de escritura.
+     */
+    struct Done
+    {
+        qint64 sequence = 0;
+        IngestOutput output;
+    };
+
+    /**
+     * @struct Counters
+     * @brief Contadores de una etapa, actualizados desde sus hilos.
+     */
+    struct Counters
+    {
+        std::atomic<qint64> tasks{0};
+        std::atomic<qint64> records{0};
+        std::atomic<qint64> busyNanoseconds{0};
+        std::atomic<qint64> blockedNanoseconds{0};
+    };
+
+    /**
+     * @brief Bucle de un hilo de procesamiento.
+     */
+    void workerLoop();
+
+    /**
+     * @brief Bucle del hilo de escritura: reordena, depura y agrupa en lotes.
+     */
+    void writerLoop();
+
+    /**
+     * @brief Parámetros del proceso.
+     */
+    IngestOptions m_options;
+
+    /**
+     * @brief Etapa de depuración.
+     */
+    OrderedStage m_orderedStage;
+
+    /**
+     * @brief Tareas pendientes de procesar.
+     */
+    BoundedQueue<Work> m_work;
+
+    /**
+     * @brief Resultados pendientes de escribir.
+     */
+    BoundedQueue<Done> m_done;
+
+    /**
+     * @brief Hilos de procesamiento.
+     */
+    std::vector<std::thread> m_workers;
+
+    /**
+     * @brief Hilo de escritura.
+     */
+    std::thread m_writer;
+
+    /**
+     * @brief Número de la siguiente tarea enviada.
+     */
+    qint64 m_nextSequence;
+
+    /**
+     * @brief Tareas enviadas y aún no escritas.
+     */
+    qint64 m_tasksInFlight;
+
+    /**
+     * @brief Límite de tareas sin escribir.
+     */
+    qint64 m_maxTasksInFlight;
+
+    /**
+     * @brief Protege m_tasksInFlight.
+     */
+    std::mutex m_flightMutex;
+
+    /**
+     * @brief Se notifica cuando se escribe una tarea.
+     */
+    std::condition_variable m_flightCondition;
+
+    /**
+     * @brief Indica que finish() ya se llamó.
+     */
+    bool m_finished;
+
+    /**
+     * @brief Resultado del proceso; lo completa el hilo de escritura.
+     */
+    IngestResult m_result;
+
+    /**
+     * @brief Inicio del proceso, para calcular el rendimiento.
+     */
+    std::chrono::steady_clock::time_point m_started;
+
+    /**
+     * @brief Contadores de la etapa de lectura (el hilo que llama a submit()).
+     */
+    Counters m_reading;
+
+    /**
+     * @brief Contadores de la etapa de procesamiento.
+     */
+    Counters m_processing;
+
+    /**
+     * @brief Contadores de la etapa de depuración.
+     */
+    Counters m_ordering;
+
+    /**
+     * @brief Contadores de la etapa de escritura.
+     */
+    Counters m_writing;
+};
+
+#endif // INGESTPIPELINE_H
@@ -0,0 +1,185 @@
+/**
+ * @file IngestQueue.h
+ * @brief Declaración de la clase IngestQueue, cola de escritura con commit agrupado para health_records.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef INGESTQUEUE_H
+#define INGESTQUEUE_H
+
+#include "healthrecord.h"
+#include "Metrics.h"
+#include "MpscRing.h"
+#include <QVector>
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+
+/**
+ * @class IngestQueue
+ * @brief Cola de inserciones con un hilo escritor propio que agrupa varias peticiones por transacción.
+ *
+ * Los productores (la interfaz, importadores, dispositivos) encolan registros en un anillo sin
+ * bloqueos y reciben un std::future que se cumple cuando la transacción que contiene su lote se
+ * confirma. El hilo escritor, dueño de su propia conexión, junta peticiones hasta maxBatchRows
+ * filas o flushIntervalMs milisegundos y las confirma con un único commit (y un único fsync).
+ */
+class IngestQueue
+{
+public:
+    /**
+     * @struct Options
+     * @brief Parámetros de agrupamiento de la cola.
+     */
+    struct Options
+    {
+        /**
+         * @brief Tiempo máximo, en milisegundos, que se espera para completar un lote desde la primera petición.
+         */
+        int flushIntervalMs = 2;
+
+        /**
+         * @brief Número de filas a partir del cual el lote se confirma sin esperar más.
+         */
+        int maxBatchRows = 5000;
+
+        /**
+         * @brief Número de peticiones que admite el anillo antes de aplicar contrapresión.
+         */
+        int capacity = 65536;
+    };
+
+    /**
+     * @brief Constructor de la cola. No inicia el hilo escritor.
+     * @param options Parámetros de agrupamiento.
+     */
+    explicit IngestQueue(const Options& options = Options());
+
+    /**
+     * @brief Destructor. Confirma las peticiones pendientes y detiene el hilo escritor.
+     */
+    ~IngestQueue();
+
+    /**
+     * @brief Inicia el hilo escritor.
+     */
+    void start();
+
+    /**
+     * @brief Confirma las peticiones pendientes y detiene el hilo escritor.
+     */
+    void stop();
+
+    /**
+     * @brief Encola un registro de salud.
+     * @param record Registro a insertar.
+     * @return Future que vale true cuando el registro quedó confirmado, false si falló.
+     */
+    std::future<bool> enqueue(const healthrecord& record);
+
+    /**
+     * @brief Encola un lote de registros de salud que se confirma de forma atómica.
+     * @param records Registros a insertar.
+     * @return Future que vale true cuando todo el lote quedó confirmado, false si falló.
+     */
+    std::future<bool> enqueue(const QVector<healthrecord>& records);
+
+    /**
+     * @brief Número aproximado de peticiones en espera.
+     * @return Profundidad actual de la cola.
+     */
+    std::size_t depth() const;
+
+private:
+    /**
+     * @struct Request
+     * @brief Petición de inserción de un productor.
+     */
+    struct Request
+    {
+        QVector<healthrecord> records;
+        std::promise<bool> done;
+    };
+
+    /**
+     * @brief Bucle del hilo escritor.
+     */
+    void run();
+
+    /**
+     * @brief Confirma un lote de peticiones en una sola transacción.
+     * @param batch Peticiones a confirmar; se liberan al terminar.
+     */
+    void commitBatch(std::vector<Request*>& batch);
+
+    /**
+     * @brief Cumple con false el future de una petición que no se confirmará y la libera.
+     * @param request Petición rechazada.
+     */
+    static void reject(Request* request);
+
+    /**
+     * @brief Despierta al hilo escritor si está dormido.
+     */
+    void wakeWriter();
+
+    /**
+     * @brief Parámetros de agrupamiento.
+     */
+    Options m_options;
+
+    /**
+     * @brief Anillo de peticiones pendientes.
+     */
+    MpscRing<Request*> m_ring;
+
+    /**
+     * @brief Lotes confirmados (salud_ingest_batches_total).
+     */
+    Metrics::Counter* m_batches;
+
+    /**
+     * @brief Duración de cada lote, de la transacción al commit (salud_ingest_batch_seconds).
+     */
+    LatencyHistogram* m_batchLatency;
+
+    /**
+     * @brief Hilo escritor.
+     */
+    std::thread m_writer;
+
+    /**
+     * @brief Indica que el hilo escritor está en marcha y acepta peticiones.
+     */
+    std::atomic<bool> m_running;
+
+    /**
+     * @brief Indica que la cola debe vaciarse y el hilo terminar.
+     */
+    std::atomic<bool> m_stopping;
+
+    /**
+     * @brief Indica que el hilo escritor está esperando nuevas peticiones.
+     */
+    std::atomic<bool> m_sleeping;
+
+    /**
+     * @brief Productores dentro de enqueue(); el escritor no termina mientras haya alguno.
+     */
+    std::atomic<int> m_producers;
+
+    /**
+     * @brief Mutex asociado a la variable de condición del escritor (solo para dormir/despertar).
+     */
+    std::mutex m_wakeMutex;
+
+    /**
+     * @brief Variable de condición para despertar al escritor.
+     */
+    std::condition_variable m_wakeCondition;
+};
+
+#endif // INGESTQUEUE_H
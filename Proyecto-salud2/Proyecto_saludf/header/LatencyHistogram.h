@@ -0,0 +1,162 @@
+/**
+ * @file LatencyHistogram.h
+ * @brief Declaración de la clase LatencyHistogram, histograma de latencias con precisión relativa fija.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QtGlobal>
+#include <atomic>
+
+/**
+ * @class LatencyHistogram
+ * @brief Histograma de latencias al estilo HDR: cubetas logarítmicas con 16 subdivisiones lineales.
+ *
+ * Cada potencia de dos se divide en 16 cubetas, así que cualquier valor entre 1 ns y varios siglos
+ * se registra con un error relativo menor al 6,25 % usando 1024 contadores fijos. record() es un
+ * incremento atómico sin bloqueos y puede llamarse desde cualquier hilo; summary() lee los
+ * contadores sin detener a quienes registran, por lo que es una foto aproximada.
+ */
+class LatencyHistogram
+{
+public:
+    /**
+     * @struct Summary
+     * @brief Resumen de un histograma en nanosegundos.
+     */
+    struct Summary
+    {
+        /**
+         * @brief Número de valores registrados.
+         */
+        quint64 count = 0;
+
+        /**
+         * @brief Valor mínimo.
+         */
+        qint64 min = 0;
+
+        /**
+         * @brief Valor máximo.
+         */
+        qint64 max = 0;
+
+        /**
+         * @brief Promedio.
+         */
+        qint64 mean = 0;
+
+        /**
+         * @brief Suma de todos los valores.
+         */
+        qint64 total = 0;
+
+        /**
+         * @brief Mediana.
+         */
+        qint64 p50 = 0;
+
+        /**
+         * @brief Percentil 90.
+         */
+        qint64 p90 = 0;
+
+        /**
+         * @brief Percentil 99.
+         */
+        qint64 p99 = 0;
+
+        /**
+         * @brief Percentil 99,9.
+         */
+        qint64 p999 = 0;
+    };
+
+    /**
+     * @brief Constructor de un histograma vacío.
+     */
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /**
+     * @brief Registra un valor.
+     * @param nanoseconds Latencia en nanosegundos; los negativos se registran como 0.
+     */
+    void record(qint64 nanoseconds);
+
+    /**
+     * @brief Número de valores registrados.
+     * @return Cantidad de valores.
+     */
+    quint64 count() const;
+
+    /**
+     * @brief Valor bajo el cual queda la fracción indicada de los registros.
+     * @param percentile Percentil entre 0 y 100.
+     * @return Valor representativo de la cubeta del percentil, o 0 si está vacío.
+     */
+    qint64 percentile(double percentile) const;
+
+    /**
+     * @brief Calcula el resumen del histograma.
+     * @return Conteo, extremos, promedio y percentiles.
+     */
+    Summary summary() const;
+
+    /**
+     * @brief Vacía el histograma.
+     */
+    void reset();
+
+    /**
+     * @brief Número de cubetas.
+     */
+    static const int kBuckets = 1024;
+
+    /**
+     * @brief Cubeta de un valor.
+     * @param value Valor no negativo.
+     * @return Índice de la cubeta.
+     */
+    static int bucketOf(qint64 value);
+
+    /**
+     * @brief Valor representativo (punto medio) de una cubeta.
+     * @param bucket Índice de la cubeta.
+     * @return Valor en nanosegundos.
+     */
+    static qint64 valueOf(int bucket);
+
+private:
+    /**
+     * @brief Contadores de cada cubeta.
+     */
+    std::atomic<quint64> m_counts[kBuckets];
+
+    /**
+     * @brief Número de valores.
+     */
+    std::atomic<quint64> m_count;
+
+    /**
+     * @brief Suma de los valores.
+     */
+    std::atomic<qint64> m_total;
+
+    /**
+     * @brief Valor mínimo.
+     */
+    std::atomic<qint64> m_min;
+
+    /**
+     * @brief Valor máximo.
+     */
+    std::atomic<qint64> m_max;
+};
+
+#endif // LATENCYHISTOGRAM_H
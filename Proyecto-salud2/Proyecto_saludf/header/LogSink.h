@@ -0,0 +1,167 @@
+/**
+ * @file LogSink.h
+ * @brief Declaración de la clase LogSink, salida asíncrona de los mensajes de registro.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef LOGSINK_H
+#define LOGSINK_H
+
+#include "MpscRing.h"
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+/**
+ * @class LogSink
+ * @brief Manejador de mensajes de Qt que escribe en un hilo propio.
+ *
+ * install() reemplaza el manejador de mensajes: quien registra solo da formato al mensaje y lo
+ * encola en un MpscRing sin bloqueos, y un hilo escritor lo pasa a stderr (y a un archivo, si se
+ * indicó). Así la E/S de registro nunca bloquea a quien llama. Si el anillo está lleno el mensaje
+ * se descarta y se cuenta en dropped(); los mensajes fatales se escriben de inmediato, ya que el
+ * proceso termina a continuación.
+ */
+class LogSink
+{
+public:
+    /**
+     * @brief Obtiene la instancia única de LogSink.
+     * @return Referencia a la instancia singleton.
+     */
+    static LogSink& instance();
+
+    /**
+     * @brief Instala el manejador de mensajes e inicia el hilo escritor.
+     * @param filePath Archivo al que también se agregan los mensajes; vacío para usar solo stderr.
+     * @return true si se instaló (y el archivo, si se indicó, se pudo abrir).
+     */
+    bool install(const QString& filePath = QString());
+
+    /**
+     * @brief Espera a que el hilo escritor vacíe los mensajes encolados hasta ahora.
+     */
+    void flush();
+
+    /**
+     * @brief Mensajes descartados porque el anillo estaba lleno.
+     * @return Cantidad de mensajes descartados.
+     */
+    quint64 dropped() const;
+
+    /**
+     * @brief Destructor. Restaura el manejador anterior y escribe los mensajes pendientes.
+     */
+    ~LogSink();
+
+private:
+    /**
+     * @brief Constructor privado para implementar el patrón singleton.
+     */
+    LogSink();
+
+    LogSink(const LogSink&) = delete;
+    LogSink& operator=(const LogSink&) = delete;
+
+    /**
+     * @brief Manejador de mensajes instalado en Qt.
+     * @param type Nivel del mensaje.
+     * @param context Archivo, función y categoría del mensaje.
+     * @param message Texto del mensaje.
+     */
+    static void handleMessage(QtMsgType type, const QMessageLogContext& context, const QString& message);
+
+    /**
+     * @brief Encola una línea ya formateada sin bloquear.
+     * @param line Línea a escribir.
+     */
+    void enqueue(QByteArray&& line);
+
+    /**
+     * @brief Ciclo del hilo escritor.
+     */
+    void writerLoop();
+
+    /**
+     * @brief Escribe una línea en stderr y en el archivo.
+     * @param line Línea a escribir.
+     */
+    void write(const QByteArray& line);
+
+    /**
+     * @brief Líneas pendientes de escribir.
+     */
+    MpscRing<QByteArray> m_ring;
+
+    /**
+     * @brief Hilo escritor.
+     */
+    std::thread m_writer;
+
+    /**
+     * @brief Archivo adicional de salida, o nullptr.
+     */
+    std::FILE* m_file;
+
+    /**
+     * @brief Manejador anterior, que se restaura al destruir la instancia.
+     */
+    QtMessageHandler m_previousHandler;
+
+    /**
+     * @brief Indica que el manejador está instalado.
+     */
+    std::atomic<bool> m_installed;
+
+    /**
+     * @brief Indica que el hilo escritor debe terminar tras vaciar el anillo.
+     */
+    std::atomic<bool> m_stopping;
+
+    /**
+     * @brief Indica que el hilo escritor está esperando mensajes.
+     */
+    std::atomic<bool> m_sleeping;
+
+    /**
+     * @brief Mensajes encolados desde la instalación.
+     */
+    std::atomic<quint64> m_enqueued;
+
+    /**
+     * @brief Mensajes escritos desde la instalación.
+     */
+    std::atomic<quint64> m_written;
+
+    /**
+     * @brief Mensajes descartados por anillo lleno.
+     */
+    std::atomic<quint64> m_dropped;
+
+    /**
+     * @brief Mutex de la variable de condición del escritor.
+     */
+    std::mutex m_wakeMutex;
+
+    /**
+     * @brief Despierta al escritor cuando llegan mensajes, y a flush() cuando se escriben.
+     */
+    std::condition_variable m_wakeCondition;
+
+    /**
+     * @brief Despierta a quien espera en flush().
+     */
+    std::condition_variable m_flushedCondition;
+
+    /**
+     * @brief Serializa a los productores que escriben directamente (mensajes fatales).
+     */
+    std::mutex m_directMutex;
+};
+
+#endif // LOGSINK_H
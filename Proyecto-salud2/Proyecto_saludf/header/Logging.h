@@ -0,0 +1,72 @@
+/**
+ * @file Logging.h
+ * @brief Categorías de registro de la aplicación y macro de depuración para rutas críticas.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef LOGGING_H
+#define LOGGING_H
+
+#include <QLoggingCategory>
+#include <QString>
+
+/**
+ * @brief Base de datos: conexiones, esquema, consultas e importaciones.
+ */
+Q_DECLARE_LOGGING_CATEGORY(lcDb)
+
+/**
+ * @brief Autenticación, registro de usuarios y derivación de contraseñas.
+ */
+Q_DECLARE_LOGGING_CATEGORY(lcAuth)
+
+/**
+ * @brief Cálculos de HealthAnalyzer.
+ */
+Q_DECLARE_LOGGING_CATEGORY(lcAnalyzer)
+
+/**
+ * @brief Exportaciones a CSV, formato por columnas y compresión.
+ */
+Q_DECLARE_LOGGING_CATEGORY(lcExport)
+
+/**
+ * @brief Ventanas y diálogos.
+ */
+Q_DECLARE_LOGGING_CATEGORY(lcUi)
+
+/**
+ * @def SALUD_HOT_DEBUG
+ * @brief Mensaje de depuración para rutas críticas (un mensaje por elemento de un ciclo).
+ *
+ * En compilaciones de depuración equivale a qCDebug(category), con el filtro de niveles en tiempo
+ * de ejecución. En compilaciones de publicación (QT_NO_DEBUG, que qmake define en release) la
+ * instrucción completa, argumentos incluidos, queda en una rama muerta que el compilador elimina.
+ */
+#if defined(QT_NO_DEBUG) || defined(QT_NO_DEBUG_OUTPUT)
+#define SALUD_HOT_DEBUG(category) while (false) QMessageLogger().noDebug()
+#else
+#define SALUD_HOT_DEBUG(category) qCDebug(category)
+#endif
+
+/**
+ * @namespace Logging
+ * @brief Configuración de los niveles de registro en tiempo de ejecución.
+ */
+namespace Logging {
+
+/**
+ * @brief Aplica niveles mínimos por categoría.
+ * @param spec Lista "categoría=nivel" separada por comas, por ejemplo "db=debug,auth=warning"; la
+ *        categoría "*" aplica a todas. Niveles: debug, info, warning, critical.
+ * @return true si toda la especificación es válida; las entradas no válidas se ignoran.
+ *
+ * Sin configuración, todas las categorías registran desde info: los mensajes de depuración
+ * deben activarse explícitamente.
+ */
+bool configure(const QString& spec);
+
+} // namespace Logging
+
+#endif // LOGGING_H
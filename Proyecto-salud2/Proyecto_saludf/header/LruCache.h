@@ -0,0 +1,178 @@
+/**
+ * @file LruCache.h
+ * @brief Declaración de la plantilla LruCache, caché acotada que descarta el elemento usado hace más tiempo.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef LRUCACHE_H
+#define LRUCACHE_H
+
+#include <QHash>
+#include <cstddef>
+#include <list>
+#include <utility>
+
+/**
+ * @class LruCache
+ * @brief Caché de capacidad fija con política LRU (menos usado recientemente).
+ *
+ * Los elementos se guardan en una lista ordenada por uso, con el más reciente al frente, y un
+ * QHash apunta a cada nodo; consultar, insertar y descartar cuestan O(1). No es segura entre
+ * hilos: quien la comparte debe protegerla con un mutex.
+ *
+ * @tparam Key Tipo de la clave; debe poder usarse en QHash.
+ * @tparam Value Tipo del valor; debe poder copiarse.
+ */
+template <typename Key, typename Value>
+class LruCache
+{
+public:
+    /**
+     * @brief Constructor de la caché.
+     * @param capacity Número máximo de elementos; como mínimo 1.
+     */
+    explicit LruCache(std::size_t capacity)
+        : m_capacity(capacity > 0 ? capacity : 1)
+        , m_hits(0)
+        , m_misses(0)
+    {
+    }
+
+    /**
+     * @brief Busca un elemento y lo marca como el más reciente.
+     * @param key Clave buscada.
+     * @param value Recibe una copia del valor si se encuentra.
+     * @return true si la clave estaba en la caché.
+     */
+    bool get(const Key& key, Value& value)
+    {
+        const auto found = m_index.constFind(key);
+        if (found == m_index.constEnd()) {
+            ++m_misses;
+            return false;
+        }
+        m_items.splice(m_items.begin(), m_items, found.value());
+        value = found.value()->second;
+        ++m_hits;
+        return true;
+    }
+
+    /**
+     * @brief Inserta o reemplaza un elemento y lo marca como el más reciente.
+     * @param key Clave.
+     * @param value Valor.
+     *
+     * Si la caché está llena se descarta el elemento usado hace más tiempo.
+     */
+    void put(const Key& key, const Value& value)
+    {
+        const auto found = m_index.constFind(key);
+        if (found != m_index.constEnd()) {
+            found.value()->second = value;
+            m_items.splice(m_items.begin(), m_items, found.value());
+            return;
+        }
+        m_items.emplace_front(key, value);
+        m_index.insert(key, m_items.begin());
+        if (m_items.size() > m_capacity) {
+            m_index.remove(m_items.back().first);
+            m_items.pop_back();
+        }
+    }
+
+    /**
+     * @brief Elimina un elemento, si está.
+     * @param key Clave.
+     */
+    void remove(const Key& key)
+    {
+        const auto found = m_index.constFind(key);
+        if (found != m_index.constEnd()) {
+            m_items.erase(found.value());
+            m_index.remove(key);
+        }
+    }
+
+    /**
+     * @brief Elimina todos los elementos.
+     */
+    void clear()
+    {
+        m_items.clear();
+        m_index.clear();
+    }
+
+    /**
+     * @brief Cambia la capacidad, descartando los elementos más antiguos si sobran.
+     * @param capacity Nueva capacidad; como mínimo 1.
+     */
+    void setCapacity(std::size_t capacity)
+    {
+        m_capacity = capacity > 0 ? capacity : 1;
+        while (m_items.size() > m_capacity) {
+            m_index.remove(m_items.back().first);
+            m_items.pop_back();
+        }
+    }
+
+    /**
+     * @brief Número de elementos guardados.
+     * @return Tamaño actual.
+     */
+    std::size_t size() const
+    {
+        return m_items.size();
+    }
+
+    /**
+     * @brief Consultas que encontraron su clave.
+     * @return Aciertos desde la creación.
+     */
+    quint64 hits() const
+    {
+        return m_hits;
+    }
+
+    /**
+     * @brief Consultas que no encontraron su clave.
+     * @return Fallos desde la creación.
+     */
+    quint64 misses() const
+    {
+        return m_misses;
+    }
+
+private:
+    /**
+     * @brief Tipo de la lista de elementos, del más reciente al más antiguo.
+     */
+    using ItemList = std::list<std::pair<Key, Value>>;
+
+    /**
+     * @brief Elementos, del más reciente al más antiguo.
+     */
+    ItemList m_items;
+
+    /**
+     * @brief Nodo de la lista de cada clave.
+     */
+    QHash<Key, typename ItemList::iterator> m_index;
+
+    /**
+     * @brief Capacidad máxima.
+     */
+    std::size_t m_capacity;
+
+    /**
+     * @brief Aciertos.
+     */
+    quint64 m_hits;
+
+    /**
+     * @brief Fallos.
+     */
+    quint64 m_misses;
+};
+
+#endif // LRUCACHE_H
@@ -0,0 +1,314 @@
+/**
+ * @file Metrics.h
+ * @brief Declaración de la clase Metrics, registro de métricas exportables en formato Prometheus y JSON.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "LatencyHistogram.h"
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+class QTcpServer;
+
+/**
+ * @class Metrics
+ * @brief Registro global de contadores, indicadores e histogramas de la aplicación.
+ *
+ * Los contadores y los histogramas se actualizan con operaciones atómicas, sin bloqueos; quien
+ * registra una métrica guarda el puntero que devuelve counter() o histogram() y lo usa en la ruta
+ * crítica. Los indicadores (tamaño de la base de datos, profundidad de la cola, entradas de una
+ * caché) se leen con una función en el momento de la foto, igual que las colecciones de
+ * collect(), que permiten exportar métricas con etiquetas como las latencias de QueryStats.
+ *
+ * La foto se puede escribir periódicamente en un archivo (startSnapshots()) y servir por HTTP
+ * solo en localhost (serve()), en formato de texto de Prometheus o en JSON.
+ */
+class Metrics
+{
+public:
+    /**
+     * @brief Tipo de una métrica, con la semántica de Prometheus.
+     */
+    enum Type {
+        CounterType, ///< Valor que solo crece.
+        GaugeType,   ///< Valor que sube y baja.
+        SummaryType  ///< Distribución con cuantiles, suma y conteo (en segundos).
+    };
+
+    /**
+     * @class Counter
+     * @brief Contador atómico.
+     */
+    class Counter
+    {
+    public:
+        /**
+         * @brief Suma al contador.
+         * @param amount Cantidad a sumar.
+         */
+        void add(quint64 amount = 1) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+
+        /**
+         * @brief Valor actual.
+         * @return Valor del contador.
+         */
+        quint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+        /**
+         * @brief Valor del contador.
+         */
+        std::atomic<quint64> m_value{0};
+    };
+
+    /**
+     * @struct Sample
+     * @brief Valor de una métrica en una foto.
+     */
+    struct Sample
+    {
+        /**
+         * @brief Nombre de la métrica, por ejemplo "salud_records_written_total".
+         */
+        QString name;
+
+        /**
+         * @brief Descripción de la métrica.
+         */
+        QString help;
+
+        /**
+         * @brief Tipo de la métrica.
+         */
+        Type type = GaugeType;
+
+        /**
+         * @brief Etiquetas (nombre, valor).
+         */
+        QList<QPair<QString, QString>> labels;
+
+        /**
+         * @brief Valor, para contadores e indicadores.
+         */
+        double value = 0;
+
+        /**
+         * @brief Distribución en nanosegundos, para SummaryType.
+         */
+        LatencyHistogram::Summary summary;
+    };
+
+    /**
+     * @brief Función que añade muestras a una foto.
+     */
+    using Collector = std::function<void(QVector<Sample>&)>;
+
+    /**
+     * @brief Obtiene la instancia única de Metrics.
+     * @return Referencia a la instancia singleton.
+     */
+    static Metrics& instance();
+
+    /**
+     * @brief Registra un contador, o devuelve el ya registrado con ese nombre.
+     * @param name Nombre de la métrica.
+     * @param help Descripción.
+     * @return Contador, válido mientras viva la instancia.
+     */
+    Counter* counter(const QString& name, const QString& help);
+
+    /**
+     * @brief Registra un histograma de duraciones, o devuelve el ya registrado con ese nombre.
+     * @param name Nombre de la métrica; se exporta como resumen en segundos.
+     * @param help Descripción.
+     * @return Histograma en nanosegundos, válido mientras viva la instancia.
+     */
+    LatencyHistogram* histogram(const QString& name, const QString& help);
+
+    /**
+     * @brief Registra una métrica cuyo valor se lee al tomar la foto.
+     * @param name Nombre de la métrica.
+     * @param help Descripción.
+     * @param type CounterType o GaugeType.
+     * @param read Función que devuelve el valor; puede llamarse desde cualquier hilo. Si devuelve
+     *        NaN, la métrica se omite de esa foto.
+     */
+    void observe(const QString& name, const QString& help, Type type, std::function<double()> read);
+
+    /**
+     * @brief Registra una colección de métricas calculadas al tomar la foto.
+     * @param collector Función que añade sus muestras; puede llamarse desde cualquier hilo.
+     */
+    void collect(Collector collector);
+
+    /**
+     * @brief Toma una foto de todas las métricas.
+     * @return Muestras en orden de registro.
+     */
+    QVector<Sample> snapshot() const;
+
+    /**
+     * @brief Foto en el formato de texto de Prometheus (versión 0.0.4).
+     * @return Texto listo para servir.
+     */
+    QByteArray toPrometheus() const;
+
+    /**
+     * @brief Foto en JSON.
+     * @return Documento con la marca de tiempo y la lista de métricas.
+     */
+    QByteArray toJson() const;
+
+    /**
+     * @brief Escribe una foto en un archivo, reemplazándolo de forma atómica.
+     * @param filePath Archivo; si termina en .json se usa JSON y si no, texto de Prometheus.
+     * @return true si se escribió correctamente.
+     */
+    bool writeSnapshot(const QString& filePath) const;
+
+    /**
+     * @brief Escribe una foto cada cierto tiempo desde un hilo propio.
+     * @param filePath Archivo de destino (ver writeSnapshot()).
+     * @param intervalMs Intervalo entre fotos en milisegundos.
+     */
+    void startSnapshots(const QString& filePath, int intervalMs);
+
+    /**
+     * @brief Detiene las fotos periódicas, escribiendo una última foto.
+     */
+    void stopSnapshots();
+
+    /**
+     * @brief Sirve las métricas por HTTP en 127.0.0.1. Debe llamarse desde el hilo principal.
+     * @param port Puerto TCP.
+     * @return true si se pudo escuchar en el puerto.
+     *
+     * GET /metrics devuelve el texto de Prometheus y GET /metrics.json la foto en JSON.
+     */
+    bool serve(quint16 port);
+
+    /**
+     * @brief Deja de servir las métricas por HTTP.
+     */
+    void stopServing();
+
+    /**
+     * @brief Destructor. Detiene las fotos periódicas y el servidor.
+     */
+    ~Metrics();
+
+private:
+    /**
+     * @brief Constructor privado para implementar el patrón singleton.
+     */
+    Metrics();
+
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    /**
+     * @struct Entry
+     * @brief Métrica registrada.
+     */
+    struct Entry
+    {
+        /**
+         * @brief Nombre de la métrica.
+         */
+        QString name;
+
+        /**
+         * @brief Descripción.
+         */
+        QString help;
+
+        /**
+         * @brief Tipo de la métrica.
+         */
+        Type type = GaugeType;
+
+        /**
+         * @brief Contador propio, o nullptr.
+         */
+        Counter* counter = nullptr;
+
+        /**
+         * @brief Histograma propio, o nullptr.
+         */
+        LatencyHistogram* histogram = nullptr;
+
+        /**
+         * @brief Función de lectura, para métricas observadas.
+         */
+        std::function<double()> read;
+    };
+
+    /**
+     * @brief Busca una métrica registrada.
+     * @param name Nombre de la métrica.
+     * @return Entrada, o nullptr. Debe llamarse con m_mutex tomado.
+     */
+    Entry* find(const QString& name);
+
+    /**
+     * @brief Ciclo del hilo de fotos periódicas.
+     * @param filePath Archivo de destino.
+     * @param intervalMs Intervalo entre fotos.
+     */
+    void snapshotLoop(QString filePath, int intervalMs);
+
+    /**
+     * @brief Protege m_entries y m_collectors.
+     */
+    mutable QMutex m_mutex;
+
+    /**
+     * @brief Métricas registradas, en orden de registro.
+     */
+    QVector<Entry> m_entries;
+
+    /**
+     * @brief Colecciones registradas.
+     */
+    QVector<Collector> m_collectors;
+
+    /**
+     * @brief Hilo de fotos periódicas.
+     */
+    std::thread m_snapshotThread;
+
+    /**
+     * @brief Indica que el hilo de fotos debe seguir en marcha.
+     */
+    std::atomic<bool> m_snapshotting;
+
+    /**
+     * @brief Mutex de la variable de condición del hilo de fotos.
+     */
+    std::mutex m_wakeMutex;
+
+    /**
+     * @brief Despierta al hilo de fotos para que termine.
+     */
+    std::condition_variable m_wakeCondition;
+
+    /**
+     * @brief Servidor HTTP, o nullptr si no se está sirviendo.
+     */
+    QTcpServer* m_server;
+};
+
+#endif // METRICS_H
@@ -0,0 +1,149 @@
+/**
+ * @file MpscRing.h
+ * @brief Declaración de la plantilla MpscRing, cola circular sin bloqueos de múltiples productores y un consumidor.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef MPSCRING_H
+#define MPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/**
+ * @class MpscRing
+ * @brief Cola circular acotada, sin bloqueos, para varios productores y un único consumidor.
+ *
+ * Cada celda lleva un número de secuencia que indica si está libre u ocupada, de modo que los
+ * productores solo compiten en un fetch/compare-exchange sobre la posición de escritura y el
+ * consumidor nunca toma un mutex. La capacidad se redondea a la siguiente potencia de dos.
+ *
+ * @tparam T Tipo de los elementos; debe poder construirse por defecto y moverse.
+ */
+template <typename T>
+class MpscRing
+{
+public:
+    /**
+     * @brief Constructor de la cola.
+     * @param capacity Número mínimo de elementos que debe poder almacenar.
+     */
+    explicit MpscRing(std::size_t capacity)
+    {
+        std::size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        m_mask = size - 1;
+        m_cells.reset(new Cell[size]);
+        for (std::size_t i = 0; i < size; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        m_enqueuePos.store(0, std::memory_order_relaxed);
+        m_dequeuePos.store(0, std::memory_order_relaxed);
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    /**
+     * @brief Intenta encolar un elemento. Seguro para varios productores concurrentes.
+     * @param value Elemento a encolar; solo se mueve si la operación tiene éxito.
+     * @return true si se encoló, false si la cola está llena.
+     */
+    bool tryPush(T&& value)
+    {
+        std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = m_cells[pos & m_mask];
+            const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Intenta desencolar un elemento. Solo debe llamarse desde el hilo consumidor.
+     * @param out Destino del elemento desencolado.
+     * @return true si se obtuvo un elemento, false si la cola está vacía.
+     */
+    bool tryPop(T& out)
+    {
+        const std::size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        Cell& cell = m_cells[pos & m_mask];
+        const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1) < 0) {
+            return false;
+        }
+        out = std::move(cell.value);
+        cell.value = T();
+        cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+        m_dequeuePos.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Número aproximado de elementos en la cola, útil para métricas.
+     * @return Cantidad de elementos encolados en el momento de la lectura.
+     */
+    std::size_t sizeApprox() const
+    {
+        const std::size_t enqueued = m_enqueuePos.load(std::memory_order_relaxed);
+        const std::size_t dequeued = m_dequeuePos.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    /**
+     * @brief Capacidad real de la cola.
+     * @return Número máximo de elementos.
+     */
+    std::size_t capacity() const
+    {
+        return m_mask + 1;
+    }
+
+private:
+    /**
+     * @brief Celda de la cola con su número de secuencia.
+     */
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    /**
+     * @brief Celdas de la cola.
+     */
+    std::unique_ptr<Cell[]> m_cells;
+
+    /**
+     * @brief Máscara para convertir posiciones en índices (capacidad - 1).
+     */
+    std::size_t m_mask = 0;
+
+    /**
+     * @brief Siguiente posición de escritura, compartida por los productores.
+     */
+    alignas(64) std::atomic<std::size_t> m_enqueuePos;
+
+    /**
+     * @brief Siguiente posición de lectura, propiedad del consumidor.
+     */
+    alignas(64) std::atomic<std::size_t> m_dequeuePos;
+};
+
+#endif // MPSCRING_H
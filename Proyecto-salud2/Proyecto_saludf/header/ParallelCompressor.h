@@ -0,0 +1,209 @@
+/**
+ * @file ParallelCompressor.h
+ * @brief Declaración de la clase ParallelCompressor, dispositivo de escritura que comprime por bloques en paralelo.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef PARALLELCOMPRESSOR_H
+#define PARALLELCOMPRESSOR_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include <QThreadPool>
+#include <deque>
+#include <future>
+
+/**
+ * @struct CompressionOptions
+ * @brief Parámetros de la compresión por bloques.
+ */
+struct CompressionOptions
+{
+    /**
+     * @brief Formatos de compresión.
+     */
+    enum Codec {
+        Gzip,   ///< Miembros gzip concatenados (RFC 1952), legibles por gzip, zcat y zlib.
+        Zstd    ///< Tramas zstd concatenadas; requiere compilar con SALUD_WITH_ZSTD.
+    };
+
+    /**
+     * @brief Formato de salida.
+     */
+    Codec codec = Gzip;
+
+    /**
+     * @brief Nivel de compresión (1-9 para gzip, 1-19 para zstd).
+     */
+    int level = 6;
+
+    /**
+     * @brief Bytes sin comprimir por bloque. Cada bloque se comprime de forma independiente.
+     */
+    int blockBytes = 1024 * 1024;
+
+    /**
+     * @brief Hilos de compresión; 0 usa el número de núcleos.
+     */
+    int threads = 0;
+};
+
+/**
+ * @class ParallelCompressor
+ * @brief QIODevice de solo escritura que comprime lo que recibe y lo escribe en otro dispositivo.
+ *
+ * Los datos se cortan en bloques de blockBytes que se comprimen en un QThreadPool; cada bloque
+ * produce un miembro gzip (o una trama zstd) completo, y los resultados se escriben en el orden
+ * original. Un archivo de miembros concatenados es un gzip válido, así que la salida se lee con
+ * las herramientas estándar sin pasos adicionales. Como mucho hay dos bloques por hilo en vuelo,
+ * lo que acota la memoria y frena al productor solo cuando todos los hilos están ocupados.
+ *
+ * El formato gzip se construye con qCompress (el zlib que ya trae Qt) quitando el envoltorio
+ * zlib, de modo que no se añade ninguna dependencia al proyecto.
+ */
+class ParallelCompressor : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructor del compresor.
+     * @param sink Dispositivo de destino, abierto para escritura; no pasa a ser propiedad del compresor.
+     * @param options Parámetros de la compresión.
+     * @param parent Objeto padre, por defecto nullptr.
+     */
+    explicit ParallelCompressor(QIODevice* sink, const CompressionOptions& options = CompressionOptions(),
+                                QObject* parent = nullptr);
+
+    /**
+     * @brief Destructor. Cierra el compresor si sigue abierto.
+     */
+    ~ParallelCompressor() override;
+
+    /**
+     * @brief Abre el compresor. Solo se admite QIODevice::WriteOnly.
+     * @param mode Modo de apertura.
+     * @return true si se abrió, false en caso contrario.
+     */
+    bool open(OpenMode mode) override;
+
+    /**
+     * @brief Comprime el último bloque, espera a los pendientes y cierra el compresor.
+     */
+    void close() override;
+
+    /**
+     * @brief El compresor es un flujo secuencial.
+     * @return Siempre true.
+     */
+    bool isSequential() const override;
+
+    /**
+     * @brief Indica si todas las escrituras al destino tuvieron éxito. Es definitivo tras close().
+     * @return false si algún bloque no se pudo comprimir o escribir.
+     */
+    bool ok() const;
+
+    /**
+     * @brief Bytes comprimidos escritos en el destino.
+     * @return Número de bytes.
+     */
+    qint64 compressedBytes() const;
+
+    /**
+     * @brief Indica si un formato está disponible en esta compilación.
+     * @param codec Formato.
+     * @return true si se puede usar.
+     */
+    static bool isAvailable(CompressionOptions::Codec codec);
+
+    /**
+     * @brief Deduce el formato de compresión a partir de la extensión de un archivo.
+     * @param filePath Ruta del archivo.
+     * @param codec Formato deducido.
+     * @return true si la ruta termina en .gz o .zst, false si no pide compresión.
+     */
+    static bool codecForPath(const QString& filePath, CompressionOptions::Codec* codec);
+
+    /**
+     * @brief Comprime un bloque como un miembro gzip o una trama zstd independiente.
+     * @param input Datos sin comprimir.
+     * @param codec Formato.
+     * @param level Nivel de compresión.
+     * @return Bloque comprimido, o un QByteArray vacío si falló.
+     */
+    static QByteArray compressBlock(const QByteArray& input, CompressionOptions::Codec codec, int level);
+
+protected:
+    /**
+     * @brief El compresor no admite lectura.
+     * @param data No se usa.
+     * @param maxSize No se usa.
+     * @return Siempre -1.
+     */
+    qint64 readData(char* data, qint64 maxSize) override;
+
+    /**
+     * @brief Acumula datos y despacha los bloques completos a los hilos de compresión.
+     * @param data Datos a escribir.
+     * @param size Número de bytes.
+     * @return size si se aceptaron, -1 si el compresor falló.
+     */
+    qint64 writeData(const char* data, qint64 size) override;
+
+private:
+    /**
+     * @brief Envía el bloque acumulado a un hilo de compresión.
+     */
+    void submitBlock();
+
+    /**
+     * @brief Escribe en el destino los bloques ya comprimidos, en orden.
+     * @param maxInFlight Espera hasta que queden como mucho estos bloques en vuelo.
+     */
+    void drain(std::size_t maxInFlight);
+
+    /**
+     * @brief Dispositivo de destino.
+     */
+    QIODevice* m_sink;
+
+    /**
+     * @brief Parámetros de la compresión.
+     */
+    CompressionOptions m_options;
+
+    /**
+     * @brief Hilos de compresión.
+     */
+    QThreadPool m_pool;
+
+    /**
+     * @brief Bloque en construcción.
+     */
+    QByteArray m_pending;
+
+    /**
+     * @brief Resultados de los bloques en vuelo, en el orden en que deben escribirse.
+     */
+    std::deque<std::future<QByteArray>> m_inFlight;
+
+    /**
+     * @brief Máximo de bloques en vuelo.
+     */
+    std::size_t m_maxInFlight;
+
+    /**
+     * @brief Bytes comprimidos escritos.
+     */
+    qint64 m_compressedBytes;
+
+    /**
+     * @brief Indica que algún bloque falló.
+     */
+    bool m_failed;
+};
+
+#endif // PARALLELCOMPRESSOR_H
@@ -0,0 +1,198 @@
+/**
+ * @file PasswordHasher.h
+ * @brief Declaración de la clase PasswordHasher, derivación de claves para contraseñas en un pool de hilos.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef PASSWORDHASHER_H
+#define PASSWORDHASHER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QThreadPool>
+#include <atomic>
+#include <functional>
+#include <future>
+
+/**
+ * @struct PasswordHash
+ * @brief Hash de una contraseña junto con los parámetros con que se calculó, tal como se guarda en users.
+ */
+struct PasswordHash
+{
+    /**
+     * @brief Función de derivación: PasswordHasher::kKdf, o "sha256" para las cuentas antiguas sin sal.
+     */
+    QString kdf;
+
+    /**
+     * @brief Iteraciones de la derivación.
+     */
+    int iterations = 0;
+
+    /**
+     * @brief Sal aleatoria, en bytes.
+     */
+    QByteArray salt;
+
+    /**
+     * @brief Clave derivada en hexadecimal (columna password).
+     */
+    QByteArray hash;
+
+    /**
+     * @brief Hash de una cuenta creada en lote (columna rehash_pending), pendiente de derivar con
+     *        el costo calibrado en el primer inicio de sesión.
+     */
+    bool provisional = false;
+};
+
+/**
+ * @class PasswordHasher
+ * @brief Servicio singleton que deriva y verifica contraseñas con PBKDF2-HMAC-SHA256.
+ *
+ * El costo (iteraciones) se calibra al arrancar para que un hash tarde lo indicado en la
+ * máquina actual, y se guarda junto a cada usuario: subir el costo no invalida las cuentas
+ * existentes, que se vuelven a derivar en su siguiente inicio de sesión (needsRehash()).
+ *
+ * Las versiones asíncronas ejecutan el trabajo en un QThreadPool propio con tantos hilos como
+ * núcleos, de modo que la interfaz no se congela y varios inicios de sesión a la vez se
+ * reparten entre los núcleos en lugar de hacer fila.
+ */
+class PasswordHasher
+{
+public:
+    /**
+     * @brief Nombre de la función de derivación actual.
+     */
+    static const char* const kKdf;
+
+    /**
+     * @brief Iteraciones mínimas admitidas, aunque la máquina sea lenta; ningún hash nuevo usa menos.
+     */
+    static const int kMinIterations;
+
+    /**
+     * @brief Iteraciones para cuentas creadas en lote.
+     *
+     * Es el mínimo admitido y no menos: una cuenta que nunca inicia sesión conserva este hash.
+     * Las cuentas en lote se guardan como provisionales, así que needsRehash() las vuelve a
+     * derivar con el costo calibrado en su primer inicio de sesión aunque ese costo sea parecido.
+     */
+    static const int kProvisioningIterations;
+
+    /**
+     * @brief Obtiene la instancia única de PasswordHasher.
+     * @return Referencia a la instancia singleton.
+     */
+    static PasswordHasher& instance();
+
+    /**
+     * @brief Mide la máquina y ajusta las iteraciones para que un hash tarde targetMilliseconds.
+     * @param targetMilliseconds Latencia objetivo de un hash.
+     * @return Iteraciones elegidas.
+     */
+    int calibrate(int targetMilliseconds = 100);
+
+    /**
+     * @brief Iteraciones usadas para los hashes nuevos.
+     * @return Número de iteraciones.
+     */
+    int iterations() const;
+
+    /**
+     * @brief Fija las iteraciones para los hashes nuevos, sin calibrar.
+     * @param iterations Número de iteraciones; se limita al mínimo admitido.
+     */
+    void setIterations(int iterations);
+
+    /**
+     * @brief Deriva el hash de una contraseña con sal nueva. Bloquea.
+     * @param password Contraseña.
+     * @param iterations Iteraciones, o 0 para usar el costo actual; se limita al rango admitido.
+     * @return Hash y parámetros.
+     */
+    PasswordHash hash(const QString& password, int iterations = 0) const;
+
+    /**
+     * @brief Verifica una contraseña contra un hash guardado. Bloquea.
+     * @param password Contraseña ingresada.
+     * @param stored Hash guardado con sus parámetros.
+     * @return true si la contraseña corresponde al hash.
+     */
+    bool verify(const QString& password, const PasswordHash& stored) const;
+
+    /**
+     * @brief Indica si un hash guardado debe recalcularse con los parámetros actuales.
+     * @param stored Hash guardado.
+     * @return true si es provisional, usa otra función de derivación o bastante menos iteraciones
+     *         que las actuales.
+     */
+    bool needsRehash(const PasswordHash& stored) const;
+
+    /**
+     * @brief Hash de referencia para comparar cuando el usuario no existe, con el costo actual.
+     * @return Hash que ninguna contraseña verifica.
+     */
+    PasswordHash dummyHash() const;
+
+    /**
+     * @brief Deriva el hash de una contraseña en el pool.
+     * @param password Contraseña.
+     * @param iterations Iteraciones, o 0 para usar el costo actual; se limita al rango admitido.
+     * @return Futuro con el hash.
+     */
+    std::future<PasswordHash> hashAsync(const QString& password, int iterations = 0);
+
+    /**
+     * @brief Verifica una contraseña en el pool.
+     * @param password Contraseña ingresada.
+     * @param stored Hash guardado.
+     * @return Futuro con el resultado de la verificación.
+     */
+    std::future<bool> verifyAsync(const QString& password, const PasswordHash& stored);
+
+    /**
+     * @brief Ejecuta un trabajo arbitrario de derivación en el pool.
+     * @param task Trabajo a ejecutar.
+     */
+    void run(std::function<void()> task);
+
+    /**
+     * @brief PBKDF2-HMAC-SHA256 (RFC 8018).
+     * @param password Contraseña en bytes.
+     * @param salt Sal.
+     * @param iterations Iteraciones.
+     * @param keyLength Bytes de la clave derivada.
+     * @return Clave derivada.
+     */
+    static QByteArray pbkdf2Sha256(const QByteArray& password, const QByteArray& salt, int iterations,
+                                   int keyLength = 32);
+
+    /**
+     * @brief Compara dos cadenas en tiempo que no depende de dónde difieren.
+     * @param a Primera cadena.
+     * @param b Segunda cadena.
+     * @return true si son iguales.
+     */
+    static bool constantTimeEquals(const QByteArray& a, const QByteArray& b);
+
+private:
+    /**
+     * @brief Constructor privado para implementar el patrón singleton.
+     */
+    PasswordHasher();
+
+    /**
+     * @brief Pool de hilos de derivación.
+     */
+    QThreadPool m_pool;
+
+    /**
+     * @brief Iteraciones actuales.
+     */
+    std::atomic<int> m_iterations;
+};
+
+#endif // PASSWORDHASHER_H
@@ -0,0 +1,301 @@
+/**
+ * @file QueryStats.h
+ * @brief Declaración de la clase QueryStats, latencias por consulta y registro de consultas lentas.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef QUERYSTATS_H
+#define QUERYSTATS_H
+
+#include "LatencyHistogram.h"
+#include "Trace.h"
+#include <QByteArray>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <chrono>
+
+class QSqlQuery;
+
+/**
+ * @class QueryStats
+ * @brief Registro global de latencias de las consultas SQL y de los puntos de entrada de DatabaseManager.
+ *
+ * Cada sentencia (el texto preparado, con sus marcadores) y cada punto de entrada tiene su propio
+ * LatencyHistogram, junto con el número de llamadas, errores, filas y bytes enlazados. Registrar
+ * cuesta una búsqueda en un QHash bajo un candado de lectura y unos cuantos incrementos atómicos.
+ *
+ * Cuando una sentencia tarda más que el umbral de consultas lentas (SALUD_SLOW_QUERY_MS, 100 ms
+ * por defecto) se registra en la categoría salud.db su SQL, sus parámetros sin los valores (solo
+ * tipo y longitud, para no exponer contraseñas ni datos de salud) y el resultado de
+ * EXPLAIN QUERY PLAN.
+ */
+class QueryStats
+{
+public:
+    /**
+     * @brief Tipo de una entrada.
+     */
+    enum Kind {
+        Statement,  ///< Una sentencia SQL.
+        EntryPoint  ///< Un método público de DatabaseManager.
+    };
+
+    /**
+     * @struct Entry
+     * @brief Foto de las estadísticas de una sentencia o punto de entrada.
+     */
+    struct Entry
+    {
+        /**
+         * @brief Tipo de la entrada.
+         */
+        Kind kind = Statement;
+
+        /**
+         * @brief Texto de la sentencia o nombre del punto de entrada.
+         */
+        QString name;
+
+        /**
+         * @brief Número de ejecuciones.
+         */
+        quint64 calls = 0;
+
+        /**
+         * @brief Ejecuciones que fallaron.
+         */
+        quint64 errors = 0;
+
+        /**
+         * @brief Filas afectadas (escrituras) o devueltas (puntos de entrada que leen).
+         */
+        quint64 rows = 0;
+
+        /**
+         * @brief Bytes de parámetros enlazados.
+         */
+        quint64 bytesBound = 0;
+
+        /**
+         * @brief Ejecuciones que superaron el umbral de consultas lentas.
+         */
+        quint64 slow = 0;
+
+        /**
+         * @brief Resumen de latencias, en nanosegundos.
+         */
+        LatencyHistogram::Summary latency;
+    };
+
+    /**
+     * @class Scope
+     * @brief Mide un punto de entrada desde su construcción hasta su destrucción.
+     *
+     * También abre un intervalo "db" de Trace, para la traza y para StallWatchdog.
+     */
+    class Scope
+    {
+    public:
+        /**
+         * @brief Inicia la medición.
+         * @param name Nombre del punto de entrada.
+         */
+        explicit Scope(const char* name);
+
+        /**
+         * @brief Registra el tiempo transcurrido y las filas.
+         */
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        /**
+         * @brief Suma filas devueltas por el punto de entrada.
+         * @param rows Número de filas.
+         */
+        void addRows(qint64 rows);
+
+    private:
+        /**
+         * @brief Nombre del punto de entrada.
+         */
+        const char* m_name;
+
+        /**
+         * @brief Inicio de la medición.
+         */
+        std::chrono::steady_clock::time_point m_start;
+
+        /**
+         * @brief Filas acumuladas.
+         */
+        qint64 m_rows;
+
+        /**
+         * @brief Intervalo "db" del punto de entrada.
+         */
+        Trace::Span m_span;
+    };
+
+    /**
+     * @brief Obtiene la instancia única de QueryStats.
+     * @return Referencia a la instancia singleton.
+     */
+    static QueryStats& instance();
+
+    /**
+     * @brief Ejecuta una consulta preparada y registra su latencia.
+     * @param query Consulta preparada con sus parámetros enlazados.
+     * @return El resultado de QSqlQuery::exec().
+     */
+    static bool exec(QSqlQuery& query);
+
+    /**
+     * @brief Ejecuta una sentencia directa y registra su latencia.
+     * @param query Consulta sobre la conexión deseada.
+     * @param sql Sentencia a ejecutar.
+     * @return El resultado de QSqlQuery::exec(sql).
+     */
+    static bool exec(QSqlQuery& query, const QString& sql);
+
+    /**
+     * @brief Cambia el umbral de consultas lentas.
+     * @param milliseconds Umbral en milisegundos; 0 o negativo desactiva el registro.
+     */
+    void setSlowQueryThreshold(int milliseconds);
+
+    /**
+     * @brief Umbral de consultas lentas.
+     * @return Umbral en milisegundos, o 0 si está desactivado.
+     */
+    int slowQueryThreshold() const;
+
+    /**
+     * @brief Foto de todas las entradas, de mayor a menor tiempo total.
+     * @return Estadísticas por sentencia y por punto de entrada.
+     */
+    QVector<Entry> snapshot() const;
+
+    /**
+     * @brief Foto en forma de tabla de texto, para registrar o mostrar.
+     * @return Una línea por entrada con llamadas, latencias en microsegundos, filas y bytes.
+     */
+    QString report() const;
+
+    /**
+     * @brief Vacía las estadísticas, conservando las entradas conocidas.
+     */
+    void reset();
+
+    /**
+     * @brief Destructor. Libera las entradas.
+     */
+    ~QueryStats();
+
+private:
+    /**
+     * @brief Constructor privado para implementar el patrón singleton.
+     */
+    QueryStats();
+
+    QueryStats(const QueryStats&) = delete;
+    QueryStats& operator=(const QueryStats&) = delete;
+
+    /**
+     * @struct Record
+     * @brief Contadores de una entrada, actualizados sin bloqueos.
+     */
+    struct Record
+    {
+        /**
+         * @brief Tipo de la entrada.
+         */
+        Kind kind = Statement;
+
+        /**
+         * @brief Texto de la sentencia o nombre del punto de entrada.
+         */
+        QString name;
+
+        /**
+         * @brief Nombre en UTF-8 para los intervalos de Trace, que guardan solo el puntero.
+         */
+        QByteArray traceName;
+
+        /**
+         * @brief Latencias.
+         */
+        LatencyHistogram latency;
+
+        /**
+         * @brief Ejecuciones.
+         */
+        std::atomic<quint64> calls{0};
+
+        /**
+         * @brief Ejecuciones fallidas.
+         */
+        std::atomic<quint64> errors{0};
+
+        /**
+         * @brief Filas afectadas o devueltas.
+         */
+        std::atomic<quint64> rows{0};
+
+        /**
+         * @brief Bytes de parámetros enlazados.
+         */
+        std::atomic<quint64> bytesBound{0};
+
+        /**
+         * @brief Ejecuciones lentas.
+         */
+        std::atomic<quint64> slow{0};
+    };
+
+    /**
+     * @brief Busca o crea la entrada de una sentencia o punto de entrada.
+     * @param kind Tipo de la entrada.
+     * @param name Texto o nombre.
+     * @return Entrada, válida mientras viva la instancia.
+     */
+    Record* record(Kind kind, const QString& name);
+
+    /**
+     * @brief Registra una ejecución ya terminada.
+     * @param query Consulta ejecutada.
+     * @param ok Resultado de exec().
+     * @param start Inicio de exec(), según Trace::now().
+     * @param nanoseconds Duración de exec().
+     */
+    void finishExec(QSqlQuery& query, bool ok, qint64 start, qint64 nanoseconds);
+
+    /**
+     * @brief Registra una consulta lenta con sus parámetros sin valores y su plan.
+     * @param query Consulta ejecutada.
+     * @param nanoseconds Duración de exec().
+     */
+    void logSlowQuery(QSqlQuery& query, qint64 nanoseconds);
+
+    /**
+     * @brief Protege m_records; las búsquedas toman el candado de lectura.
+     */
+    mutable QReadWriteLock m_lock;
+
+    /**
+     * @brief Entradas por tipo y nombre.
+     */
+    QHash<QString, Record*> m_records;
+
+    /**
+     * @brief Umbral de consultas lentas en nanosegundos, o 0.
+     */
+    std::atomic<qint64> m_slowThresholdNs;
+};
+
+#endif // QUERYSTATS_H
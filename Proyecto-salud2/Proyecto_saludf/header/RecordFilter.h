@@ -0,0 +1,81 @@
+/**
+ * @file RecordFilter.h
+ * @brief Declaración de la estructura RecordFilter para filtrar y ordenar registros de salud.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef RECORDFILTER_H
+#define RECORDFILTER_H
+
+#include <QString>
+#include <QDateTime>
+#include <Qt>
+
+/**
+ * @struct RecordFilter
+ * @brief Criterios de filtrado y ordenamiento para la tabla de registros de salud.
+ *
+ * Cada criterio se traduce a un predicado SQL sobre columnas indexadas, de modo que
+ * el filtrado y el ordenamiento se resuelven en la base de datos y no en memoria.
+ */
+struct RecordFilter
+{
+    /**
+     * @brief Columnas por las que se puede ordenar la tabla.
+     */
+    enum SortKey {
+        SortById,
+        SortByDateTime,
+        SortByWeight,
+        SortByBloodPressure,
+        SortByGlucose
+    };
+
+    /**
+     * @brief Fecha y hora mínima (inclusive). Si no es válida, no hay límite inferior.
+     */
+    QDateTime from;
+
+    /**
+     * @brief Fecha y hora máxima (inclusive). Si no es válida, no hay límite superior.
+     */
+    QDateTime to;
+
+    /**
+     * @brief Campo sobre el que se aplican los umbrales ("weight", "blood_pressure" o "glucose_level").
+     */
+    QString valueField;
+
+    /**
+     * @brief Indica si se aplica el umbral mínimo.
+     */
+    bool hasMinValue = false;
+
+    /**
+     * @brief Umbral mínimo (inclusive) del campo valueField.
+     */
+    double minValue = 0.0;
+
+    /**
+     * @brief Indica si se aplica el umbral máximo.
+     */
+    bool hasMaxValue = false;
+
+    /**
+     * @brief Umbral máximo (inclusive) del campo valueField.
+     */
+    double maxValue = 0.0;
+
+    /**
+     * @brief Columna de ordenamiento.
+     */
+    SortKey sortKey = SortById;
+
+    /**
+     * @brief Sentido del ordenamiento.
+     */
+    Qt::SortOrder sortOrder = Qt::AscendingOrder;
+};
+
+#endif // RECORDFILTER_H
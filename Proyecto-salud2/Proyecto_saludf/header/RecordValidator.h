@@ -0,0 +1,100 @@
+/**
+ * @file RecordValidator.h
+ * @brief Declaración de la clase RecordValidator, reglas de validación comunes a la captura manual y a los importadores.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef RECORDVALIDATOR_H
+#define RECORDVALIDATOR_H
+
+#include <QDateTime>
+#include <QString>
+
+/**
+ * @class RecordValidator
+ * @brief Valida y convierte los campos de un registro de salud.
+ *
+ * Las mismas reglas se aplican al formulario de datos y a cualquier importación: todos los
+ * campos presentes, peso y glucosa numéricos y presión con formato "sistólica/diastólica".
+ * Las variantes sobre bytes no reservan memoria y no dependen de la configuración regional
+ * (el separador decimal siempre es el punto), para usarse en los importadores masivos.
+ */
+class RecordValidator
+{
+public:
+    /**
+     * @brief Resultado de una validación.
+     */
+    enum Result {
+        Valid,                  ///< Los campos son válidos.
+        MissingField,           ///< Algún campo está vacío.
+        InvalidNumber,          ///< Peso o glucosa no son numéricos.
+        InvalidBloodPressure,   ///< La presión no tiene el formato "sistólica/diastólica".
+        InvalidDateTime         ///< La fecha y hora no es válida.
+    };
+
+    /**
+     * @brief Valida los campos tal como los escribe el usuario en el formulario.
+     * @param weight Texto del peso.
+     * @param bloodPressure Texto de la presión arterial.
+     * @param glucose Texto de la glucosa.
+     * @param weightValue Peso convertido, si es válido.
+     * @param glucoseValue Glucosa convertida, si es válida.
+     * @return Resultado de la validación.
+     */
+    static Result validate(const QString& weight, const QString& bloodPressure, const QString& glucose,
+                           float* weightValue, float* glucoseValue);
+
+    /**
+     * @brief Valida campos en bytes (ASCII/UTF-8) sin reservar memoria.
+     * @param weight Inicio del peso.
+     * @param weightSize Bytes del peso.
+     * @param bloodPressure Inicio de la presión arterial.
+     * @param bloodPressureSize Bytes de la presión arterial.
+     * @param glucose Inicio de la glucosa.
+     * @param glucoseSize Bytes de la glucosa.
+     * @param weightValue Peso convertido, si es válido.
+     * @param glucoseValue Glucosa convertida, si es válida.
+     * @return Resultado de la validación.
+     */
+    static Result validate(const char* weight, int weightSize, const char* bloodPressure, int bloodPressureSize,
+                           const char* glucose, int glucoseSize, float* weightValue, float* glucoseValue);
+
+    /**
+     * @brief Mensaje para el usuario correspondiente a un resultado.
+     * @param result Resultado de una validación.
+     * @return Mensaje en español.
+     */
+    static QString message(Result result);
+
+    /**
+     * @brief Convierte un número decimal con punto, con signo y exponente opcionales.
+     * @param begin Inicio del texto.
+     * @param end Fin del texto.
+     * @param value Valor convertido.
+     * @return true si todo el texto (salvo espacios a los lados) es un número finito.
+     */
+    static bool parseFloat(const char* begin, const char* end, float* value);
+
+    /**
+     * @brief Separa una presión "sistólica/diastólica" en bytes.
+     * @param begin Inicio del texto.
+     * @param end Fin del texto.
+     * @param systolic Presión sistólica resultante.
+     * @param diastolic Presión diastólica resultante.
+     * @return true si ambos valores son enteros positivos, false en caso contrario.
+     */
+    static bool parseBloodPressure(const char* begin, const char* end, int* systolic, int* diastolic);
+
+    /**
+     * @brief Convierte una fecha "yyyy-MM-dd hh:mm[:ss[.zzz]]" (también con 'T') sin reservar memoria.
+     * @param begin Inicio del texto.
+     * @param end Fin del texto.
+     * @param dateTime Fecha y hora resultante, en hora local como las del formulario.
+     * @return true si la fecha es válida, false en caso contrario.
+     */
+    static bool parseDateTime(const char* begin, const char* end, QDateTime* dateTime);
+};
+
+#endif // RECORDVALIDATOR_H
@@ -0,0 +1,95 @@
+/**
+ * @file Session.h
+ * @brief Declaración de la clase Session, datos del usuario autenticado durante una sesión.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <QHash>
+#include <QString>
+
+/**
+ * @class Session
+ * @brief Usuario autenticado: identificador, nombre para mostrar y preferencias.
+ *
+ * DatabaseManager::authenticate() crea la sesión una vez y la ventana de datos la recibe, de modo
+ * que abrir el espacio de trabajo no vuelve a consultar la tabla users. No guarda la contraseña
+ * ni su hash. Las sesiones son valores: copiar una es barato (QString y QHash comparten datos).
+ */
+class Session
+{
+public:
+    /**
+     * @brief Constructor de una sesión vacía (no válida).
+     */
+    Session();
+
+    /**
+     * @brief Constructor con los datos del usuario.
+     * @param userId Identificador del usuario.
+     * @param displayName Nombre para mostrar.
+     * @param preferences Preferencias guardadas del usuario.
+     */
+    Session(int userId, const QString& displayName, const QHash<QString, QString>& preferences);
+
+    /**
+     * @brief Indica si la sesión corresponde a un usuario autenticado.
+     * @return true si el identificador es válido.
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Identificador del usuario.
+     * @return Identificador, o 0 si la sesión no es válida.
+     */
+    int userId() const;
+
+    /**
+     * @brief Nombre para mostrar del usuario.
+     * @return Nombre de usuario.
+     */
+    QString displayName() const;
+
+    /**
+     * @brief Lee una preferencia del usuario.
+     * @param key Nombre de la preferencia.
+     * @param defaultValue Valor si la preferencia no existe.
+     * @return Valor guardado o defaultValue.
+     */
+    QString preference(const QString& key, const QString& defaultValue = QString()) const;
+
+    /**
+     * @brief Cambia una preferencia y la guarda en la base de datos.
+     * @param key Nombre de la preferencia.
+     * @param value Nuevo valor.
+     * @return true si se guarda, false en caso contrario.
+     */
+    bool setPreference(const QString& key, const QString& value);
+
+    /**
+     * @brief Todas las preferencias del usuario.
+     * @return Preferencias por nombre.
+     */
+    QHash<QString, QString> preferences() const;
+
+private:
+    /**
+     * @brief Identificador del usuario.
+     */
+    int m_userId;
+
+    /**
+     * @brief Nombre para mostrar.
+     */
+    QString m_displayName;
+
+    /**
+     * @brief Preferencias por nombre.
+     */
+    QHash<QString, QString> m_preferences;
+};
+
+#endif // SESSION_H
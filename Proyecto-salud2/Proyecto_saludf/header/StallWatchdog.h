@@ -0,0 +1,228 @@
+/**
+ * @file StallWatchdog.h
+ * @brief Declaración de la clase StallWatchdog, detección de bloqueos del bucle de eventos principal.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef STALLWATCHDOG_H
+#define STALLWATCHDOG_H
+
+#include "LatencyHistogram.h"
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+class QObject;
+class QThread;
+class QWidget;
+
+/**
+ * @class StallWatchdog
+ * @brief Hilo vigilante que detecta cuándo el bucle de eventos de la interfaz deja de responder.
+ *
+ * Está desactivado salvo que se pida (SALUD_STALL_MS o --stall): mientras funciona, Trace marca
+ * los intervalos abiertos de todos los hilos, lo que añade trabajo a cada TRACE_SPAN y consulta.
+ *
+ * El vigilante encola un latido en el hilo principal y mide cuánto tarda en atenderse. Si tarda
+ * más que el umbral (50 ms con --stall sin valor), el bucle estuvo bloqueado: la duración
+ * se suma a un LatencyHistogram y se atribuye a los intervalos de Trace (TRACE_SPAN y los puntos
+ * de entrada de DatabaseManager) que estaban abiertos en el hilo principal mientras duraba.
+ *
+ * El informe se registra al terminar la aplicación y se puede pedir en cualquier momento con
+ * Ctrl+Shift+F12 en las ventanas que llamen a installShortcut().
+ */
+class StallWatchdog
+{
+public:
+    /**
+     * @struct Attribution
+     * @brief Bloqueos ocurridos con la misma pila de intervalos abiertos.
+     */
+    struct Attribution
+    {
+        /**
+         * @brief Intervalos abiertos, del más externo al más interno, separados por " > ".
+         */
+        QString spans;
+
+        /**
+         * @brief Número de bloqueos.
+         */
+        quint64 count = 0;
+
+        /**
+         * @brief Suma de las duraciones, en nanosegundos.
+         */
+        qint64 total = 0;
+
+        /**
+         * @brief Bloqueo más largo, en nanosegundos.
+         */
+        qint64 max = 0;
+    };
+
+    /**
+     * @brief Umbral por defecto, en milisegundos.
+     */
+    static const int kDefaultThresholdMs = 50;
+
+    /**
+     * @brief Obtiene la instancia única de StallWatchdog.
+     * @return Referencia a la instancia singleton.
+     */
+    static StallWatchdog& instance();
+
+    /**
+     * @brief Inicia el hilo vigilante. Debe llamarse desde el hilo principal.
+     * @param thresholdMs Duración a partir de la cual se considera un bloqueo.
+     * @return true si se inició; false si ya estaba en marcha o no hay QCoreApplication.
+     */
+    bool start(int thresholdMs = kDefaultThresholdMs);
+
+    /**
+     * @brief Detiene el hilo vigilante. Debe llamarse desde el hilo principal.
+     */
+    void stop();
+
+    /**
+     * @brief Indica si el vigilante está en marcha.
+     * @return true entre start() y stop().
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Cambia el umbral de bloqueo.
+     * @param milliseconds Umbral en milisegundos; los valores menores que 1 se toman como 1.
+     */
+    void setThreshold(int milliseconds);
+
+    /**
+     * @brief Umbral de bloqueo.
+     * @return Umbral en milisegundos.
+     */
+    int threshold() const;
+
+    /**
+     * @brief Resumen de las duraciones de los bloqueos.
+     * @return Conteo, extremos y percentiles en nanosegundos.
+     */
+    LatencyHistogram::Summary summary() const;
+
+    /**
+     * @brief Bloqueos agrupados por intervalos abiertos, de mayor a menor tiempo total.
+     * @return Una entrada por pila de intervalos distinta.
+     */
+    QVector<Attribution> attributions() const;
+
+    /**
+     * @brief Informe en texto con el resumen y los puntos calientes.
+     * @return Informe listo para registrar o mostrar.
+     */
+    QString report() const;
+
+    /**
+     * @brief Vacía las estadísticas.
+     */
+    void reset();
+
+    /**
+     * @brief Agrega a una ventana el atajo Ctrl+Shift+F12, que registra y muestra el informe.
+     * @param window Ventana; el atajo se destruye con ella.
+     */
+    static void installShortcut(QWidget* window);
+
+    /**
+     * @brief Destructor. Detiene el hilo vigilante.
+     */
+    ~StallWatchdog();
+
+private:
+    /**
+     * @brief Constructor privado para implementar el patrón singleton.
+     */
+    StallWatchdog();
+
+    StallWatchdog(const StallWatchdog&) = delete;
+    StallWatchdog& operator=(const StallWatchdog&) = delete;
+
+    /**
+     * @brief Ciclo del hilo vigilante.
+     */
+    void watchLoop();
+
+    /**
+     * @brief Registra un bloqueo terminado.
+     * @param nanoseconds Duración del bloqueo.
+     * @param spans Intervalos abiertos durante el bloqueo.
+     */
+    void recordStall(qint64 nanoseconds, const QStringList& spans);
+
+    /**
+     * @brief Objeto del hilo principal que recibe los latidos.
+     */
+    QObject* m_heartbeat;
+
+    /**
+     * @brief Hilo vigilado.
+     */
+    const QThread* m_guiThread;
+
+    /**
+     * @brief Hilo vigilante.
+     */
+    std::thread m_watcher;
+
+    /**
+     * @brief Indica que el hilo vigilante debe seguir en marcha.
+     */
+    std::atomic<bool> m_running;
+
+    /**
+     * @brief Umbral en nanosegundos.
+     */
+    std::atomic<qint64> m_thresholdNs;
+
+    /**
+     * @brief Instante de envío del último latido atendido.
+     */
+    std::atomic<qint64> m_answeredBeat;
+
+    /**
+     * @brief Instante en que se atendió ese latido.
+     */
+    std::atomic<qint64> m_answeredAt;
+
+    /**
+     * @brief Duraciones de los bloqueos.
+     */
+    LatencyHistogram m_histogram;
+
+    /**
+     * @brief Protege m_attributions.
+     */
+    mutable QMutex m_mutex;
+
+    /**
+     * @brief Bloqueos por pila de intervalos.
+     */
+    QHash<QString, Attribution> m_attributions;
+
+    /**
+     * @brief Mutex de la variable de condición del vigilante.
+     */
+    std::mutex m_wakeMutex;
+
+    /**
+     * @brief Despierta al vigilante para que termine.
+     */
+    std::condition_variable m_wakeCondition;
+};
+
+#endif // STALLWATCHDOG_H
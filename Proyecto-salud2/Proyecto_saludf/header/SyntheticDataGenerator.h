@@ -0,0 +1,130 @@
+/**
+ * @file SyntheticDataGenerator.h
+ * @brief Declaración de la clase SyntheticDataGenerator, datos de salud sintéticos y reproducibles.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef SYNTHETICDATAGENERATOR_H
+#define SYNTHETICDATAGENERATOR_H
+
+#include "UserRegistration.h"
+#include "healthrecord.h"
+#include <QDate>
+#include <QVector>
+#include <functional>
+
+/**
+ * @class SyntheticDataGenerator
+ * @brief Genera usuarios y series de salud de varios años, siempre iguales para la misma semilla.
+ *
+ * Cada usuario tiene su propio generador pseudoaleatorio (splitmix64) derivado de la semilla y
+ * de su posición, así que su serie no depende del orden ni del tamaño de los lotes. Las series
+ * imitan mediciones reales: peso con deriva lenta y variación estacional, glucosa con picos
+ * posprandiales y algunos perfiles diabéticos, presión sistólica/diastólica correlacionadas y
+ * campos ausentes (como en las importaciones de dispositivos).
+ *
+ * Las filas se entregan por lotes a una función, sin materializar el conjunto completo, de modo
+ * que la escala va de mil a cien millones de filas con memoria constante.
+ */
+class SyntheticDataGenerator
+{
+public:
+    /**
+     * @struct Options
+     * @brief Parámetros del conjunto de datos.
+     */
+    struct Options
+    {
+        /**
+         * @brief Semilla; la misma semilla produce exactamente los mismos datos.
+         */
+        quint64 seed = 20250524;
+
+        /**
+         * @brief Número de usuarios.
+         */
+        int users = 100;
+
+        /**
+         * @brief Número total de filas de health_records, repartidas entre los usuarios.
+         */
+        qint64 rows = 100000;
+
+        /**
+         * @brief Años que cubre la serie de cada usuario.
+         */
+        int years = 3;
+
+        /**
+         * @brief Primer día de las series (UTC).
+         */
+        QDate start = QDate(2021, 1, 1);
+
+        /**
+         * @brief Lee las opciones de SALUD_BENCH_SEED, SALUD_BENCH_USERS, SALUD_BENCH_ROWS y SALUD_BENCH_YEARS.
+         * @return Opciones, con los valores por defecto para las variables ausentes o no válidas.
+         */
+        static Options fromEnvironment();
+    };
+
+    /**
+     * @brief Constructor.
+     * @param options Parámetros del conjunto de datos.
+     */
+    explicit SyntheticDataGenerator(const Options& options = Options());
+
+    /**
+     * @brief Parámetros del conjunto de datos.
+     * @return Opciones con las que se creó el generador.
+     */
+    const Options& options() const;
+
+    /**
+     * @brief Cuentas de los usuarios sintéticos.
+     * @return Un nombre "sint_000001" y una contraseña por usuario, en orden.
+     */
+    QVector<UserRegistration> users() const;
+
+    /**
+     * @brief Filas que corresponden a un usuario.
+     * @param index Posición del usuario, desde 0.
+     * @return Número de filas de su serie.
+     */
+    qint64 rowsForUser(int index) const;
+
+    /**
+     * @brief Serie completa de un usuario, en memoria.
+     * @param index Posición del usuario, desde 0.
+     * @param userId Identificador del usuario en la base de datos.
+     * @return Registros en orden cronológico.
+     */
+    QVector<healthrecord> userSeries(int index, const QString& userId) const;
+
+    /**
+     * @brief Genera las series de todos los usuarios por lotes.
+     * @param userIds Identificador en la base de datos de cada usuario, en el orden de users().
+     * @param batchRows Filas por lote.
+     * @param sink Recibe cada lote; si devuelve false se detiene la generación.
+     * @return true si se entregaron todas las filas.
+     */
+    bool generate(const QVector<int>& userIds, int batchRows,
+                  const std::function<bool(const QVector<healthrecord>&)>& sink) const;
+
+private:
+    /**
+     * @brief Genera la serie de un usuario, una lectura a la vez.
+     * @param index Posición del usuario, desde 0.
+     * @param userId Identificador del usuario en la base de datos.
+     * @param emit Recibe cada registro; si devuelve false se detiene.
+     * @return false si emit pidió detenerse.
+     */
+    bool forEachReading(int index, const QString& userId, const std::function<bool(const healthrecord&)>& emit) const;
+
+    /**
+     * @brief Parámetros del conjunto de datos.
+     */
+    Options m_options;
+};
+
+#endif // SYNTHETICDATAGENERATOR_H
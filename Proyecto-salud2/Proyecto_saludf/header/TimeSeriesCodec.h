@@ -0,0 +1,126 @@
+/**
+ * @file TimeSeriesCodec.h
+ * @brief Declaración de TimeSeriesCodec, codificación comprimida de series temporales por bloques.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef TIMESERIESCODEC_H
+#define TIMESERIESCODEC_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @struct TimePoint
+ * @brief Muestra de una serie temporal.
+ */
+struct TimePoint
+{
+    /**
+     * @brief Marca de tiempo en milisegundos desde la época Unix (UTC).
+     */
+    qint64 timestampMs = 0;
+
+    /**
+     * @brief Valor de la muestra.
+     */
+    double value = 0.0;
+};
+
+/**
+ * @struct TimeSeriesTail
+ * @brief Estado del codificador al final de un bloque, para seguir añadiendo muestras sin decodificarlo.
+ */
+struct TimeSeriesTail
+{
+    /**
+     * @brief Marca de tiempo de la última muestra.
+     */
+    qint64 lastTimestampMs = 0;
+
+    /**
+     * @brief Diferencia entre las dos últimas marcas de tiempo (0 con una sola muestra).
+     */
+    qint64 lastDeltaMs = 0;
+
+    /**
+     * @brief Bits del último valor.
+     */
+    quint64 lastValueBits = 0;
+
+    /**
+     * @brief Ceros iniciales de la ventana de bits significativos, o -1 si aún no hay ventana.
+     */
+    int windowLeading = -1;
+
+    /**
+     * @brief Ceros finales de la ventana de bits significativos.
+     */
+    int windowTrailing = 0;
+
+    /**
+     * @brief Bits útiles del flujo después de la cabecera; el resto del último byte es relleno.
+     */
+    qint64 bitLength = 0;
+};
+
+/**
+ * @class TimeSeriesCodec
+ * @brief Codifica bloques de muestras con marcas de tiempo delta-of-delta y valores XOR.
+ *
+ * Las marcas de tiempo se guardan como la diferencia entre deltas consecutivos, que para un
+ * sensor a frecuencia fija es casi siempre cero y ocupa un bit. Cada valor se guarda como el XOR
+ * con el anterior; cuando la lectura se repite ocupa un bit y, si cambia poco, solo se guardan
+ * los bits significativos. Es el esquema de Gorilla (Pelkonen et al., VLDB 2015).
+ *
+ * Formato del bloque: número de muestras (uint32), primera marca de tiempo (int64) y bits
+ * del primer valor (uint64), todos big-endian, seguidos del flujo de bits de las muestras restantes.
+ */
+class TimeSeriesCodec
+{
+public:
+    /**
+     * @brief Codifica un bloque de muestras ordenadas por marca de tiempo.
+     * @param points Muestras en orden ascendente de marca de tiempo.
+     * @param tail Si no es nulo, recibe el estado del codificador al final del bloque.
+     * @return Bloque codificado; vacío si no hay muestras.
+     */
+    static QByteArray encode(const QVector<TimePoint>& points, TimeSeriesTail* tail = nullptr);
+
+    /**
+     * @brief Añade muestras al final de un bloque continuando su flujo de bits.
+     * @param block Bloque producido por encode() o append(); se modifica.
+     * @param tail Estado del codificador al final del bloque; se actualiza.
+     * @param points Muestras en orden ascendente, todas posteriores a tail.lastTimestampMs.
+     * @return true si se añadieron; false sin modificar nada si el bloque no corresponde al estado o
+     *         las muestras no son posteriores.
+     */
+    static bool append(QByteArray& block, TimeSeriesTail& tail, const QVector<TimePoint>& points);
+
+    /**
+     * @brief Serializa el estado del codificador para guardarlo junto al bloque.
+     * @param tail Estado.
+     * @return Bytes del estado.
+     */
+    static QByteArray saveTail(const TimeSeriesTail& tail);
+
+    /**
+     * @brief Lee un estado guardado con saveTail().
+     * @param data Bytes del estado.
+     * @param tail Estado leído.
+     * @return true si los bytes son un estado válido.
+     */
+    static bool loadTail(const QByteArray& data, TimeSeriesTail* tail);
+
+    /**
+     * @brief Decodifica un bloque completo.
+     * @param block Bloque producido por encode().
+     * @param ok Si no es nulo, recibe false cuando el bloque está dañado.
+     * @return Muestras del bloque, en orden.
+     */
+    static QVector<TimePoint> decode(const QByteArray& block, bool* ok = nullptr);
+};
+
+#endif // TIMESERIESCODEC_H
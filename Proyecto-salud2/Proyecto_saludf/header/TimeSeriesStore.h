@@ -0,0 +1,145 @@
+/**
+ * @file TimeSeriesStore.h
+ * @brief Declaración de la clase TimeSeriesStore, almacén de series de alta frecuencia de dispositivos portátiles.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef TIMESERIESSTORE_H
+#define TIMESERIESSTORE_H
+
+#include "TimeSeriesCodec.h"
+#include <QSqlDatabase>
+#include <QVector>
+
+/**
+ * @struct DecimatedPoint
+ * @brief Resumen de las muestras de un intervalo de una serie.
+ */
+struct DecimatedPoint
+{
+    /**
+     * @brief Inicio del intervalo, en milisegundos desde la época Unix.
+     */
+    qint64 bucketStartMs = 0;
+
+    /**
+     * @brief Número de muestras del intervalo.
+     */
+    qint64 count = 0;
+
+    /**
+     * @brief Valor mínimo del intervalo.
+     */
+    double minValue = 0.0;
+
+    /**
+     * @brief Valor máximo del intervalo.
+     */
+    double maxValue = 0.0;
+
+    /**
+     * @brief Promedio de los valores del intervalo.
+     */
+    double average = 0.0;
+};
+
+/**
+ * @class TimeSeriesStore
+ * @brief Almacén de series temporales por usuario y métrica, agrupadas en bloques comprimidos.
+ *
+ * Las lecturas a 1 Hz (frecuencia cardiaca, SpO2...) no caben razonablemente en health_records,
+ * que guarda una fila por lectura. Este almacén agrupa las muestras de cada usuario y métrica en
+ * bloques de chunkMs milisegundos y guarda cada bloque como un BLOB codificado con TimeSeriesCodec
+ * en la tabla ts_chunks, junto con su mínimo, máximo, suma y número de muestras. Así la decimación
+ * para gráficas usa las estadísticas del bloque sin decodificarlo cuando el bloque cae completo
+ * dentro de un intervalo.
+ */
+class TimeSeriesStore
+{
+public:
+    /**
+     * @brief Métricas conocidas. Se admiten otros identificadores enteros.
+     */
+    enum Metric {
+        HeartRate = 1,
+        OxygenSaturation = 2,
+        RespiratoryRate = 3,
+        SkinTemperature = 4
+    };
+
+    /**
+     * @brief Duración de cada bloque: una hora.
+     */
+    static const qint64 kChunkMs = 3600 * 1000;
+
+    /**
+     * @brief Constructor del almacén.
+     * @param connection Conexión abierta en el hilo que usará el almacén.
+     */
+    explicit TimeSeriesStore(const QSqlDatabase& connection);
+
+    /**
+     * @brief Crea la tabla ts_chunks si no existe y le agrega la columna tail si es anterior a ella.
+     * @param connection Conexión abierta.
+     * @return true si el esquema está disponible, false en caso contrario.
+     */
+    static bool createSchema(QSqlDatabase& connection);
+
+    /**
+     * @brief Añade muestras a una serie.
+     * @param userId Identificador del usuario.
+     * @param metric Métrica de la serie.
+     * @param points Muestras en cualquier orden; una marca de tiempo repetida reemplaza a la anterior.
+     * @return true si todas las muestras se guardaron, false en caso contrario.
+     *
+     * Las muestras posteriores a la última de su bloque se añaden al final del flujo de bits sin
+     * decodificarlo; solo las atrasadas obligan a decodificar, combinar y volver a codificar el
+     * bloque, una vez por llamada.
+     */
+    bool append(int userId, int metric, QVector<TimePoint> points);
+
+    /**
+     * @brief Lee las muestras de una serie en un rango de tiempo.
+     * @param userId Identificador del usuario.
+     * @param metric Métrica de la serie.
+     * @param fromMs Inicio del rango (inclusive), en milisegundos desde la época Unix.
+     * @param toMs Fin del rango (exclusive), en milisegundos desde la época Unix.
+     * @return Muestras del rango en orden ascendente.
+     */
+    QVector<TimePoint> scan(int userId, int metric, qint64 fromMs, qint64 toMs);
+
+    /**
+     * @brief Resume una serie en intervalos de igual duración, para graficar rangos largos.
+     * @param userId Identificador del usuario.
+     * @param metric Métrica de la serie.
+     * @param fromMs Inicio del rango (inclusive).
+     * @param toMs Fin del rango (exclusive).
+     * @param buckets Número de intervalos.
+     * @return Un DecimatedPoint por intervalo con muestras, en orden.
+     */
+    QVector<DecimatedPoint> decimate(int userId, int metric, qint64 fromMs, qint64 toMs, int buckets);
+
+    /**
+     * @brief Bytes ocupados por los bloques de una serie.
+     * @param userId Identificador del usuario.
+     * @param metric Métrica de la serie.
+     * @return Suma del tamaño de los BLOB de la serie.
+     */
+    qint64 storedBytes(int userId, int metric);
+
+private:
+    /**
+     * @brief Inicio del bloque que contiene una marca de tiempo.
+     * @param timestampMs Marca de tiempo.
+     * @return Inicio del bloque.
+     */
+    static qint64 chunkStartFor(qint64 timestampMs);
+
+    /**
+     * @brief Conexión usada por el almacén.
+     */
+    QSqlDatabase m_connection;
+};
+
+#endif // TIMESERIESSTORE_H
@@ -0,0 +1,343 @@
+/**
+ * @file Trace.h
+ * @brief Declaración de la clase Trace, trazas por intervalos en formato Chrome / Perfetto.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QtGlobal>
+#include <atomic>
+#include <chrono>
+
+class QThread;
+
+/**
+ * @class Trace
+ * @brief Registra intervalos (spans) con nombre, categoría e hilo y los escribe como JSON de Chrome.
+ *
+ * Cada hilo escribe en su propio búfer, sin bloqueos: los eventos se guardan en bloques que solo
+ * ese hilo llena y se publican con un contador atómico. El anidamiento no se guarda aparte; el
+ * visor (chrome://tracing o ui.perfetto.dev) lo deduce de los intervalos de un mismo hilo.
+ *
+ * Se activa con la variable SALUD_TRACE o la opción --trace (ver start()). Aparte, setMarking()
+ * hace que cada hilo publique la pila de intervalos abiertos, que StallWatchdog consulta con
+ * activeSpans() para atribuir los bloqueos del hilo principal. Con ambos desactivados, cada
+ * TRACE_SPAN cuesta una lectura atómica y una rama; con SALUD_NO_TRACE desaparece al compilar.
+ */
+class Trace
+{
+public:
+    /**
+     * @brief Modos activos, combinables.
+     */
+    enum Mode {
+        Recording = 1, ///< Se registran los intervalos terminados (start()).
+        Marking = 2    ///< Se publica la pila de intervalos abiertos (setMarking()).
+    };
+
+    /**
+     * @class Span
+     * @brief Intervalo que va desde su construcción hasta su destrucción.
+     */
+    class Span
+    {
+    public:
+        /**
+         * @brief Abre el intervalo si la traza está activa.
+         * @param category Categoría (por ejemplo "ui" o "db"); debe ser una cadena literal.
+         * @param name Nombre del intervalo; debe ser una cadena literal.
+         */
+        Span(const char* category, const char* name)
+            : m_category(category), m_name(name), m_mode(Trace::mode()), m_start(-1)
+        {
+            if (m_mode) {
+                begin();
+            }
+        }
+
+        /**
+         * @brief Cierra el intervalo y lo registra.
+         */
+        ~Span()
+        {
+            if (m_mode) {
+                end();
+            }
+        }
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        /**
+         * @brief Toma el tiempo de inicio y publica el intervalo como abierto, según m_mode.
+         */
+        void begin();
+
+        /**
+         * @brief Registra el intervalo y lo retira de la pila de abiertos, según m_mode.
+         */
+        void end();
+
+        /**
+         * @brief Categoría del intervalo.
+         */
+        const char* m_category;
+
+        /**
+         * @brief Nombre del intervalo.
+         */
+        const char* m_name;
+
+        /**
+         * @brief Modos activos al abrir el intervalo; end() usa los mismos.
+         */
+        int m_mode;
+
+        /**
+         * @brief Inicio en nanosegundos, o -1 si no se está registrando.
+         */
+        qint64 m_start;
+    };
+
+    /**
+     * @brief Obtiene la instancia única de Trace.
+     * @return Referencia a la instancia singleton.
+     */
+    static Trace& instance();
+
+    /**
+     * @brief Indica si se están registrando intervalos.
+     * @return true entre start() y stop().
+     */
+    static bool enabled() { return s_mode.load(std::memory_order_relaxed) & Recording; }
+
+    /**
+     * @brief Modos activos.
+     * @return Combinación de Mode, o 0 si no hay ninguno.
+     */
+    static int mode() { return s_mode.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Reloj de la traza.
+     * @return Nanosegundos de steady_clock.
+     */
+    static qint64 now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Registra un intervalo ya terminado en el búfer del hilo actual.
+     * @param category Categoría; el puntero debe seguir siendo válido hasta escribir la traza.
+     * @param name Nombre; el puntero debe seguir siendo válido hasta escribir la traza.
+     * @param start Inicio, según now().
+     * @param duration Duración en nanosegundos.
+     */
+    static void complete(const char* category, const char* name, qint64 start, qint64 duration);
+
+    /**
+     * @brief Empieza a registrar intervalos.
+     * @param filePath Archivo JSON que escribirán flush() y stop().
+     */
+    void start(const QString& filePath);
+
+    /**
+     * @brief Deja de registrar y escribe el archivo.
+     * @return true si se escribió correctamente.
+     */
+    bool stop();
+
+    /**
+     * @brief Escribe el archivo con los intervalos registrados hasta ahora, sin detener la traza.
+     * @return true si se escribió correctamente.
+     */
+    bool flush();
+
+    /**
+     * @brief Intervalos descartados porque el búfer de su hilo estaba lleno.
+     * @return Cantidad de intervalos descartados.
+     */
+    quint64 dropped() const;
+
+    /**
+     * @brief Activa o desactiva la publicación de la pila de intervalos abiertos de cada hilo.
+     * @param enabled true para publicarla.
+     */
+    void setMarking(bool enabled);
+
+    /**
+     * @brief Intervalos abiertos en un hilo, del más externo al más interno.
+     * @param thread Hilo a consultar.
+     * @return Nombres de los intervalos; vacío si el hilo no tiene ninguno o no se está marcando.
+     *
+     * Puede llamarse desde cualquier hilo. La pila se lee sin detener al hilo consultado, así que
+     * es una muestra: puede cambiar justo después.
+     */
+    QStringList activeSpans(const QThread* thread) const;
+
+    /**
+     * @brief Destructor. Libera los búferes de los hilos.
+     */
+    ~Trace();
+
+private:
+    /**
+     * @brief Constructor privado para implementar el patrón singleton.
+     */
+    Trace();
+
+    Trace(const Trace&) = delete;
+    Trace& operator=(const Trace&) = delete;
+
+    /**
+     * @struct Event
+     * @brief Un intervalo terminado.
+     */
+    struct Event
+    {
+        /**
+         * @brief Categoría.
+         */
+        const char* category;
+
+        /**
+         * @brief Nombre.
+         */
+        const char* name;
+
+        /**
+         * @brief Inicio en nanosegundos.
+         */
+        qint64 start;
+
+        /**
+         * @brief Duración en nanosegundos.
+         */
+        qint64 duration;
+    };
+
+    /**
+     * @brief Eventos por bloque.
+     */
+    static const int kChunkEvents = 4096;
+
+    /**
+     * @brief Bloques por hilo (hasta ~1 millón de intervalos por hilo).
+     */
+    static const int kMaxChunks = 256;
+
+    /**
+     * @brief Profundidad máxima publicada de intervalos abiertos; los más internos no se publican.
+     */
+    static const int kMaxDepth = 32;
+
+    /**
+     * @struct ThreadBuffer
+     * @brief Eventos de un hilo. Solo ese hilo escribe; el lector respeta el contador publicado.
+     */
+    struct ThreadBuffer
+    {
+        /**
+         * @brief Identificador del hilo en la traza.
+         */
+        int tid = 0;
+
+        /**
+         * @brief Nombre del hilo en la traza.
+         */
+        QString name;
+
+        /**
+         * @brief Hilo dueño del búfer.
+         */
+        const QThread* thread = nullptr;
+
+        /**
+         * @brief Bloques de eventos, reservados a medida que se llenan.
+         */
+        std::atomic<Event*> chunks[kMaxChunks] = {};
+
+        /**
+         * @brief Eventos publicados.
+         */
+        std::atomic<quint64> count{0};
+
+        /**
+         * @brief Eventos descartados.
+         */
+        std::atomic<quint64> dropped{0};
+
+        /**
+         * @brief Intervalos abiertos, del más externo al más interno.
+         */
+        std::atomic<const char*> open[kMaxDepth] = {};
+
+        /**
+         * @brief Intervalos abiertos, incluidos los que no caben en open.
+         */
+        std::atomic<int> depth{0};
+    };
+
+    /**
+     * @brief Búfer del hilo actual, creado en su primer intervalo.
+     * @return Búfer del hilo.
+     */
+    ThreadBuffer* threadBuffer();
+
+    /**
+     * @brief Escribe el JSON de la traza.
+     * @return true si se escribió correctamente.
+     */
+    bool writeFile();
+
+    /**
+     * @brief Modos activos (Mode).
+     */
+    static std::atomic<int> s_mode;
+
+    /**
+     * @brief Protege m_buffers, m_filePath y la escritura del archivo.
+     */
+    mutable QMutex m_mutex;
+
+    /**
+     * @brief Búferes de todos los hilos que registraron intervalos.
+     */
+    QVector<ThreadBuffer*> m_buffers;
+
+    /**
+     * @brief Archivo de salida.
+     */
+    QString m_filePath;
+
+    /**
+     * @brief Instante de start(); los tiempos de la traza son relativos a él.
+     */
+    qint64 m_origin;
+};
+
+#define SALUD_TRACE_CONCAT_(a, b) a##b
+#define SALUD_TRACE_CONCAT(a, b) SALUD_TRACE_CONCAT_(a, b)
+
+/**
+ * @def TRACE_SPAN
+ * @brief Abre un intervalo que dura hasta el final del bloque actual.
+ * @param category Categoría literal, por ejemplo "ui", "db", "analyzer" o "export".
+ * @param name Nombre literal, normalmente "Clase::método".
+ */
+#ifdef SALUD_NO_TRACE
+#define TRACE_SPAN(category, name) do { } while (false)
+#else
+#define TRACE_SPAN(category, name) const Trace::Span SALUD_TRACE_CONCAT(traceSpan_, __LINE__)(category, name)
+#endif
+
+#endif // TRACE_H
@@ -14,7 +14,8 @@
  * @class User
  * @brief Clase que representa un usuario de la aplicación.
  *
- * Almacena información básica del usuario, como su identificador, nombre de usuario y contraseña.
+ * Almacena información básica del usuario: su identificador y nombre de usuario. La contraseña y
+ * su hash no salen de DatabaseManager.
  */
 class User
 {
@@ -28,9 +29,8 @@ public:
      * @brief Constructor con parámetros de la clase User.
      * @param id Identificador único del usuario.
      * @param username Nombre de usuario.
-     * @param password Contraseña del usuario.
      */
-    User(const QString& id, const QString& username, const QString& password);
+    User(const QString& id, const QString& username);
 
     /**
      * @brief Obtiene el identificador del usuario.
@@ -44,12 +44,6 @@ public:
      */
     QString getUsername() const;
 
-    /**
-     * @brief Obtiene la contraseña del usuario.
-     * @return Contraseña del usuario.
-     */
-    QString getPassword() const;
-
     /**
      * @brief Establece el identificador del usuario.
      * @param id Nuevo identificador del usuario.
@@ -62,12 +56,6 @@ public:
      */
     void setUsername(const QString& username);
 
-    /**
-     * @brief Establece la contraseña del usuario.
-     * @param password Nueva contraseña del usuario.
-     */
-    void setPassword(const QString& password);
-
 private:
     /**
      * @brief Identificador único del usuario.
@@ -78,11 +66,6 @@ private:
      * @brief Nombre de usuario.
      */
     QString m_username;
-
-    /**
-     * @brief Contraseña del usuario.
-     */
-    QString m_password;
 };
 
 #endif // USER_H
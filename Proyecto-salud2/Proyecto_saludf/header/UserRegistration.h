@@ -0,0 +1,62 @@
+/**
+ * @file UserRegistration.h
+ * @brief Declaración de las estructuras para el registro de usuarios en lote.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef USERREGISTRATION_H
+#define USERREGISTRATION_H
+
+#include <QString>
+
+/**
+ * @struct UserRegistration
+ * @brief Datos de una cuenta que se va a registrar.
+ */
+struct UserRegistration
+{
+    /**
+     * @brief Nombre de usuario; se ignoran los espacios al inicio y al final.
+     */
+    QString username;
+
+    /**
+     * @brief Contraseña inicial.
+     */
+    QString password;
+};
+
+/**
+ * @struct RegistrationResult
+ * @brief Resultado del registro de una cuenta del lote.
+ */
+struct RegistrationResult
+{
+    /**
+     * @brief Resultados posibles.
+     */
+    enum Outcome {
+        Registered,  ///< La cuenta se creó.
+        Duplicate,   ///< El nombre ya existía, o se repite antes en el mismo lote.
+        Invalid,     ///< Nombre o contraseña vacíos.
+        Failed       ///< Error de la base de datos; el lote completo se revirtió.
+    };
+
+    /**
+     * @brief Nombre de usuario, ya sin espacios al inicio y al final.
+     */
+    QString username;
+
+    /**
+     * @brief Resultado del registro.
+     */
+    Outcome outcome = Failed;
+
+    /**
+     * @brief Identificador asignado, o 0 si la cuenta no se creó.
+     */
+    qint64 userId = 0;
+};
+
+#endif // USERREGISTRATION_H
@@ -0,0 +1,157 @@
+/**
+ * @file XMLImporter.h
+ * @brief Declaración de la clase XMLImporter para importar exportaciones XML de teléfonos y relojes.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#ifndef XMLIMPORTER_H
+#define XMLIMPORTER_H
+
+#include "IngestPipeline.h"
+#include <QObject>
+#include <QString>
+#include <atomic>
+
+/**
+ * @struct XMLImportOptions
+ * @brief Parámetros de la importación XML.
+ */
+struct XMLImportOptions
+{
+    /**
+     * @brief Muestras recientes que se recuerdan para descartar duplicados.
+     */
+    int dedupeWindow = 65536;
+
+    /**
+     * @brief Presiones sistólicas o diastólicas sueltas que esperan a su pareja.
+     */
+    int pairingWindow = 1024;
+
+    /**
+     * @brief Elementos leídos entre dos avisos de progreso.
+     */
+    int progressInterval = 20000;
+
+    /**
+     * @brief Muestras por tarea enviada a los hilos de procesamiento.
+     */
+    int samplesPerTask = 4096;
+
+    /**
+     * @brief Parámetros del proceso por etapas (hilos, lotes).
+     */
+    IngestOptions ingest;
+};
+
+/**
+ * @struct XMLImportReport
+ * @brief Resultado de una importación XML.
+ */
+struct XMLImportReport
+{
+    /**
+     * @brief Indica si el archivo se leyó completo y todos los lotes se confirmaron.
+     */
+    bool ok = false;
+
+    /**
+     * @brief Descripción del error que detuvo la importación, si lo hubo.
+     */
+    QString error;
+
+    /**
+     * @brief Muestras de un tipo reconocido encontradas en el archivo.
+     */
+    qint64 samples = 0;
+
+    /**
+     * @brief Registros insertados.
+     */
+    qint64 imported = 0;
+
+    /**
+     * @brief Muestras con valor, unidad o fecha no válidos.
+     */
+    qint64 invalid = 0;
+
+    /**
+     * @brief Muestras descartadas por repetidas.
+     */
+    qint64 duplicates = 0;
+
+    /**
+     * @brief Presiones sistólicas o diastólicas que no encontraron pareja.
+     */
+    qint64 unpaired = 0;
+
+    /**
+     * @brief Métricas de cada etapa de la importación.
+     */
+    QVector<StageMetrics> metrics;
+};
+
+/**
+ * @class XMLImporter
+ * @brief Importa registros de salud desde exportaciones XML de plataformas de salud.
+ *
+ * El archivo se recorre con QXmlStreamReader sin construir un árbol, así que la memoria no
+ * depende del tamaño del archivo. Se reconocen los elementos Record con atributos type, unit,
+ * startDate y value (el formato de exportación de Apple Salud, entre otros); los tipos de peso,
+ * glucosa y presión arterial se convierten a kilogramos, mg/dL y mmHg, y los demás se ignoran.
+ *
+ * Cada muestra se guarda como un registro con solo su campo; los demás quedan en NULL. Las
+ * presiones sistólica y diastólica llegan como muestras separadas: se emparejan dentro de un
+ * elemento Correlation, o por fecha entre las últimas pairingWindow muestras sueltas. Las
+ * muestras repetidas (mismo tipo, fecha y valor, como las que varios dispositivos registran a la
+ * vez o las que la exportación repite dentro de Correlation) se descartan mientras estén entre
+ * las últimas dedupeWindow.
+ *
+ * QXmlStreamReader solo puede avanzar en un hilo, así que el hilo que llama lee los atributos y
+ * envía grupos de samplesPerTask muestras a IngestPipeline; los hilos de procesamiento convierten
+ * fechas, zonas horarias y unidades, y la etapa de depuración, en orden, empareja presiones
+ * sueltas y descarta repetidas.
+ */
+class XMLImporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructor del importador.
+     * @param parent Objeto padre, por defecto nullptr.
+     */
+    explicit XMLImporter(QObject *parent = nullptr);
+
+    /**
+     * @brief Importa un archivo XML para un usuario. Bloquea hasta terminar.
+     * @param filePath Ruta del archivo.
+     * @param userId Usuario al que se asignan los registros.
+     * @param options Parámetros de la importación.
+     * @return Informe con los totales.
+     */
+    XMLImportReport importFile(const QString& filePath, int userId,
+                               const XMLImportOptions& options = XMLImportOptions());
+
+    /**
+     * @brief Solicita la cancelación; la importación se detiene en el siguiente aviso de progreso.
+     */
+    void cancel();
+
+signals:
+    /**
+     * @brief Progreso de la lectura del archivo.
+     * @param bytesRead Bytes leídos hasta el momento.
+     * @param bytesTotal Tamaño del archivo.
+     */
+    void progress(qint64 bytesRead, qint64 bytesTotal);
+
+private:
+    /**
+     * @brief Indica que se solicitó la cancelación.
+     */
+    std::atomic<bool> m_cancelled;
+};
+
+#endif // XMLIMPORTER_H
@@ -9,8 +9,11 @@
 #define DATOS_H
 
 #include <QWidget>
-#include <QSqlQueryModel>
 #include "healthrecord.h"
+#include "ChangeFeed.h"
+#include "Session.h"
+
+class HealthRecordsModel;
 
 namespace Ui {
 class datos;
@@ -32,9 +35,9 @@ public:
     /**
      * @brief Constructor de la clase datos.
      * @param parent Puntero al widget padre, por defecto nullptr.
-     * @param userId Identificador del usuario autenticado para cargar sus datos de salud.
+     * @param session Sesión del usuario autenticado cuyos datos de salud se cargan.
      */
-    explicit datos(QWidget *parent = nullptr, const QString& userId = "");
+    explicit datos(QWidget *parent = nullptr, const Session& session = Session());
 
     /**
      * @brief Destructor de la clase datos.
@@ -81,6 +84,36 @@ private slots:
      */
     void onExportButtonClicked();
 
+    /**
+     * @brief Slot para manejar el clic en el botón de importar.
+     *
+     * Importa registros de salud desde un archivo CSV, por columnas o XML de un dispositivo y muestra un resumen
+     * con las líneas rechazadas.
+     */
+    void onImportarClicked();
+
+    /**
+     * @brief Slot para manejar el clic en el botón de filtrar.
+     *
+     * Aplica a la tabla el rango de fechas y los umbrales de valor seleccionados.
+     */
+    void onFiltrarClicked();
+
+    /**
+     * @brief Slot para manejar el clic en el botón de limpiar filtro.
+     *
+     * Elimina los criterios de filtrado y muestra todos los registros del usuario.
+     */
+    void onLimpiarFiltroClicked();
+
+    /**
+     * @brief Slot que recibe los cambios confirmados en health_records.
+     * @param changes Cambios de una transacción.
+     *
+     * Actualiza la tabla si alguno de los cambios pertenece al usuario actual.
+     */
+    void onRecordsChanged(const QVector<RecordChange>& changes);
+
 private:
     /**
      * @brief Puntero a la interfaz de usuario generada por Qt Designer para la ventana de datos.
@@ -88,14 +121,14 @@ private:
     Ui::datos *ui;
 
     /**
-     * @brief Identificador del usuario autenticado actualmente.
+     * @brief Sesión del usuario autenticado actualmente.
      */
-    QString currentUserId;
+    Session m_session;
 
     /**
      * @brief Modelo de datos para interactuar con la base de datos y mostrar los registros de salud.
      */
-    QSqlQueryModel *model;
+    HealthRecordsModel *model;
 
     /**
      * @brief Bandera para evitar la repetición del mensaje de bienvenida.
@@ -104,10 +137,15 @@ private:
      */
     bool welcomeMessageShown;
 
+    /**
+     * @brief Bandera que indica que ya hay una actualización de la tabla programada.
+     */
+    bool refreshPending;
+
     /**
      * @brief Configura el modelo de datos y la vista para mostrar los registros de salud.
      *
-     * Inicializa el modelo QSqlQueryModel y lo conecta con la interfaz gráfica para mostrar
+     * Inicializa el modelo HealthRecordsModel y lo conecta con la interfaz gráfica para mostrar
      * los datos de salud del usuario.
      */
     void setupModelAndView();
@@ -70,6 +70,15 @@ public:
      */
     float getGlucose() const;
 
+    /**
+     * @brief Separa una presión arterial con formato "sistólica/diastólica" en sus dos valores.
+     * @param bloodPressure Texto de la presión arterial.
+     * @param systolic Presión sistólica resultante.
+     * @param diastolic Presión diastólica resultante.
+     * @return true si ambos valores son enteros positivos, false en caso contrario.
+     */
+    static bool parseBloodPressure(const QString& bloodPressure, int* systolic, int* diastolic);
+
 private:
     /**
      * @brief Identificador único del registro.
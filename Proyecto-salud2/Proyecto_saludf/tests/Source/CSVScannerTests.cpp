@@ -0,0 +1,247 @@
+/**
+ * @file CSVScannerTests.cpp
+ * @brief Pruebas de la separación de líneas y el corte en fragmentos de CSVScanner.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "CSVScanner.h"
+#include <QRandomGenerator>
+#include <QtTest>
+
+/**
+ * @class CSVScannerTests
+ * @brief Verifica campos entre comillas, cortes de fragmento dentro de comillas y que SSE2 coincida con la versión escalar.
+ */
+class CSVScannerTests : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Líneas con comillas, comillas escapadas, delimitadores y CRLF dentro de los campos.
+     */
+    void splitLine_data();
+
+    /**
+     * @brief Separa una línea y compara los campos y los saltos de línea internos.
+     */
+    void splitLine();
+
+    /**
+     * @brief Todos los cortes posibles caen al inicio de un registro, aunque target quede dentro de comillas.
+     */
+    void chunkBoundariesInsideQuotes();
+
+    /**
+     * @brief Separar por fragmentos da los mismos campos que separar el texto completo.
+     */
+    void chunkedMatchesWhole();
+
+    /**
+     * @brief findSpecial() y countByte() con SSE2 coinciden con la versión byte a byte en cada posición.
+     */
+    void sse2MatchesScalar();
+
+private:
+    /**
+     * @brief Separa un texto completo en líneas y campos.
+     * @param begin Inicio del texto.
+     * @param end Fin del texto.
+     * @return Campos de cada línea, en orden.
+     */
+    static QVector<QStringList> splitAll(const char* begin, const char* end);
+
+    /**
+     * @brief Texto con campos entre comillas que contienen delimitadores, comillas escapadas y CRLF.
+     * @return Documento CSV de varias líneas.
+     */
+    static QByteArray quotedDocument();
+};
+
+/**
+ * @brief Separa un texto completo en líneas y campos.
+ * @param begin Inicio del texto.
+ * @param end Fin del texto.
+ * @return Campos de cada línea, en orden.
+ */
+QVector<QStringList> CSVScannerTests::splitAll(const char* begin, const char* end)
+{
+    QVector<QStringList> lines;
+    CSVField fields[CSVScanner::kMaxFields];
+    int fieldCount = 0;
+    std::vector<char> scratch;
+    qint64 newlines = 0;
+    while (begin < end) {
+        begin = CSVScanner::splitLine(begin, end, ',', '"', fields, &fieldCount, scratch, &newlines);
+        QStringList line;
+        for (int i = 0; i < fieldCount; ++i) {
+            line << QString::fromUtf8(fields[i].data, fields[i].size);
+        }
+        lines.append(line);
+    }
+    return lines;
+}
+
+/**
+ * @brief Texto con campos entre comillas que contienen delimitadores, comillas escapadas y CRLF.
+ * @return Documento CSV de varias líneas.
+ */
+QByteArray CSVScannerTests::quotedDocument()
+{
+    return QByteArray("1,7,2024-03-15 08:30,72.5,120/80,95\r\n"
+                      "2,7,\"2024-03-15 09:00\",\"72,6\",\"121/81\",96\r\n"
+                      "3,7,2024-03-15 10:00,\"nota\r\nde dos líneas, con coma\",122/82,97\n"
+                      "4,7,\"dice \"\"hola\"\"\",73.0,\"\",98\n"
+                      "5,7,\"\"\"\",\"a\nb\nc\",\"\r\n\",99\r\n"
+                      "6,7,2024-03-15 12:00,74,124/84,100");
+}
+
+/**
+ * @brief Líneas con comillas, comillas escapadas, delimitadores y CRLF dentro de los campos.
+ */
+void CSVScannerTests::splitLine_data()
+{
+    QTest::addColumn<QByteArray>("line");
+    QTest::addColumn<QStringList>("fields");
+    QTest::addColumn<qint64>("newlines");
+
+    QTest::newRow("simple") << QByteArray("a,b,c\n") << QStringList{"a", "b", "c"} << qint64(0);
+    QTest::newRow("crlf") << QByteArray("a,b\r\n") << QStringList{"a", "b"} << qint64(0);
+    QTest::newRow("sin salto final") << QByteArray("a,\"b\"") << QStringList{"a", "b"} << qint64(0);
+    QTest::newRow("vacíos") << QByteArray(",,\n") << QStringList{"", "", ""} << qint64(0);
+    QTest::newRow("delimitador entre comillas") << QByteArray("\"a,b\",c\n") << QStringList{"a,b", "c"} << qint64(0);
+    QTest::newRow("crlf entre comillas") << QByteArray("\"x\r\ny\",z\r\n") << QStringList{"x\r\ny", "z"} << qint64(1);
+    QTest::newRow("varios saltos") << QByteArray("\"1\n2\n3\",4\n") << QStringList{"1\n2\n3", "4"} << qint64(2);
+    QTest::newRow("comillas escapadas") << QByteArray("\"di \"\"hola\"\"\",2\n") << QStringList{"di \"hola\"", "2"}
+                                        << qint64(0);
+    QTest::newRow("solo comilla escapada") << QByteArray("\"\"\"\"\n") << QStringList{"\""} << qint64(0);
+    QTest::newRow("escapada con salto") << QByteArray("\"a\"\"\r\nb\",c\n") << QStringList{"a\"\r\nb", "c"}
+                                        << qint64(1);
+    QTest::newRow("texto tras la comilla") << QByteArray("\"a\"xyz,b\n") << QStringList{"a", "b"} << qint64(0);
+    QTest::newRow("comilla sin cerrar") << QByteArray("\"abc,d\ne") << QStringList{"abc,d\ne"} << qint64(1);
+    QTest::newRow("largo") << QByteArray("abcdefghijklmnopqrstuvwxyz0123456789,\"ABCDEFGHIJKLMNOPQRSTUVWXYZ,0123\",x\n")
+                           << QStringList{"abcdefghijklmnopqrstuvwxyz0123456789", "ABCDEFGHIJKLMNOPQRSTUVWXYZ,0123", "x"}
+                           << qint64(0);
+}
+
+/**
+ * @brief Separa una línea y compara los campos y los saltos de línea internos.
+ */
+void CSVScannerTests::splitLine()
+{
+    QFETCH(QByteArray, line);
+    QFETCH(QStringList, fields);
+    QFETCH(qint64, newlines);
+
+    CSVField spans[CSVScanner::kMaxFields];
+    int fieldCount = 0;
+    std::vector<char> scratch;
+    qint64 innerNewlines = -1;
+    const char* end = line.constData() + line.size();
+    const char* next = CSVScanner::splitLine(line.constData(), end, ',', '"', spans, &fieldCount, scratch,
+                                             &innerNewlines);
+
+    QCOMPARE(next - line.constData(), end - line.constData());
+    QCOMPARE(innerNewlines, newlines);
+    QStringList actual;
+    for (int i = 0; i < fieldCount; ++i) {
+        actual << QString::fromUtf8(spans[i].data, spans[i].size);
+    }
+    QCOMPARE(actual, fields);
+}
+
+/**
+ * @brief Todos los cortes posibles caen al inicio de un registro, aunque target quede dentro de comillas.
+ */
+void CSVScannerTests::chunkBoundariesInsideQuotes()
+{
+    const QByteArray document = quotedDocument();
+    const char* begin = document.constData();
+    const char* end = begin + document.size();
+
+    QVector<const char*> recordStarts;
+    CSVField fields[CSVScanner::kMaxFields];
+    int fieldCount = 0;
+    std::vector<char> scratch;
+    qint64 newlines = 0;
+    for (const char* p = begin; p < end;) {
+        p = CSVScanner::splitLine(p, end, ',', '"', fields, &fieldCount, scratch, &newlines);
+        recordStarts.append(p);
+    }
+
+    for (qint64 target = 1; target <= document.size() + 1; ++target) {
+        const char* cut = CSVScanner::nextChunkEnd(begin, end, target, '"');
+        QVERIFY2(recordStarts.contains(cut),
+                 qPrintable(QString("target %1 corta en el byte %2").arg(target).arg(cut - begin)));
+        QVERIFY(cut == end || cut - begin > target);
+    }
+}
+
+/**
+ * @brief Separar por fragmentos da los mismos campos que separar el texto completo.
+ */
+void CSVScannerTests::chunkedMatchesWhole()
+{
+    const QByteArray document = quotedDocument();
+    const char* begin = document.constData();
+    const char* end = begin + document.size();
+    const QVector<QStringList> whole = splitAll(begin, end);
+    QCOMPARE(whole.size(), 6);
+    QCOMPARE(whole[2][3], QString::fromUtf8("nota\r\nde dos líneas, con coma"));
+
+    for (qint64 target = 1; target <= 64; ++target) {
+        QVector<QStringList> chunked;
+        for (const char* p = begin; p < end;) {
+            const char* chunkEnd = CSVScanner::nextChunkEnd(p, end, target, '"');
+            chunked += splitAll(p, chunkEnd);
+            p = chunkEnd;
+        }
+        QCOMPARE(chunked, whole);
+    }
+}
+
+/**
+ * @brief findSpecial() y countByte() con SSE2 coinciden con la versión byte a byte en cada posición.
+ *
+ * Los textos mezclan los cuatro caracteres especiales con bytes comunes y con bytes altos (UTF-8),
+ * con largos que cruzan varios bloques de 16 bytes y restos de todos los tamaños.
+ */
+void CSVScannerTests::sse2MatchesScalar()
+{
+    if (!CSVScanner::hasSse2()) {
+        QSKIP("Compilado sin SSE2: findSpecial() y countByte() ya son la versión escalar");
+    }
+    const char alphabet[] = {'a', 'b', ',', ';', '"', '\n', '\r', ' ', '7', '\xC3', '\xB3', '\x80'};
+    QRandomGenerator random(20250524);
+    for (int round = 0; round < 500; ++round) {
+        const int length = random.bounded(0, 80);
+        QByteArray text(length, 'x');
+        for (int i = 0; i < length; ++i) {
+            if (random.bounded(0, 8) < 2) {
+                text[i] = alphabet[random.bounded(0, static_cast<int>(sizeof(alphabet)))];
+            }
+        }
+        const char delimiter = round % 3 == 0 ? ';' : ',';
+        const char* end = text.constData() + length;
+        for (const char* p = text.constData(); p <= end; ++p) {
+            QCOMPARE(CSVScanner::findSpecial(p, end, delimiter, '"') - p,
+                     CSVScanner::findSpecialScalar(p, end, delimiter, '"') - p);
+            QCOMPARE(CSVScanner::countByte(p, end, '"'), CSVScanner::countByteScalar(p, end, '"'));
+        }
+    }
+}
+
+/**
+ * @brief Ejecuta las pruebas de CSVScanner.
+ * @param argc Número de argumentos.
+ * @param argv Argumentos de QtTest.
+ * @return Número de pruebas fallidas.
+ */
+int runCSVScannerTests(int argc, char** argv)
+{
+    CSVScannerTests tests;
+    return QTest::qExec(&tests, argc, argv);
+}
+
+#include "CSVScannerTests.moc"
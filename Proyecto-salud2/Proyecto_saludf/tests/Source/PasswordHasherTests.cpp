@@ -0,0 +1,186 @@
+/**
+ * @file PasswordHasherTests.cpp
+ * @brief Pruebas de PBKDF2-HMAC-SHA256 de PasswordHasher con vectores publicados.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "PasswordHasher.h"
+#include <QMessageAuthenticationCode>
+#include <QtTest>
+
+/**
+ * @class PasswordHasherTests
+ * @brief Verifica pbkdf2Sha256() con los vectores del RFC 7914 y contra HMAC de Qt.
+ */
+class PasswordHasherTests : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Vectores PBKDF2-HMAC-SHA256 del RFC 7914, sección 11.
+     */
+    void rfc7914_data();
+
+    /**
+     * @brief Deriva la clave del caso y la compara con el vector.
+     */
+    void rfc7914();
+
+    /**
+     * @brief Claves y sales en los bordes del bloque de SHA-256.
+     */
+    void matchesReference_data();
+
+    /**
+     * @brief Compara con una derivación hecha con QMessageAuthenticationCode.
+     */
+    void matchesReference();
+
+    /**
+     * @brief Un hash nuevo verifica su contraseña y rechaza otra.
+     */
+    void hashAndVerify();
+
+private:
+    /**
+     * @brief PBKDF2-HMAC-SHA256 directo del RFC 8018, con un HMAC completo por iteración.
+     * @param password Contraseña.
+     * @param salt Sal.
+     * @param iterations Iteraciones.
+     * @param keyLength Bytes de la clave derivada.
+     * @return Clave derivada.
+     */
+    static QByteArray referencePbkdf2(const QByteArray& password, const QByteArray& salt, int iterations,
+                                      int keyLength);
+};
+
+/**
+ * @brief PBKDF2-HMAC-SHA256 directo del RFC 8018, con un HMAC completo por iteración.
+ * @param password Contraseña.
+ * @param salt Sal.
+ * @param iterations Iteraciones.
+ * @param keyLength Bytes de la clave derivada.
+ * @return Clave derivada.
+ */
+QByteArray PasswordHasherTests::referencePbkdf2(const QByteArray& password, const QByteArray& salt, int iterations,
+                                                int keyLength)
+{
+    QByteArray derived;
+    for (quint32 block = 1; derived.size() < keyLength; ++block) {
+        QByteArray message = salt;
+        message.append(static_cast<char>(block >> 24));
+        message.append(static_cast<char>(block >> 16));
+        message.append(static_cast<char>(block >> 8));
+        message.append(static_cast<char>(block));
+        QByteArray u = QMessageAuthenticationCode::hash(message, password, QCryptographicHash::Sha256);
+        QByteArray t = u;
+        for (int i = 1; i < iterations; ++i) {
+            u = QMessageAuthenticationCode::hash(u, password, QCryptographicHash::Sha256);
+            for (int j = 0; j < t.size(); ++j) {
+                t[j] = static_cast<char>(t[j] ^ u[j]);
+            }
+        }
+        derived.append(t);
+    }
+    return derived.left(keyLength);
+}
+
+/**
+ * @brief Vectores PBKDF2-HMAC-SHA256 del RFC 7914, sección 11.
+ */
+void PasswordHasherTests::rfc7914_data()
+{
+    QTest::addColumn<QByteArray>("password");
+    QTest::addColumn<QByteArray>("salt");
+    QTest::addColumn<int>("iterations");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::newRow("c=1") << QByteArray("passwd") << QByteArray("salt") << 1
+                         << QByteArray("55ac046e56e3089fec1691c22544b605f94185216dde0465e68b9d57c20dacbc"
+                                       "49ca9cccf179b645991664b39d77ef317c71b845b1e30bd509112041d3a19783");
+    QTest::newRow("c=80000") << QByteArray("Password") << QByteArray("NaCl") << 80000
+                             << QByteArray("4ddcd8f60b98be21830cee5ef22701f9641a4418d04c0414aeff08876b34ab56"
+                                           "a1d425a1225833549adb841b51c9b3176a272bdebba1d078478f62b397f33c8d");
+}
+
+/**
+ * @brief Deriva la clave del caso y la compara con el vector.
+ */
+void PasswordHasherTests::rfc7914()
+{
+    QFETCH(QByteArray, password);
+    QFETCH(QByteArray, salt);
+    QFETCH(int, iterations);
+    QFETCH(QByteArray, expected);
+
+    QCOMPARE(PasswordHasher::pbkdf2Sha256(password, salt, iterations, 64).toHex(), expected);
+}
+
+/**
+ * @brief Claves y sales en los bordes del bloque de SHA-256.
+ *
+ * Las claves de más de 64 bytes se reemplazan por su resumen; una sal de 52 a 60 bytes deja el
+ * relleno del primer HMAC en un segundo bloque.
+ */
+void PasswordHasherTests::matchesReference_data()
+{
+    QTest::addColumn<QByteArray>("password");
+    QTest::addColumn<QByteArray>("salt");
+    QTest::addColumn<int>("iterations");
+    QTest::addColumn<int>("keyLength");
+
+    QTest::newRow("vacías") << QByteArray() << QByteArray() << 1 << 32;
+    QTest::newRow("clave de 63") << QByteArray(63, 'k') << QByteArray("sal") << 3 << 32;
+    QTest::newRow("clave de 64") << QByteArray(64, 'k') << QByteArray("sal") << 3 << 32;
+    QTest::newRow("clave de 65") << QByteArray(65, 'k') << QByteArray("sal") << 3 << 32;
+    QTest::newRow("clave de 200") << QByteArray(200, 'k') << QByteArray("sal") << 2 << 32;
+    QTest::newRow("sal de 51") << QByteArray("clave") << QByteArray(51, 's') << 2 << 32;
+    QTest::newRow("sal de 52") << QByteArray("clave") << QByteArray(52, 's') << 2 << 32;
+    QTest::newRow("sal de 60") << QByteArray("clave") << QByteArray(60, 's') << 2 << 32;
+    QTest::newRow("sal de 130") << QByteArray("clave") << QByteArray(130, 's') << 2 << 32;
+    QTest::newRow("clave corta") << QByteArray("clave") << QByteArray("sal") << 5 << 20;
+    QTest::newRow("dos bloques") << QByteArray("clave") << QByteArray("sal") << 5 << 33;
+    QTest::newRow("tres bloques") << QByteArray("clave") << QByteArray("sal") << 4 << 70;
+}
+
+/**
+ * @brief Compara con una derivación hecha con QMessageAuthenticationCode.
+ */
+void PasswordHasherTests::matchesReference()
+{
+    QFETCH(QByteArray, password);
+    QFETCH(QByteArray, salt);
+    QFETCH(int, iterations);
+    QFETCH(int, keyLength);
+
+    QCOMPARE(PasswordHasher::pbkdf2Sha256(password, salt, iterations, keyLength).toHex(),
+             referencePbkdf2(password, salt, iterations, keyLength).toHex());
+}
+
+/**
+ * @brief Un hash nuevo verifica su contraseña y rechaza otra.
+ */
+void PasswordHasherTests::hashAndVerify()
+{
+    const PasswordHasher& hasher = PasswordHasher::instance();
+    const PasswordHash stored = hasher.hash(QStringLiteral("contraseña-de-prueba"), PasswordHasher::kMinIterations);
+    QCOMPARE(stored.iterations, PasswordHasher::kMinIterations);
+    QVERIFY(hasher.verify(QStringLiteral("contraseña-de-prueba"), stored));
+    QVERIFY(!hasher.verify(QStringLiteral("contraseña-de-prueba2"), stored));
+}
+
+/**
+ * @brief Ejecuta las pruebas de PasswordHasher.
+ * @param argc Número de argumentos.
+ * @param argv Argumentos de QtTest.
+ * @return Número de pruebas fallidas.
+ */
+int runPasswordHasherTests(int argc, char** argv)
+{
+    PasswordHasherTests tests;
+    return QTest::qExec(&tests, argc, argv);
+}
+
+#include "PasswordHasherTests.moc"
@@ -0,0 +1,226 @@
+/**
+ * @file RecordValidatorTests.cpp
+ * @brief Pruebas de las conversiones sobre bytes de RecordValidator.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "RecordValidator.h"
+#include <QDateTime>
+#include <QtTest>
+
+/**
+ * @class RecordValidatorTests
+ * @brief Verifica que números, presiones y fechas mal formados se rechacen y los válidos se conviertan.
+ */
+class RecordValidatorTests : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Números válidos y mal formados.
+     */
+    void parseFloat_data();
+
+    /**
+     * @brief Convierte el número del caso y compara resultado y valor.
+     */
+    void parseFloat();
+
+    /**
+     * @brief Presiones válidas y mal formadas.
+     */
+    void parseBloodPressure_data();
+
+    /**
+     * @brief Separa la presión del caso y compara resultado y valores.
+     */
+    void parseBloodPressure();
+
+    /**
+     * @brief Fechas válidas, inexistentes y mal formadas.
+     */
+    void parseDateTime_data();
+
+    /**
+     * @brief Convierte la fecha del caso y compara resultado y valor.
+     */
+    void parseDateTime();
+
+    /**
+     * @brief validate() sobre bytes informa el primer problema de los campos.
+     */
+    void validateBytes();
+};
+
+/**
+ * @brief Números válidos y mal formados.
+ */
+void RecordValidatorTests::parseFloat_data()
+{
+    QTest::addColumn<QByteArray>("text");
+    QTest::addColumn<bool>("valid");
+    QTest::addColumn<float>("value");
+
+    QTest::newRow("decimal") << QByteArray("72.5") << true << 72.5f;
+    QTest::newRow("espacios") << QByteArray(" \t80 ") << true << 80.0f;
+    QTest::newRow("signo y exponente") << QByteArray("-1.5e2") << true << -150.0f;
+    QTest::newRow("signo positivo") << QByteArray("+3") << true << 3.0f;
+    QTest::newRow("sin entero") << QByteArray(".5") << true << 0.5f;
+    QTest::newRow("punto final") << QByteArray("5.") << true << 5.0f;
+    QTest::newRow("exponente negativo") << QByteArray("125E-1") << true << 12.5f;
+    QTest::newRow("vacío") << QByteArray("") << false << 0.0f;
+    QTest::newRow("solo espacios") << QByteArray("   ") << false << 0.0f;
+    QTest::newRow("letras") << QByteArray("abc") << false << 0.0f;
+    QTest::newRow("coma decimal") << QByteArray("72,5") << false << 0.0f;
+    QTest::newRow("dos puntos") << QByteArray("1.2.3") << false << 0.0f;
+    QTest::newRow("unidad") << QByteArray("72kg") << false << 0.0f;
+    QTest::newRow("espacio tras el signo") << QByteArray("- 1") << false << 0.0f;
+    QTest::newRow("solo signo") << QByteArray("-") << false << 0.0f;
+    QTest::newRow("solo punto") << QByteArray(".") << false << 0.0f;
+    QTest::newRow("exponente vacío") << QByteArray("1e") << false << 0.0f;
+    QTest::newRow("exponente con solo signo") << QByteArray("1e+") << false << 0.0f;
+    QTest::newRow("exponente sin mantisa") << QByteArray("e5") << false << 0.0f;
+    QTest::newRow("desborda float") << QByteArray("1e999") << false << 0.0f;
+    QTest::newRow("nan") << QByteArray("nan") << false << 0.0f;
+    QTest::newRow("inf") << QByteArray("inf") << false << 0.0f;
+}
+
+/**
+ * @brief Convierte el número del caso y compara resultado y valor.
+ */
+void RecordValidatorTests::parseFloat()
+{
+    QFETCH(QByteArray, text);
+    QFETCH(bool, valid);
+    QFETCH(float, value);
+
+    float parsed = -1.0f;
+    QCOMPARE(RecordValidator::parseFloat(text.constData(), text.constData() + text.size(), &parsed), valid);
+    if (valid) {
+        QCOMPARE(parsed, value);
+    } else {
+        QCOMPARE(parsed, -1.0f);
+    }
+}
+
+/**
+ * @brief Presiones válidas y mal formadas.
+ */
+void RecordValidatorTests::parseBloodPressure_data()
+{
+    QTest::addColumn<QByteArray>("text");
+    QTest::addColumn<bool>("valid");
+    QTest::addColumn<int>("systolic");
+    QTest::addColumn<int>("diastolic");
+
+    QTest::newRow("simple") << QByteArray("120/80") << true << 120 << 80;
+    QTest::newRow("espacios alrededor") << QByteArray(" 120 / 80 ") << true << 120 << 80;
+    QTest::newRow("vacía") << QByteArray("") << false << 0 << 0;
+    QTest::newRow("sin diastólica") << QByteArray("120/") << false << 0 << 0;
+    QTest::newRow("sin sistólica") << QByteArray("/80") << false << 0 << 0;
+    QTest::newRow("sin barra") << QByteArray("120") << false << 0 << 0;
+    QTest::newRow("guion") << QByteArray("120-80") << false << 0 << 0;
+    QTest::newRow("espacio dentro") << QByteArray("12 0/80") << false << 0 << 0;
+    QTest::newRow("cero") << QByteArray("0/80") << false << 0 << 0;
+    QTest::newRow("tres partes") << QByteArray("120/80/60") << false << 0 << 0;
+    QTest::newRow("decimal") << QByteArray("120.5/80") << false << 0 << 0;
+    QTest::newRow("letras") << QByteArray("alta") << false << 0 << 0;
+}
+
+/**
+ * @brief Separa la presión del caso y compara resultado y valores.
+ */
+void RecordValidatorTests::parseBloodPressure()
+{
+    QFETCH(QByteArray, text);
+    QFETCH(bool, valid);
+    QFETCH(int, systolic);
+    QFETCH(int, diastolic);
+
+    int parsedSystolic = 0;
+    int parsedDiastolic = 0;
+    QCOMPARE(RecordValidator::parseBloodPressure(text.constData(), text.constData() + text.size(), &parsedSystolic,
+                                                 &parsedDiastolic),
+             valid);
+    QCOMPARE(parsedSystolic, systolic);
+    QCOMPARE(parsedDiastolic, diastolic);
+}
+
+/**
+ * @brief Fechas válidas, inexistentes y mal formadas.
+ */
+void RecordValidatorTests::parseDateTime_data()
+{
+    QTest::addColumn<QByteArray>("text");
+    QTest::addColumn<QDateTime>("expected");
+
+    const QDate day(2024, 3, 15);
+    QTest::newRow("minutos") << QByteArray("2024-03-15 08:30") << QDateTime(day, QTime(8, 30));
+    QTest::newRow("segundos con T") << QByteArray("2024-03-15T08:30:45") << QDateTime(day, QTime(8, 30, 45));
+    QTest::newRow("milisegundos") << QByteArray("2024-03-15 08:30:45.123") << QDateTime(day, QTime(8, 30, 45, 123));
+    QTest::newRow("microsegundos") << QByteArray("2024-03-15 08:30:45.123456") << QDateTime(day, QTime(8, 30, 45, 123));
+    QTest::newRow("solo fecha") << QByteArray("2024-03-15") << QDateTime(day, QTime(0, 0));
+    QTest::newRow("espacios") << QByteArray("  2024-03-15 08:30\t") << QDateTime(day, QTime(8, 30));
+    QTest::newRow("bisiesto") << QByteArray("2024-02-29 23:59:59") << QDateTime(QDate(2024, 2, 29), QTime(23, 59, 59));
+
+    QTest::newRow("vacía") << QByteArray("") << QDateTime();
+    QTest::newRow("día inexistente") << QByteArray("2023-02-29 10:00") << QDateTime();
+    QTest::newRow("mes 13") << QByteArray("2024-13-01") << QDateTime();
+    QTest::newRow("hora 24") << QByteArray("2024-03-15 24:00") << QDateTime();
+    QTest::newRow("minuto 60") << QByteArray("2024-03-15 08:60") << QDateTime();
+    QTest::newRow("barras") << QByteArray("2024/03/15") << QDateTime();
+    QTest::newRow("orden día-mes") << QByteArray("15-03-2024") << QDateTime();
+    QTest::newRow("mes de un dígito") << QByteArray("2024-3-15") << QDateTime();
+    QTest::newRow("hora de un dígito") << QByteArray("2024-03-15 8:30") << QDateTime();
+    QTest::newRow("sin minutos") << QByteArray("2024-03-15 08") << QDateTime();
+    QTest::newRow("texto al final") << QByteArray("2024-03-15 08:30x") << QDateTime();
+    QTest::newRow("segundos incompletos") << QByteArray("2024-03-15 08:30:4") << QDateTime();
+}
+
+/**
+ * @brief Convierte la fecha del caso y compara resultado y valor.
+ */
+void RecordValidatorTests::parseDateTime()
+{
+    QFETCH(QByteArray, text);
+    QFETCH(QDateTime, expected);
+
+    QDateTime parsed;
+    QCOMPARE(RecordValidator::parseDateTime(text.constData(), text.constData() + text.size(), &parsed),
+             expected.isValid());
+    QCOMPARE(parsed, expected);
+}
+
+/**
+ * @brief validate() sobre bytes informa el primer problema de los campos.
+ */
+void RecordValidatorTests::validateBytes()
+{
+    float weight = 0.0f;
+    float glucose = 0.0f;
+    QCOMPARE(RecordValidator::validate("72.5", 4, "120/80", 6, "95", 2, &weight, &glucose), RecordValidator::Valid);
+    QCOMPARE(weight, 72.5f);
+    QCOMPARE(glucose, 95.0f);
+    QCOMPARE(RecordValidator::validate("", 0, "120/80", 6, "95", 2, &weight, &glucose),
+             RecordValidator::MissingField);
+    QCOMPARE(RecordValidator::validate("72,5", 4, "120/80", 6, "95", 2, &weight, &glucose),
+             RecordValidator::InvalidNumber);
+    QCOMPARE(RecordValidator::validate("72.5", 4, "120", 3, "95", 2, &weight, &glucose),
+             RecordValidator::InvalidBloodPressure);
+}
+
+/**
+ * @brief Ejecuta las pruebas de RecordValidator.
+ * @param argc Número de argumentos.
+ * @param argv Argumentos de QtTest.
+ * @return Número de pruebas fallidas.
+ */
+int runRecordValidatorTests(int argc, char** argv)
+{
+    RecordValidatorTests tests;
+    return QTest::qExec(&tests, argc, argv);
+}
+
+#include "RecordValidatorTests.moc"
@@ -0,0 +1,246 @@
+/**
+ * @file TimeSeriesCodecTests.cpp
+ * @brief Pruebas de ida y vuelta de TimeSeriesCodec.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include "TimeSeriesCodec.h"
+#include <QtTest>
+
+/**
+ * @class TimeSeriesCodecTests
+ * @brief Verifica que decode() devuelva exactamente lo que recibió encode().
+ */
+class TimeSeriesCodecTests : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Delta-of-delta en los extremos de cada cubeta y justo fuera de ellos.
+     */
+    void bucketBoundaries_data();
+
+    /**
+     * @brief Ida y vuelta de una serie cuyo único cambio de delta es el del caso.
+     */
+    void bucketBoundaries();
+
+    /**
+     * @brief Ida y vuelta de una serie que recorre todos los extremos seguidos.
+     */
+    void allBoundariesInOneBlock();
+
+    /**
+     * @brief Ida y vuelta de series de intervalo y valor constantes, que usan el mínimo de bits por muestra.
+     */
+    void constantSeries();
+
+    /**
+     * @brief Un bloque cuya cabecera declara más muestras de las que caben se rechaza sin reservar memoria.
+     */
+    void rejectsInflatedCount();
+
+    /**
+     * @brief Añadir una serie por partes con append() da los mismos bytes que codificarla de una vez.
+     */
+    void appendMatchesEncode();
+
+    /**
+     * @brief append() rechaza muestras no posteriores y bloques que no corresponden al estado.
+     */
+    void appendRejectsOutOfOrder();
+
+private:
+    /**
+     * @brief Codifica y decodifica, comparando marca de tiempo y valor de cada muestra.
+     * @param points Muestras a verificar.
+     */
+    static void verifyRoundTrip(const QVector<TimePoint>& points);
+};
+
+/**
+ * @brief Codifica y decodifica, comparando marca de tiempo y valor de cada muestra.
+ * @param points Muestras a verificar.
+ */
+void TimeSeriesCodecTests::verifyRoundTrip(const QVector<TimePoint>& points)
+{
+    bool ok = false;
+    const QVector<TimePoint> decoded = TimeSeriesCodec::decode(TimeSeriesCodec::encode(points), &ok);
+    QVERIFY(ok);
+    QCOMPARE(decoded.size(), points.size());
+    for (int i = 0; i < points.size(); ++i) {
+        QCOMPARE(decoded[i].timestampMs, points[i].timestampMs);
+        QCOMPARE(decoded[i].value, points[i].value);
+    }
+}
+
+/**
+ * @brief Delta-of-delta en los extremos de cada cubeta y justo fuera de ellos.
+ */
+void TimeSeriesCodecTests::bucketBoundaries_data()
+{
+    QTest::addColumn<qint64>("deltaOfDelta");
+    const qint64 values[] = {1, -1, 63, -64, 64, -65, 255, -256, 256, -257, 2047, -2048, 2048, -2049};
+    for (qint64 value : values) {
+        QTest::newRow(QByteArray::number(value).constData()) << value;
+    }
+}
+
+/**
+ * @brief Ida y vuelta de una serie cuyo único cambio de delta es el del caso.
+ *
+ * Las tres primeras muestras fijan un delta de 10 s; la cuarta lo cambia en deltaOfDelta y la
+ * quinta lo mantiene, así que la cubeta del caso se usa exactamente una vez.
+ */
+void TimeSeriesCodecTests::bucketBoundaries()
+{
+    QFETCH(qint64, deltaOfDelta);
+    const qint64 start = 1700000000000;
+    const qint64 delta = 10000;
+    const QVector<TimePoint> points = {
+        {start, 70.0},
+        {start + delta, 70.1},
+        {start + 2 * delta, 70.1},
+        {start + 3 * delta + deltaOfDelta, 70.4},
+        {start + 4 * delta + 2 * deltaOfDelta, 69.9},
+    };
+    verifyRoundTrip(points);
+}
+
+/**
+ * @brief Ida y vuelta de una serie que recorre todos los extremos seguidos.
+ */
+void TimeSeriesCodecTests::allBoundariesInOneBlock()
+{
+    const qint64 deltaOfDeltas[] = {0, 63, -64, 64, -65, 255, -256, 256, -257, 2047, -2048, 2048, -2049, 0};
+    QVector<TimePoint> points;
+    qint64 timestamp = 1700000000000;
+    qint64 delta = 60000;
+    double value = 95.0;
+    points.append({timestamp, value});
+    for (qint64 deltaOfDelta : deltaOfDeltas) {
+        delta += deltaOfDelta;
+        timestamp += delta;
+        value += 0.5;
+        points.append({timestamp, value});
+    }
+    verifyRoundTrip(points);
+}
+
+/**
+ * @brief Ida y vuelta de series de intervalo y valor constantes, que usan el mínimo de bits por muestra.
+ */
+void TimeSeriesCodecTests::constantSeries()
+{
+    for (int size : {1, 2, 3, 4, 5, 8, 9, 1000}) {
+        QVector<TimePoint> points;
+        for (int i = 0; i < size; ++i) {
+            points.append({1700000000000 + i * 60000LL, 88.0});
+        }
+        verifyRoundTrip(points);
+    }
+}
+
+/**
+ * @brief Un bloque cuya cabecera declara más muestras de las que caben se rechaza sin reservar memoria.
+ */
+void TimeSeriesCodecTests::rejectsInflatedCount()
+{
+    QVector<TimePoint> points;
+    for (int i = 0; i < 16; ++i) {
+        points.append({1700000000000 + i * 60000LL, 88.0});
+    }
+    const QByteArray block = TimeSeriesCodec::encode(points);
+
+    for (quint32 count : {0u, 0xFFFFFFFFu, 0x7FFFFFFFu, static_cast<quint32>(block.size() * 4)}) {
+        QByteArray damaged = block;
+        damaged[0] = static_cast<char>(count >> 24);
+        damaged[1] = static_cast<char>(count >> 16);
+        damaged[2] = static_cast<char>(count >> 8);
+        damaged[3] = static_cast<char>(count);
+        bool ok = true;
+        QVERIFY(TimeSeriesCodec::decode(damaged, &ok).isEmpty());
+        QVERIFY(!ok);
+    }
+}
+
+/**
+ * @brief Añadir una serie por partes con append() da los mismos bytes que codificarla de una vez.
+ *
+ * Los cortes caen en todas las posiciones, así que el flujo se retoma desde cada desplazamiento de
+ * bit, y el estado pasa por saveTail() y loadTail() entre una parte y la siguiente.
+ */
+void TimeSeriesCodecTests::appendMatchesEncode()
+{
+    QVector<TimePoint> points;
+    qint64 timestamp = 1700000000000;
+    const qint64 steps[] = {60000, 60000, 60001, 59000, 60000, 61000, 1, 300000, 60000, 60000, 60250, 5000000};
+    const double values[] = {95.0, 95.0, 95.5, 120.25, 95.0, -3.0, 0.1, 0.1, 1e300, 88.0, 88.0, 87.5};
+    points.append({timestamp, 94.0});
+    for (int i = 0; i < 12; ++i) {
+        timestamp += steps[i];
+        points.append({timestamp, values[i]});
+    }
+    const QByteArray whole = TimeSeriesCodec::encode(points);
+
+    for (int split = 1; split < points.size(); ++split) {
+        for (int step = 1; step <= 3; ++step) {
+            TimeSeriesTail tail;
+            QByteArray block = TimeSeriesCodec::encode(points.mid(0, split), &tail);
+            for (int next = split; next < points.size(); next += step) {
+                TimeSeriesTail saved;
+                QVERIFY(TimeSeriesCodec::loadTail(TimeSeriesCodec::saveTail(tail), &saved));
+                QVERIFY(TimeSeriesCodec::append(block, saved, points.mid(next, step)));
+                tail = saved;
+            }
+            QCOMPARE(block.toHex(), whole.toHex());
+        }
+    }
+}
+
+/**
+ * @brief append() rechaza muestras no posteriores y bloques que no corresponden al estado.
+ */
+void TimeSeriesCodecTests::appendRejectsOutOfOrder()
+{
+    const QVector<TimePoint> points = {{1000, 1.0}, {2000, 2.0}};
+    TimeSeriesTail tail;
+    QByteArray block = TimeSeriesCodec::encode(points, &tail);
+    const QByteArray original = block;
+
+    const QVector<TimePoint> repeated = {{2000, 3.0}};
+    const QVector<TimePoint> earlier = {{1500, 3.0}};
+    const QVector<TimePoint> duplicated = {{3000, 3.0}, {3000, 4.0}};
+    const QVector<TimePoint> later = {{3000, 3.0}};
+    QVERIFY(!TimeSeriesCodec::append(block, tail, repeated));
+    QVERIFY(!TimeSeriesCodec::append(block, tail, earlier));
+    QVERIFY(!TimeSeriesCodec::append(block, tail, duplicated));
+    QCOMPARE(block, original);
+    QCOMPARE(tail.lastTimestampMs, qint64(2000));
+
+    QByteArray padded = block;
+    padded.append('\0');
+    QVERIFY(!TimeSeriesCodec::append(padded, tail, later));
+    QVERIFY(!TimeSeriesCodec::loadTail(QByteArray(3, '\0'), &tail));
+
+    QVERIFY(TimeSeriesCodec::append(block, tail, later));
+    bool ok = false;
+    QCOMPARE(TimeSeriesCodec::decode(block, &ok).size(), 3);
+    QVERIFY(ok);
+}
+
+/**
+ * @brief Ejecuta las pruebas de TimeSeriesCodec.
+ * @param argc Número de argumentos.
+ * @param argv Argumentos de QtTest.
+ * @return Número de pruebas fallidas.
+ */
+int runTimeSeriesCodecTests(int argc, char** argv)
+{
+    TimeSeriesCodecTests tests;
+    return QTest::qExec(&tests, argc, argv);
+}
+
+#include "TimeSeriesCodecTests.moc"
@@ -0,0 +1,30 @@
+/**
+ * @file main.cpp
+ * @brief Punto de entrada de salud-tests: ejecuta cada clase de pruebas del núcleo.
+ * @author TuNombre
+ * @date 2025-05-24
+ */
+
+#include <QCoreApplication>
+
+int runCSVScannerTests(int argc, char** argv);
+int runPasswordHasherTests(int argc, char** argv);
+int runRecordValidatorTests(int argc, char** argv);
+int runTimeSeriesCodecTests(int argc, char** argv);
+
+/**
+ * @brief Ejecuta todas las clases de pruebas con los mismos argumentos de QtTest.
+ * @param argc Número de argumentos.
+ * @param argv Argumentos de QtTest.
+ * @return Número total de pruebas fallidas; 0 si todas pasan.
+ */
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    int failures = 0;
+    failures += runCSVScannerTests(argc, argv);
+    failures += runPasswordHasherTests(argc, argv);
+    failures += runRecordValidatorTests(argc, argv);
+    failures += runTimeSeriesCodecTests(argc, argv);
+    return failures;
+}
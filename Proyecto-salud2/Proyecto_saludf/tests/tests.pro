@@ -0,0 +1,17 @@
+# Pruebas unitarias del núcleo (QtTest).
+QT += testlib
+QT -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = salud-tests
+
+include(../core/core.pri)
+
+SOURCES += \
+    Source/CSVScannerTests.cpp \
+    Source/PasswordHasherTests.cpp \
+    Source/RecordValidatorTests.cpp \
+    Source/TimeSeriesCodecTests.cpp \
+    Source/main.cpp